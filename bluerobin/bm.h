@@ -213,6 +213,21 @@
 //  #endif
 
 
+#elif defined EZCHRONOS_HOST
+  // Native build on the development host (simulators, host tools)
+  #define ISR(vector)
+  #define MONITOR
+  #define NO_INIT
+  #define INTERRUPTS_ENABLE()
+  #define INTERRUPTS_DISABLE()
+  #define NO_OPERATION()
+  #define INLINE_FUNC
+
+	#define _CPU_TID_             _TI_MSP430_
+	#define _CPU_DIRECTION_OUT_1_ TRUE
+	#define _CPU_EDGE_HIGH_LOW_1_ TRUE
+
+
 #else
   #error "Unknown Compiler, the file bm.h has to be expanded !"
 #endif
@@ -0,0 +1,483 @@
+#!/usr/bin/env python3
+#
+# SimpliciTI access point emulator for host builds of the watch firmware.
+#
+# Plays the part of the eZ430-Chronos USB access point:
+#
+#  - radio side: listens on the MRFI_HOST medium (UDP or UNIX datagram socket, see
+#    simpliciti/Components/mrfi/radios/host/mrfi_radio.c) for simulated watches built with
+#    "make simpliciti_host", answers join/link requests and runs the sync and data protocols
+#    of the real access point. Any number of watches may link at the same time.
+#
+#  - serial side: opens a pseudo terminal that speaks the same packet protocol as the USB
+#    dongle ([0xFF, cmd, length, data...]), so tools such as contrib/read_acceleration.py
+#    work unchanged when pointed at it.
+#
+# Link quality is simulated per watch: a path loss turns the transmit power reported by the
+# watch into an RSSI, and frames are dropped at random or when below sensitivity.
+#
+# Examples:
+#
+#   # access point on a pty, symlinked to /tmp/chronos, talk to it with any serial tool
+#   contrib/ap_emulator.py --tty /tmp/chronos
+#
+#   # benchmark 8 watches streaming acceleration data for 20 seconds with 5% loss
+#   contrib/ap_emulator.py --start acc --spawn 8 --ed-mode acc --duration 20 --loss 0.05
+#
+#   # sync mode regression run: every watch is polled for its status continuously
+#   contrib/ap_emulator.py --start sync --auto-status --spawn 4 --ed-mode sync --duration 15
+#
+
+import argparse
+import json
+import os
+import random
+import select
+import signal
+import socket
+import subprocess
+import sys
+import time
+import tty
+
+# ---------------------------------------------------------------------------------------------
+# Host radio datagram header
+MRFI_HOST_MAGIC = 0x5A
+MRFI_HOST_HDR_SIZE = 4
+
+# ---------------------------------------------------------------------------------------------
+# Serial protocol of the USB access point
+BM_GET_STATUS = 0x00
+BM_RESET = 0x01
+BM_START_SIMPLICITI = 0x07
+BM_GET_SIMPLICITIDATA = 0x08
+BM_STOP_SIMPLICITI = 0x09
+BM_GET_PRODUCT_ID = 0x20
+BM_SYNC_START = 0x30
+BM_SYNC_SEND_COMMAND = 0x31
+BM_SYNC_GET_BUFFER_STATUS = 0x32
+BM_SYNC_READ_BUFFER = 0x33
+
+HW_NO_ERROR = 0x06
+
+HW_IDLE = 0x00
+HW_SIMPLICITI_STOPPED = 0x01
+HW_SIMPLICITI_TRYING_TO_LINK = 0x02
+HW_SIMPLICITI_LINKED = 0x03
+
+PRODUCT_ID = [0x01, 0x00, 0x00, 0x00]
+
+# ---------------------------------------------------------------------------------------------
+# SimpliciTI network layer (simpliciti/Components/nwk)
+SMPL_PORT_LINK = 0x02
+SMPL_PORT_JOIN = 0x03
+AP_USER_PORT = 0x20
+NWK_APP_REPLY_BIT = 0x80
+F_TX_DEVICE_AP = 0x20
+JOIN_REQ_JOIN = 1
+LINK_REQ_LINK = 1
+DEFAULT_JOIN_TOKEN = 0x05060708
+DEFAULT_LINK_TOKEN = 0x01020304
+AP_ADDRESS = bytes([0x32, 0x41, 0x50, 0x01])
+AP_TX_DBM = 1
+
+# ---------------------------------------------------------------------------------------------
+# Watch application protocol (simpliciti/simpliciti.h)
+BM_SYNC_DATA_LENGTH = 19
+SYNC_ED_TYPE_R2R = 1
+SYNC_AP_CMD_NOP = 1
+SYNC_AP_CMD_GET_STATUS = 2
+SYNC_AP_CMD_LINK_RSSI = 8
+SIMPLICITI_SYNC_STARTED_EVENTS = 0x10
+
+SYNC_BUFFER_PACKETS = 64
+
+
+class Watch(object):
+    """State and statistics of one simulated watch, keyed by its device address."""
+
+    def __init__(self, addr, sockaddr, pathloss):
+        self.addr = addr
+        self.sockaddr = sockaddr
+        self.pathloss = pathloss
+        self.ed_port = None
+        self.tid = 0
+        self.first_seen = time.time()
+        self.joined = None
+        self.linked = None
+        self.r2r_since_echo = 0
+        self.pending = None
+        self.pending_sent = None
+        self.rssi = None
+        self.tx_dbm = None
+        self.stats = dict(rx=0, tx=0, lost_up=0, lost_down=0, data=0, r2r=0,
+                          commands=0, replies=0, sync_started=0)
+        self.latency = []
+
+    def name(self):
+        return ''.join('%02x' % b for b in self.addr)
+
+
+class AccessPoint(object):
+
+    def __init__(self, args):
+        self.args = args
+        self.state = HW_SIMPLICITI_STOPPED
+        self.mode = None
+        self.watches = {}
+        self.data = None
+        self.command = None
+        self.sync_buffer = []
+        self.rng = random.Random(args.seed)
+
+        if args.medium.startswith('/'):
+            if os.path.exists(args.medium):
+                os.unlink(args.medium)
+            self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_DGRAM)
+            self.sock.bind(args.medium)
+        else:
+            host, port = args.medium.rsplit(':', 1)
+            info = socket.getaddrinfo(host, int(port), 0, socket.SOCK_DGRAM)[0]
+            self.sock = socket.socket(info[0], socket.SOCK_DGRAM)
+            self.sock.bind(info[4])
+
+        if args.start:
+            self.start(args.start)
+
+    def log(self, msg):
+        if self.args.verbose:
+            sys.stderr.write('ap: %s\n' % msg)
+
+    def start(self, mode):
+        # a second start in the same mode keeps the linked watches, as each dump tool starts sync
+        if mode == self.mode and any(w.linked for w in self.watches.values()):
+            return
+        self.mode = mode
+        self.state = HW_SIMPLICITI_TRYING_TO_LINK
+        self.log('started in %s mode' % mode)
+
+    def stop(self):
+        self.mode = None
+        self.state = HW_SIMPLICITI_STOPPED
+        self.watches = {}
+
+    # -----------------------------------------------------------------------------------------
+    # Radio side
+
+    def radio_rx(self):
+        dgram, sockaddr = self.sock.recvfrom(256)
+        if len(dgram) < MRFI_HOST_HDR_SIZE + 9 or dgram[0] != MRFI_HOST_MAGIC:
+            return
+        chan = dgram[1]
+        tx_dbm = dgram[2] - 256 if dgram[2] > 127 else dgram[2]
+        frame = dgram[MRFI_HOST_HDR_SIZE:]
+        if frame[0] + 1 != len(frame):
+            return
+        dst, src, payload = frame[1:5], frame[5:9], frame[9:]
+        if len(payload) < 3 or (dst != AP_ADDRESS and dst != b'\xff\xff\xff\xff'):
+            return
+
+        w = self.watches.get(src)
+        if w is None:
+            if self.mode is None:
+                return
+            w = Watch(src, sockaddr, self.args.pathloss + self.rng.uniform(-self.args.pathloss_spread,
+                                                                          self.args.pathloss_spread))
+            self.watches[src] = w
+        w.sockaddr = sockaddr
+        w.tx_dbm = tx_dbm
+
+        rssi = tx_dbm - w.pathloss + self.rng.gauss(0, self.args.fading)
+        if rssi < self.args.sensitivity or self.rng.random() < self.args.loss:
+            w.stats['lost_up'] += 1
+            return
+        w.rssi = int(round(rssi))
+        w.stats['rx'] += 1
+
+        port = payload[0] & 0x3F
+        tid = payload[2]
+        app = payload[3:]
+
+        if port == SMPL_PORT_JOIN:
+            self.handle_join(w, chan, tid, app)
+        elif port == SMPL_PORT_LINK:
+            self.handle_link(w, chan, tid, app)
+        elif port == AP_USER_PORT and w.linked:
+            self.handle_user(w, chan, app)
+
+    def radio_tx(self, w, chan, port, app, tid=None):
+        if tid is None:
+            w.tid = (w.tid + 1) & 0xFF
+            tid = w.tid
+        payload = bytes([port, F_TX_DEVICE_AP, tid]) + bytes(app)
+        frame = bytes([8 + len(payload)]) + w.addr + AP_ADDRESS + payload
+
+        rssi = AP_TX_DBM - w.pathloss + self.rng.gauss(0, self.args.fading)
+        if rssi < self.args.sensitivity or self.rng.random() < self.args.loss:
+            w.stats['lost_down'] += 1
+            return
+        lqi = max(0, min(127, int(rssi - self.args.sensitivity)))
+        hdr = bytes([MRFI_HOST_MAGIC, chan, int(round(rssi)) & 0xFF, lqi])
+        try:
+            self.sock.sendto(hdr + frame, w.sockaddr)
+            w.stats['tx'] += 1
+        except socket.error:
+            pass
+
+    def handle_join(self, w, chan, tid, app):
+        if len(app) < 8 or app[0] != JOIN_REQ_JOIN:
+            return
+        if int.from_bytes(app[2:6], 'little') != DEFAULT_JOIN_TOKEN:
+            return
+        w.joined = time.time()
+        reply = [JOIN_REQ_JOIN | NWK_APP_REPLY_BIT, app[1]] + list(DEFAULT_LINK_TOKEN.to_bytes(4, 'little')) + [0]
+        self.radio_tx(w, chan, SMPL_PORT_JOIN, reply, tid)
+        self.log('%s joined' % w.name())
+
+    def handle_link(self, w, chan, tid, app):
+        if len(app) < 9 or app[0] != LINK_REQ_LINK:
+            return
+        if int.from_bytes(app[2:6], 'little') != DEFAULT_LINK_TOKEN:
+            return
+        w.ed_port = app[6]
+        if not w.linked:
+            w.linked = time.time()
+            self.log('%s linked after %.0f ms' % (w.name(), (w.linked - w.first_seen) * 1000))
+        self.state = HW_SIMPLICITI_LINKED
+        self.radio_tx(w, chan, SMPL_PORT_LINK, [LINK_REQ_LINK | NWK_APP_REPLY_BIT, app[1], AP_USER_PORT, 0], tid)
+
+    def handle_user(self, w, chan, app):
+        if len(app) == 2 and app[0] == SYNC_ED_TYPE_R2R:
+            w.stats['r2r'] += 1
+            if self.mode == 'sync':
+                self.radio_tx(w, chan, w.ed_port, self.next_command(w))
+        elif len(app) == BM_SYNC_DATA_LENGTH:
+            w.stats['replies'] += 1
+            if w.pending_sent is not None:
+                w.latency.append(time.time() - w.pending_sent)
+                w.pending_sent = None
+            if len(self.sync_buffer) < SYNC_BUFFER_PACKETS:
+                self.sync_buffer.append(bytes(app))
+        elif len(app) == 4:
+            if app[0] == SIMPLICITI_SYNC_STARTED_EVENTS:
+                w.stats['sync_started'] += 1
+            else:
+                w.stats['data'] += 1
+                self.data = bytes(app)
+
+    def next_command(self, w):
+        cmd = None
+        if self.command is not None:
+            cmd, self.command = self.command, None
+        elif self.args.auto_status and w.pending_sent is None:
+            cmd = bytes([SYNC_AP_CMD_GET_STATUS])
+        elif self.args.rssi_echo and w.r2r_since_echo + 1 >= self.args.rssi_echo:
+            cmd = bytes([SYNC_AP_CMD_LINK_RSSI, w.rssi & 0xFF])
+
+        if cmd is None:
+            w.r2r_since_echo += 1
+            cmd = bytes([SYNC_AP_CMD_NOP])
+        else:
+            w.stats['commands'] += 1
+            if cmd[0] == SYNC_AP_CMD_LINK_RSSI:
+                w.r2r_since_echo = 0
+            elif cmd[0] == SYNC_AP_CMD_GET_STATUS:
+                w.pending_sent = time.time()
+        return cmd + bytes(BM_SYNC_DATA_LENGTH - len(cmd))
+
+    # -----------------------------------------------------------------------------------------
+    # Serial side
+
+    def serial_packet(self, cmd, data):
+        if cmd == BM_GET_STATUS:
+            return [self.state]
+        if cmd == BM_RESET:
+            self.stop()
+            self.state = HW_IDLE
+            return []
+        if cmd == BM_START_SIMPLICITI:
+            self.start('acc')
+            return []
+        if cmd == BM_GET_SIMPLICITIDATA:
+            if self.data is None:
+                return [0xFF, 0x00, 0x00, 0x00]
+            d, self.data = self.data, None
+            return list(d)
+        if cmd == BM_STOP_SIMPLICITI:
+            self.stop()
+            return []
+        if cmd == BM_GET_PRODUCT_ID:
+            return PRODUCT_ID
+        if cmd == BM_SYNC_START:
+            self.start('sync')
+            return []
+        if cmd == BM_SYNC_SEND_COMMAND:
+            self.command = bytes(data[:BM_SYNC_DATA_LENGTH]).ljust(BM_SYNC_DATA_LENGTH, b'\0')
+            return []
+        if cmd == BM_SYNC_GET_BUFFER_STATUS:
+            return [min(len(self.sync_buffer), 0xFF)]
+        if cmd == BM_SYNC_READ_BUFFER:
+            if not self.sync_buffer:
+                return [0] * BM_SYNC_DATA_LENGTH
+            return list(self.sync_buffer.pop(0))
+        return []
+
+
+class SerialPort(object):
+    """Pseudo terminal speaking the USB access point packet protocol."""
+
+    def __init__(self, ap, link):
+        self.ap = ap
+        self.master, slave = os.openpty()
+        tty.setraw(slave)
+        self.name = os.ttyname(slave)
+        self.slave = slave
+        self.buf = b''
+        self.link = link
+        if link:
+            if os.path.lexists(link):
+                os.unlink(link)
+            os.symlink(self.name, link)
+        sys.stderr.write('ap: serial port %s\n' % (link or self.name))
+
+    def rx(self):
+        try:
+            self.buf += os.read(self.master, 256)
+        except OSError:
+            return
+        while len(self.buf) >= 3:
+            if self.buf[0] != 0xFF:
+                self.buf = self.buf[1:]
+                continue
+            length = max(self.buf[2], 3)
+            if len(self.buf) < length:
+                break
+            cmd, data, self.buf = self.buf[1], self.buf[3:length], self.buf[length:]
+            reply = self.ap.serial_packet(cmd, data)
+            os.write(self.master, bytes([0xFF, HW_NO_ERROR, 3 + len(reply)] + reply))
+
+    def close(self):
+        if self.link and os.path.islink(self.link):
+            os.unlink(self.link)
+
+
+def spawn_watches(args):
+    procs = []
+    env = dict(os.environ, MRFI_HOST_MEDIUM=args.medium)
+    for i in range(args.spawn):
+        addr = '%02x%02x%02x%02x' % (0x10 + (i >> 8), 0x00, 0xC4, i & 0xFF)
+        cmd = [args.ed_binary, '-q', '-m', args.ed_mode, '-a', addr]
+        if args.duration:
+            cmd += ['-t', str(args.duration)]
+        procs.append(subprocess.Popen(cmd, env=env, stdout=subprocess.PIPE, universal_newlines=True))
+    return procs
+
+
+def report(ap, elapsed, ed_lines):
+    watches = sorted(ap.watches.values(), key=lambda w: w.addr)
+    rows = []
+    for w in watches:
+        s = dict(w.stats)
+        s['address'] = w.name()
+        s['link_ms'] = int((w.linked - w.first_seen) * 1000) if w.linked else None
+        s['rssi'] = w.rssi
+        s['tx_dbm'] = w.tx_dbm
+        s['data_per_s'] = round(s['data'] / elapsed, 1) if elapsed else 0
+        sent = s['rx'] + s['lost_up']
+        s['loss_up'] = round(float(s['lost_up']) / sent, 3) if sent else 0
+        if w.latency:
+            lat = sorted(w.latency)
+            s['latency_ms'] = dict(min=round(lat[0] * 1000, 1),
+                                   median=round(lat[len(lat) // 2] * 1000, 1),
+                                   max=round(lat[-1] * 1000, 1))
+        rows.append(s)
+
+    sys.stdout.write('%-8s %7s %6s %6s %6s %6s %6s %6s %8s %5s %5s %s\n' %
+                     ('watch', 'link_ms', 'rx', 'tx', 'lostU', 'lostD', 'data/s', 'r2r', 'replies',
+                      'rssi', 'dBm', 'latency ms (min/med/max)'))
+    for s in rows:
+        lat = s.get('latency_ms')
+        sys.stdout.write('%-8s %7s %6d %6d %6d %6d %6.1f %6d %8d %5s %5s %s\n' %
+                         (s['address'], s['link_ms'], s['rx'], s['tx'], s['lost_up'], s['lost_down'],
+                          s['data_per_s'], s['r2r'], s['replies'], s['rssi'], s['tx_dbm'],
+                          '%s/%s/%s' % (lat['min'], lat['median'], lat['max']) if lat else '-'))
+    for line in ed_lines:
+        sys.stdout.write(line)
+    return rows
+
+
+def main():
+    p = argparse.ArgumentParser(description='SimpliciTI access point emulator for host watch builds')
+    p.add_argument('--medium', default=os.environ.get('MRFI_HOST_MEDIUM', '127.0.0.1:47100'),
+                   help='host:port for UDP or /path for a UNIX datagram socket')
+    p.add_argument('--tty', metavar='LINK', help='symlink the serial pty to this path')
+    p.add_argument('--no-tty', action='store_true', help='do not open a serial pty')
+    p.add_argument('--start', choices=['acc', 'sync'], help='start without a serial command')
+    p.add_argument('--auto-status', action='store_true',
+                   help='sync mode: keep asking every watch for its status, measure latency')
+    p.add_argument('--rssi-echo', type=int, default=4, metavar='N',
+                   help='sync mode: report link RSSI every N idle ready-to-receive packets (0 = off)')
+    p.add_argument('--pathloss', type=float, default=60.0, help='mean path loss in dB')
+    p.add_argument('--pathloss-spread', type=float, default=0.0,
+                   help='per watch path loss is drawn from mean +/- spread')
+    p.add_argument('--fading', type=float, default=1.0, help='RSSI standard deviation in dB')
+    p.add_argument('--sensitivity', type=float, default=-100.0, help='receiver sensitivity in dBm')
+    p.add_argument('--loss', type=float, default=0.0, help='random frame loss probability')
+    p.add_argument('--seed', type=int, help='random seed for reproducible runs')
+    p.add_argument('--spawn', type=int, default=0, metavar='N', help='start N simulated watches')
+    p.add_argument('--ed-mode', choices=['sync', 'acc', 'ppt'], default='sync')
+    p.add_argument('--ed-binary', default=os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                                       '..', 'build', 'host', 'simpliciti_ed'))
+    p.add_argument('--duration', type=int, default=0, help='stop after this many seconds')
+    p.add_argument('--json', metavar='FILE', help='write statistics as JSON')
+    p.add_argument('-v', '--verbose', action='store_true')
+    args = p.parse_args()
+
+    ap = AccessPoint(args)
+    port = None if args.no_tty else SerialPort(ap, args.tty)
+    procs = spawn_watches(args) if args.spawn else []
+
+    running = [True]
+    signal.signal(signal.SIGINT, lambda *a: running.__setitem__(0, False))
+    signal.signal(signal.SIGTERM, lambda *a: running.__setitem__(0, False))
+
+    t0 = time.time()
+    # give spawned watches time to finish their last cycle and print statistics
+    end = t0 + args.duration + 2 if args.duration else None
+    fds = [ap.sock] + ([port.master] if port else [])
+    while running[0]:
+        if end and time.time() >= end:
+            break
+        if procs and all(pr.poll() is not None for pr in procs):
+            break
+        r, _, _ = select.select(fds, [], [], 0.1)
+        if ap.sock in r:
+            ap.radio_rx()
+        if port and port.master in r:
+            port.rx()
+    elapsed = time.time() - t0
+
+    ed_lines = []
+    for pr in procs:
+        if pr.poll() is None:
+            pr.terminate()
+        out = pr.communicate()[0]
+        ed_lines.extend(out.splitlines(True))
+
+    rows = report(ap, min(elapsed, args.duration) if args.duration else elapsed, ed_lines)
+    if args.json:
+        with open(args.json, 'w') as f:
+            json.dump(dict(elapsed=elapsed, watches=rows), f, indent=1)
+    if port:
+        port.close()
+    if args.medium.startswith('/') and os.path.exists(args.medium):
+        os.unlink(args.medium)
+
+    # with spawned watches, fail if any of them did not link
+    if procs and (len([w for w in ap.watches.values() if w.linked]) < len(procs)):
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
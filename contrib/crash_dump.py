@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+#
+# Post-mortem dump of the watch crash recorder (CONFIG_CRASH_LOG).
+#
+# Reads the crash record over the sync protocol (SYNC_AP_CMD_GET_CRASH) through the USB access
+# point or contrib/ap_emulator.py, or from a file saved by an earlier run, and prints reset cause,
+# watchdog reason, last interrupt, interrupted PC/SP and the last events before the reset.
+# With --elf the PC is resolved to a source line.
+#
+# Examples:
+#
+#   # watch in SYNC mode, access point on the default port, resolve PC, clear record after reading
+#   contrib/crash_dump.py --tty /dev/ttyACM0 --elf build/eZChronos.elf --clear
+#
+#   # keep the raw pages for a bug report
+#   contrib/crash_dump.py --tty /tmp/chronos --save crash.txt
+#   contrib/crash_dump.py --load crash.txt
+#
+
+import argparse
+import subprocess
+import sys
+
+from sync_pages import read_pages, erase_log, load_pages, save_pages, u16
+
+# ---------------------------------------------------------------------------------------------
+# Watch application protocol (simpliciti/simpliciti.h, driver/crash.h)
+SYNC_ED_TYPE_CRASH = 5
+SYNC_AP_CMD_GET_CRASH = 10
+CRASH_PAGES = 2
+CRASH_TRACE_LENGTH = 8
+
+# SYSRSTIV of the CC430F6137
+RESET_NAMES = {
+    0x00: 'none', 0x02: 'brownout', 0x04: 'RST/NMI pin', 0x06: 'software BOR', 0x08: 'LPMx.5 wakeup',
+    0x0A: 'security violation', 0x0C: 'SVSL', 0x0E: 'SVSH', 0x10: 'SVML overvoltage',
+    0x12: 'SVMH overvoltage', 0x14: 'software POR', 0x16: 'watchdog timeout',
+    0x18: 'watchdog password violation', 0x1A: 'flash password violation', 0x1C: 'PLL unlock',
+    0x1E: 'peripheral area fetch', 0x20: 'PMM password violation',
+}
+WATCHDOG_NAMES = ['-', 'software pre-timeout (main loop stuck)', 'hardware timeout (interrupts disabled)']
+ISR_NAMES = ['-', 'TIMER0_A0', 'TIMER0_A1', 'PORT2', 'ADC12', 'RADIO']
+
+# Trace events, type in the upper 4 bits
+BUTTON_NAMES = ['star', 'num', 'up', 'down', 'backlight', 'star long', 'num long']
+# Only the first request flags are fixed, the rest depends on the configuration (include/project.h)
+REQUEST_NAMES = ['temperature', 'voltage', 'altitude']
+
+
+def decode(pages):
+    head, tail = pages
+    record = [u16(head, 2 + 2 * i) for i in range(6)]
+    trace = [u16(tail, 2 + 2 * i) for i in range(CRASH_TRACE_LENGTH)]
+    return dict(count=record[0], reset=record[1], isr=record[2] >> 8, watchdog=record[2] & 0xFF,
+                pc=record[3], sp=record[4], hour=record[5] >> 8, minute=record[5] & 0xFF,
+                trace=[t for t in trace if t])
+
+
+def name(names, value):
+    return names[value] if value < len(names) else str(value)
+
+
+def flags(value, names):
+    set_ = [names[i] if i < len(names) else 'bit%d' % i for i in range(12) if value & (1 << i)]
+    return ', '.join(set_) or '-'
+
+
+def event(entry):
+    kind, value = entry >> 12, entry & 0x0FFF
+    if kind == 1:
+        return 'wakeup   buttons: %s' % flags(value, BUTTON_NAMES)
+    if kind == 2:
+        return 'request  %s' % flags(value, REQUEST_NAMES)
+    if kind == 3:
+        return 'radio    %s' % ('open' if value else 'close')
+    return 'unknown  0x%04X' % entry
+
+
+def resolve(elf, addr2line, pc):
+    try:
+        out = subprocess.check_output([addr2line, '-f', '-C', '-e', elf, '0x%04x' % pc])
+    except (OSError, subprocess.CalledProcessError) as e:
+        return '(%s)' % e
+    func, line = (out.decode('latin-1').splitlines() + ['?', '?'])[:2]
+    return '%s at %s' % (func, line)
+
+
+def report(crash, args):
+    if crash['count'] == 0:
+        print('no crash recorded')
+        return
+    print('crashes since last clear: %d' % crash['count'])
+    print('last reset cause:  %s (SYSRSTIV 0x%02X)' % (RESET_NAMES.get(crash['reset'], 'unknown'), crash['reset']))
+    print('watchdog:          %s' % name(WATCHDOG_NAMES, crash['watchdog']))
+    print('last interrupt:    %s' % name(ISR_NAMES, crash['isr']))
+    print('watch time:        %02d:%02d' % (crash['hour'], crash['minute']))
+    if crash['pc']:
+        where = ' ' + resolve(args.elf, args.addr2line, crash['pc']) if args.elf else ''
+        print('interrupted PC:    0x%04X%s' % (crash['pc'], where))
+        print('SP:                0x%04X' % crash['sp'])
+    print('last events (oldest first):')
+    for entry in crash['trace']:
+        print('  ' + event(entry))
+
+
+def main():
+    p = argparse.ArgumentParser(description='Post-mortem dump of the watch crash recorder')
+    src = p.add_mutually_exclusive_group(required=True)
+    src.add_argument('--tty', metavar='PORT', help='access point serial port (e.g. /dev/ttyACM0)')
+    src.add_argument('--load', metavar='FILE', help='read raw pages saved with --save')
+    p.add_argument('--save', metavar='FILE', help='save raw pages as hex lines')
+    p.add_argument('--clear', action='store_true', help='clear the record on the watch once it was read and decoded')
+    p.add_argument('--timeout', type=float, default=30.0, help='seconds to wait for link and data')
+    p.add_argument('--elf', help='firmware image to resolve the PC')
+    p.add_argument('--addr2line', default='msp430-addr2line')
+    args = p.parse_args()
+
+    if args.tty:
+        pages = read_pages(args.tty, SYNC_AP_CMD_GET_CRASH, SYNC_ED_TYPE_CRASH,
+                           lambda head: CRASH_PAGES,
+                           timeout=args.timeout, name='crash')
+    else:
+        pages = load_pages(args.load)
+
+    if args.save:
+        save_pages(args.save, pages)
+
+    crash = decode(pages)
+    report(crash, args)
+
+    # Clear only once the record was received and decoded
+    if args.tty and args.clear:
+        if not erase_log(args.tty, SYNC_ED_TYPE_CRASH, crash['count'], args.timeout, 'crash'):
+            print('crash record not cleared, the watch crashed again since it was read')
+            return 1
+        print('crash record cleared')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
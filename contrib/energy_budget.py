@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+#
+# Average current estimate from the on-watch energy profiler (CONFIG_PROFILE).
+#
+# Reads the profile counters over the sync protocol (SYNC_AP_CMD_GET_PROFILE) through the USB
+# access point or contrib/ap_emulator.py, or from a file saved by an earlier run, and turns
+# wakeups, CPU active time and radio airtime into a current budget in uA.
+#
+# The counters only tell how long each part of the system was on, the currents come from the
+# command line. Defaults are datasheet values for the CC430F6137 at the operating points used
+# by the firmware (3MHz MCLK at VCore 0, 12MHz at VCore 3 while the radio is on).
+#
+# Examples:
+#
+#   # watch in SYNC mode, access point on the default port, clear counters after reading
+#   contrib/energy_budget.py --tty /dev/ttyACM0 --clear
+#
+#   # keep the raw pages, evaluate later with a different radio current
+#   contrib/energy_budget.py --tty /tmp/chronos --save profile.txt
+#   contrib/energy_budget.py --load profile.txt --rx-ma 18
+#
+
+import argparse
+import sys
+
+from sync_pages import read_pages, erase_log, load_pages, save_pages, u16, u32
+
+# ---------------------------------------------------------------------------------------------
+# Watch application protocol (simpliciti/simpliciti.h, driver/profile.h)
+SYNC_ED_TYPE_PROFILE = 4
+SYNC_AP_CMD_GET_PROFILE = 9
+
+PROFILE_SOURCES_PER_PAGE = 2
+SOURCE_NAMES = ['timer0_a0', 'timer0_a1', 'buttons', 'adc12', 'radio', 'accel', 'pressure', 'other']
+
+ACLK_HZ = 32768.0
+
+
+def decode(pages):
+    head = pages[0]
+    profile = dict(seconds=u32(head, 2), rx=u32(head, 6) / ACLK_HZ, tx=u32(head, 10) / ACLK_HZ,
+                   stack=u16(head, 15), sources=[])
+    for n in range(head[14]):
+        p = pages[1 + n // PROFILE_SOURCES_PER_PAGE]
+        o = 2 + (n % PROFILE_SOURCES_PER_PAGE) * 6
+        name = SOURCE_NAMES[n] if n < len(SOURCE_NAMES) else 'source%d' % n
+        profile['sources'].append((name, u16(p, o), u32(p, o + 2) / ACLK_HZ))
+    return profile
+
+
+def budget(profile, args):
+    up = float(max(profile['seconds'], 1))
+    rows = []
+    active_total = 0.0
+    for name, wakeups, active in profile['sources']:
+        ma = args.radio_active_ma if name == 'radio' else args.active_ma
+        rows.append((name, wakeups * 3600.0 / up, active * 1000.0 / up, active * ma * 1000.0 / up))
+        active_total += active
+    rows.append(('radio rx', None, profile['rx'] * 1000.0 / up, profile['rx'] * args.rx_ma * 1000.0 / up))
+    rows.append(('radio tx', None, profile['tx'] * 1000.0 / up, profile['tx'] * args.tx_ma * 1000.0 / up))
+    sleep = max(up - active_total, 0.0)
+    rows.append(('lpm3', None, sleep * 1000.0 / up, sleep * args.sleep_ua / up))
+    return rows
+
+
+def report(profile, rows, args):
+    print('uptime %d s, stack high water mark %d bytes' % (profile['seconds'], profile['stack']))
+    print('%-10s %10s %12s %10s' % ('source', 'wakeups/h', 'on ms/s', 'uA'))
+    total = 0.0
+    for name, rate, duty, ua in rows:
+        total += ua
+        print('%-10s %10s %12.3f %10.2f' % (name, '-' if rate is None else '%.0f' % rate, duty, ua))
+    print('%-10s %10s %12s %10.2f' % ('total', '', '', total))
+    if total > 0:
+        days = args.battery_mah * 1000.0 / total / 24.0
+        print('%.0f mAh battery: %.0f days' % (args.battery_mah, days))
+
+
+def main():
+    p = argparse.ArgumentParser(description='Current budget from the watch energy profiler')
+    src = p.add_mutually_exclusive_group(required=True)
+    src.add_argument('--tty', metavar='PORT', help='access point serial port (e.g. /dev/ttyACM0)')
+    src.add_argument('--load', metavar='FILE', help='read raw pages saved with --save')
+    p.add_argument('--save', metavar='FILE', help='save raw pages as hex lines')
+    p.add_argument('--clear', action='store_true', help='clear the counters on the watch once they were read and printed')
+    p.add_argument('--timeout', type=float, default=30.0, help='seconds to wait for link and data')
+    p.add_argument('--sleep-ua', type=float, default=3.5,
+                   help='LPM3 current with RTC, LCD and idle sensors in uA')
+    p.add_argument('--active-ma', type=float, default=0.65, help='CPU active current at 3MHz in mA')
+    p.add_argument('--radio-active-ma', type=float, default=2.6,
+                   help='CPU active current at 12MHz (radio wakeups) in mA')
+    p.add_argument('--rx-ma', type=float, default=16.0, help='radio RX current in mA')
+    p.add_argument('--tx-ma', type=float, default=17.0, help='radio TX current in mA')
+    p.add_argument('--battery-mah', type=float, default=220.0, help='battery capacity for the lifetime estimate')
+    args = p.parse_args()
+
+    if args.tty:
+        pages = read_pages(args.tty, SYNC_AP_CMD_GET_PROFILE, SYNC_ED_TYPE_PROFILE,
+                           lambda head: 1 + (head[14] + PROFILE_SOURCES_PER_PAGE - 1) // PROFILE_SOURCES_PER_PAGE,
+                           timeout=args.timeout, name='profile')
+    else:
+        pages = load_pages(args.load)
+
+    if args.save:
+        save_pages(args.save, pages)
+
+    profile = decode(pages)
+    report(profile, budget(profile, args), args)
+
+    # Start a new measurement period only once the counters were received and printed
+    if args.tty and args.clear:
+        if not erase_log(args.tty, SYNC_ED_TYPE_PROFILE, 0, args.timeout, 'profile'):
+            print('profile counters not cleared')
+            return 1
+        print('profile counters cleared')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+#
+# Download and print the daily temperature and battery history of the watch (CONFIG_HISTORY).
+#
+# Reads the history over the sync protocol (SYNC_AP_CMD_GET_HISTORY) through the USB access
+# point or contrib/ap_emulator.py, or from a file saved by an earlier run, and prints one line per
+# day with minimum, maximum and mean temperature and mean and minimum battery voltage. The trend
+# of the daily mean voltage is extrapolated to the low battery threshold of the watch.
+#
+# Examples:
+#
+#   # watch in SYNC mode, access point on the default port, erase the history after reading
+#   contrib/history_dump.py --tty /dev/ttyACM0 --clear
+#
+#   # keep the raw pages, fit the trend to the last 14 days only
+#   contrib/history_dump.py --tty /tmp/chronos --save history.txt
+#   contrib/history_dump.py --load history.txt --days 14
+#
+
+import argparse
+import sys
+
+from sync_pages import read_pages, erase_log, load_pages, save_pages, u16
+
+# ---------------------------------------------------------------------------------------------
+# Watch application protocol (simpliciti/simpliciti.h, logic/history.h, logic/battery.h)
+SYNC_ED_TYPE_HISTORY = 9
+SYNC_AP_CMD_GET_HISTORY = 14
+HISTORY_RECORD = 12
+HISTORY_BATT_BASE = 100
+HISTORY_SAMPLES_UNIT = 6
+BATTERY_LOW_THRESHOLD = 240
+
+
+def s16(data, offset):
+    value = u16(data, offset)
+    return value - 0x10000 if value & 0x8000 else value
+
+
+def record(r):
+    return dict(month=r[0], day=r[1], temp_min=s16(r, 2), temp_max=s16(r, 4), temp_mean=s16(r, 6),
+                batt_mean=u16(r, 8), batt_min=(r[10] + HISTORY_BATT_BASE) * 10,
+                hours=r[11] * HISTORY_SAMPLES_UNIT / 60.0)
+
+
+def decode(pages):
+    today = pages[0][3:3 + HISTORY_RECORD]
+    days = [record(page[2:2 + HISTORY_RECORD]) for page in pages[1:]]
+    return days, record(today) if today[11] else None
+
+
+def trend(days):
+    """Least squares slope of the daily mean voltage in mV/day, as shown by the watch"""
+    n = len(days)
+    if n < 3:
+        return None
+    ys = [d['batt_mean'] for d in days]
+    sx, sy = sum(range(n)), sum(ys)
+    sxx, sxy = sum(i * i for i in range(n)), sum(i * y for i, y in enumerate(ys))
+    slope = (n * sxy - sx * sy) / float(n * sxx - sx * sx)
+    return slope, sy / float(n) - slope * sx / float(n)
+
+
+def line(d, label):
+    return '%-7s  %5.1f %5.1f %5.1f C   %5.3f V  %5.2f V  %4.1f h' % (
+        label, d['temp_min'] / 10.0, d['temp_max'] / 10.0, d['temp_mean'] / 10.0,
+        d['batt_mean'] / 1000.0, d['batt_min'] / 1000.0, d['hours'])
+
+
+def report(days, today, args):
+    print('%-7s  %5s %5s %5s     %7s  %7s  %6s' % ('day', 'min', 'max', 'mean', 'battery', 'lowest', 'sampled'))
+    for d in days:
+        print(line(d, '%02d.%02d.' % (d['day'], d['month'])))
+    if today:
+        print(line(today, 'today'))
+    if not days:
+        print('no days logged')
+        return
+
+    fit = trend(days[-args.days:])
+    if fit is None:
+        print('battery trend: needs 3 days')
+        return
+    slope, offset = fit
+    n = len(days[-args.days:])
+    print('battery trend: %+.2f mV/day over %d days' % (slope, n))
+    if slope < 0:
+        now = offset + slope * (n - 1)
+        left = (now - BATTERY_LOW_THRESHOLD * 10) / -slope
+        print('low battery (%.2f V) in about %d days' % (BATTERY_LOW_THRESHOLD / 100.0, max(0, left)))
+
+
+def main():
+    p = argparse.ArgumentParser(description='Download and print the daily temperature and battery history of the watch')
+    src = p.add_mutually_exclusive_group(required=True)
+    src.add_argument('--tty', metavar='PORT', help='access point serial port (e.g. /dev/ttyACM0)')
+    src.add_argument('--load', metavar='FILE', help='read raw pages saved with --save')
+    p.add_argument('--save', metavar='FILE', help='save raw pages as hex lines')
+    p.add_argument('--clear', action='store_true', help='erase the history on the watch once it was read and printed')
+    p.add_argument('--timeout', type=float, default=30.0, help='seconds to wait for link and data')
+    p.add_argument('--days', type=int, default=30, help='days the battery trend is fitted to')
+    args = p.parse_args()
+
+    if args.tty:
+        pages = read_pages(args.tty, SYNC_AP_CMD_GET_HISTORY, SYNC_ED_TYPE_HISTORY,
+                           lambda head: 1 + head[2],
+                           timeout=args.timeout, name='history')
+    else:
+        pages = load_pages(args.load)
+
+    if args.save:
+        save_pages(args.save, pages)
+
+    days, today = decode(pages)
+    report(days, today, args)
+
+    # Erase only once all days were received and printed
+    if args.tty and args.clear:
+        if not erase_log(args.tty, SYNC_ED_TYPE_HISTORY, pages[0][2], args.timeout, 'history'):
+            print('history not erased, a day was completed since it was read')
+            return 1
+        print('history erased')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
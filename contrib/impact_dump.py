@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+#
+# Download and print the falls and shocks logged by the watch (CONFIG_IMPACT).
+#
+# Reads the event log over the sync protocol (SYNC_AP_CMD_GET_IMPACT) through the USB access
+# point or contrib/ap_emulator.py, or from a file saved by an earlier run, and prints one line per
+# event with date, time, type and peak acceleration.
+#
+# Examples:
+#
+#   # watch in SYNC mode, access point on the default port, erase the log after reading
+#   contrib/impact_dump.py --tty /dev/ttyACM0 --clear
+#
+#   # keep the raw pages, list only events above 6g
+#   contrib/impact_dump.py --tty /tmp/chronos --save impacts.txt
+#   contrib/impact_dump.py --load impacts.txt --min 6000
+#
+
+import argparse
+import sys
+
+from sync_pages import read_pages, erase_log, load_pages, save_pages, u16
+
+# ---------------------------------------------------------------------------------------------
+# Watch application protocol (simpliciti/simpliciti.h, logic/impact.h)
+SYNC_ED_TYPE_IMPACT = 7
+SYNC_AP_CMD_GET_IMPACT = 12
+IMPACT_RECORD = 8
+IMPACT_RECORDS_PER_PAGE = 2
+TYPE_NAMES = {1: 'fall', 2: 'shock'}
+
+
+def decode(pages):
+    count = pages[0][2]
+    data = []
+    for page in pages[1:]:
+        data += page[2:2 + IMPACT_RECORDS_PER_PAGE * IMPACT_RECORD]
+    events = []
+    for i in range(count):
+        r = data[i * IMPACT_RECORD:(i + 1) * IMPACT_RECORD]
+        events.append(dict(type=r[0], month=r[1], day=r[2], hour=r[3], minute=r[4], second=r[5],
+                           peak=u16(r, 6)))
+    return events
+
+
+def report(events, args):
+    if not events:
+        print('no events logged')
+        return
+    shown = [e for e in events if e['peak'] >= args.min]
+    for e in shown:
+        print('%02d.%02d. %02d:%02d:%02d  %-5s  %5.1f g' % (
+            e['day'], e['month'], e['hour'], e['minute'], e['second'],
+            TYPE_NAMES.get(e['type'], e['type']), e['peak'] / 1000.0))
+    print('%d events, %d shown, %d falls, largest peak %.1f g' % (
+        len(events), len(shown), sum(1 for e in events if e['type'] == 1),
+        max(e['peak'] for e in events) / 1000.0))
+
+
+def main():
+    p = argparse.ArgumentParser(description='Download and print the falls and shocks logged by the watch')
+    src = p.add_mutually_exclusive_group(required=True)
+    src.add_argument('--tty', metavar='PORT', help='access point serial port (e.g. /dev/ttyACM0)')
+    src.add_argument('--load', metavar='FILE', help='read raw pages saved with --save')
+    p.add_argument('--save', metavar='FILE', help='save raw pages as hex lines')
+    p.add_argument('--clear', action='store_true', help='erase the log on the watch once it was read and printed')
+    p.add_argument('--timeout', type=float, default=30.0, help='seconds to wait for link and data')
+    p.add_argument('--min', type=int, default=0, metavar='MG', help='only list events with a larger peak')
+    args = p.parse_args()
+
+    if args.tty:
+        pages = read_pages(args.tty, SYNC_AP_CMD_GET_IMPACT, SYNC_ED_TYPE_IMPACT,
+                           lambda head: 1 + (head[2] + IMPACT_RECORDS_PER_PAGE - 1) // IMPACT_RECORDS_PER_PAGE,
+                           timeout=args.timeout, name='event')
+    else:
+        pages = load_pages(args.load)
+
+    if args.save:
+        save_pages(args.save, pages)
+
+    report(decode(pages), args)
+
+    # Erase only once all events were received and printed
+    if args.tty and args.clear:
+        if not erase_log(args.tty, SYNC_ED_TYPE_IMPACT, pages[0][2], args.timeout, 'event'):
+            print('event log not erased, an event was logged since it was read')
+            return 1
+        print('event log erased')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,196 @@
+#!/usr/bin/env python3
+#
+# Sensor recordings for the record/replay harness (host/replay.c, make replay_host).
+#
+# Synthesizes recordings from a simple profile, or captures accelerometer and button events from
+# a watch in ACC mode through the USB access point. Pressure and temperature of a real walk or
+# flight are logged the same way with any barometer logger and converted to the "<ms> P" lines.
+#
+# Recording format, one event per line, time in milliseconds:
+#
+#   <ms> P <pressure Pa> <temperature 0.1K>
+#   <ms> A <x> <y> <z>
+#   <ms> B <button>
+#
+# Examples:
+#
+#   # 2 hours hiking up 600m and down again, pressure every second, with sensor noise
+#   contrib/make_recording.py climb --minutes 120 --climb 600 > hike.rec
+#   build/host/replay -m accumulator -h 400 hike.rec
+#
+#   # knock pattern for the doorlock, 3 short and 1 long pause
+#   contrib/make_recording.py knock --pauses 300,300,300,900 > knock.rec
+#
+#   # enroll the pattern, then knock it 5 more times somewhat off the beat
+#   contrib/make_recording.py knock --pauses 300,300,300,900 --repeat 6 --jitter 40 > knocks.rec
+#   build/host/replay -m doorlock knocks.rec
+#
+#   # 7 hours of sleep in 90 minute cycles, smart alarm window ending at 07:00
+#   contrib/make_recording.py night --minutes 420 > night.rec
+#   build/host/replay -m phase -a 07:00 night.rec
+#
+#   # two days at home, a front passes after 24 hours with a fall of 12hPa in 4 hours
+#   contrib/make_recording.py front --hours 48 --at 24 --fall 12 --over 4 > front.rec
+#   build/host/replay -m weather front.rec
+#
+#   # capture 60s of real accelerometer data, watch in ACC mode
+#   contrib/make_recording.py capture --tty /dev/ttyACM0 --seconds 60 > wrist.rec
+#
+
+import argparse
+import math
+import random
+import sys
+import time
+
+# ---------------------------------------------------------------------------------------------
+# Standard atmosphere, the same model driver/vti_ps.c and logic/altitude.c use
+SEA_LEVEL_PA = 101325.0
+BUTTON_NAMES = ['star', 'num', 'up', 'down', 'backlight', 'star_long', 'num_long']
+
+# Serial protocol of the USB access point
+BM_START_SIMPLICITI = 0x07
+BM_GET_SIMPLICITIDATA = 0x08
+BM_STOP_SIMPLICITI = 0x09
+
+
+def pressure(altitude_m, temp_k):
+    return SEA_LEVEL_PA * (1.0 - 0.0065 * altitude_m / 288.15) ** 5.255
+
+
+def climb(args, out):
+    rnd = random.Random(args.seed)
+    total = args.minutes * 60
+    out.write('# climb %dm in %d minutes, start at %dm\n' % (args.climb, args.minutes, args.start))
+    for s in range(0, total, args.period):
+        # Up for the first half, down for the second, smooth at the turns
+        phase = math.sin(math.pi * s / total)
+        altitude = args.start + args.climb * phase
+        temp_k = 288.15 - 0.0065 * altitude + rnd.gauss(0, 0.1)
+        pa = pressure(altitude, temp_k) + rnd.gauss(0, args.noise)
+        out.write('%d P %d %d\n' % (s * 1000, round(pa), round(temp_k * 10)))
+
+
+def front(args, out):
+    rnd = random.Random(args.seed)
+    out.write('# %d hours at %dm, front after %g hours: -%ghPa in %g hours\n' % (args.hours, args.altitude, args.at, args.fall, args.over))
+    for s in range(0, args.hours * 3600, args.period):
+        hours = s / 3600.0
+        # Semi-diurnal tide of 0.5hPa, smooth fall, then half of it comes back within 12 hours
+        sea_level = SEA_LEVEL_PA + 50.0 * math.sin(math.pi * hours / 6.0)
+        if hours > args.at:
+            x = min(1.0, (hours - args.at) / args.over)
+            sea_level -= args.fall * 100.0 * (1.0 - math.cos(math.pi * x)) / 2
+        if hours > args.at + args.over:
+            x = min(1.0, (hours - args.at - args.over) / 12.0)
+            sea_level += args.fall * 50.0 * (1.0 - math.cos(math.pi * x)) / 2
+        temp_k = 288.15 - 0.0065 * args.altitude + 3.0 * math.sin(math.pi * (hours - 9) / 12.0)
+        pa = pressure(args.altitude, temp_k) * sea_level / SEA_LEVEL_PA + rnd.gauss(0, args.noise)
+        out.write('%d P %d %d\n' % (s * 1000, round(pa), round(temp_k * 10)))
+
+
+def knock(args, out):
+    rnd = random.Random(args.seed)
+    t = 1000
+    out.write('# knock pattern, pauses %s ms%s\n' % (args.pauses, ', %d times' % args.repeat if args.repeat > 1 else ''))
+    # Rest with gravity on z, one shock per knock, 10ms samples
+    for n in range(args.repeat):
+        pauses = [int(p) for p in args.pauses.split(',')]
+        if args.jitter:
+            pauses = [max(20, p + int(rnd.gauss(0, args.jitter))) for p in pauses]
+        pauses += [2500]
+        for pause in pauses:
+            for i in range(0, pause, 10):
+                z = 54 if i else 120
+                out.write('%d A %d %d %d\n' % (t + i, rnd.randint(0, 2), rnd.randint(0, 2), z + rnd.randint(-2, 2)))
+            t += pause
+
+
+def night(args, out):
+    rnd = random.Random(args.seed)
+    out.write('# %d minutes of sleep, %d minute cycles\n' % (args.minutes, args.cycle))
+    x, y, z = 0, 0, 54
+    ms = 0
+    while ms < args.minutes * 60000:
+        # Light sleep at the turn of a cycle, deep sleep in the middle
+        depth = math.sin(math.pi * (ms / 60000.0 % args.cycle) / args.cycle)
+        if rnd.random() < args.restless * (1.0 - depth) ** 2 + 0.002:
+            # Turn over or twitch: some samples of 100ms with changing orientation
+            for i in range(rnd.randint(5, 30)):
+                x = max(0, min(255, x + rnd.randint(-8, 8)))
+                y = max(0, min(255, y + rnd.randint(-8, 8)))
+                z = max(0, min(255, z + rnd.randint(-8, 8)))
+                out.write('%d A %d %d %d\n' % (ms, x, y, z))
+                ms += 100
+        else:
+            out.write('%d A %d %d %d\n' % (ms, x, y, z + rnd.randint(-1, 1)))
+            ms += 1000
+
+
+def capture(args, out):
+    from sync_pages import AccessPoint
+    ap = AccessPoint(args.tty)
+    try:
+        ap.request(BM_START_SIMPLICITI)
+        start = time.time()
+        while time.time() - start < args.seconds:
+            data = ap.request(BM_GET_SIMPLICITIDATA, [0] * 4)
+            ms = int((time.time() - start) * 1000)
+            if data[0] == 0xFF:
+                time.sleep(0.01)
+                continue
+            # Upper nibble: button, lower nibble: 1 = acceleration data valid
+            event = data[0] >> 4
+            if event:
+                for i in range(len(BUTTON_NAMES)):
+                    if event == 1 << i:
+                        out.write('%d B %s\n' % (ms, BUTTON_NAMES[i]))
+            if data[0] & 0x01:
+                out.write('%d A %d %d %d\n' % (ms, data[1], data[2], data[3]))
+            out.flush()
+    finally:
+        ap.request(BM_STOP_SIMPLICITI)
+        ap.close()
+
+
+def main():
+    p = argparse.ArgumentParser(description='Sensor recordings for the replay harness')
+    sub = p.add_subparsers(dest='cmd')
+    sub.required = True
+    c = sub.add_parser('climb', help='pressure/temperature of a climb and descent')
+    c.add_argument('--minutes', type=int, default=60)
+    c.add_argument('--climb', type=float, default=300.0, help='height gain in m')
+    c.add_argument('--start', type=float, default=400.0, help='start altitude in m')
+    c.add_argument('--period', type=int, default=1, help='seconds between samples')
+    c.add_argument('--noise', type=float, default=3.0, help='pressure noise in Pa (1 sigma)')
+    c.add_argument('--seed', type=int, default=1)
+    f = sub.add_parser('front', help='pressure at rest over days with a passing weather front')
+    f.add_argument('--hours', type=int, default=48)
+    f.add_argument('--at', type=float, default=24.0, help='hours until the pressure starts to fall')
+    f.add_argument('--fall', type=float, default=12.0, help='pressure fall in hPa')
+    f.add_argument('--over', type=float, default=4.0, help='duration of the fall in hours')
+    f.add_argument('--altitude', type=float, default=400.0, help='altitude in m')
+    f.add_argument('--period', type=int, default=60, help='seconds between samples')
+    f.add_argument('--noise', type=float, default=3.0, help='pressure noise in Pa (1 sigma)')
+    f.add_argument('--seed', type=int, default=1)
+    k = sub.add_parser('knock', help='accelerometer knock pattern')
+    k.add_argument('--pauses', default='300,300,900', help='pauses between knocks in ms')
+    k.add_argument('--repeat', type=int, default=1, help='knock the pattern this many times')
+    k.add_argument('--jitter', type=float, default=0, help='standard deviation of every pause in ms')
+    k.add_argument('--seed', type=int, default=1)
+    n = sub.add_parser('night', help='accelerometer of a night in bed')
+    n.add_argument('--minutes', type=int, default=420)
+    n.add_argument('--cycle', type=int, default=90, help='sleep cycle in minutes')
+    n.add_argument('--restless', type=float, default=0.05, help='chance of a movement per second in light sleep')
+    n.add_argument('--seed', type=int, default=1)
+    a = sub.add_parser('capture', help='accelerometer and buttons from a watch in ACC mode')
+    a.add_argument('--tty', required=True, metavar='PORT', help='access point serial port')
+    a.add_argument('--seconds', type=float, default=60.0)
+    args = p.parse_args()
+
+    {'climb': climb, 'front': front, 'knock': knock, 'night': night, 'capture': capture}[args.cmd](args, sys.stdout)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
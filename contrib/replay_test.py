@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+#
+# Regression test of the record/replay harness against reference outputs.
+#
+# Replays the recordings in host/test/replay through build/host/replay, one run per mode, and
+# compares the output with host/test/replay/<mode>.out. The recordings were made with
+# contrib/make_recording.py, the command is in their first line. Run through 'make replay_test',
+# --update rewrites the expected outputs after an intended change of a logic module.
+#
+# Examples:
+#
+#   make replay_host && contrib/replay_test.py
+#   contrib/replay_test.py --update weather
+#
+
+import argparse
+import difflib
+import os
+import subprocess
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+TESTS_DIR = os.path.join(HERE, '..', 'host', 'test', 'replay')
+
+# Mode, recording and options of the run
+TESTS = [
+    ('altitude', 'climb.rec', ['-h', '400']),
+    ('vario', 'climb.rec', ['-h', '400']),
+    ('accumulator', 'hike.rec', ['-h', '400']),
+    ('phase', 'night.rec', ['-a', '00:35']),
+    ('doorlock', 'knock.rec', []),
+    ('weather', 'front.rec', []),
+]
+
+
+def main():
+    p = argparse.ArgumentParser(description='Compare the replay harness against reference outputs')
+    p.add_argument('modes', nargs='*', help='modes to run, default all')
+    p.add_argument('--update', action='store_true', help='write the output as the expected files')
+    p.add_argument('--replay', default=os.path.join(HERE, '..', 'build', 'host', 'replay'))
+    args = p.parse_args()
+
+    if not os.path.exists(args.replay):
+        sys.exit('%s not found, run make replay_host' % args.replay)
+
+    failed = []
+    for mode, recording, options in TESTS:
+        if args.modes and mode not in args.modes:
+            continue
+        run = subprocess.run([args.replay, '-m', mode] + options + [os.path.join(TESTS_DIR, recording)],
+                             stdout=subprocess.PIPE, stderr=subprocess.PIPE, universal_newlines=True)
+        out = run.stdout
+        if run.returncode:
+            out += 'exit status %d\n' % run.returncode
+        path = os.path.join(TESTS_DIR, mode + '.out')
+        if args.update:
+            with open(path, 'w') as f:
+                f.write(out)
+            print('%-12s %-10s updated' % (mode, recording))
+            continue
+        with open(path) as f:
+            expected = f.read()
+        if out == expected:
+            print('%-12s %-10s ok' % (mode, recording))
+        else:
+            print('%-12s %-10s FAILED' % (mode, recording))
+            sys.stdout.writelines(difflib.unified_diff(expected.splitlines(True), out.splitlines(True),
+                                                       path, mode))
+            failed.append(mode)
+
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+#
+# Download and print the night recorded by the watch sleep phase recorder (CONFIG_PHASE_CLOCK).
+#
+# Reads the sleep log over the sync protocol (SYNC_AP_CMD_GET_SLEEP) through the USB access
+# point or contrib/ap_emulator.py, or from a file saved by an earlier run, and prints start
+# time, smart alarm window and wake up time and a per-minute activity chart with every epoch
+# classified as deep sleep, light sleep or awake.
+#
+# Examples:
+#
+#   # watch in SYNC mode, access point on the default port, erase the log after reading
+#   contrib/sleep_dump.py --tty /dev/ttyACM0 --clear
+#
+#   # keep the raw pages, print a 10 minute summary instead of every epoch
+#   contrib/sleep_dump.py --tty /tmp/chronos --save night.txt
+#   contrib/sleep_dump.py --load night.txt --bin 10
+#
+
+import argparse
+import sys
+
+from sync_pages import read_pages, erase_log, load_pages, save_pages, u16
+
+# ---------------------------------------------------------------------------------------------
+# Watch application protocol (simpliciti/simpliciti.h, logic/phase_clock.h)
+SYNC_ED_TYPE_SLEEP = 6
+SYNC_AP_CMD_GET_SLEEP = 11
+PHASE_MAGIC = 0x5A
+PHASE_EPOCH = 60
+PHASE_EPOCHS_PER_PAGE = 16
+PHASE_LIGHT_SLEEP = 3
+STATE_NAMES = ['stopped', 'recording']
+
+# Seconds with movement per minute above which the epoch counts as awake
+AWAKE = 20
+
+
+def decode(pages):
+    head = pages[0]
+    night = dict(valid=head[2] == PHASE_MAGIC, month=head[3], day=head[4], hour=head[5],
+                 minute=head[6], window=head[7], wake=u16(head, 8), epochs=u16(head, 10),
+                 state=head[12])
+    activity = []
+    for page in pages[1:]:
+        activity += page[2:2 + PHASE_EPOCHS_PER_PAGE]
+    night['activity'] = activity[:night['epochs']]
+    return night
+
+
+def classify(value):
+    if value < PHASE_LIGHT_SLEEP:
+        return 'deep'
+    if value < AWAKE:
+        return 'light'
+    return 'awake'
+
+
+def clock(night, epoch):
+    minutes = night['hour'] * 60 + night['minute'] + epoch * PHASE_EPOCH // 60
+    return '%02d:%02d' % (minutes // 60 % 24, minutes % 60)
+
+
+def report(night, args):
+    if not night['valid']:
+        print('no night recorded')
+        return
+    epochs = night['epochs']
+    print('night of %02d.%02d., started %s, %d minutes, %s' % (
+        night['day'], night['month'], clock(night, 0), epochs * PHASE_EPOCH // 60,
+        STATE_NAMES[night['state']] if night['state'] < len(STATE_NAMES) else night['state']))
+    if night['wake'] != 0xFFFF:
+        print('smart alarm:  woken at %s in light sleep (window %d min)' % (clock(night, night['wake']), night['window']))
+    else:
+        print('smart alarm:  not triggered (window %d min)' % night['window'])
+
+    totals = dict(deep=0, light=0, awake=0)
+    for value in night['activity']:
+        totals[classify(value)] += 1
+    for kind in ('deep', 'light', 'awake'):
+        share = 100.0 * totals[kind] / epochs if epochs else 0
+        print('%-12s  %4d min  %5.1f %%' % (kind, totals[kind] * PHASE_EPOCH // 60, share))
+
+    print()
+    for first in range(0, epochs, args.bin):
+        values = night['activity'][first:first + args.bin]
+        mean = sum(values) / len(values)
+        print('%s  %-5s %4.1f  %s' % (clock(night, first), classify(mean), mean, '#' * int(round(mean))))
+
+
+def main():
+    p = argparse.ArgumentParser(description='Download and print the night of the watch sleep phase recorder')
+    src = p.add_mutually_exclusive_group(required=True)
+    src.add_argument('--tty', metavar='PORT', help='access point serial port (e.g. /dev/ttyACM0)')
+    src.add_argument('--load', metavar='FILE', help='read raw pages saved with --save')
+    p.add_argument('--save', metavar='FILE', help='save raw pages as hex lines')
+    p.add_argument('--clear', action='store_true', help='erase the log on the watch once it was read and printed')
+    p.add_argument('--timeout', type=float, default=30.0, help='seconds to wait for link and data')
+    p.add_argument('--bin', type=int, default=1, help='epochs per chart line')
+    args = p.parse_args()
+
+    if args.tty:
+        pages = read_pages(args.tty, SYNC_AP_CMD_GET_SLEEP, SYNC_ED_TYPE_SLEEP,
+                           lambda head: 1 + (u16(head, 10) + PHASE_EPOCHS_PER_PAGE - 1) // PHASE_EPOCHS_PER_PAGE,
+                           timeout=args.timeout, name='sleep')
+    else:
+        pages = load_pages(args.load)
+
+    if args.save:
+        save_pages(args.save, pages)
+
+    report(decode(pages), args)
+
+    # Erase only once the night was received and printed
+    if args.tty and args.clear:
+        if not erase_log(args.tty, SYNC_ED_TYPE_SLEEP, u16(pages[0], 10), args.timeout, 'sleep'):
+            print('sleep log not erased, a night is recorded or it changed since it was read')
+            return 1
+        print('sleep log erased')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+#
+# Download of data pages from the watch over the sync protocol, shared by the contrib tools.
+#
+# The watch is put in SYNC mode and linked through the USB access point or contrib/ap_emulator.py.
+# A SYNC_AP_CMD_GET_xxx command makes it send its data as packets of BM_SYNC_DATA_LENGTH bytes:
+# the SYNC_ED_TYPE_xxx of the data, the page number and the payload. The number of pages follows
+# from page 0. Raw pages can be saved as hex lines and loaded again instead of reading the watch.
+# A log is erased with SYNC_AP_CMD_ERASE_LOG only after the download was received and decoded,
+# the watch keeps it when entries were added since.
+#
+# Example:
+#
+#   from sync_pages import read_pages, erase_log, u16
+#   pages = read_pages('/dev/ttyACM0', SYNC_AP_CMD_GET_TRACK, SYNC_ED_TYPE_TRACK,
+#                      lambda head: 1 + (head[10] + 3) // 4, timeout=30.0, name='track')
+#   erase_log('/dev/ttyACM0', SYNC_ED_TYPE_TRACK, pages[0][10], timeout=30.0, name='track')
+#
+
+import os
+import termios
+import time
+import tty
+
+# ---------------------------------------------------------------------------------------------
+# Serial protocol of the USB access point
+BM_GET_STATUS = 0x00
+BM_SYNC_START = 0x30
+BM_SYNC_SEND_COMMAND = 0x31
+BM_SYNC_GET_BUFFER_STATUS = 0x32
+BM_SYNC_READ_BUFFER = 0x33
+
+HW_SIMPLICITI_LINKED = 0x03
+
+# Packets of the watch application protocol (simpliciti/simpliciti.h)
+BM_SYNC_DATA_LENGTH = 19
+SYNC_ED_TYPE_ERASE = 10
+SYNC_AP_CMD_ERASE_LOG = 15
+
+
+class AccessPoint(object):
+    """USB access point or emulator pty, [0xFF, cmd, length, data...] packets."""
+
+    def __init__(self, path):
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+        if os.isatty(self.fd):
+            tty.setraw(self.fd)
+            attr = termios.tcgetattr(self.fd)
+            attr[4] = attr[5] = termios.B115200
+            termios.tcsetattr(self.fd, termios.TCSANOW, attr)
+
+    def request(self, cmd, data=(), reply_length=0):
+        data = list(data) + [0] * max(0, reply_length - len(data))
+        os.write(self.fd, bytes([0xFF, cmd, 3 + len(data)] + data))
+        buf = b''
+        deadline = time.time() + 1.0
+        while time.time() < deadline:
+            buf += os.read(self.fd, 64)
+            if len(buf) >= 3 and len(buf) >= buf[2]:
+                return list(buf[3:buf[2]])
+        raise IOError('no reply from access point')
+
+    def close(self):
+        os.close(self.fd)
+
+
+def link(ap, timeout):
+    """Start sync mode on the access point and wait until the watch is linked."""
+    ap.request(BM_SYNC_START)
+    deadline = time.time() + timeout
+    while ap.request(BM_GET_STATUS, reply_length=1)[0] != HW_SIMPLICITI_LINKED:
+        if time.time() > deadline:
+            raise IOError('watch did not link, start SYNC on the watch')
+        time.sleep(0.2)
+
+
+def send_command(ap, cmd):
+    ap.request(BM_SYNC_SEND_COMMAND, cmd + [0] * (BM_SYNC_DATA_LENGTH - len(cmd)))
+
+
+def read_pages(path, command, ed_type, count, timeout=30.0, name='data'):
+    """Link with the watch, send command and collect the pages of ed_type.
+
+    count(head) returns the number of pages from page 0. timeout applies to the link and to
+    each page. The data stays on the watch, erase_log removes it."""
+    ap = AccessPoint(path)
+    try:
+        link(ap, timeout)
+        send_command(ap, [command])
+
+        pages = {}
+        total = None
+        deadline = time.time() + timeout
+        while total is None or len(pages) < total:
+            if time.time() > deadline:
+                raise IOError('got %d of %s %s pages' % (len(pages), total or '?', name))
+            if ap.request(BM_SYNC_GET_BUFFER_STATUS, reply_length=1)[0] == 0:
+                time.sleep(0.1)
+                continue
+            packet = ap.request(BM_SYNC_READ_BUFFER, reply_length=BM_SYNC_DATA_LENGTH)
+            if packet[0] != ed_type:
+                continue
+            pages[packet[1]] = packet
+            if packet[1] == 0:
+                total = count(packet)
+            deadline = time.time() + timeout
+        return [pages[i] for i in range(total)]
+    finally:
+        ap.close()
+
+
+def erase_log(path, ed_type, count, timeout=30.0, name='data'):
+    """Erase the log of ed_type on the watch once its pages were received.
+
+    count is the number of entries on page 0 of the download, the watch keeps the log when it
+    has changed since. Returns True when the log was erased or is empty."""
+    ap = AccessPoint(path)
+    try:
+        link(ap, timeout)
+        send_command(ap, [SYNC_AP_CMD_ERASE_LOG, ed_type, count >> 8, count & 0xFF])
+
+        deadline = time.time() + timeout
+        while time.time() < deadline:
+            if ap.request(BM_SYNC_GET_BUFFER_STATUS, reply_length=1)[0] == 0:
+                time.sleep(0.1)
+                continue
+            packet = ap.request(BM_SYNC_READ_BUFFER, reply_length=BM_SYNC_DATA_LENGTH)
+            if packet[0] == SYNC_ED_TYPE_ERASE and packet[1] == ed_type:
+                return packet[2] == 1
+        raise IOError('watch did not confirm erasing the %s log' % name)
+    finally:
+        ap.close()
+
+
+def load_pages(path):
+    """Pages saved with save_pages."""
+    with open(path) as f:
+        return [list(bytes.fromhex(line)) for line in f if line.strip()]
+
+
+def save_pages(path, pages):
+    """One page per line in hex."""
+    with open(path, 'w') as f:
+        for page in pages:
+            f.write(bytes(page).hex() + '\n')
+
+
+def u16(p, i):
+    return (p[i] << 8) | p[i + 1]
+
+
+def u32(p, i):
+    return (u16(p, i) << 16) | u16(p, i + 2)
@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+#
+# End to end test of the sync data commands against the host end device.
+#
+# Starts contrib/ap_emulator.py with one build/host/simpliciti_ed in SYNC mode, which answers with
+# the real logic/rfsync.c and fixed synthetic logs. Each dump tool reads its data three times:
+# as is, with --clear and once more to see the log was erased. The output is compared with
+# host/test/sync/<tool>.txt. Run through 'make sync_test', --update rewrites the expected files.
+#
+# Examples:
+#
+#   make simpliciti_host && contrib/sync_test.py
+#   contrib/sync_test.py --update energy_budget
+#
+
+import argparse
+import difflib
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+EXPECTED = os.path.join(HERE, '..', 'host', 'test', 'sync')
+
+# Tool and the sync command it covers
+TOOLS = [
+    ('energy_budget', 'SYNC_AP_CMD_GET_PROFILE'),
+    ('crash_dump', 'SYNC_AP_CMD_GET_CRASH'),
+    ('sleep_dump', 'SYNC_AP_CMD_GET_SLEEP'),
+    ('impact_dump', 'SYNC_AP_CMD_GET_IMPACT'),
+    ('track_dump', 'SYNC_AP_CMD_GET_TRACK'),
+    ('history_dump', 'SYNC_AP_CMD_GET_HISTORY'),
+]
+
+
+def run_tool(name, tty, timeout):
+    """Output of the three reads, each preceded by its command line."""
+    out = ''
+    for extra in ([], ['--clear'], []):
+        args = [name + '.py', '--tty', 'TTY', '--timeout', str(timeout)] + extra
+        out += '$ %s\n' % ' '.join(args)
+        p = subprocess.run([sys.executable, os.path.join(HERE, name + '.py'), '--tty', tty,
+                            '--timeout', str(timeout)] + extra,
+                           stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+        out += p.stdout
+        if p.returncode:
+            out += 'exit status %d\n' % p.returncode
+    return out
+
+
+def main():
+    p = argparse.ArgumentParser(description='Compare the sync dump tools against the host end device')
+    p.add_argument('tools', nargs='*', help='tools to run, default all')
+    p.add_argument('--update', action='store_true', help='write the output as the expected files')
+    p.add_argument('--ed-binary', default=os.path.join(HERE, '..', 'build', 'host', 'simpliciti_ed'))
+    p.add_argument('--timeout', type=int, default=10, help='seconds to wait for link and data')
+    args = p.parse_args()
+
+    tools = [t for t in TOOLS if not args.tools or t[0] in args.tools]
+    if not os.path.exists(args.ed_binary):
+        sys.exit('%s not found, run make simpliciti_host' % args.ed_binary)
+
+    tmp = tempfile.mkdtemp(prefix='sync_test.')
+    tty = os.path.join(tmp, 'tty')
+    ap = subprocess.Popen([sys.executable, os.path.join(HERE, 'ap_emulator.py'),
+                           '--medium', os.path.join(tmp, 'medium'), '--tty', tty, '--seed', '1',
+                           '--spawn', '1', '--ed-mode', 'sync', '--ed-binary', args.ed_binary],
+                          stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    failed = []
+    try:
+        deadline = time.time() + 5
+        while not os.path.exists(tty):
+            if time.time() > deadline or ap.poll() is not None:
+                sys.exit('access point emulator did not start')
+            time.sleep(0.1)
+
+        for name, command in tools:
+            out = run_tool(name, tty, args.timeout)
+            path = os.path.join(EXPECTED, name + '.txt')
+            if args.update:
+                with open(path, 'w') as f:
+                    f.write(out)
+                print('%-14s %-24s updated' % (name, command))
+                continue
+            with open(path) as f:
+                expected = f.read()
+            if out == expected:
+                print('%-14s %-24s ok' % (name, command))
+            else:
+                print('%-14s %-24s FAILED' % (name, command))
+                sys.stdout.writelines(difflib.unified_diff(expected.splitlines(True), out.splitlines(True),
+                                                           path, name))
+                failed.append(name)
+    finally:
+        ap.terminate()
+        ap.wait()
+        shutil.rmtree(tmp, ignore_errors=True)
+
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == '__main__':
+    main()
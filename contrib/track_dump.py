@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+#
+# Download and print the altitude track recorded by the watch (CONFIG_ALTI_TRACK).
+#
+# Reads the track over the sync protocol (SYNC_AP_CMD_GET_TRACK) through the USB access point or
+# contrib/ap_emulator.py, or from a file saved by an earlier run, and prints the elevation profile
+# of peaks and dips with time and altitude, followed by every climb with its gain and rate.
+#
+# Examples:
+#
+#   # watch in SYNC mode, access point on the default port, erase the track after reading
+#   contrib/track_dump.py --tty /dev/ttyACM0 --clear
+#
+#   # keep the raw pages, list only climbs of 50m or more
+#   contrib/track_dump.py --tty /tmp/chronos --save hike.txt
+#   contrib/track_dump.py --load hike.txt --min 50
+#
+
+import argparse
+import sys
+
+from sync_pages import read_pages, erase_log, load_pages, save_pages, u16
+
+# ---------------------------------------------------------------------------------------------
+# Watch application protocol (simpliciti/simpliciti.h, logic/track.h)
+SYNC_ED_TYPE_TRACK = 8
+SYNC_AP_CMD_GET_TRACK = 13
+TRACK_MAGIC = 0x7A
+TRACK_HEADER = 8
+TRACK_POINT = 4
+TRACK_POINTS_PER_PAGE = 4
+TRACK_TYPE_SHIFT = 14
+TYPE_NAMES = {1: 'peak', 2: 'dip', 3: 'end'}
+
+
+def s16(data, offset):
+    value = u16(data, offset)
+    return value - 0x10000 if value & 0x8000 else value
+
+
+def decode(pages):
+    head = pages[0]
+    track = dict(valid=head[2] == TRACK_MAGIC, month=head[3], day=head[4], hour=head[5],
+                 minute=head[6], start=s16(head, 7), count=head[10], ascent=u16(head, 11),
+                 descent=u16(head, 13), climbs=head[15])
+    data = []
+    for page in pages[1:]:
+        data += page[2:2 + TRACK_POINTS_PER_PAGE * TRACK_POINT]
+    points = []
+    for i in range(track['count']):
+        p = data[i * TRACK_POINT:(i + 1) * TRACK_POINT]
+        time_field = u16(p, 0)
+        points.append(dict(type=time_field >> TRACK_TYPE_SHIFT,
+                           minute=time_field & ((1 << TRACK_TYPE_SHIFT) - 1), altitude=s16(p, 2)))
+    track['points'] = points
+    return track
+
+
+def clock(track, minute):
+    minutes = track['hour'] * 60 + track['minute'] + minute
+    return '%02d:%02d' % (minutes // 60 % 24, minutes % 60)
+
+
+def report(track, args):
+    if not track['valid']:
+        print('no track recorded')
+        return
+    print('track of %02d.%02d., started %s at %d m, %d points' % (
+        track['day'], track['month'], clock(track, 0), track['start'], track['count']))
+
+    # Profile, and climbs as the legs that gain altitude, as counted by the watch
+    climbs = []
+    last = dict(minute=0, altitude=track['start'])
+    ascent = descent = 0
+    print()
+    for p in track['points']:
+        delta = p['altitude'] - last['altitude']
+        if delta > 0:
+            ascent += delta
+            climbs.append((last, p, delta))
+        else:
+            descent -= delta
+        print('%s  %-4s  %5d m  %+5d m' % (clock(track, p['minute']), TYPE_NAMES.get(p['type'], p['type']),
+                                        p['altitude'], delta))
+        last = p
+
+    shown = [c for c in climbs if c[2] >= args.min]
+    if shown:
+        print()
+    for first, top, gain in shown:
+        minutes = top['minute'] - first['minute']
+        rate = '%5d m/h' % (gain * 60 // minutes) if minutes else '      -'
+        print('climb %s - %s  %5d m  %4d min  %s' % (clock(track, first['minute']), clock(track, top['minute']),
+                                                     gain, minutes, rate))
+
+    print()
+    altitudes = [track['start']] + [p['altitude'] for p in track['points']]
+    print('ascent %d m, descent %d m, max %d m, min %d m, %d climbs' % (
+        ascent, descent, max(altitudes), min(altitudes), len(climbs)))
+    if (ascent, descent, len(climbs)) != (track['ascent'], track['descent'], track['climbs']):
+        # Log full: the watch keeps counting the points it could not store
+        print('watch: ascent %d m, descent %d m, %d climbs' % (track['ascent'], track['descent'], track['climbs']))
+
+
+def main():
+    p = argparse.ArgumentParser(description='Download and print the altitude track recorded by the watch')
+    src = p.add_mutually_exclusive_group(required=True)
+    src.add_argument('--tty', metavar='PORT', help='access point serial port (e.g. /dev/ttyACM0)')
+    src.add_argument('--load', metavar='FILE', help='read raw pages saved with --save')
+    p.add_argument('--save', metavar='FILE', help='save raw pages as hex lines')
+    p.add_argument('--clear', action='store_true', help='erase the track on the watch once it was read and printed')
+    p.add_argument('--timeout', type=float, default=30.0, help='seconds to wait for link and data')
+    p.add_argument('--min', type=int, default=0, metavar='M', help='only list climbs with a larger gain')
+    args = p.parse_args()
+
+    if args.tty:
+        pages = read_pages(args.tty, SYNC_AP_CMD_GET_TRACK, SYNC_ED_TYPE_TRACK,
+                           lambda head: 1 + (head[10] + TRACK_POINTS_PER_PAGE - 1) // TRACK_POINTS_PER_PAGE,
+                           timeout=args.timeout, name='track')
+    else:
+        pages = load_pages(args.load)
+
+    if args.save:
+        save_pages(args.save, pages)
+
+    report(decode(pages), args)
+
+    # Erase only once all points were received and printed
+    if args.tty and args.clear:
+        if not erase_log(args.tty, SYNC_ED_TYPE_TRACK, pages[0][10], args.timeout, 'track'):
+            print('track not erased, a point was logged since it was read')
+            return 1
+        print('track erased')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
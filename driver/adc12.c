@@ -45,6 +45,11 @@
 // driver
 #include "adc12.h"
 #include "timer.h"
+#include "power.h"
+#include "crash.h"
+#ifdef CONFIG_PROFILE
+#include "profile.h"
+#endif
 
 
 // *************************************************************************************************
@@ -60,6 +65,9 @@
 u16 adc12_result;
 u8  adc12_data_ready;
 
+// Reference voltage the shared reference has settled to (ADC12_REF_NONE = reference off)
+static u16 adc12_ref = ADC12_REF_NONE;
+
 
 // *************************************************************************************************
 // Extern section
@@ -111,6 +119,32 @@ u8  adc12_data_ready;
 //}
 
 
+// *************************************************************************************************
+// @fn          adc12_ref_on
+// @brief       Power domain start: enable shared reference. Voltage is selected on conversion.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void adc12_ref_on(void)
+{
+	REFCTL0 |= REFMSTR + REFON;
+	adc12_ref = ADC12_REF_NONE;
+}
+
+
+// *************************************************************************************************
+// @fn          adc12_ref_off
+// @brief       Power domain stop: disable shared reference.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void adc12_ref_off(void)
+{
+	REFCTL0 &= ~(REFMSTR + REFVSEL_3 + REFON);
+	adc12_ref = ADC12_REF_NONE;
+}
+
+
 // *************************************************************************************************
 // @fn          adc12_single_conversion
 // @brief       Init ADC12. Do single conversion. Turn off ADC12.
@@ -120,7 +154,7 @@ u8  adc12_data_ready;
 u16 adc12_single_conversion(u16 ref, u16 sht, u16 channel)
 {
 	// Initialize the shared reference module 
-	REFCTL0 |= REFMSTR + ref + REFON;    		// Enable internal reference (1.5V or 2.5V)
+	power_acquire(POWER_REF, POWER_USER_ADC12);	// Enable internal reference
   
 	// Initialize ADC12_A 
 	ADC12CTL0 = sht + ADC12ON;					// Set sample time 
@@ -128,8 +162,15 @@ u16 adc12_single_conversion(u16 ref, u16 sht, u16 channel)
 	ADC12MCTL0 = ADC12SREF_1 + channel;  		// ADC input channel  
 	ADC12IE = 0x001;                          	// ADC_IFG upon conv result-ADCMEMO
   
-  	// Wait 2 ticks (66us) to allow internal reference to settle
-	Timer0_A4_Delay(2);       
+	// Select 1.5V or 2.5V, reference held by other consumers may be settled already
+	if (adc12_ref != ref)
+	{
+		REFCTL0 = (REFCTL0 & ~REFVSEL_3) | ref;
+		
+	  	// Wait 2 ticks (66us) to allow internal reference to settle
+		Timer0_A4_Delay(2);
+		adc12_ref = ref;
+	}
 	
 	// Start ADC12
 	ADC12CTL0 |= ADC12ENC;                             		  	
@@ -149,7 +190,7 @@ u16 adc12_single_conversion(u16 ref, u16 sht, u16 channel)
 	ADC12CTL0 &= ~ADC12ON;
 	
 	// Shut down reference voltage 	
-	REFCTL0 &= ~(REFMSTR + ref + REFON); 
+	power_release(POWER_REF, POWER_USER_ADC12);
 	
 	ADC12IE = 0;                          	
 	
@@ -175,12 +216,17 @@ interrupt (ADC12_VECTOR) ADC12ISR (void)
 __interrupt void ADC12ISR (void)
 #endif
 {
+  CRASH_ISR(CRASH_ISR_ADC12);
+
   switch(__even_in_range(ADC12IV,34))
   {
   case  0: break;                           // Vector  0:  No interrupt
   case  2: break;                           // Vector  2:  ADC overflow
   case  4: break;                           // Vector  4:  ADC timing overflow
   case  6:                                  // Vector  6:  ADC12IFG0
+#ifdef CONFIG_PROFILE
+    		profile_wakeup(PROFILE_ADC12);
+#endif
     		adc12_result = ADC12MEM0;                       // Move results, IFG is cleared
     		adc12_data_ready = 1;
     		_BIC_SR_IRQ(LPM3_bits);   						// Exit active CPU
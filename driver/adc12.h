@@ -43,10 +43,15 @@
 // *************************************************************************************************
 // Prototypes section
 extern u16 adc12_single_conversion(u16 ref, u16 sht, u16 channel);
+extern void adc12_ref_on(void);
+extern void adc12_ref_off(void);
 
 // *************************************************************************************************
 // Defines section
 
+// No reference voltage selected
+#define ADC12_REF_NONE							(0xFFFFu)
+
 //// Reference settling time
 //#define ADC12_REFERENCE_SETTLING_TIME_USEC		(4*34u)	
 //
@@ -0,0 +1,252 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// *************************************************************************************************
+// *************************************************************************************************
+// Crash recorder. Reset cause, last ISR, a software watchdog pre-timeout with the interrupted 
+// PC/SP and a ring of main loop events are kept in uninitialised RAM and committed to information
+// memory after the reset.
+// *************************************************************************************************
+
+
+// *************************************************************************************************
+// Include section
+
+// system
+#include "project.h"
+
+#ifdef CONFIG_CRASH_LOG
+
+// driver
+#include "crash.h"
+#include "infomem.h"
+
+// logic
+#include "clock.h"
+
+
+// *************************************************************************************************
+// Prototypes section
+void crash_frame(void);
+
+
+// *************************************************************************************************
+// Defines section
+
+// Words searched above the stack pointer for the interrupt frame
+#define CRASH_FRAME_SEARCH		(32u)
+
+// Start of flash, a stacked PC must lie above
+#define CRASH_FLASH_START		(0x8000u)
+
+
+// *************************************************************************************************
+// Global Variable section
+
+// Not cleared by the startup code
+struct crash sCrash __attribute__((section(".noinit")));
+
+// Seconds since to_lpm() was last reached
+static volatile u8 crash_idle;
+
+
+// *************************************************************************************************
+// Extern section
+
+
+// *************************************************************************************************
+// @fn          crash_restore
+// @brief       Evaluate the reset cause. Resets that kept RAM alive and resets caused by watchdog,
+//				supervisors or access violations are stored in information memory, then the RAM 
+//				record is armed for this run. Call once after the information memory is ready.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void crash_restore(void)
+{
+	u16 record[CRASH_RECORD_WORDS];
+	u16 reset;
+	u8 warm;
+	u8 i;
+	
+	// Highest priority reset cause, read the others to clear them
+	reset = SYSRSTIV;
+	while (SYSRSTIV != SYSRSTIV_NONE);
+	
+	warm = (sCrash.magic == CRASH_MAGIC);
+	
+	// Skip intended resets and power-up
+	if ((sCrash.magic != CRASH_DISARMED) && (warm || ((reset >= SYSRSTIV_SVSL) && (reset != SYSRSTIV_DOPOR))))
+	{
+		if (!warm)
+		{
+			// RAM content is lost, keep only the cause
+			sCrash.isr = CRASH_ISR_NONE;
+			sCrash.pc = 0;
+			sCrash.sp = 0;
+			sCrash.time = 0;
+			for (i=0; i<CRASH_TRACE_LENGTH; i++) sCrash.trace[i] = 0;
+			sCrash.trace_pos = 0;
+			sCrash.watchdog = CRASH_WDT_NONE;
+		}
+		if ((reset == SYSRSTIV_WDTTO) && (sCrash.watchdog == CRASH_WDT_NONE)) sCrash.watchdog = CRASH_WDT_TIMEOUT;
+		
+		// Number of crashes since the record was last cleared
+		if (crash_read(record) == 0) record[0] = 0;
+		record[0]++;
+		record[1] = reset;
+		record[2] = (sCrash.isr << 8) | sCrash.watchdog;
+		record[3] = sCrash.pc;
+		record[4] = sCrash.sp;
+		record[5] = sCrash.time;
+		for (i=0; i<CRASH_TRACE_LENGTH; i++)
+		{
+			record[6+i] = sCrash.trace[(sCrash.trace_pos + i) % CRASH_TRACE_LENGTH];
+		}
+		infomem_app_replace(CRASH_INFOMEM_ID, record, CRASH_RECORD_WORDS);
+	}
+	
+	// Arm record for this run
+	sCrash.isr = CRASH_ISR_NONE;
+	sCrash.watchdog = CRASH_WDT_NONE;
+	sCrash.pc = 0;
+	sCrash.sp = 0;
+	sCrash.time = 0;
+	for (i=0; i<CRASH_TRACE_LENGTH; i++) sCrash.trace[i] = 0;
+	sCrash.trace_pos = 0;
+	sCrash.magic = CRASH_MAGIC;
+	crash_idle = 0;
+}
+
+
+// *************************************************************************************************
+// @fn          crash_read
+// @brief       Read the stored crash record.
+// @param       u16 * record		Buffer of CRASH_RECORD_WORDS words
+// @return      u8					CRASH_RECORD_WORDS, 0 if no record is stored
+// *************************************************************************************************
+u8 crash_read(u16 * record)
+{
+	if (infomem_app_amount(CRASH_INFOMEM_ID) != CRASH_RECORD_WORDS) return (0);
+	if (infomem_app_read(CRASH_INFOMEM_ID, record, CRASH_RECORD_WORDS, 0) != CRASH_RECORD_WORDS) return (0);
+	
+	return (CRASH_RECORD_WORDS);
+}
+
+
+// *************************************************************************************************
+// @fn          crash_kick
+// @brief       Main loop is alive. Called on every LPM3 entry.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void crash_kick(void)
+{
+	crash_idle = 0;
+}
+
+
+// *************************************************************************************************
+// @fn          crash_tick
+// @brief       Software watchdog pre-timeout. Called once per second from timer ISR. If the CPU
+//				did not sleep for CRASH_PRETIMEOUT seconds, the interrupted PC/SP are recorded 
+//				and a reset is forced before the hardware watchdog would hit.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void crash_tick(void)
+{
+	sCrash.time = (sTime.hour << 8) | sTime.minute;
+	
+	if (++crash_idle < CRASH_PRETIMEOUT) return;
+	
+	sCrash.watchdog = CRASH_WDT_PRETIMEOUT;
+	crash_frame();
+	
+	// Write without password: PUC with SYSRSTIV_WDTKEY
+	WDTCTL = 0;
+}
+
+
+// *************************************************************************************************
+// @fn          crash_frame
+// @brief       Find the interrupt frame of the interrupted main loop code on the stack. The ISR 
+//				prologue size is not known here, so search for the first SR/PC pair with GIE set, 
+//				CPU on and a PC in flash.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void crash_frame(void)
+{
+	u16 * sp;
+	u8 i;
+	
+	asm volatile("mov r1, %0" : "=r" (sp));
+	
+	for (i=0; i<CRASH_FRAME_SEARCH; i++, sp++)
+	{
+		if (((sp[0] & ~0x01FFu) == 0) && (sp[0] & GIE) && !(sp[0] & CPUOFF) && (sp[1] >= CRASH_FLASH_START))
+		{
+			sCrash.pc = sp[1];
+			sCrash.sp = (u16)(sp + 2);
+			return;
+		}
+	}
+}
+
+
+// *************************************************************************************************
+// @fn          crash_trace
+// @brief       Add an event to the trace ring.
+// @param       u16 event		CRASH_TRACE_xxx | value
+// @return      none
+// *************************************************************************************************
+void crash_trace(u16 event)
+{
+	sCrash.trace[sCrash.trace_pos] = event;
+	if (++sCrash.trace_pos >= CRASH_TRACE_LENGTH) sCrash.trace_pos = 0;
+}
+
+
+// *************************************************************************************************
+// @fn          crash_disarm
+// @brief       An intended reset follows (RFBSL, shutdown), do not record it.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void crash_disarm(void)
+{
+	sCrash.magic = CRASH_DISARMED;
+}
+
+#endif /* CONFIG_CRASH_LOG */
@@ -0,0 +1,130 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// *************************************************************************************************
+
+#ifndef CRASH_H_
+#define CRASH_H_
+
+// *************************************************************************************************
+// Include section
+
+
+// *************************************************************************************************
+// Prototypes section
+extern void crash_restore(void);
+extern void crash_kick(void);
+extern void crash_tick(void);
+extern void crash_trace(u16 event);
+extern void crash_disarm(void);
+extern u8 crash_read(u16 * record);
+
+
+// *************************************************************************************************
+// Defines section
+
+#define CRASH_INFOMEM_ID		(0x12)
+
+// Marks the RAM record as valid, i.e. RAM survived the reset
+#define CRASH_MAGIC				(0xC7A5u)
+
+// Marks an intended reset that is not recorded
+#define CRASH_DISARMED			(0x5A7Cu)
+
+// Seconds without reaching to_lpm() until the pre-timeout forces a reset.
+// Must stay below the 16 second hardware watchdog.
+#define CRASH_PRETIMEOUT		(12u)
+
+// Trace ring entries
+#define CRASH_TRACE_LENGTH		(8u)
+
+// Stored record: count, reset cause, isr/watchdog, pc, sp, time, trace
+#define CRASH_RECORD_WORDS		(6u + CRASH_TRACE_LENGTH)
+
+// Watchdog reasons
+#define CRASH_WDT_NONE			(0u)
+#define CRASH_WDT_PRETIMEOUT	(1u)			// main loop stuck with interrupts enabled
+#define CRASH_WDT_TIMEOUT		(2u)			// hardware watchdog, interrupts were disabled
+
+// Last ISR entered
+#define CRASH_ISR_NONE			(0u)
+#define CRASH_ISR_TIMER0_A0		(1u)
+#define CRASH_ISR_TIMER0_A1		(2u)
+#define CRASH_ISR_PORT2			(3u)
+#define CRASH_ISR_ADC12			(4u)
+#define CRASH_ISR_RADIO			(5u)
+
+// Trace events, type in the upper 4 bits
+#define CRASH_TRACE_WAKEUP		(0x1000u)		// button flags
+#define CRASH_TRACE_REQUEST		(0x2000u)		// request flags
+#define CRASH_TRACE_RADIO		(0x3000u)		// 1 = open, 0 = close
+#define CRASH_TRACE_MASK		(0x0FFFu)
+
+#ifdef CONFIG_CRASH_LOG
+#define CRASH_ISR(id)			(sCrash.isr = (id))
+#else
+#define CRASH_ISR(id)
+#endif
+
+
+// *************************************************************************************************
+// Global Variable section
+struct crash
+{
+	u16		magic;
+	
+	// Last ISR entered, CRASH_ISR_xxx
+	u8		isr;
+	
+	// CRASH_WDT_xxx
+	u8		watchdog;
+	
+	// Interrupted PC and SP captured by the pre-timeout, 0 if unknown
+	u16		pc;
+	u16		sp;
+	
+	// Time of day of the last tick, hour << 8 | minute
+	u16		time;
+	
+	// Ring of recent main loop events, trace_pos is the next entry to write
+	u16		trace[CRASH_TRACE_LENGTH];
+	u8		trace_pos;
+};
+extern struct crash sCrash;
+
+
+// *************************************************************************************************
+// Extern section
+
+
+#endif /*CRASH_H_*/
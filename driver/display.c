@@ -160,7 +160,7 @@ void clear_display(void)
 // *************************************************************************************************
 void clear_line(u8 line)
 {
-	display_chars(switch_seg(line, LCD_SEG_L1_3_0, LCD_SEG_L2_5_0), NULL, SEG_OFF);
+	display_chars(switch_seg(line, LCD_SEG_L1_3_0, LCD_SEG_L2_5_0), (u8*)"      ", SEG_OFF);
 	if (line == LINE1)
 	{
 		display_symbol(LCD_SEG_L1_DP1, SEG_OFF);
@@ -601,7 +601,7 @@ void set_blink_rate(u8 bits)
 // *************************************************************************************************
 void display_all_off(void)
 {
-	u8 * lcdptr = (u8*)0x0A20;
+	u8 * lcdptr = LCD_MEM_1;
 	u8 i;
 	
 	for (i=1; i<=12; i++) 
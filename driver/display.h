@@ -228,18 +228,23 @@ extern volatile s_display_flags display;
 
 
 // LCD controller memory map
-#define LCD_MEM_1          			((u8*)0x0A20)
-#define LCD_MEM_2          			((u8*)0x0A21)
-#define LCD_MEM_3          			((u8*)0x0A22)
-#define LCD_MEM_4          			((u8*)0x0A23)
-#define LCD_MEM_5          			((u8*)0x0A24)
-#define LCD_MEM_6          			((u8*)0x0A25)
-#define LCD_MEM_7          			((u8*)0x0A26)
-#define LCD_MEM_8          	 		((u8*)0x0A27)
-#define LCD_MEM_9          			((u8*)0x0A28)
-#define LCD_MEM_10         			((u8*)0x0A29)
-#define LCD_MEM_11         			((u8*)0x0A2A)
-#define LCD_MEM_12         			((u8*)0x0A2B)
+#ifdef EZCHRONOS_HOST
+#define LCD_MEM_BASE				((u8*)LCDMEM)
+#else
+#define LCD_MEM_BASE				((u8*)0x0A20)
+#endif
+#define LCD_MEM_1          			(LCD_MEM_BASE + 0)
+#define LCD_MEM_2          			(LCD_MEM_BASE + 1)
+#define LCD_MEM_3          			(LCD_MEM_BASE + 2)
+#define LCD_MEM_4          			(LCD_MEM_BASE + 3)
+#define LCD_MEM_5          			(LCD_MEM_BASE + 4)
+#define LCD_MEM_6          			(LCD_MEM_BASE + 5)
+#define LCD_MEM_7          			(LCD_MEM_BASE + 6)
+#define LCD_MEM_8          	 		(LCD_MEM_BASE + 7)
+#define LCD_MEM_9          			(LCD_MEM_BASE + 8)
+#define LCD_MEM_10         			(LCD_MEM_BASE + 9)
+#define LCD_MEM_11         			(LCD_MEM_BASE + 10)
+#define LCD_MEM_12         			(LCD_MEM_BASE + 11)
 
 
 // Memory assignment
@@ -0,0 +1,125 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// *************************************************************************************************
+// Dynamic voltage and frequency scaling. The watch idles at low VCore and a divided MCLK, 
+// modules with heavy work (radio, pressure conversion, ...) hold the fast operating point.
+// *************************************************************************************************
+
+
+// *************************************************************************************************
+// Include section
+
+// system
+#include "project.h"
+
+#ifdef CONFIG_DVFS
+
+// driver
+#include "pmm.h"
+#include "dvfs.h"
+
+
+// *************************************************************************************************
+// Prototypes section
+
+
+// *************************************************************************************************
+// Defines section
+
+
+// *************************************************************************************************
+// Global Variable section
+struct dvfs sDvfs;
+
+
+// *************************************************************************************************
+// Extern section
+
+
+// *************************************************************************************************
+// @fn          dvfs_init
+// @brief       Drop from the boot clock setup (fast) to the slow operating point. 
+//				Call once after the DCO has settled.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void dvfs_init(void)
+{
+	sDvfs.users  = 0;
+	sDvfs.raised = 0;
+	
+	// Lower frequency before VCore
+	UCSCTL5 = DVFS_DIVIDER_SLOW;
+	SetVCore(DVFS_VCORE_SLOW);
+}
+
+
+// *************************************************************************************************
+// @fn          dvfs_acquire
+// @brief       Request the fast operating point. Calls must be balanced by dvfs_release.
+//				Switching only touches the clock dividers, so there is no FLL settling time.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void dvfs_acquire(void)
+{
+	if (sDvfs.users++ == 0)
+	{
+		// Raise VCore before frequency
+		SetVCore(DVFS_VCORE_FAST);
+		UCSCTL5 = DVFS_DIVIDER_FAST;
+		sDvfs.raised++;
+	}
+}
+
+
+// *************************************************************************************************
+// @fn          dvfs_release
+// @brief       Release the fast operating point. Last user returns to the slow operating point.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void dvfs_release(void)
+{
+	if (sDvfs.users == 0) return;
+	
+	if (--sDvfs.users == 0)
+	{
+		// Lower frequency before VCore
+		UCSCTL5 = DVFS_DIVIDER_SLOW;
+		SetVCore(DVFS_VCORE_SLOW);
+	}
+}
+
+#endif /* CONFIG_DVFS */
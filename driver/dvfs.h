@@ -0,0 +1,77 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// *************************************************************************************************
+
+#ifndef DVFS_H_
+#define DVFS_H_
+
+// *************************************************************************************************
+// Include section
+
+
+// *************************************************************************************************
+// Prototypes section
+extern void dvfs_init(void);
+extern void dvfs_acquire(void);
+extern void dvfs_release(void);
+
+
+// *************************************************************************************************
+// Defines section
+
+// Operating points. DCOCLKDIV stays locked at 12MHz, only the MCLK/SMCLK dividers change.
+#define DVFS_VCORE_SLOW			(0u)						// up to 8MHz
+#define DVFS_VCORE_FAST			(3u)						// up to 20MHz, needed by RF1A
+#define DVFS_DIVIDER_SLOW		(DIVM__4 + DIVS__4)			// MCLK = SMCLK = 3MHz
+#define DVFS_DIVIDER_FAST		(DIVM__1 + DIVS__1)			// MCLK = SMCLK = 12MHz
+
+
+// *************************************************************************************************
+// Global Variable section
+struct dvfs
+{
+	// Number of modules holding the fast operating point
+	u8		users;
+	
+	// Number of switches to the fast operating point
+	u16		raised;
+};
+extern struct dvfs sDvfs;
+
+
+// *************************************************************************************************
+// Extern section
+
+
+#endif /*DVFS_H_*/
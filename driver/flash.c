@@ -0,0 +1,118 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// *************************************************************************************************
+// *************************************************************************************************
+// Main memory flash programming for data logs kept in a FLASH_SEGMENT. The information memory has 
+// its own journaling driver (driver/infomem.c).
+// *************************************************************************************************
+
+
+// *************************************************************************************************
+// Include section
+
+// system
+#include "project.h"
+
+#ifdef FEATURE_FLASH_LOG
+
+#include <string.h>
+
+// driver
+#include "flash.h"
+
+
+// *************************************************************************************************
+// Prototypes section
+
+
+// *************************************************************************************************
+// Defines section
+
+#define flash_waitbusy()		while (FCTL3 & BUSY)
+
+
+// *************************************************************************************************
+// Global Variable section
+
+
+// *************************************************************************************************
+// Extern section
+
+
+// *************************************************************************************************
+// @fn          flash_erase
+// @brief       Erase one main memory segment. The CPU is held for about 25ms.
+// @param       volatile u8 * segment		first address of the segment
+// @return      none
+// *************************************************************************************************
+void flash_erase(volatile u8 * segment)
+{
+	flash_waitbusy();
+	FCTL3 = FWKEY;
+	FCTL1 = FWKEY | ERASE;
+#ifdef EZCHRONOS_HOST
+	// Host flash is RAM, the dummy write would not erase it
+	memset((u8 *)segment, FLASH_ERASED, FLASH_SEGMENT_SIZE);
+#else
+	*segment = 0;
+#endif
+	flash_waitbusy();
+	FCTL1 = FWKEY;
+	FCTL3 = FWKEY | LOCK;
+}
+
+
+// *************************************************************************************************
+// @fn          flash_write
+// @brief       Program bytes into erased main memory.
+// @param       volatile u8 * addr		destination
+//				const u8 * data			source
+//				u16 count				number of bytes
+// @return      none
+// *************************************************************************************************
+void flash_write(volatile u8 * addr, const u8 * data, u16 count)
+{
+	flash_waitbusy();
+	FCTL3 = FWKEY;
+	FCTL1 = FWKEY | WRT;
+	while (count--)
+	{
+		*addr++ = *data++;
+		flash_waitbusy();
+	}
+	FCTL1 = FWKEY;
+	FCTL3 = FWKEY | LOCK;
+}
+
+#endif /*FEATURE_FLASH_LOG*/
@@ -0,0 +1,77 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// *************************************************************************************************
+
+#ifndef FLASH_H_
+#define FLASH_H_
+
+// *************************************************************************************************
+// Include section
+
+
+// *************************************************************************************************
+// Prototypes section
+extern void flash_erase(volatile u8 * segment);
+extern void flash_write(volatile u8 * addr, const u8 * data, u16 count);
+
+
+// *************************************************************************************************
+// Defines section
+
+// Main memory is erased in segments of 512 bytes
+#define FLASH_SEGMENT_SIZE		(512u)
+#define FLASH_ERASED			(0xFFu)
+
+// Reserve one main memory segment for data that has to survive a reset. The segments are collected
+// in the .flashlog section, which gcc/flashlog.x places on top of main flash without load data: it is not
+// part of the image, programming the watch leaves it erased and a reset keeps its content. It is
+// only changed by flash_erase() and flash_write(). The host builds keep an erased image in RAM.
+#ifdef EZCHRONOS_HOST
+#define FLASH_SEGMENT(name)		u8 name[FLASH_SEGMENT_SIZE] \
+								__attribute__((aligned(FLASH_SEGMENT_SIZE))) = { [0 ... FLASH_SEGMENT_SIZE-1] = FLASH_ERASED }
+#else
+#define FLASH_SEGMENT(name)		u8 name[FLASH_SEGMENT_SIZE] \
+								__attribute__((section(".flashlog"), aligned(FLASH_SEGMENT_SIZE)))
+#endif
+
+
+// *************************************************************************************************
+// Global Variable section
+
+
+// *************************************************************************************************
+// Extern section
+
+
+#endif /*FLASH_H_*/
@@ -13,10 +13,27 @@
 
 struct infomem sInfomem;
 
-void infomem_write_flash_segment(u16* start, u16* data, u8 erase);
-void infomem_insert_delete_modify(u16* start, u16* data, u8 del_count, u8 ins_count, u16** mod_addr, u16* mod_data, u8 mod_count, u16* free_start, u16* free_stop);
-void infomem_write_data(u16* start, u16* data, u8 count);
-u16* infomem_get_app_addr(u8 identifier);
+//LOCKA has been removed by infomem_flash_open and has to be set again
+u8 infomem_relock_a;
+
+void infomem_flash_open(u16* end);
+void infomem_flash_close(void);
+void infomem_flash_erase(u16* segment);
+void infomem_flash_write(u16* addr, u16 data);
+u8 infomem_blank(u16* start, u16* end);
+u8 infomem_layout(void);
+u16* infomem_segment_end(void);
+u16* infomem_segment_next(u16* segment);
+u8 infomem_segment_valid(u16* segment);
+struct infomem_app* infomem_get_app(u8 identifier);
+s16 infomem_index_set(u8 identifier, u16* addr, u8 size);
+u16 infomem_index_crc(void);
+void infomem_index_clear(void);
+u16* infomem_scan_segment(u16* segment);
+u16* infomem_copy_live(u16* from, u16* dst);
+void infomem_advance(void);
+s16 infomem_prepare(u8 identifier, u8 size);
+void infomem_append(u8 identifier, u16* data, u8 count, u8 offset, u8 size);
 
 #define infomem_waitbusy() \
 	while(1) \
@@ -25,376 +42,616 @@ u16* infomem_get_app_addr(u8 identifier);
 			break; \
 	}
 
-// write one complete flash segment
-//        FOR INTERNAL USE ONLY
-//
-// erases segment when needed. Only writes to a long word if data has changed
-//data has size of at least 128 Byte
-//erase 0: do not erase; 1: test if need to erase; 2: erase without test
-void infomem_write_flash_segment(u16* start, u16* data, u8 erase)
+//sequence number of a used segment
+#define infomem_segment_seq(segment) (((u8*)(segment))[2])
+
+//first index slot to look for an application
+#define infomem_index_slot(identifier) ((identifier) & (INFOMEM_MAX_APPS-1))
+
+// *************************************************************************************************
+// @fn          infomem_flash_open
+// @brief       unlock flash for erasing and writing
+//				FOR INTERNAL USE ONLY
+// @param       u16* end		first address after the memory that will be changed
+// @return		none
+// *************************************************************************************************
+void infomem_flash_open(u16* end)
 {
-	int i;
-	
-	//check if we need to erase
-	if(erase ==1)
-	{
-		for(i=0; i <INFOMEM_SEGMENT_WORDS; i++)
-		{
-			//we have to erase if the new data has bits 1 that are 0 already
-			if( ( start[i] | data[i] ) != start[i])
-			{
-				erase=2;
-				break;
-			}
-		}
-	}
-	
 	#ifdef USE_WATCHDOG
 	//hold watch dog timer
 	WDTCTL = (WDTCTL &0xff) | WDTPW | WDTHOLD;
 	#endif
-	
+
 	infomem_waitbusy()
-	
+
 	//remove LOCK and LOCKA bit if needed (LOCKA is toggled if it is written as 1)
-	if(start == (u16*)INFOMEM_A && (FCTL3 & LOCKA))
+	if(end > (u16*)INFOMEM_A && (FCTL3 & LOCKA))
 	{
 		FCTL3 = FWKEY | LOCKA;
+		infomem_relock_a = 1;
 	}
 	else
 	{
 		FCTL3 = FWKEY;
 	}
-	
+
 	//remove LOCKINFO bit
 	FCTL4 = FWKEY ;
-	
-	if(erase==2)
-	{
-	FCTL1 = FWKEY | ERASE;
-	*start = 0;
-	infomem_waitbusy()
-	}
-	
-	//set long-word write mode
-	FCTL1 = FWKEY | BLKWRT;
-	
-	//write long words if the new data is different from the old
-	for(i=0; i< INFOMEM_SEGMENT_WORDS; i+=2)
-	{
-		if(start[i] != data[i] || start[i+1] != data[i+1] )
-		{
-			start[i  ] = data[i  ];
-			start[i+1] = data[i+1];
-			infomem_waitbusy()
-		}
-	}
-	
+
+	//set word write mode
+	FCTL1 = FWKEY | WRT;
+}
+
+// *************************************************************************************************
+// @fn          infomem_flash_close
+// @brief       lock flash again after infomem_flash_open
+//				FOR INTERNAL USE ONLY
+// @param       none
+// @return		none
+// *************************************************************************************************
+void infomem_flash_close(void)
+{
 	//leave write mode
 	FCTL1 = FWKEY;
 	//set LOCKINFO bit
 	FCTL4 = FWKEY | (FCTL4 & 0xff) | LOCKINFO;
-	
-	//set LOCK bit
-	FCTL3 = FWKEY | (FCTL3 & 0xff) | LOCK;
-	
+
+	//set LOCK bit and toggle LOCKA back if we have removed it
+	FCTL3 = FWKEY | LOCK | (infomem_relock_a ? LOCKA : 0);
+	infomem_relock_a = 0;
+
 	#ifdef USE_WATCHDOG
 	//restart and reset watchdog timer
 	WDTCTL = (WDTCTL &0xff & ~WDTHOLD ) | WDTPW | WDTCNTCL;
 	#endif
 }
 
-
-//write count words at address start
-void infomem_write_data(u16* start, u16* data, u8 count)
+// *************************************************************************************************
+// @fn          infomem_flash_erase
+// @brief       erase one flash segment, flash has to be opened
+//				FOR INTERNAL USE ONLY
+// @param       u16* segment	first address of segment
+// @return		none
+// *************************************************************************************************
+void infomem_flash_erase(u16* segment)
 {
-	infomem_insert_delete_modify(start, data, count, count, NULL, NULL, 0, sInfomem.startaddr+3+sInfomem.size, sInfomem.startaddr+3+sInfomem.maxsize);
+	FCTL1 = FWKEY | ERASE;
+	*segment = 0;
+	infomem_waitbusy()
+	FCTL1 = FWKEY | WRT;
 }
 
-// function to do nearly anything with memory
-//
-//        FOR INTERNAL USE ONLY
-//
-// mod_addr[n] < mod_addr[n+1]
-// the mod always precedes data (data is not read in that case and can point to invalid memory location)
-// mod_addr<free_start+ins_count-del_count
-// when data is NULL and ins_count>0, INFOMEM_ERASED_WORD will be inserted instead
-// memory right of free_stop is never changed
-// free_start is the first address after the meaningful data (BEFORE any insert or delete)
-// mod_addr are addresses AFTER the insert/delete
-void infomem_insert_delete_modify(u16* start, u16* data, u8 del_count, u8 ins_count, u16** mod_addr, u16* mod_data, u8 mod_count, u16* free_start, u16* free_stop)
+// *************************************************************************************************
+// @fn          infomem_flash_write
+// @brief       program one word, flash has to be opened and the word has to be erased
+//				FOR INTERNAL USE ONLY
+// @param       u16* addr		address of word
+//				u16 data		new content
+// @return		none
+// *************************************************************************************************
+void infomem_flash_write(u16* addr, u16 data)
 {
-	int i;
-	u8 next_mod;
-	int more=ins_count-del_count;
-	
-	//beginning of segment that is the first (address wise) to be modified
-	u16* segment_first;
-	//beginning of the segment that is the last (address wise) to be modified
-	u16* segment_last;
-	
-	//find first modified flash segment
-	if((mod_count>0) && (mod_addr[0]< start))
-	{
-		segment_first=(u16*)((u16) mod_addr[0] & ~(INFOMEM_SEGMENT_SIZE-1));
-	}
-	else
+	//erased words already have the right content
+	if(data != INFOMEM_ERASED_WORD)
 	{
-		segment_first=(u16*)((u16) start & ~(INFOMEM_SEGMENT_SIZE-1));
+		*addr = data;
+		infomem_waitbusy()
 	}
-	
-	//find last modified flash segment
-	if(more==0)
+}
+
+// *************************************************************************************************
+// @fn          infomem_blank
+// @brief       check if memory range is erased
+//				FOR INTERNAL USE ONLY
+// @param       u16* start		first word to check
+//				u16* end		first word after the range
+// @return		1 all words erased
+//				0 otherwise
+// *************************************************************************************************
+u8 infomem_blank(u16* start, u16* end)
+{
+	while(start<end)
 	{
-		if((mod_count>0) && (mod_addr[mod_count-1]>=start+ins_count))
+		if(*start++ != INFOMEM_ERASED_WORD)
 		{
-			segment_last= (u16*)((u16) mod_addr[mod_count-1] & ~(INFOMEM_SEGMENT_SIZE-1));
-		}
-		else
-		{
-			segment_last= (u16*)((u16) (start+ins_count-1) & ~(INFOMEM_SEGMENT_SIZE-1));
+			return 0;
 		}
 	}
-	else if(more>0)
+	return 1;
+}
+
+// *************************************************************************************************
+// @fn          infomem_layout
+// @brief       return layout byte of segment headers (first segment, number of segments)
+//				FOR INTERNAL USE ONLY
+// @param       none
+// @return		layout byte
+// *************************************************************************************************
+u8 infomem_layout(void)
+{
+	return ((((u16)sInfomem.startaddr-INFOMEM_START)/INFOMEM_SEGMENT_SIZE)<<4) | sInfomem.segments;
+}
+
+// *************************************************************************************************
+// @fn          infomem_segment_end
+// @brief       return first address after managed memory
+//				FOR INTERNAL USE ONLY
+// @param       none
+// @return		address
+// *************************************************************************************************
+u16* infomem_segment_end(void)
+{
+	return sInfomem.startaddr+sInfomem.segments*INFOMEM_SEGMENT_WORDS;
+}
+
+// *************************************************************************************************
+// @fn          infomem_segment_next
+// @brief       return segment following the given one (wraps around at the end)
+//				FOR INTERNAL USE ONLY
+// @param       u16* segment	first address of segment
+// @return		first address of next segment
+// *************************************************************************************************
+u16* infomem_segment_next(u16* segment)
+{
+	segment+=INFOMEM_SEGMENT_WORDS;
+	if(segment>=infomem_segment_end())
 	{
-		segment_last= (u16*)((u16) (free_start+more-1) & ~(INFOMEM_SEGMENT_SIZE-1));
+		segment=sInfomem.startaddr;
 	}
-	else  //more<0
+	return segment;
+}
+
+// *************************************************************************************************
+// @fn          infomem_segment_valid
+// @brief       check if segment has a complete header
+//				FOR INTERNAL USE ONLY
+// @param       u16* segment	first address of segment
+// @return		1 segment is in use
+//				0 segment is erased or contains garbage
+// *************************************************************************************************
+u8 infomem_segment_valid(u16* segment)
+{
+	return segment[0]==INFOMEM_IDENTIFIER && ((u8*)segment)[3]==infomem_layout();
+}
+
+// *************************************************************************************************
+// @fn          infomem_get_app
+// @brief       return the index entry of an application
+//				the index is a hash table with linear probing, free slots have size 0
+//				FOR INTERNAL USE ONLY
+// @param       u8 identifier	Identifier byte for application
+// @return		NULL not present
+//				n index entry
+// *************************************************************************************************
+struct infomem_app* infomem_get_app(u8 identifier)
+{
+	u8 i;
+	u8 slot= infomem_index_slot(identifier);
+
+	for(i=0; i<INFOMEM_MAX_APPS; i++)
 	{
-		segment_last= (u16*)((u16) (free_start-1) & ~(INFOMEM_SEGMENT_SIZE-1));
+		//applications are never stored behind a free slot
+		if(sInfomem.index[slot].size == 0)
+		{
+			break;
+		}
+		if(sInfomem.index[slot].identifier == identifier)
+		{
+			return &sInfomem.index[slot];
+		}
+		slot= infomem_index_slot(slot+1);
 	}
-	
-	//we need buffer memory to store a flash page while it is erased and rewritten
-	u16 buf[INFOMEM_SEGMENT_WORDS];
-	
-	//position of the newly to insert data relative to the beginning of the segment
-	int data_offset;
-	
-	//we insert data, so start with the last segment and make your way to the beginning
-	if(more>0)
+	//application not found
+	return NULL;
+}
+
+// *************************************************************************************************
+// @fn          infomem_index_set
+// @brief       point index entry of an application to a new record
+//				FOR INTERNAL USE ONLY
+// @param       u8 identifier	Identifier byte for application
+//				u16* addr		address of the record header
+//				u8 size			payload size of record, 0 removes the application
+// @return		-1 index is full
+//				0 done
+// *************************************************************************************************
+s16 infomem_index_set(u8 identifier, u16* addr, u8 size)
+{
+	struct infomem_app* app= infomem_get_app(identifier);
+	u8 slot, next, home;
+
+	if(app != NULL)
 	{
-		//start with the last mod
-		next_mod=mod_count;
-		//while we have not processed all modified flash segments
-		while(segment_first<=segment_last)
+		sInfomem.size-=app->size+1;
+		if(size==0)
 		{
-			data_offset=((u16)start - (u16)segment_last)/2;
-			
-			for(i=INFOMEM_SEGMENT_WORDS-1;i>=0;i--)
+			sInfomem.apps--;
+			//free the slot and move entries back that could not be stored in it before
+			slot= app-sInfomem.index;
+			next= slot;
+			while(1)
 			{
-				//data we need to preserve
-				if( (segment_last+i) >= free_stop)
+				sInfomem.index[slot].size= 0;
+				do
 				{
-					buf[i]=segment_last[i];
-				}
-				//data to change with single modify
-				else if( next_mod!=0 && (segment_last+i) == mod_addr[next_mod-1] )
-				{
-					buf[i] = mod_data[next_mod-1];
-					next_mod --;
-				}
-				//data we do not care about (leave erased)
-				else if( (segment_last+i) >= (free_start+more))
-				{
-					buf[i]=INFOMEM_ERASED_WORD;
-				}
-				//data not to change
-				else if((segment_last+i) < start)
-				{
-					buf[i]=segment_last[i];
-				}
-				//data following the data we insert
-				else if( (segment_last+i) >= (start+ins_count))
-				{
-					buf[i]=segment_last[i-more];
-				}
-				//data to insert
-				else // if( (segment_last+i) >= start &&  (segment_last+i) < (start+ins_count) )
-				{
-					if(data == NULL)
-					{
-						buf[i]=INFOMEM_ERASED_WORD;
-					}
-					else
+					next= infomem_index_slot(next+1);
+					if(sInfomem.index[next].size == 0)
 					{
-						buf[i]=data[i-data_offset];
+						return 0;
 					}
+					home= infomem_index_slot(sInfomem.index[next].identifier);
 				}
+				//entry stays if its home slot lies cyclically in (slot, next]
+				while(slot<next ? (home>slot && home<=next) : (home>slot || home<=next));
+				sInfomem.index[slot]= sInfomem.index[next];
+				slot= next;
 			}
-			//write buffer to flash
-			infomem_write_flash_segment(segment_last,buf,1);
-			//we have processed the last segment, process the next in the next loop run
-			segment_last-=INFOMEM_SEGMENT_WORDS;
 		}
 	}
-	//start with the first segment
-	else //if more<0
+	else
 	{
-		//start with the first mod
-		next_mod=0;
-		while(segment_first<=segment_last)
+		if(size==0)
 		{
-			data_offset=((u16)start - (u16)segment_first)/2;
-			
-			for(i=0;i<INFOMEM_SEGMENT_WORDS;i++)
-			{
-				//data we need to preserve
-				if( (segment_first+i) >= free_stop)
-				{
-					buf[i]=segment_first[i];
-				}
-				//data to change with single modify
-				else if( next_mod!=mod_count && (segment_first+i) == mod_addr[next_mod] )
-				{
-					buf[i] = mod_data[next_mod];
-					next_mod++;
-				}
-				//data we do not care about (leave erased)
-				else if( (segment_first+i) >= (free_start+more))
-				{
-					buf[i]=INFOMEM_ERASED_WORD;
-				}
-				//data not to change
-				else if((segment_first+i) < start)
-				{
-					buf[i]=segment_first[i];
-				}
-				//data following the data we insert
-				else if( (segment_first+i) >= (start+ins_count))
-				{
-					buf[i]=segment_first[i-more];
-				}
-				//data to insert
-				else // if( (segment_first+i) >= start &&  (segment_first+i) < (start+ins_count) )
-				{
-					if(data == NULL)
-					{
-						buf[i]=INFOMEM_ERASED_WORD;
-					}
-					else
-					{
-						buf[i]=data[i-data_offset];
-					}
-				}
-			}
-			infomem_write_flash_segment(segment_first,buf,1);
-			segment_first +=INFOMEM_SEGMENT_WORDS;
+			return 0;
+		}
+		if(sInfomem.apps>=INFOMEM_MAX_APPS)
+		{
+			return -1;
+		}
+		//take the first free slot
+		slot= infomem_index_slot(identifier);
+		while(sInfomem.index[slot].size != 0)
+		{
+			slot= infomem_index_slot(slot+1);
+		}
+		sInfomem.apps++;
+		app=&sInfomem.index[slot];
+		app->identifier=identifier;
+	}
+	app->addr=addr;
+	app->size=size;
+	sInfomem.size+=size+1;
+	return 0;
+}
+
+// *************************************************************************************************
+// @fn          infomem_index_clear
+// @brief       remove all applications from the index
+//				FOR INTERNAL USE ONLY
+// @param       none
+// @return		none
+// *************************************************************************************************
+void infomem_index_clear(void)
+{
+	u8 i;
+
+	for(i=0; i<INFOMEM_MAX_APPS; i++)
+	{
+		sInfomem.index[i].size= 0;
+	}
+	sInfomem.apps= 0;
+	sInfomem.size= 0;
+}
+
+// *************************************************************************************************
+// @fn          infomem_index_crc
+// @brief       calculate CRC16 over the index and the record headers it points to
+//				a changed header or index entry changes the result
+//				FOR INTERNAL USE ONLY
+// @param       none
+// @return		CRC16 value
+// *************************************************************************************************
+u16 infomem_index_crc(void)
+{
+	u8 i;
+	struct infomem_app* app;
+
+	CRCINIRES = 0xFFFF;
+	CRCDI = sInfomem.head[1];
+	CRCDI = (u16)sInfomem.free;
+	for(i=0; i<INFOMEM_MAX_APPS; i++)
+	{
+		app=&sInfomem.index[i];
+		if(app->size != 0)
+		{
+			CRCDI = (u16)app->addr;
+			CRCDI = ((u16)app->size<<8) | app->identifier;
+			CRCDI = app->addr[0];
 		}
 	}
+	return CRCINIRES;
 }
 
 // *************************************************************************************************
-// @fn          infomem_get_app_addr
-// @brief       return the address of the header for an address
+// @fn          infomem_scan_segment
+// @brief       add all records of a segment to the index
+//				FOR INTERNAL USE ONLY
+// @param       u16* segment	first address of segment
+// @return		NULL too many applications
+//				n first word after the last record (end of segment if it cannot be appended to)
+// *************************************************************************************************
+u16* infomem_scan_segment(u16* segment)
+{
+	u16* addr= segment+INFOMEM_SEGMENT_HEADER;
+	u16* end= segment+INFOMEM_SEGMENT_WORDS;
+
+	while(addr<end && *addr!=INFOMEM_ERASED_WORD)
+	{
+		//damaged header, do not trust the rest of the segment
+		if(addr+((u8*)addr)[1]+1 > end)
+		{
+			return end;
+		}
+		if(infomem_index_set(((u8*)addr)[0], addr, ((u8*)addr)[1]) < 0)
+		{
+			return NULL;
+		}
+		addr+=((u8*)addr)[1]+1;
+	}
+
+	//payload of an interrupted write, do not write to this segment any more
+	if(!infomem_blank(addr,end))
+	{
+		return end;
+	}
+	return addr;
+}
+
+// *************************************************************************************************
+// @fn          infomem_copy_live
+// @brief       copy the newest records of all applications in a segment, flash has to be opened
+//				FOR INTERNAL USE ONLY
+// @param       u16* from		first address of segment to copy from, NULL for all segments
+//				u16* dst		address to copy the first record to
+// @return		first word after the copied records
+// *************************************************************************************************
+u16* infomem_copy_live(u16* from, u16* dst)
+{
+	u8 i,j;
+	struct infomem_app* app;
+
+	for(i=0; i<INFOMEM_MAX_APPS; i++)
+	{
+		app=&sInfomem.index[i];
+		if(app->size==0 || (from!=NULL && (app->addr<from || app->addr>=from+INFOMEM_SEGMENT_WORDS)))
+		{
+			continue;
+		}
+		//payload first, the header makes the record valid
+		for(j=1; j<=app->size; j++)
+		{
+			infomem_flash_write(dst+j, app->addr[j]);
+		}
+		infomem_flash_write(dst, app->addr[0]);
+		app->addr=dst;
+		dst+=app->size+1;
+	}
+	return dst;
+}
+
+// *************************************************************************************************
+// @fn          infomem_advance
+// @brief       start appending to the next segment
+//				copies the live records of the oldest segment and erases it
+//				FOR INTERNAL USE ONLY
+// @param       none
+// @return		none
+// *************************************************************************************************
+void infomem_advance(void)
+{
+	u16* segment= infomem_segment_next(sInfomem.head);
+	u16* oldest= infomem_segment_next(segment);
+	u16* addr= segment+INFOMEM_SEGMENT_HEADER;
+
+	infomem_flash_open(infomem_segment_end());
+
+	//garbage of an interrupted write or an oldest segment that had already been copied
+	if(!infomem_blank(segment, segment+INFOMEM_SEGMENT_WORDS))
+	{
+		infomem_flash_erase(segment);
+	}
+
+	//all segments are in use, save what is still needed from the oldest one
+	if(infomem_segment_valid(oldest))
+	{
+		addr=infomem_copy_live(oldest, addr);
+	}
+
+	//the copies become valid with the segment header, newer than anything in the oldest segment
+	sInfomem.seq++;
+	infomem_flash_write(segment+1, ((u16)infomem_layout()<<8) | sInfomem.seq);
+	infomem_flash_write(segment, INFOMEM_IDENTIFIER);
+
+	if(infomem_segment_valid(oldest))
+	{
+		infomem_flash_erase(oldest);
+	}
+
+	infomem_flash_close();
+
+	sInfomem.head=segment;
+	sInfomem.free=addr;
+	sInfomem.crc=infomem_index_crc();
+}
+
+// *************************************************************************************************
+// @fn          infomem_prepare
+// @brief       make room in the head segment for a new record of an application
 //				FOR INTERNAL USE ONLY
 // @param       u8 identifier	Identifier byte for application
-// @return		NULL not present
-//				n address of identifier byte
+//				u8 size			payload size of new record
+// @return		-4 not enough memory
+//				0 record can be appended
+// *************************************************************************************************
+s16 infomem_prepare(u8 identifier, u8 size)
+{
+	u8 i;
+
+	if(size>0)
+	{
+		//a new application needs an index entry
+		if(infomem_get_app(identifier)==NULL && sInfomem.apps>=INFOMEM_MAX_APPS)
+		{
+			return -4;
+		}
+		//records do not span segments, old and new record have to fit at the same time
+		if(size+1 > INFOMEM_SEGMENT_WORDS-INFOMEM_SEGMENT_HEADER || (u16)sInfomem.size+size+1 > sInfomem.maxsize)
+		{
+			return -4;
+		}
+	}
+
+	for(i=0; sInfomem.free+size+1 > sInfomem.head+INFOMEM_SEGMENT_WORDS; i++)
+	{
+		//records are spread too badly to make room
+		if(i>=sInfomem.segments)
+		{
+			return -4;
+		}
+		infomem_advance();
+	}
+	return 0;
+}
+
+// *************************************************************************************************
+// @fn          infomem_append
+// @brief       append new record for application, the old record stays valid until it is complete
+//				words outside data are taken from the old record (erased if not present)
+//				infomem_prepare has to succeed before
+//				FOR INTERNAL USE ONLY
+// @param       u8 identifier	Identifier byte for application
+//				u16* data		new data, NULL to write erased words
+//				u8 count		number of words in data
+//				u8 offset		word offset of data in new record
+//				u8 size			payload size of new record, 0 removes the application
+// @return		none
 // *************************************************************************************************
-u16* infomem_get_app_addr(u8 identifier)
+void infomem_append(u8 identifier, u16* data, u8 count, u8 offset, u8 size)
 {
-	//start at the first word of payload
-	u16* addr= sInfomem.startaddr +2;
-	
-	//while we have not reached the end
-	while(addr<sInfomem.startaddr+2+sInfomem.size)
-	{
-		//application found, return address
-		if( ((u8*)addr)[0] == identifier )
+	struct infomem_app* app= infomem_get_app(identifier);
+	u16* addr= sInfomem.free;
+	u16 word;
+	u8 i;
+
+	infomem_flash_open(infomem_segment_end());
+
+	for(i=0; i<size; i++)
+	{
+		if(i>=offset && i<offset+count)
 		{
-			return addr;
+			word= (data==NULL) ? INFOMEM_ERASED_WORD : data[i-offset];
+		}
+		else if(app!=NULL && i<app->size)
+		{
+			word= app->addr[i+1];
 		}
-		//step to header of next application
 		else
 		{
-			addr+=((u8*)addr)[1]+1;
+			word= INFOMEM_ERASED_WORD;
 		}
+		infomem_flash_write(addr+1+i, word);
 	}
-	//application not found
-	return NULL;
+	infomem_flash_write(addr, ((u16)size<<8) | identifier);
+
+	infomem_flash_close();
+
+	sInfomem.free+=size+1;
+	infomem_index_set(identifier, addr, size);
+	sInfomem.crc=infomem_index_crc();
 }
 
 // *************************************************************************************************
 // @fn          infomem_ready
 // @brief       check if infomem is initialized and in sane state, return amount of data present
+//				rebuilds the RAM index from the records in flash unless the CRC of
+//				index and record headers shows that nothing has changed since it was built
 // @param		none
 // @return		-2 no memory structure present
-//				-3,-4,-5 data structure error
+//				-3,-4 data structure error
 //				>=0 size of data present
 // *************************************************************************************************
 s16 infomem_ready()
 {
-	u8 found_beg=0;
-	
-	//already checked, trust that and just return size
+	u16* segment;
+	u16* head= NULL;
+	u16* addr;
+	u8 layout= 0;
+	u8 i;
+
+	//already checked, the index is still right if no record header has changed since
 	if(sInfomem.sane== INFOMEM_SANE)
 	{
-		return sInfomem.size;
-	}
-	
-	//if address is already set and in right range, look if it is correct, otherwise reset it
-	if( (((u16) (sInfomem.startaddr)) >= INFOMEM_START) && (((u16) (sInfomem.startaddr)) < (INFOMEM_START+4*INFOMEM_SEGMENT_SIZE)))
-	{
-		if(  *(sInfomem.startaddr) == INFOMEM_IDENTIFIER)
+		if(infomem_index_crc() == sInfomem.crc)
 		{
-			found_beg=1;
-		}
-		else
-		{
-			sInfomem.startaddr= NULL;
+			return sInfomem.size;
 		}
+		sInfomem.sane= 0;
 	}
-	
-	//search for identifier word of information memory by looping over memory
-	if( found_beg == 0 )
+
+	//every used segment tells where the managed memory is
+	for(segment=(u16*)INFOMEM_START; segment<(u16*)INFOMEM_END; segment+=INFOMEM_SEGMENT_WORDS)
 	{
-		u16* addr;
-		for(addr=(u16*)INFOMEM_START; addr<(u16*)(INFOMEM_START+4*INFOMEM_SEGMENT_SIZE); addr++)
+		if( *segment == INFOMEM_IDENTIFIER )
 		{
-			if( *addr == INFOMEM_IDENTIFIER )
-			{
-				sInfomem.startaddr= addr;
-				found_beg=1;
-				break;
-			}
+			layout= ((u8*)segment)[3];
+			break;
 		}
 	}
-	
+
 	//give up searching
-	if( found_beg ==0)
+	if( layout == 0 )
 	{
 		return -2;
 	}
-	
-	//read size and maxsize
-	sInfomem.size = ((u8*)(sInfomem.startaddr))[2];
-	sInfomem.maxsize =  ((u8*)(sInfomem.startaddr))[3];
-	
-	//check size and maxsize for plausibility
-	if(sInfomem.size > sInfomem.maxsize || sInfomem.maxsize > (INFOMEM_START+4*INFOMEM_SEGMENT_SIZE-6 - (u16)sInfomem.startaddr)/2 )
+
+	sInfomem.startaddr= (u16*)INFOMEM_START + (layout>>4)*INFOMEM_SEGMENT_WORDS;
+	sInfomem.segments= layout & 0x0f;
+
+	//check layout for plausibility
+	if( sInfomem.segments < 2 || infomem_segment_end() > (u16*)INFOMEM_END )
 	{
 		return -3;
 	}
-	
-	//loop through applications towards the end of the memory
-	u16* addr= sInfomem.startaddr+2;
-	while(addr<sInfomem.startaddr+2+sInfomem.size)
+
+	//find the newest segment
+	for(segment=sInfomem.startaddr; segment<infomem_segment_end(); segment+=INFOMEM_SEGMENT_WORDS)
 	{
-		addr+=((u8*)addr)[1]+1;
+		if(infomem_segment_valid(segment) && (head==NULL || (s8)(infomem_segment_seq(segment)-infomem_segment_seq(head)) > 0))
+		{
+			head=segment;
+		}
 	}
-	//return when the sum of the application sizes does not match the total size
-	if(addr !=sInfomem.startaddr+sInfomem.size+2)
+	if( head == NULL )
 	{
-		return -4;
+		return -3;
 	}
-	
-	
-	//check if terminator word is in place
-	if( sInfomem.startaddr[sInfomem.size+2] != INFOMEM_TERMINATOR)
+
+	//rebuild index by replaying the segments from the oldest to the newest
+	infomem_index_clear();
+	for(i=sInfomem.segments; i>0; i--)
 	{
-		return -5;
+		for(segment=sInfomem.startaddr; segment<infomem_segment_end(); segment+=INFOMEM_SEGMENT_WORDS)
+		{
+			if(infomem_segment_valid(segment) && infomem_segment_seq(segment) == (u8)(infomem_segment_seq(head)-(i-1)))
+			{
+				if((addr=infomem_scan_segment(segment)) == NULL)
+				{
+					return -4;
+				}
+				if(segment == head)
+				{
+					sInfomem.free= addr;
+				}
+			}
+		}
 	}
-	
+
+	sInfomem.head= head;
+	sInfomem.seq= infomem_segment_seq(head);
+	//one word is kept free so that applications can always be deleted
+	sInfomem.maxsize= (sInfomem.segments-1)*(INFOMEM_SEGMENT_WORDS-INFOMEM_SEGMENT_HEADER)-1;
+	sInfomem.crc= infomem_index_crc();
+
 	//exerything seems to be OK
 	sInfomem.sane= INFOMEM_SANE;
 	sInfomem.not_lock =1;
@@ -404,12 +661,11 @@ s16 infomem_ready()
 
 // *************************************************************************************************
 // @fn          infomem_init
-// @brief       write infomem data structure
-// @param		u16	start		(word) address of first word of used memory
-//				u16	end			(word) address of first word of NOT used memory
+// @brief       erase memory range and write infomem data structure
+// @param		u16	start		address of first segment of used memory
+//				u16	end			address of first segment of NOT used memory
 // @return		-1 infomem already present
-//				-2 addresses not word addresses or out of range
-//				-3 memory not empty
+//				-2 addresses not segment addresses or out of range
 //				>0 new maximum size
 // *************************************************************************************************
 s16 infomem_init(u16 start, u16 end)
@@ -418,42 +674,47 @@ s16 infomem_init(u16 start, u16 end)
 	{
 		return -1;
 	}
-	
-	u16 numwords=(end-start)/2;
-	
-	//check if address boundaries are usable
-	if( start & 0x1 || end &0x1 || end<start || numwords<10 || start < INFOMEM_START || end > INFOMEM_START+4*INFOMEM_SEGMENT_SIZE )
+
+	//check if address boundaries are usable (at least two segments)
+	if( start & (INFOMEM_SEGMENT_SIZE-1) || end & (INFOMEM_SEGMENT_SIZE-1) || end<start+2*INFOMEM_SEGMENT_SIZE || start < INFOMEM_START || end > INFOMEM_END )
 	{
 		return -2;
 	}
-	
-	
-	int i;
-	//check if memory area is empty
-	for(i=0; i<numwords; i++)
+
+	//init struct with standard values
+	sInfomem.startaddr = (u16*) start;
+	sInfomem.segments = (end-start)/INFOMEM_SEGMENT_SIZE;
+	sInfomem.head = (u16*) start;
+	sInfomem.free = sInfomem.head+INFOMEM_SEGMENT_HEADER;
+	sInfomem.seq = 0;
+	sInfomem.maxsize = (sInfomem.segments-1)*(INFOMEM_SEGMENT_WORDS-INFOMEM_SEGMENT_HEADER)-1;
+	sInfomem.not_lock=0;
+	infomem_index_clear();
+
+	infomem_flash_open((u16*)end);
+
+	//erase old content
+	u16* segment;
+	for(segment=(u16*)start; segment<(u16*)end; segment+=INFOMEM_SEGMENT_WORDS)
 	{
-		if( ((u16*)start)[i] != INFOMEM_ERASED_WORD )
+		if(!infomem_blank(segment, segment+INFOMEM_SEGMENT_WORDS))
 		{
-			return -3;
+			infomem_flash_erase(segment);
 		}
 	}
-	
-	//init struct with standard values
-	sInfomem.startaddr = (u16*) start;
-	sInfomem.size=0;
-	sInfomem.maxsize=(end-start-6)/2;
-	sInfomem.not_lock=0;
-	
-	//prepare the three words of the initial structure
-	u16 buf[3]={INFOMEM_IDENTIFIER,((numwords-3) & 0xFF)<<8,INFOMEM_TERMINATOR};
-	
-	//write the initial structure to memory
-	infomem_write_data((u16*)start, buf,3);
-	
+
+	//write header of first segment
+	infomem_flash_write(sInfomem.head+1, (u16)infomem_layout()<<8);
+	infomem_flash_write(sInfomem.head, INFOMEM_IDENTIFIER);
+
+	infomem_flash_close();
+
+	sInfomem.crc= infomem_index_crc();
+
 	//make structure usable
 	sInfomem.sane= INFOMEM_SANE;
 	sInfomem.not_lock=1;
-	
+
 	return sInfomem.maxsize;
 
 };
@@ -463,7 +724,7 @@ s16 infomem_init(u16 start, u16 end)
 // @brief       return amount of free space
 // @param		none
 // @return		<0 see infomem_ready
-//				>=0 available free space (in words)
+//				>=0 available free space (in words, including one header word per application)
 // *************************************************************************************************
 s16 infomem_space()
 {
@@ -481,34 +742,34 @@ s16 infomem_space()
 // *************************************************************************************************
 // @fn          infomem_relocate
 // @brief       change start and end address of data storage (can change size)
-// @param		u16	start		(word) address of first word of used memory
-//				u16	end			(word) address of first word of NOT used memory
+// @param		u16	start		address of first segment of used memory
+//				u16	end			address of first segment of NOT used memory
 // @return		-1 data structure error or memory not initialized
 //				-2 temporary error (try again later)
-//				-3 address not word addresses
-//				-4 addresses out of range
+//				-3 address not segment addresses
+//				-4 addresses out of range or overlapping the current memory
 //				-5 new space too small
 //				>0 new maximum size
 // *************************************************************************************************
 s16 infomem_relocate(u16 start, u16 end)
 {
-	//check if we really have word addresses
-	if((start & 0x1) || (end & 0x1))
+	//check if we really have segment addresses
+	if((start & (INFOMEM_SEGMENT_SIZE-1)) || (end & (INFOMEM_SEGMENT_SIZE-1)))
 	{
 		return -3;
 	}
-	
+
 	if(sInfomem.sane!=INFOMEM_SANE)
 	{
 		return -1;
 	}
-	//check if range is within memory
-	if(end > INFOMEM_START+4*INFOMEM_SEGMENT_SIZE || start < INFOMEM_START)
+	//check if range is within memory and does not overlap the current one
+	if(end > INFOMEM_END || start < INFOMEM_START || ((u16*)start < infomem_segment_end() && (u16*)end > sInfomem.startaddr))
 	{
 		return -4;
 	}
-	//check if new memory range is big enough
-	if((u16*)end < (u16*)start +sInfomem.size+3)
+	//check if new memory range is big enough, all data is copied to its first segment
+	if(end < start+2*INFOMEM_SEGMENT_SIZE || sInfomem.size > INFOMEM_SEGMENT_WORDS-INFOMEM_SEGMENT_HEADER)
 	{
 		return -5;
 	}
@@ -518,40 +779,45 @@ s16 infomem_relocate(u16 start, u16 end)
 		return -2;
 	}
 	sInfomem.not_lock=0;
-	
-	
-	u16* old_end=sInfomem.startaddr+sInfomem.maxsize+3;
-	
-	sInfomem.maxsize= (u16*)end - (u16*)start - 3;
-	
-	//new address of size word
-	u16* mod_addr= (u16*)start+1;
-	
-	//prepare new size word
-	u16 buf;
-	((u8*)(&buf))[0] = sInfomem.size;
-	((u8*)(&buf))[1] = sInfomem.maxsize;
-	
-	//no relocation, just resize
-	if((u16*)start == sInfomem.startaddr)
-	{
-		infomem_write_data(mod_addr, &buf, 1);
-	}
-	//left shift (might be with resize)
-	else if((u16*)start < sInfomem.startaddr)
-	{
-		//delete bytes before information memory
-		infomem_insert_delete_modify((u16*)start, NULL, (u8)(sInfomem.startaddr-(u16*)start), 0, &mod_addr, &buf, 1, sInfomem.startaddr+3+sInfomem.size, old_end);
-	}
-	//right shift
-	else
+
+	u16* old_start=sInfomem.startaddr;
+	u16* old_end=infomem_segment_end();
+	u16* segment;
+
+	infomem_flash_open((u16*)(end > (u16)old_end ? end : (u16)old_end));
+
+	//erase new memory
+	for(segment=(u16*)start; segment<(u16*)end; segment+=INFOMEM_SEGMENT_WORDS)
 	{
-		//insert empty bytes before information memory
-		infomem_insert_delete_modify(sInfomem.startaddr, NULL, 0, (u8)((u16*)start-sInfomem.startaddr), &mod_addr, &buf, 1, sInfomem.startaddr+3+sInfomem.size, (u16*)start+3+sInfomem.maxsize);
+		if(!infomem_blank(segment, segment+INFOMEM_SEGMENT_WORDS))
+		{
+			infomem_flash_erase(segment);
+		}
 	}
-	
+
+	//copy all data to the first new segment and make it valid
+	sInfomem.free=infomem_copy_live(NULL, (u16*)start+INFOMEM_SEGMENT_HEADER);
 	sInfomem.startaddr=(u16*)start;
-	
+	sInfomem.segments=(end-start)/INFOMEM_SEGMENT_SIZE;
+	sInfomem.head=(u16*)start;
+	sInfomem.seq++;
+	infomem_flash_write(sInfomem.head+1, ((u16)infomem_layout()<<8) | sInfomem.seq);
+	infomem_flash_write(sInfomem.head, INFOMEM_IDENTIFIER);
+
+	//erase old memory
+	for(segment=old_start; segment<old_end; segment+=INFOMEM_SEGMENT_WORDS)
+	{
+		if(!infomem_blank(segment, segment+INFOMEM_SEGMENT_WORDS))
+		{
+			infomem_flash_erase(segment);
+		}
+	}
+
+	infomem_flash_close();
+
+	sInfomem.maxsize= (sInfomem.segments-1)*(INFOMEM_SEGMENT_WORDS-INFOMEM_SEGMENT_HEADER)-1;
+	sInfomem.crc= infomem_index_crc();
+
 	sInfomem.not_lock=1;
 	return sInfomem.maxsize;
 }
@@ -569,14 +835,25 @@ s16 infomem_delete_all(void)
 	{
 		return -1;
 	}
-	
-	//overwrite complete previously reserved memory with erased bytes
-	infomem_insert_delete_modify(sInfomem.startaddr, NULL, sInfomem.maxsize+3, sInfomem.maxsize+3, NULL, NULL, 0, sInfomem.startaddr+3+sInfomem.size, sInfomem.startaddr+3+sInfomem.maxsize);
-	
+
+	u16* segment;
+
+	//erase all segments of the managed memory
+	infomem_flash_open(infomem_segment_end());
+	for(segment=sInfomem.startaddr; segment<infomem_segment_end(); segment+=INFOMEM_SEGMENT_WORDS)
+	{
+		if(!infomem_blank(segment, segment+INFOMEM_SEGMENT_WORDS))
+		{
+			infomem_flash_erase(segment);
+		}
+	}
+	infomem_flash_close();
+
 	sInfomem.sane=0;
 	sInfomem.startaddr=NULL;
-	sInfomem.size=0;
+	sInfomem.segments=0;
 	sInfomem.maxsize=0;
+	infomem_index_clear();
 	return 0;
 }
 
@@ -594,17 +871,17 @@ s16 infomem_app_amount(u8 identifier)
 	{
 		return -1;
 	}
-	
-	u16* addr= infomem_get_app_addr(identifier);
-	if( addr == NULL)
+
+	struct infomem_app* app= infomem_get_app(identifier);
+	if( app == NULL)
 	{
 		return 0;
 	}
-	
-	return ((u8*)addr)[1];
+
+	return app->size;
 }
-	
-	
+
+
 // *************************************************************************************************
 // @fn          infomem_app_read
 // @brief       read count bytes of data with offset for given application into prepared memory
@@ -623,36 +900,34 @@ s16 infomem_app_read(u8 identifier, u16* data, u8 count, u8 offset)
 	{
 		return -1;
 	}
-	
+
 	//find application
-	u16* addr= infomem_get_app_addr(identifier);
-	if( addr == NULL)
+	struct infomem_app* app= infomem_get_app(identifier);
+	if( app == NULL)
 	{
 		return 0;
 	}
-	
-	//read application size
-	u8 size=((u8*)addr)[1];
+
 	//check if offset is still within application memory
-	if (offset>=size)
+	if (offset>=app->size)
 	{
 		return 0;
 	}
 	//do not read more data than what is present
-	if(count+offset>size)
+	if(count+offset>app->size)
 	{
-		count= size-offset;
+		count= app->size-offset;
 	}
 	//set address to read from
-	addr+=offset+1;
-	
+	u16* addr= app->addr+offset+1;
+
 	int i;
 	//copy data
 	for(i=0;i<count;i++)
 	{
 		data[i]=addr[i];
 	}
-	
+
 	return count;
 }
 
@@ -669,12 +944,14 @@ s16 infomem_app_read(u8 identifier, u16* data, u8 count, u8 offset)
 // *************************************************************************************************
 s16 infomem_app_replace(u8 identifier, u16* data, u8 count)
 {
+	s16 ret;
+
 	//delete app completely if we have to replace it with zero content.
 	if(count ==0)
 	{
 		return infomem_app_delete(identifier,0);
 	}
-	
+
 	if(sInfomem.sane!=INFOMEM_SANE)
 	{
 		return -1;
@@ -684,59 +961,14 @@ s16 infomem_app_replace(u8 identifier, u16* data, u8 count)
 		return -2;
 	}
 	sInfomem.not_lock=0;
-	
-	u8 old_size=0;
-	//get address of application
-	u16* addr= infomem_get_app_addr(identifier);
-	//application is already present, really replace memory content
-	if( addr != NULL)
-	{
-		old_size=((u8*)addr)[1];
-		
-		//check if new data does fit
-		if((s16)sInfomem.size + (s16) count - (s16)old_size > sInfomem.maxsize)
-		{
-			sInfomem.not_lock=1;
-			return -4;
-		}
-		
-		//set global header and application header to be modified
-		u16* mod_addr[2]={sInfomem.startaddr+1,addr};
-		u16 mod_data[2];
-		((u8*)mod_data)[0]=sInfomem.size+count-old_size;
-		((u8*)mod_data)[1]=sInfomem.maxsize;
-		((u8*)mod_data)[2]=identifier;
-		((u8*)mod_data)[3]=count;
-		
-		//delete old_size words and write count new words instead, also replace headers
-		infomem_insert_delete_modify(addr+1, data, old_size, count, mod_addr, mod_data, 2, sInfomem.startaddr+3+sInfomem.size, sInfomem.startaddr+3+sInfomem.maxsize);
-		//store new size
-		sInfomem.size=((u8*)mod_data)[0];
-	}
-	//application not present, add it at the end of the information memory
-	else
+
+	if((ret=infomem_prepare(identifier, count)) < 0)
 	{
-		//check if new data does fit
-		if((s16)sInfomem.size + (s16) count +1 > sInfomem.maxsize)
-		{
-			sInfomem.not_lock=1;
-			return -4;
-		}
-		
-		//prepare header words
-		u16* mod_addr[2]={sInfomem.startaddr+1,sInfomem.startaddr+2+sInfomem.size};
-		u16 mod_data[2];
-		((u8*)mod_data)[0]=sInfomem.size+count+1;
-		((u8*)mod_data)[1]=sInfomem.maxsize;
-		((u8*)mod_data)[2]=identifier;
-		((u8*)mod_data)[3]=count;
-		
-		//hack: to write the application header and size add it to mod, increase count and decrease data pointer. the first data word at data-1 will not be read
-		//this avoids copying data to add a header
-		infomem_insert_delete_modify(sInfomem.startaddr+2+sInfomem.size, data-1, 0, count+1, mod_addr, mod_data, 2, sInfomem.startaddr+3+sInfomem.size, sInfomem.startaddr+3+sInfomem.maxsize);
-		//store size
-		sInfomem.size=((u8*)mod_data)[0];
+		sInfomem.not_lock=1;
+		return ret;
 	}
+	infomem_append(identifier, data, count, 0, count);
+
 	sInfomem.not_lock=1;
 	return sInfomem.size;
 }
@@ -764,11 +996,14 @@ s16 infomem_app_clear(u8 identifier)
 // @return		-1 data structure error or memory not initialized
 //				-2 temporary error (try again later)
 //				-3 offset out of range
+//				-4 not enough memory
 //				0 application not present
 //				n new total size of data in information memory
 // *************************************************************************************************
 s16 infomem_app_delete(u8 identifier,u8 offset)
 {
+	s16 ret;
+
 	if(sInfomem.sane!=INFOMEM_SANE)
 	{
 		return -1;
@@ -778,54 +1013,29 @@ s16 infomem_app_delete(u8 identifier,u8 offset)
 		return -2;
 	}
 	sInfomem.not_lock=0;
-	
-	//get address of application
-	u16* addr= infomem_get_app_addr(identifier);
-	if( addr == NULL)
+
+	//get index entry of application
+	struct infomem_app* app= infomem_get_app(identifier);
+	if( app == NULL)
 	{
 		sInfomem.not_lock=1;
 		return 0;
 	}
-	//get old size of application
-	u8 old_size=((u8*)addr)[1];
-	//delete application completely
-	if(offset==0)
-	{
-		//prepare global size header
-		u16* mod_addr[1]={sInfomem.startaddr+1};
-		u16 mod_data[1];
-		((u8*)mod_data)[0]=sInfomem.size-old_size-1;
-		((u8*)mod_data)[1]=sInfomem.maxsize;
-		
-		infomem_insert_delete_modify(addr, NULL, old_size+1, 0, mod_addr, mod_data, 1, sInfomem.startaddr+3+sInfomem.size, sInfomem.startaddr+3+sInfomem.maxsize);
-		//store new size
-		sInfomem.size=((u8*)mod_data)[0];
-	}
-	//let some data be present
-	else
+	//check if offset is in range
+	if(offset>=app->size)
 	{
-		//check if offset is in range
-		if(offset>=old_size)
-		{
-			sInfomem.not_lock=1;
-			return -3;
-		}
-		
-		//determine count of data to be deleted
-		u8 count_delete=old_size-offset;
-		
-		//prepare new size headers
-		u16* mod_addr[2]={sInfomem.startaddr+1,addr};
-		u16 mod_data[2];
-		((u8*)mod_data)[0]=sInfomem.size-count_delete;
-		((u8*)mod_data)[1]=sInfomem.maxsize;
-		((u8*)mod_data)[2]=identifier;
-		((u8*)mod_data)[3]=old_size-count_delete;
-		
-		infomem_insert_delete_modify(addr+1+offset, NULL, count_delete, 0, mod_addr, mod_data, 2, sInfomem.startaddr+3+sInfomem.size, sInfomem.startaddr+3+sInfomem.maxsize);
-		//store new size
-		sInfomem.size=((u8*)mod_data)[0];
+		sInfomem.not_lock=1;
+		return -3;
 	}
+
+	//a record of size zero removes the application, otherwise keep the first offset words
+	if((ret=infomem_prepare(identifier, offset)) < 0)
+	{
+		sInfomem.not_lock=1;
+		return ret;
+	}
+	infomem_append(identifier, NULL, 0, 0, offset);
+
 	sInfomem.not_lock=1;
 	return sInfomem.size;
 }
@@ -847,6 +1057,8 @@ s16 infomem_app_delete(u8 identifier,u8 offset)
 // *************************************************************************************************
 s16 infomem_app_modify(u8 identifier, u16* data, u8 count, u8 offset)
 {
+	s16 ret;
+
 	if(sInfomem.sane!=INFOMEM_SANE)
 	{
 		return -1;
@@ -856,58 +1068,38 @@ s16 infomem_app_modify(u8 identifier, u16* data, u8 count, u8 offset)
 		return -2;
 	}
 	sInfomem.not_lock=0;
-	
-	u16* addr= infomem_get_app_addr(identifier);
-	
-	if( addr == NULL)
+
+	struct infomem_app* app= infomem_get_app(identifier);
+
+	if( app == NULL)
 	{
 		sInfomem.not_lock=1;
 		return 0;
 	}
-	u8 old_size=((u8*)addr)[1];
-	
-	if(offset>old_size)
+	u8 size=app->size;
+
+	if(offset>size)
 	{
 		sInfomem.not_lock=1;
 		return -3;
 	}
-	
-	//new data does fit in old data, just modify the selected words
-	if(count+offset<=old_size)
+
+	//new data does not fit, increase size of application's storage
+	if(count+offset>size)
 	{
-		infomem_write_data(addr+1+offset,data,count);
-		sInfomem.not_lock=1;
-		return old_size;
+		size=count+offset;
 	}
-	//new data does not fit, increase size of application's storage
-	else
+
+	//the new record takes the unmodified words from the old one
+	if((ret=infomem_prepare(identifier, size)) < 0)
 	{
-		//calculate number of words that are overwritten
-		u8 count_delete=old_size-offset;
-		
-		//check if new data does fit into memory
-		if((s16)sInfomem.size -(s16)count_delete+(s16) count > sInfomem.maxsize)
-		{
-			sInfomem.not_lock=1;
-			return -4;
-		}
-		
-		//prepare new headers with size
-		u16* mod_addr[2]={sInfomem.startaddr+1,addr};
-		u16 mod_data[2];
-		((u8*)mod_data)[0]=sInfomem.size-count_delete+count;
-		((u8*)mod_data)[1]=sInfomem.maxsize;
-		((u8*)mod_data)[2]=identifier;
-		((u8*)mod_data)[3]=old_size-count_delete+count;
-		
-		infomem_insert_delete_modify(addr+1+offset, data, count_delete, count, mod_addr, mod_data, 2, sInfomem.startaddr+3+sInfomem.size, sInfomem.startaddr+3+sInfomem.maxsize);
-		
-		//store new size
-		sInfomem.size=((u8*)mod_data)[0];
-		
 		sInfomem.not_lock=1;
-		return offset+count;
+		return ret;
 	}
+	infomem_append(identifier, data, count, offset, size);
+
+	sInfomem.not_lock=1;
+	return size;
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -14,6 +14,16 @@
  * without interfering with each other (except for the total available memory) or
  * having to care about the characteristics of flash memory.
  * 
+ * The data is kept as an append-only journal spread over two or more flash segments.
+ * Every write appends a record (one header word with identifier and size, followed
+ * by the payload) to the newest segment and updates a small index in RAM, so reads
+ * never search the flash. Only when the newest segment is full, the live records of
+ * the oldest segment are copied to an erased segment and the oldest one is erased.
+ * A single update therefore costs the payload plus one word of programming and
+ * erases a segment only every few dozen updates. A record only becomes valid once
+ * its header word is written, so a reset during a write leaves the old data intact.
+ * An update needs room for the old and the new copy of the data at the same time.
+ * 
  * infomem_ready() has to be called before any other function does work (except
  * infomem_init, but use infomem_ready to check if infomem_init is really needed).
  * 
@@ -24,16 +34,18 @@
  * Use infomem_app_replace() with count>0 to initialize memory for application. This has
  * to be redone if data of size zero was present and the application header was therefore
  * also removed (replace with zero count, clear, delete with zero offset or modify with 
- * zero count and offset).
+ * zero count and offset). Identifier 0xFF is reserved, at most INFOMEM_MAX_APPS
+ * applications can store data at the same time.
  * 
- * All pointers and addresses have to be word addresses (even numbers) and all counts
- * are given in units of words (two bytes).
+ * All pointers have to be word addresses (even numbers) and all counts are given in
+ * units of words (two bytes). The start and end addresses of the managed memory have
+ * to be segment boundaries.
  */
 
 
 //check if infomem is initialized and in sane state, return amount of data present
 extern s16 infomem_ready();
-//write infomem data structure
+//erase memory range and write empty infomem data structure
 extern s16 infomem_init(u16 start, u16 end);
 //return amount of free space
 extern s16 infomem_space();
@@ -57,19 +69,39 @@ extern s16 infomem_app_modify(u8 identifier, u16* data, u8 count, u8 offset);
 
 
 
-struct infomem
+//size of the RAM index, has to be a power of two
+#define INFOMEM_MAX_APPS 8
+
+//RAM index entry for the newest record of an application (unused if size is 0)
+struct infomem_app
 {
-	u16*		startaddr; //starting address (position of header)
+	u16*		addr;  //address of the record header
+	u8			identifier;
 	u8			size;  //size of payload in words
-	u8			maxsize;  //maximum size of payload in words
+};
+
+struct infomem
+{
+	u16*		startaddr; //address of the first segment
+	u16*		head;  //segment that records are appended to
+	u16*		free;  //first unused word in head segment
+	u8			seq;  //sequence number of head segment
+	u8			segments;  //number of segments
+	u8			size;  //size of live records (payload and headers) in words
+	u8			maxsize;  //maximum size of live records in words
+	u8			apps;  //number of used index entries
 	volatile u8	not_lock;  //memory is not locked for write
 	u8			sane;  //sanity check passed
+	u16			crc;  //CRC16 of index and record headers when the index was last changed
+	struct infomem_app	index[INFOMEM_MAX_APPS];  //hashed by identifier
 };
 // extern struct infomem sInfomem;
 
 
+//first word of every used segment, the second word holds the sequence number
+//in the low byte and the memory layout (first segment, number of segments) in the high byte
 #define INFOMEM_IDENTIFIER 0x5a74
-#define INFOMEM_TERMINATOR 0xdaf4
+#define INFOMEM_SEGMENT_HEADER 2
 #define INFOMEM_SANE 0xda
 
 #define INFOMEM_START 0x1800
@@ -77,6 +109,7 @@ struct infomem
 #define INFOMEM_C 0x1880
 #define INFOMEM_B 0x1900
 #define INFOMEM_A 0x1980
+#define INFOMEM_END 0x1a00
 #define INFOMEM_SEGMENT_SIZE 128
 #define INFOMEM_SEGMENT_WORDS INFOMEM_SEGMENT_SIZE/2
 #define INFOMEM_ERASED_WORD 0xFFFF
@@ -51,6 +51,10 @@
 #include "vti_ps.h"
 #include "timer.h"
 #include "display.h"
+#include "crash.h"
+#ifdef CONFIG_PROFILE
+#include "profile.h"
+#endif
 
 // logic
 #include "clock.h"
@@ -64,12 +68,40 @@
 #include "eggtimer.h"
 #endif
 
+#ifdef CONFIG_PEDOMETER
+#include "pedometer.h"
+#endif
+
+#ifdef CONFIG_PHASE_CLOCK
+#include "phase_clock.h"
+#endif
+
+#ifdef CONFIG_GESTURE
+#include "gesture.h"
+#endif
+
+#ifdef CONFIG_IMPACT
+#include "impact.h"
+#endif
+
+#ifdef CONFIG_WEATHER
+#include "weather.h"
+#endif
+
+#ifdef CONFIG_USE_GPS
+#include "sequence.h"
+#endif
+
 
 // *************************************************************************************************
 // Prototypes section
 void button_repeat_on(u16 msec);
+void backlight_on(void);
 void button_repeat_off(void);
 void button_repeat_function(void);
+#ifdef FEATURE_PROVIDE_ACCEL
+u8 as_idle_interrupt(void);
+#endif
 
 
 // *************************************************************************************************
@@ -78,6 +110,18 @@ void button_repeat_function(void);
 // Macro for button IRQ 
 #define IRQ_TRIGGERED(flags, bit)		((flags & bit) == bit)
 
+// Sensor interrupts that are handled completely in the ISR
+#ifdef CONFIG_USE_GPS
+#define AS_SERVED_IN_ISR				(AS_IN_IDLE_MODE || DOORLOCK_CAPTURING)
+#else
+#define AS_SERVED_IN_ISR				(AS_IN_IDLE_MODE)
+#endif
+
+// Consumers of the 8g samples in idle mode
+#if defined(CONFIG_PEDOMETER) || defined(CONFIG_GESTURE) || defined(CONFIG_IMPACT)
+#define AS_IDLE_SAMPLES
+#endif
+
 
 // *************************************************************************************************
 // Global Variable section
@@ -116,6 +160,115 @@ void init_buttons(void)
 }
 
 
+// *************************************************************************************************
+// @fn          backlight_on
+// @brief       Switch on the backlight for BACKLIGHT_TIME_ON seconds.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void backlight_on(void)
+{
+	sButton.backlight_status = 1;
+	sButton.backlight_timeout = 0;
+	P2OUT |= BUTTON_BACKLIGHT_PIN;
+	P2DIR |= BUTTON_BACKLIGHT_PIN;
+}
+
+
+#ifdef FEATURE_PROVIDE_ACCEL
+// *************************************************************************************************
+// @fn          as_idle_interrupt
+// @brief       Hand an interrupt of the acceleration sensor in idle mode to its consumer. A motion
+//				interrupt also wakes up the consumers that sleep while the wrist is still. Knock
+//				capture of the doorlock and the peak capture of the impact logger take the 400Hz
+//				samples. Called from PORT2_ISR.
+// @param       none
+// @return      u8		1 = main loop has to process data
+// *************************************************************************************************
+u8 as_idle_interrupt(void)
+{
+#ifdef AS_IDLE_SAMPLES
+	u8 xyz[3];
+#endif
+	u8 wakeup = 0;
+#ifdef CONFIG_IMPACT
+	u8 capture;
+#endif
+	
+#ifdef CONFIG_USE_GPS
+	// Reading Z clears the data ready interrupt
+	if (DOORLOCK_CAPTURING) return (doorlock_sample(as_get_z()));
+#endif
+	
+	if (as_mode == AS_MODE_MOTION)
+	{
+		// Reading the interrupt status releases the INT line for the next motion
+		as_read_register(0x05);
+		
+#ifdef CONFIG_PHASE_CLOCK
+		// Sleep recorder owns the motion interrupts while it runs, the others pause
+		if (sPhase.state == PHASE_RECORDING) 	phase_clock_interrupt();
+		else
+#endif
+		{
+#ifdef CONFIG_PEDOMETER
+			pedometer_motion();
+#endif
+#ifdef CONFIG_GESTURE
+			gesture_motion();
+#endif
+		}
+		
+		// Consumers see the mode they were interrupted in, switch for the main loop consumers last
+		as_motion_interrupt();
+		return (0);
+	}
+	
+#ifdef CONFIG_IMPACT
+	if (as_mode == AS_MODE_FREEFALL)
+	{
+		// Reading the interrupt status releases the INT line
+		as_read_register(0x05);
+		impact_freefall();
+		return (0);
+	}
+#endif
+	
+#ifdef AS_IDLE_SAMPLES
+	// 8g sample, reading Z last clears the data ready interrupt
+	xyz[0] = as_read_register(0x06);
+	xyz[1] = as_read_register(0x07);
+	xyz[2] = as_read_register(0x08);
+#endif
+	
+#ifdef CONFIG_IMPACT
+	// The others pause while a peak is captured at 400Hz
+	capture = (as_mode == AS_MODE_8G_400HZ);
+	if (impact_sample(xyz))
+	{
+		request.flag.impact = 1;
+		wakeup = 1;
+	}
+	if (capture) return (wakeup);
+#endif
+	
+#ifdef CONFIG_PEDOMETER
+	if (pedometer_sample(xyz))
+	{
+		request.flag.pedometer = 1;
+		wakeup = 1;
+	}
+#endif
+#ifdef CONFIG_GESTURE
+	if (gesture_sample(xyz))
+	{
+		request.flag.gesture = 1;
+		wakeup = 1;
+	}
+#endif
+	return (wakeup);
+}
+#endif
 
 
 // *************************************************************************************************
@@ -141,6 +294,33 @@ __interrupt void PORT2_ISR(void)
 	u8 simpliciti_button_event = 0;
 	static u8 simpliciti_button_repeat = 0;
 
+#ifdef FEATURE_PROVIDE_ACCEL
+	// ---------------------------------------------------
+	// Pedometer samples, motion interrupts and knocks are collected here, only a complete burst
+	// of pedometer samples, a gesture, a knock or a sensor mode change wakes up the main loop
+	if (((BUTTONS_IFG & BUTTONS_IE) == AS_INT_PIN) && AS_SERVED_IN_ISR)
+	{
+	#ifdef CONFIG_PROFILE
+		u8 wakeup = profile_wakeup(PROFILE_ACCEL);
+	#endif
+		CRASH_ISR(CRASH_ISR_PORT2);
+		
+		AS_INT_IFG &= ~AS_INT_PIN;
+		if (as_idle_interrupt() || request.flag.acceleration_service)
+		{
+			__bic_SR_register_on_exit(LPM4_bits);
+		}
+	#ifdef CONFIG_PROFILE
+		else if (wakeup)
+		{
+			// Back to LPM3 without passing the main loop
+			profile_sleep();
+		}
+	#endif
+		return;
+	}
+#endif
+
 	// Clear button flags
 	button.all_flags = 0;
 
@@ -150,6 +330,17 @@ __interrupt void PORT2_ISR(void)
 	// Store valid button interrupt flag
 	int_flag = BUTTONS_IFG & int_enable;
 
+	CRASH_ISR(CRASH_ISR_PORT2);
+
+#ifdef CONFIG_PROFILE
+	// Charge sensor interrupts to the sensor, everything else to the buttons (first call wins)
+	#ifdef FEATURE_PROVIDE_ACCEL
+	if (IRQ_TRIGGERED(int_flag, AS_INT_PIN)) 		profile_wakeup(PROFILE_ACCEL);
+	#endif
+	if (IRQ_TRIGGERED(int_flag, PS_INT_PIN)) 		profile_wakeup(PROFILE_PRESSURE);
+	profile_wakeup(PROFILE_BUTTONS);
+#endif
+
 	// ---------------------------------------------------
 	// While SimpliciTI stack is active, buttons behave differently:
 	//  - Store button events in SimpliciTI packet data
@@ -296,10 +487,7 @@ __interrupt void PORT2_ISR(void)
 			// Filter bouncing noise 
 			if (BUTTON_BACKLIGHT_IS_PRESSED)
 			{
-				sButton.backlight_status = 1;
-				sButton.backlight_timeout = 0;
-				P2OUT |= BUTTON_BACKLIGHT_PIN;
-				P2DIR |= BUTTON_BACKLIGHT_PIN;
+				backlight_on();
 				button.flag.backlight = 1;
 			}
 		}	
@@ -348,6 +536,11 @@ __interrupt void PORT2_ISR(void)
 	// Acceleration sensor IRQ
 	if (IRQ_TRIGGERED(int_flag, AS_INT_PIN))
 	{
+		if (AS_SERVED_IN_ISR)
+		{
+			as_idle_interrupt();
+		}
+		else
 		// Get data from sensor
 		request.flag.acceleration_measurement = 1;
   	}
@@ -358,6 +551,10 @@ __interrupt void PORT2_ISR(void)
 	if (IRQ_TRIGGERED(int_flag, PS_INT_PIN)) 
 	{
 		// Get data from sensor
+#ifdef CONFIG_WEATHER
+		if (sWeather.converting) request.flag.weather = 1;
+		else
+#endif
 		request.flag.altitude_measurement = 1;
   	}
   	
@@ -375,7 +572,12 @@ __interrupt void PORT2_ISR(void)
 	
 	// Reenable PORT2 IRQ
 	__disable_interrupt();
+	#ifdef FEATURE_PROVIDE_ACCEL
+	// Keep a sensor interrupt that came in during debouncing, the INT line stays high until read
+	BUTTONS_IFG &= AS_INT_PIN & ~int_flag;
+	#else
 	BUTTONS_IFG = 0x00; 	
+	#endif
 	BUTTONS_IE  = int_enable; 	
 	__enable_interrupt();
 
@@ -121,6 +121,7 @@ extern void button_repeat_on(u16 msec);
 extern void button_repeat_off(void);
 extern void button_repeat_function(void);
 extern void init_buttons(void);
+extern void backlight_on(void);
 
 
 #endif /*BUTTONS_H_*/
@@ -0,0 +1,242 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// *************************************************************************************************
+// Peripheral power domains. Consumers acquire and release sensors, reference and radio, a domain
+// is switched off when its last consumer is gone and the power-down hysteresis has elapsed.
+// *************************************************************************************************
+
+
+// *************************************************************************************************
+// Include section
+
+// system
+#include "project.h"
+
+// driver
+#include "power.h"
+#include "vti_as.h"
+#include "vti_ps.h"
+#include "adc12.h"
+#include "radio.h"
+
+
+// *************************************************************************************************
+// Prototypes section
+void power_stop_idle(u8 domain);
+
+
+// *************************************************************************************************
+// Defines section
+
+#define POWER_BIT(domain)		(1u << (domain))
+
+
+// *************************************************************************************************
+// Global Variable section
+struct power sPower;
+
+struct power_domain
+{
+	void	(*start)(void);
+	void	(*stop)(void);
+	void	(*change)(void);		// Consumers of a powered domain changed, can be NULL
+	u8		hold;
+};
+
+// Switch functions and hysteresis, indexed by POWER_ACCEL, POWER_PRESSURE, ...
+static const struct power_domain power_domain[POWER_DOMAINS] =
+{
+	{ as_start, 		as_stop, 		as_configure,	POWER_HOLD_ACCEL },
+	{ ps_start, 		ps_stop, 		NULL,			POWER_HOLD_PRESSURE },
+	{ adc12_ref_on, 	adc12_ref_off, 	NULL,			POWER_HOLD_REF },
+	{ open_radio, 		close_radio, 	NULL,			POWER_HOLD_RADIO },
+};
+
+
+// *************************************************************************************************
+// Extern section
+
+
+// *************************************************************************************************
+// @fn          power_acquire
+// @brief       Register a consumer and switch the domain on if it is off. A domain that is 
+//				lingering after its last release is taken over without power cycling it.
+// @param       u8 domain		POWER_ACCEL, POWER_PRESSURE, POWER_REF, POWER_RADIO
+//				u16 user		POWER_USER_xxx
+// @return      none
+// *************************************************************************************************
+void power_acquire(u8 domain, u16 user)
+{
+	istate_t state;
+	u8 start, change;
+	
+	state = __get_interrupt_state();
+	__disable_interrupt();
+	start = !(sPower.on & POWER_BIT(domain));
+	change = !(sPower.users[domain] & user);
+	sPower.users[domain] |= user;
+	sPower.linger[domain] = 0;
+	sPower.on |= POWER_BIT(domain);
+	__set_interrupt_state(state);
+	
+	if (start) 							power_domain[domain].start();
+	else if (change && power_domain[domain].change) 	power_domain[domain].change();
+}
+
+
+// *************************************************************************************************
+// @fn          power_release
+// @brief       Unregister a consumer. When the last consumer is gone, the domain is switched off
+//				now or after its hysteresis time. Releasing a domain that was not acquired by the
+//				consumer does nothing.
+// @param       u8 domain		POWER_ACCEL, POWER_PRESSURE, POWER_REF, POWER_RADIO
+//				u16 user		POWER_USER_xxx
+// @return      none
+// *************************************************************************************************
+void power_release(u8 domain, u16 user)
+{
+	istate_t state;
+	u8 stop = 0, change = 0;
+	
+	state = __get_interrupt_state();
+	__disable_interrupt();
+	if (sPower.users[domain] & user)
+	{
+		sPower.users[domain] &= ~user;
+		change = (sPower.users[domain] != 0);
+		if (sPower.users[domain] == 0)
+		{
+			if (power_domain[domain].hold == 0)
+			{
+				sPower.on &= ~POWER_BIT(domain);
+				stop = 1;
+			}
+			else
+			{
+				sPower.linger[domain] = power_domain[domain].hold;
+			}
+		}
+	}
+	__set_interrupt_state(state);
+	
+	if (stop) 							power_domain[domain].stop();
+	else if (change && power_domain[domain].change) 	power_domain[domain].change();
+}
+
+
+// *************************************************************************************************
+// @fn          power_is_on
+// @brief       Check if a domain is powered (used or lingering).
+// @param       u8 domain		POWER_ACCEL, POWER_PRESSURE, POWER_REF, POWER_RADIO
+// @return      u8				1 = domain is on
+// *************************************************************************************************
+u8 power_is_on(u8 domain)
+{
+	return ((sPower.on & POWER_BIT(domain)) != 0);
+}
+
+
+// *************************************************************************************************
+// @fn          power_tick
+// @brief       Count down hysteresis of released domains. Called once per second from timer ISR.
+//				Switching off is done by power_service outside ISR context.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void power_tick(void)
+{
+	u8 i;
+	
+	for (i=0; i<POWER_DOMAINS; i++)
+	{
+		if (sPower.linger[i] != 0)
+		{
+			if (--sPower.linger[i] == 0) request.flag.power_service = 1;
+		}
+	}
+}
+
+
+// *************************************************************************************************
+// @fn          power_stop_idle
+// @brief       Switch off a domain if it has no consumer and its hysteresis is over.
+// @param       u8 domain		POWER_ACCEL, POWER_PRESSURE, POWER_REF, POWER_RADIO
+// @return      none
+// *************************************************************************************************
+void power_stop_idle(u8 domain)
+{
+	istate_t state;
+	u8 stop;
+	
+	state = __get_interrupt_state();
+	__disable_interrupt();
+	stop = (sPower.on & POWER_BIT(domain)) && (sPower.users[domain] == 0) && (sPower.linger[domain] == 0);
+	if (stop) sPower.on &= ~POWER_BIT(domain);
+	__set_interrupt_state(state);
+	
+	if (stop) power_domain[domain].stop();
+}
+
+
+// *************************************************************************************************
+// @fn          power_service
+// @brief       Switch off domains whose hysteresis has elapsed.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void power_service(void)
+{
+	u8 i;
+	
+	for (i=0; i<POWER_DOMAINS; i++) power_stop_idle(i);
+}
+
+
+// *************************************************************************************************
+// @fn          power_idle
+// @brief       Switch off all domains without consumer now, ignoring the hysteresis. Used before 
+//				modes that freeze the 1Hz system tick.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void power_idle(void)
+{
+	u8 i;
+	
+	for (i=0; i<POWER_DOMAINS; i++)
+	{
+		if (sPower.users[i] == 0) sPower.linger[i] = 0;
+		power_stop_idle(i);
+	}
+}
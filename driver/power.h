@@ -0,0 +1,103 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// *************************************************************************************************
+
+#ifndef POWER_H_
+#define POWER_H_
+
+// *************************************************************************************************
+// Include section
+
+
+// *************************************************************************************************
+// Prototypes section
+extern void power_acquire(u8 domain, u16 user);
+extern void power_release(u8 domain, u16 user);
+extern u8 power_is_on(u8 domain);
+extern void power_tick(void);
+extern void power_service(void);
+extern void power_idle(void);
+
+
+// *************************************************************************************************
+// Defines section
+
+// Power domains
+#define POWER_ACCEL				(0u)		// Acceleration sensor and its SPI interface
+#define POWER_PRESSURE			(1u)		// Pressure sensor sampling
+#define POWER_REF				(2u)		// Shared voltage reference for ADC12
+#define POWER_RADIO				(3u)		// RF1A radio core
+#define POWER_DOMAINS			(4u)
+
+// Power-down hysteresis in seconds (0 = switch off on last release)
+#define POWER_HOLD_ACCEL		(2u)
+#define POWER_HOLD_PRESSURE		(2u)
+#define POWER_HOLD_REF			(0u)
+#define POWER_HOLD_RADIO		(0u)
+
+// Consumers. Acquire/release are idempotent per consumer, a domain is on while any bit is set.
+#define POWER_USER_ACCELERATION	(BIT0)
+#define POWER_USER_ALTITUDE		(BIT1)
+#define POWER_USER_SIMPLICITI	(BIT2)
+#define POWER_USER_BLUEROBIN	(BIT3)
+#define POWER_USER_SEQUENCE		(BIT4)
+#define POWER_USER_TEST			(BIT5)
+#define POWER_USER_ADC12		(BIT6)
+#define POWER_USER_PEDOMETER	(BIT7)
+#define POWER_USER_PHASE_CLOCK	(BIT8)
+#define POWER_USER_GESTURE		(BIT9)
+#define POWER_USER_IMPACT		(BITA)
+
+
+// *************************************************************************************************
+// Global Variable section
+struct power
+{
+	// Consumers per domain
+	u16		users[POWER_DOMAINS];
+	
+	// Seconds until a released domain is switched off
+	u8		linger[POWER_DOMAINS];
+	
+	// Domain is powered (bit per domain)
+	u8		on;
+};
+extern struct power sPower;
+
+
+// *************************************************************************************************
+// Extern section
+
+
+#endif /*POWER_H_*/
@@ -0,0 +1,230 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// *************************************************************************************************
+// *************************************************************************************************
+// Energy accounting. Counts LPM3 exits and CPU active time per wakeup source and radio airtime,
+// so the average current of a firmware build can be estimated on the watch.
+// *************************************************************************************************
+
+
+// *************************************************************************************************
+// Include section
+
+// system
+#include "project.h"
+
+#ifdef CONFIG_PROFILE
+
+// driver
+#include "profile.h"
+#include "power.h"
+
+
+// *************************************************************************************************
+// Prototypes section
+u16 profile_now(void);
+
+
+// *************************************************************************************************
+// Defines section
+
+
+// *************************************************************************************************
+// Global Variable section
+struct profile sProfile;
+
+// Source the CPU is currently awake for, PROFILE_ASLEEP while in LPM3
+static u8 profile_source = PROFILE_ASLEEP;
+
+// TA0R at wakeup
+static u16 profile_start;
+
+// Radio state and TA0R at the last state change
+static u8 profile_radio_state = PROFILE_RADIO_IDLE;
+static u16 profile_radio_start;
+
+
+// *************************************************************************************************
+// Extern section
+
+
+// *************************************************************************************************
+// @fn          profile_now
+// @brief       Read TA0R. The timer runs from ACLK asynchronous to MCLK, so read until two
+//				consecutive values match.
+// @param       none
+// @return      u16		ACLK ticks
+// *************************************************************************************************
+u16 profile_now(void)
+{
+	u16 t;
+	
+	do
+	{
+		t = TA0R;
+	}
+	while (t != TA0R);
+	
+	return (t);
+}
+
+
+// *************************************************************************************************
+// @fn          profile_wakeup
+// @brief       Charge the following active period to a wakeup source. Called at ISR entry, only
+//				the first ISR after LPM3 counts.
+// @param       u8 source		PROFILE_TIMER0_A0, PROFILE_BUTTONS, ...
+// @return      u8				1 = CPU was in LPM3, a new active period was opened
+// *************************************************************************************************
+u8 profile_wakeup(u8 source)
+{
+	if (profile_source != PROFILE_ASLEEP) return (0);
+	
+	profile_start  = profile_now();
+	profile_source = source;
+	sProfile.wakeups[source]++;
+	return (1);
+}
+
+
+// *************************************************************************************************
+// @fn          profile_sleep
+// @brief       Close the active period. Called with interrupts disabled right before entering LPM3,
+//				or at the end of an ISR that opened the period and returns to LPM3 directly.
+//				A wakeup by an ISR without profiling hook is counted, but its time is lost.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void profile_sleep(void)
+{
+	if (profile_source == PROFILE_ASLEEP)
+	{
+		sProfile.wakeups[PROFILE_OTHER]++;
+	}
+	else
+	{
+		sProfile.active[profile_source] += (u16)(profile_now() - profile_start);
+		profile_source = PROFILE_ASLEEP;
+	}
+}
+
+
+// *************************************************************************************************
+// @fn          profile_tick
+// @brief       Count uptime and on-time of the power domains. Called once per second from timer
+//				ISR. Open active and airtime periods are folded in here, so the 16-bit timer cannot 
+//				wrap within one period.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void profile_tick(void)
+{
+	u16 now = profile_now();
+	u8 i;
+	
+	sProfile.seconds++;
+	
+	for (i=0; i<PROFILE_DOMAINS; i++)
+	{
+		if (power_is_on(i)) sProfile.powered[i]++;
+	}
+	
+	if (profile_source != PROFILE_ASLEEP)
+	{
+		sProfile.active[profile_source] += (u16)(now - profile_start);
+		profile_start = now;
+	}
+	if (profile_radio_state != PROFILE_RADIO_IDLE)
+	{
+		sProfile.airtime[profile_radio_state - 1] += (u16)(now - profile_radio_start);
+		profile_radio_start = now;
+	}
+}
+
+
+// *************************************************************************************************
+// @fn          profile_radio
+// @brief       Track radio state changes reported by MRFI and add up RX and TX airtime.
+// @param       u8 state		PROFILE_RADIO_IDLE, PROFILE_RADIO_RX, PROFILE_RADIO_TX
+// @return      none
+// *************************************************************************************************
+void profile_radio(u8 state)
+{
+	istate_t s;
+	u16 now;
+	
+	s = __get_interrupt_state();
+	__disable_interrupt();
+	if (state != profile_radio_state)
+	{
+		now = profile_now();
+		if (profile_radio_state != PROFILE_RADIO_IDLE)
+		{
+			sProfile.airtime[profile_radio_state - 1] += (u16)(now - profile_radio_start);
+		}
+		profile_radio_start = now;
+		profile_radio_state = state;
+	}
+	__set_interrupt_state(s);
+}
+
+
+// *************************************************************************************************
+// @fn          profile_reset
+// @brief       Clear all counters.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void profile_reset(void)
+{
+	istate_t s;
+	u8 i;
+	
+	s = __get_interrupt_state();
+	__disable_interrupt();
+	for (i=0; i<PROFILE_SOURCES; i++)
+	{
+		sProfile.wakeups[i] = 0;
+		sProfile.active[i] = 0;
+	}
+	sProfile.airtime[0] = 0;
+	sProfile.airtime[1] = 0;
+	for (i=0; i<PROFILE_DOMAINS; i++) sProfile.powered[i] = 0;
+	sProfile.seconds = 0;
+	profile_start = profile_now();
+	profile_radio_start = profile_start;
+	__set_interrupt_state(s);
+}
+
+#endif /* CONFIG_PROFILE */
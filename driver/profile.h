@@ -0,0 +1,107 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// *************************************************************************************************
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+// *************************************************************************************************
+// Include section
+
+
+// *************************************************************************************************
+// Prototypes section
+extern u8 profile_wakeup(u8 source);
+extern void profile_sleep(void);
+extern void profile_tick(void);
+extern void profile_radio(u8 state);
+extern void profile_reset(void);
+
+
+// *************************************************************************************************
+// Defines section
+
+// Wakeup sources. CPU time between leaving LPM3 and the next to_lpm() is charged to the source 
+// whose ISR woke the CPU.
+#define PROFILE_TIMER0_A0		(0u)				// 1Hz clock tick
+#define PROFILE_TIMER0_A1		(1u)				// Timer0_A1..A4: delays, stopwatch, 1/20s tasks
+#define PROFILE_BUTTONS			(2u)
+#define PROFILE_ADC12			(3u)
+#define PROFILE_RADIO			(4u)
+#define PROFILE_ACCEL			(5u)				// acceleration sensor interrupt
+#define PROFILE_PRESSURE		(6u)				// pressure sensor data ready
+#define PROFILE_OTHER			(7u)				// interrupt without profiling hook
+#define PROFILE_SOURCES			(8u)
+#define PROFILE_ASLEEP			(0xFFu)
+
+// Radio states reported by MRFI
+#define PROFILE_RADIO_IDLE		(0u)
+#define PROFILE_RADIO_RX		(1u)
+#define PROFILE_RADIO_TX		(2u)
+
+// Power domains POWER_ACCEL .. POWER_RADIO, counted by their on-time
+#define PROFILE_DOMAINS			(4u)
+
+// Sync packet layout: page 0 holds uptime and airtime, each further page holds two sources
+#define PROFILE_SOURCES_PER_PAGE	(2u)
+#define PROFILE_PAGES			(1u + (PROFILE_SOURCES + PROFILE_SOURCES_PER_PAGE - 1) / PROFILE_SOURCES_PER_PAGE)
+
+
+// *************************************************************************************************
+// Global Variable section
+struct profile
+{
+	// Number of LPM3 exits per source
+	u16		wakeups[PROFILE_SOURCES];
+	
+	// CPU active time per source in ACLK ticks (30.5us)
+	u32		active[PROFILE_SOURCES];
+	
+	// Radio airtime in ACLK ticks, index PROFILE_RADIO_RX-1 and PROFILE_RADIO_TX-1
+	u32		airtime[2];
+	
+	// Seconds each power domain was on, index POWER_ACCEL .. POWER_RADIO
+	u32		powered[PROFILE_DOMAINS];
+	
+	// Seconds since the counters were cleared
+	u32		seconds;
+};
+extern struct profile sProfile;
+
+
+// *************************************************************************************************
+// Extern section
+
+
+#endif /*PROFILE_H_*/
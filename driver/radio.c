@@ -41,6 +41,13 @@
 // driver
 #include "rf1a.h"
 #include "timer.h"
+#include "crash.h"
+#ifdef CONFIG_DVFS
+#include "dvfs.h"
+#endif
+#ifdef CONFIG_PROFILE
+#include "profile.h"
+#endif
 
 // logic
 #include "rfsimpliciti.h"
@@ -48,6 +55,17 @@
 #ifndef ELIMINATE_BLUEROBIN
 #include "bluerobin.h"
 #endif
+#ifdef CONFIG_SETTINGS
+#include "settings.h"
+#endif
+
+
+// *************************************************************************************************
+// Global Variable section
+#ifdef CONFIG_DVFS
+// 1 = radio holds the fast operating point (open_radio may be called repeatedly)
+static u8 radio_dvfs;
+#endif
 
 
 // *************************************************************************************************
@@ -129,6 +147,24 @@ void radio_sxoff(void)
 // *************************************************************************************************
 void open_radio(void)
 {
+#ifdef CONFIG_CRASH_LOG
+	crash_trace(CRASH_TRACE_RADIO | 1);
+#endif
+
+#ifdef CONFIG_SETTINGS
+	// Write back pending settings while the radio is still off
+	settings_flush();
+#endif
+
+#ifdef CONFIG_DVFS
+	// Radio core and SimpliciTI timing need VCore 3 and full MCLK
+	if (!radio_dvfs)
+	{
+		dvfs_acquire();
+		radio_dvfs = 1;
+	}
+#endif
+
 	// Reset radio core
 	radio_reset();
 
@@ -148,6 +184,10 @@ void open_radio(void)
 // *************************************************************************************************
 void close_radio(void)
 {
+#ifdef CONFIG_CRASH_LOG
+	crash_trace(CRASH_TRACE_RADIO | 0);
+#endif
+
 	// Disable radio IRQ
 	RF1AIFG = 0;
 	RF1AIE  = 0; 
@@ -157,6 +197,19 @@ void close_radio(void)
 	
 	// Put radio to sleep
 	radio_powerdown();
+
+#ifdef CONFIG_PROFILE
+	// Stop airtime count if the stack did not idle the radio before
+	profile_radio(PROFILE_RADIO_IDLE);
+#endif
+
+#ifdef CONFIG_DVFS
+	if (radio_dvfs)
+	{
+		radio_dvfs = 0;
+		dvfs_release();
+	}
+#endif
 }
 
 
@@ -179,10 +232,18 @@ __interrupt void radio_ISR(void)
 {
 	u8 rf1aivec = RF1AIV;
 	
+	CRASH_ISR(CRASH_ISR_RADIO);
+
 	// Forward to SimpliciTI interrupt service routine
 	if (is_rf())
 	{
+#ifdef CONFIG_PROFILE
+		profile_wakeup(PROFILE_RADIO);
+#endif
 		MRFI_RadioIsr();
+		
+		// Wake up MRFI delays sleeping in LPM3 so they can check for an early exit
+		_BIC_SR_IRQ(LPM3_bits);
 	}
 	else // BlueRobin packet end interrupt service routine
 	{		
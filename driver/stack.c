@@ -0,0 +1,101 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// *************************************************************************************************
+// *************************************************************************************************
+// Stack painting. The RAM between the end of the static variables and the stack pointer is filled 
+// with a pattern at boot, the untouched part that is left shows the deepest stack use since reset.
+// *************************************************************************************************
+
+
+// *************************************************************************************************
+// Include section
+
+// system
+#include "project.h"
+
+// driver
+#include "stack.h"
+
+
+// *************************************************************************************************
+// Prototypes section
+
+
+// *************************************************************************************************
+// Defines section
+
+
+// *************************************************************************************************
+// Global Variable section
+
+
+// *************************************************************************************************
+// Extern section
+
+// Provided by the linker script: end of static RAM and initial stack pointer
+extern u8 __noinit_end;
+extern u8 __stack;
+
+
+// *************************************************************************************************
+// @fn          stack_paint
+// @brief       Fill free RAM below the stack pointer with STACK_PAINT. Call first thing in main().
+// @param       none
+// @return      none
+// *************************************************************************************************
+void stack_paint(void)
+{
+	u8 * sp;
+	u8 * p;
+	
+	asm volatile("mov r1, %0" : "=r" (sp));
+	
+	for (p = &__noinit_end; p < sp - STACK_PAINT_GUARD; p++) *p = STACK_PAINT;
+}
+
+
+// *************************************************************************************************
+// @fn          stack_high_water
+// @brief       Deepest stack use since reset.
+// @param       none
+// @return      u16		Bytes between initial stack pointer and the lowest overwritten byte
+// *************************************************************************************************
+u16 stack_high_water(void)
+{
+	u8 * p = &__noinit_end;
+	
+	while ((p < &__stack) && (*p == STACK_PAINT)) p++;
+	
+	return (&__stack - p);
+}
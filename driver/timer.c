@@ -51,6 +51,11 @@
 #include "vti_as.h"
 #endif
 #include "display.h"
+#include "power.h"
+#include "crash.h"
+#ifdef CONFIG_PROFILE
+#include "profile.h"
+#endif
 
 // logic
 #include "clock.h"
@@ -94,6 +99,18 @@
 #include "strength.h"
 #endif
 
+#ifdef CONFIG_PHASE_CLOCK
+#include "phase_clock.h"
+#endif
+
+#ifdef CONFIG_WEATHER
+#include "weather.h"
+#endif
+
+#ifdef CONFIG_SETTINGS
+#include "settings.h"
+#endif
+
 // *************************************************************************************************
 // Prototypes section
 void Timer0_Init(void);
@@ -103,6 +120,7 @@ void Timer0_A1_Stop(void);
 void Timer0_A3_Start(u16 ticks);
 void Timer0_A3_Stop(void);
 void Timer0_A4_Delay(u16 ticks);
+void Timer0_A4_Sleep(u16 ticks, volatile u8 * abort);
 void (*fptr_Timer0_A3_function)(void);
 #ifdef CONFIG_USE_GPS
 void (*fptr_Timer0_A1_function)(void);
@@ -303,6 +321,55 @@ void Timer0_A4_Delay(u16 ticks)
 }
 
 
+// *************************************************************************************************
+// @fn          Timer0_A4_Sleep
+// @brief       Wait in LPM3 for some ticks without the display and hardware watchdog service of 
+//				Timer0_A4_Delay. Used by the SimpliciTI delays (BSP_Sleep), TA1 is the buzzer timer.
+//				Each sleep counts as idle for the crash log watchdog, as in to_lpm().
+//				The deadline is checked against TA0R after every wakeup, so a Timer0_A4_Delay in 
+//				an ISR that took over CCR4 meanwhile only costs an extra wakeup.
+// @param       ticks (1 tick = 1/32768 sec), may end up to one tick early
+//				abort	Optional early-out flag set from ISR context, may be NULL
+// @return      none
+// *************************************************************************************************
+void Timer0_A4_Sleep(u16 ticks, volatile u8 * abort)
+{
+	u16 start = TA0R;
+
+	// Exit immediately if Timer0 not running - otherwise we'll get stuck here
+	if ((TA0CTL & (BIT4 | BIT5)) == 0) return;    
+
+	while (1)
+	{
+		// Test the stop conditions with interrupts disabled, GIE and LPM3 are set in one instruction
+		__disable_interrupt();
+
+		// Stop one tick early, so the compare value below is always at least 2 ticks ahead
+		if ((u16)(TA0R - start) + 1 >= ticks) break;
+		if (abort && *abort) break;
+
+		// (Re)load CCR, the timer IRQ handler disables it after each compare
+		TA0CCR4   = start + ticks;
+		TA0CCTL4 &= ~CCIFG; 
+		TA0CCTL4 |= CCIE; 
+
+#ifdef CONFIG_CRASH_LOG
+		// A radio loop waiting for the access point is not stuck
+		crash_kick();
+#endif
+#ifdef CONFIG_PROFILE
+		profile_sleep();
+#endif
+		_BIS_SR(LPM3_bits + GIE); 
+		__no_operation();
+	}
+
+	// Disable timer interrupt    
+	TA0CCTL4 &= ~CCIE; 
+	__enable_interrupt();
+}
+
+
 
 // *************************************************************************************************
 // @fn          TIMER0_A0_ISR
@@ -327,6 +394,11 @@ __interrupt void TIMER0_A0_ISR(void)
 	static u8 button_lock_counter = 0;
 	static u8 button_beep_counter = 0;
 	
+#ifdef CONFIG_PROFILE
+	profile_wakeup(PROFILE_TIMER0_A0);
+#endif
+	CRASH_ISR(CRASH_ISR_TIMER0_A0);
+
 	// Disable IE 
 	TA0CCTL0 &= ~CCIE;
 	// Reset IRQ flag  
@@ -339,6 +411,11 @@ __interrupt void TIMER0_A0_ISR(void)
 	// Add 1 second to global time
 	clock_tick();
 	
+#ifdef CONFIG_PROFILE
+	// Count uptime, also while the system state is frozen
+	profile_tick();
+#endif
+
 	// Set clock update flag
 	display.flag.update_time = 1;
 	
@@ -457,6 +534,29 @@ __interrupt void TIMER0_A0_ISR(void)
 	}            
 #endif
 
+#ifdef CONFIG_SETTINGS
+	// Count down settings write back delay
+	settings_tick();
+#endif
+
+#ifdef CONFIG_PHASE_CLOCK
+	// Collect motion of the current sleep epoch
+	if (sPhase.state == PHASE_RECORDING) phase_clock_tick();
+#endif
+
+#ifdef CONFIG_WEATHER
+	// Count down to the next pressure sample of the weather trend
+	weather_tick();
+#endif
+
+#ifdef CONFIG_CRASH_LOG
+	// Software watchdog pre-timeout
+	crash_tick();
+#endif
+
+	// Count down power-down hysteresis of released peripherals
+	power_tick();
+
 	// Do a temperature measurement each second while menu item is active
 	if (is_temp_measurement()) request.flag.temperature_measurement = 1;
 	
@@ -490,11 +590,12 @@ __interrupt void TIMER0_A0_ISR(void)
 		// Countdown acceleration measurement timeout 
 		sAccel.timeout--;
 
-		// Stop measurement when timeout has elapsed
-		if (sAccel.timeout == 0) as_stop();	
+		// Stop measurement when timeout has elapsed. Releasing the sensor can reconfigure it for 
+		// the remaining consumers, which is done in the main loop.
+		if (sAccel.timeout == 0) request.flag.acceleration_service = 1;
 		
-		// If DRDY is (still) high, request data again
-		if ((AS_INT_IN & AS_INT_PIN) == AS_INT_PIN) request.flag.acceleration_measurement = 1; 
+		// If DRDY is (still) high, request data again. Not a motion interrupt while the wrist is still.
+		if (((AS_INT_IN & AS_INT_PIN) == AS_INT_PIN) && !AS_IN_IDLE_MODE) request.flag.acceleration_measurement = 1; 
 	}	
 #endif
 
@@ -567,6 +668,9 @@ __interrupt void TIMER0_A0_ISR(void)
 		{
 			// Toggle no_beep buttons flag
 			sys.flag.no_beep = ~sys.flag.no_beep;
+#ifdef CONFIG_SETTINGS
+			settings_changed();
+#endif
 	
 			// Show "beep / nobeep" message synchronously with next second tick
 			message.flag.prepare = 1;
@@ -582,6 +686,9 @@ __interrupt void TIMER0_A0_ISR(void)
 		{
 			// Toggle lock / unlock buttons flag
 			sys.flag.lock_buttons = ~sys.flag.lock_buttons;
+#ifdef CONFIG_SETTINGS
+			settings_changed();
+#endif
 	
 			// Show "buttons are locked/unlocked" message synchronously with next second tick
 			message.flag.prepare = 1;
@@ -657,6 +764,11 @@ __interrupt void TIMER0_A1_5_ISR(void)
 {
 	u16 value;
 		
+#ifdef CONFIG_PROFILE
+	profile_wakeup(PROFILE_TIMER0_A1);
+#endif
+	CRASH_ISR(CRASH_ISR_TIMER0_A1);
+
 	switch (TA0IV)
 	{
 	//pfs
@@ -50,6 +50,7 @@ extern void Timer0_A1_Stop(void);
 extern void Timer0_A3_Start(u16 ticks);
 extern void Timer0_A3_Stop(void);
 extern void Timer0_A4_Delay(u16 ticks);
+extern void Timer0_A4_Sleep(u16 ticks, volatile u8 * abort);
 extern void (*fptr_Timer0_A3_function)(void);
 #ifdef CONFIG_USE_GPS
 extern void (*fptr_Timer0_A1_function)(void);
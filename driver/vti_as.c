@@ -42,6 +42,7 @@
 // system
 #include "project.h"
 #include "vti_as.h"
+#include "power.h"
 
 #ifndef FEATURE_PROVIDE_ACCEL
 void as_disconnect(void)
@@ -85,14 +86,28 @@ u8 as_get_z(void);
 // Speed in Hz = 12MHz / AS_BR_DIVIDER (max. 500kHz)
 #define AS_BR_DIVIDER        (30u)
 
-// Acceleration measurement range in g
-// Valid ranges are: 2 and 8
-#define AS_RANGE             (2u)
+// Consumers that are served in the port ISR while they are alone, in motion or free fall detection
+// mode or at 8g/40Hz when one of them asked for samples with as_idle_sampling. Any other consumer reads data
+// in the main loop and gets the rate it asked for with as_request_rate.
+#define AS_IDLE_USERS		(POWER_USER_PEDOMETER | POWER_USER_PHASE_CLOCK | POWER_USER_GESTURE | POWER_USER_IMPACT)
 
-// Sample rate for acceleration values in Hz
-// Valid sample rates for 2g range are:     100, 400
-// Valid sample rates for 8g range are: 40, 100, 400
-#define AS_SAMPLE_RATE       (400u)
+// Idle consumers that need motion interrupts, nobody gets samples while one of them is registered
+#define AS_MOTION_USERS		(POWER_USER_PHASE_CLOCK)
+
+// Idle consumer that samples at 8g/400Hz, and waits in free fall detection while it is alone
+#define AS_FAST_IDLE_USERS	(POWER_USER_IMPACT)
+
+// Lowest motion detection threshold, any wrist movement wakes the sensor
+#define AS_MOTION_THRESHOLD	(0x01u)
+
+// Free fall below 6 * 71mg for 15 * 10ms
+#define AS_FREEFALL_THRESHOLD	(0x06u)
+#define AS_FREEFALL_TIME		(0x0Fu)
+
+// Motion tracker for AS_RATE_ADAPTIVE: the wrist is still when no axis changed by more than
+// AS_STILL_COUNTS (18mg each) for AS_STILL_SAMPLES samples at 100Hz
+#define AS_STILL_COUNTS		(4)
+#define AS_STILL_SAMPLES	(500u)
 
 
 // *************************************************************************************************
@@ -101,6 +116,21 @@ u8 as_get_z(void);
 // Global flag for proper acceleration sensor operation
 u8 as_ok;
 
+// CTRL register content, 0 while the sensor is not configured
+u8 as_mode;
+
+// AS_IDLE_USERS that want samples
+static u16 as_sampling_users;
+
+// Consumers that asked for AS_RATE_400HZ and AS_RATE_ADAPTIVE
+static u16 as_fast_users;
+static u16 as_adaptive_users;
+
+// Motion tracker: reference sample, samples within AS_STILL_COUNTS of it, 1 = wrist is still
+static u8 as_still_xyz[3];
+static u16 as_still_samples;
+static u8 as_still;
+
 
 // *************************************************************************************************
 // Extern section
@@ -150,7 +180,6 @@ void as_init(void)
 void as_start(void)
 {
 	volatile u16 Counter_u16;
-	u8 bConfig;//, bStatus;
 	
 	// Initialize SPI interface to acceleration sensor
 	AS_SPI_CTL0 |= UCSYNC | UCMST | UCMSB // SPI master, 8 data bits,  MSB first,
@@ -180,31 +209,6 @@ void as_start(void)
 	AS_INT_IFG &= ~AS_INT_PIN;            // Reset flag
 	AS_INT_IE  |=  AS_INT_PIN;            // Enable interrupt
 	
-	// Configure sensor and start to sample data
-#if (AS_RANGE == 2)
-  bConfig = 0x80;
-  #if (AS_SAMPLE_RATE == 100)
-    bConfig |= 0x02;
-  #elif (AS_SAMPLE_RATE == 400)
-    bConfig |= 0x04;
-  #else
-    #error "Sample rate not supported"
-  #endif
-#elif (AS_RANGE == 8)
-  bConfig = 0x00;
-  #if (AS_SAMPLE_RATE == 40)
-    bConfig |= 0x06;
-  #elif (AS_SAMPLE_RATE == 100)
-    bConfig |= 0x02;
-  #elif (AS_SAMPLE_RATE == 400)
-    bConfig |= 0x04;
-  #else
-    #error "Sample rate not supported"
-  #endif
-#else
-  #error "Measurement range not supported"    
-#endif  
-
 	// Reset sensor
 	as_write_register(0x04, 0x02);   
 	as_write_register(0x04, 0x0A);   
@@ -213,8 +217,11 @@ void as_start(void)
 	// Wait 5 ms before starting sensor output
 	Timer0_A4_Delay(CONV_MS_TO_TICKS(5));
 	
-	// Set 2g measurement range, start to output data with 100Hz rate
-	as_write_register(0x02, bConfig);   
+	// Set measurement range and start to output data
+	as_mode = 0;
+	as_still = 0;
+	as_still_samples = 0;
+	as_configure();
 }
 
 
@@ -229,6 +236,7 @@ void as_stop(void)
 {
 	// Disable interrupt 
 	AS_INT_IE  &=  ~AS_INT_PIN;            	// Disable interrupt
+	as_mode = 0;
 
 #ifdef AS_DISCONNECT
 	// Power-down sensor
@@ -249,6 +257,125 @@ void as_stop(void)
 }
 
 
+// *************************************************************************************************
+// @fn          as_configure
+// @brief       Select the sensor mode for the registered consumers. Consumers that only need 
+//				low rate data (AS_IDLE_USERS) get motion detection or 8g/40Hz while they are alone.
+//				Otherwise the fastest rate requested with as_request_rate wins, adaptive consumers
+//				alone drop to motion detection while the wrist is still. With a low battery the 
+//				400Hz modes fall back to 100Hz and 40Hz. Called on power-up, whenever the consumers
+//				of POWER_ACCEL or the battery state change and by the motion tracker. Main loop only,
+//				changes made in ISR context are applied with request.flag.acceleration_service.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void as_configure(void)
+{
+	istate_t state;
+	u16 users = sPower.users[POWER_ACCEL] & ~AS_IDLE_USERS;
+	u16 idle = sPower.users[POWER_ACCEL] & AS_IDLE_USERS;
+	u8 bConfig;
+	
+	if (users == 0)
+	{
+		if (idle & AS_MOTION_USERS)									bConfig = AS_MODE_MOTION;
+		else if (idle & as_sampling_users & AS_FAST_IDLE_USERS)		bConfig = AS_MODE_8G_400HZ;
+		else if (idle & as_sampling_users)							bConfig = AS_MODE_8G_40HZ;
+		else if (idle == AS_FAST_IDLE_USERS)						bConfig = AS_MODE_FREEFALL;
+		else														bConfig = AS_MODE_MOTION;
+	}
+	else if (users & as_fast_users)					bConfig = AS_MODE_2G_400HZ;
+	else if ((users & ~as_adaptive_users) || !as_still)	bConfig = AS_MODE_2G_100HZ;
+	else											bConfig = AS_MODE_MOTION;
+	
+	// Battery at its end, no 400Hz modes
+	if (sys.flag.low_battery)
+	{
+		if (bConfig == AS_MODE_2G_400HZ) 		bConfig = AS_MODE_2G_100HZ;
+		else if (bConfig == AS_MODE_8G_400HZ) 	bConfig = AS_MODE_8G_40HZ;
+	}
+
+	// Exit if sensor is not powered up or already configured
+	if (((AS_PWR_OUT & AS_PWR_PIN) != AS_PWR_PIN) || (bConfig == as_mode)) return;
+	
+	// Idle mode data is read out in the port ISR, keep it off the bus 
+	state = __get_interrupt_state();
+	__disable_interrupt();
+	
+	if (bConfig == AS_MODE_MOTION) as_write_register(0x09, AS_MOTION_THRESHOLD);
+	if (bConfig == AS_MODE_FREEFALL)
+	{
+		as_write_register(0x0A, AS_FREEFALL_TIME << 4);
+		as_write_register(0x0B, AS_FREEFALL_THRESHOLD);
+	}
+	as_write_register(0x02, bConfig);
+	as_mode = bConfig;
+	
+	// Release an INT line still held by the previous mode, so the next event gives an edge
+	as_read_register(0x05);
+	as_read_register(0x08);
+	AS_INT_IFG &= ~AS_INT_PIN;
+	
+	__set_interrupt_state(state);
+}
+
+
+// *************************************************************************************************
+// @fn          as_idle_sampling
+// @brief       Start or stop 8g/40Hz samples for an idle consumer, 8g/400Hz for AS_FAST_IDLE_USERS.
+//				The sensor waits in motion or free fall detection mode while no idle consumer wants
+//				samples. Can be called from ISR, the mode is changed in the main loop.
+// @param       u16 user		POWER_USER_xxx of AS_IDLE_USERS
+//				u8 on			1 = samples, 0 = motion interrupts
+// @return      none
+// *************************************************************************************************
+void as_idle_sampling(u16 user, u8 on)
+{
+	if (on) as_sampling_users |= user;
+	else	as_sampling_users &= ~user;
+	request.flag.acceleration_service = 1;
+}
+
+
+// *************************************************************************************************
+// @fn          as_request_rate
+// @brief       Declare the data rate a consumer reading data in the main loop needs. Call before
+//				power_acquire, consumers that never call it get AS_RATE_100HZ.
+// @param       u16 user		POWER_USER_xxx
+//				u8 rate			AS_RATE_100HZ, AS_RATE_400HZ, AS_RATE_ADAPTIVE
+// @return      none
+// *************************************************************************************************
+void as_request_rate(u16 user, u8 rate)
+{
+	as_fast_users 		&= ~user;
+	as_adaptive_users 	&= ~user;
+	if (rate == AS_RATE_400HZ) 			as_fast_users |= user;
+	else if (rate == AS_RATE_ADAPTIVE) 	as_adaptive_users |= user;
+	
+	// A new consumer wants data first
+	as_still = 0;
+	as_still_samples = 0;
+	as_configure();
+}
+
+
+// *************************************************************************************************
+// @fn          as_motion_interrupt
+// @brief       Motion interrupt: the wrist is no longer still, the main loop selects the mode 
+//				again. Called from PORT2_ISR.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void as_motion_interrupt(void)
+{
+	as_still = 0;
+	as_still_samples = 0;
+	
+	// Only adaptive consumers leave motion detection on movement, the idle ones switch themselves
+	if (sPower.users[POWER_ACCEL] & as_adaptive_users) request.flag.acceleration_service = 1;
+}
+
+
 // *************************************************************************************************
 // @fn          as_read_register
 // @brief       Read a byte from the acceleration sensor
@@ -360,13 +487,36 @@ u8 as_write_register(u8 bAddress, u8 bData)
 // *************************************************************************************************
 void as_get_data(u8 * data)
 {
-	// Exit if sensor is not powered up
-	if ((AS_PWR_OUT & AS_PWR_PIN) != AS_PWR_PIN) return;
+	u8 i;
+	s8 diff;
+	
+	// Exit if sensor is not powered up, keep the last data while the wrist is still
+	if (((AS_PWR_OUT & AS_PWR_PIN) != AS_PWR_PIN) || (as_mode == AS_MODE_MOTION)) return;
   
   	// Store X/Y/Z acceleration data in buffer
 	*(data+0) = as_read_register(0x06);
 	*(data+1) = as_read_register(0x07);
 	*(data+2) = as_read_register(0x08);
+	
+	// Motion tracker: restart the still period on movement, after it the mode is chosen again
+	for (i=0; i<3; i++)
+	{
+		diff = (s8)(data[i] - as_still_xyz[i]);
+		if ((diff > AS_STILL_COUNTS) || (diff < -AS_STILL_COUNTS)) break;
+	}
+	if (i < 3)
+	{
+		as_still_xyz[0] = data[0];
+		as_still_xyz[1] = data[1];
+		as_still_xyz[2] = data[2];
+		as_still_samples = 0;
+		as_still = 0;
+	}
+	else if ((sPower.users[POWER_ACCEL] & as_adaptive_users) && (++as_still_samples == AS_STILL_SAMPLES))
+	{
+		as_still = 1;
+		as_configure();
+	}
 }
 
 u8 as_get_x(void)
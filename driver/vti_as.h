@@ -54,6 +54,10 @@ extern void as_get_data(u8 * data);
 extern u8 as_get_x(void);
 extern u8 as_get_y(void);
 extern u8 as_get_z(void);
+extern void as_configure(void);
+extern void as_idle_sampling(u16 user, u8 on);
+extern void as_request_rate(u16 user, u8 rate);
+extern void as_motion_interrupt(void);
 #endif
 
 
@@ -106,6 +110,25 @@ extern u8 as_get_z(void);
 // SPI timeout to detect sensor failure
 #define SPI_TIMEOUT				(1000u)
 
+// CTRL register settings for consumers that read data in the main loop
+#define AS_MODE_2G_100HZ		(0x82u)		// 2g range, 100Hz measurement
+#define AS_MODE_2G_400HZ		(0x84u)		// 2g range, 400Hz measurement
+
+// CTRL register settings for consumers that run the sensor in a low power mode
+#define AS_MODE_8G_40HZ			(0x06u)		// 8g range, 40Hz measurement
+#define AS_MODE_8G_400HZ		(0x04u)		// 8g range, 400Hz measurement
+#define AS_MODE_MOTION			(0x08u)		// 8g range, motion detection at 10Hz, INT on motion
+#define AS_MODE_FREEFALL		(0x0Au)		// 8g range, free fall detection at 100Hz, INT on free fall
+
+// Sensor runs in one of these modes, its interrupts are handled in the port ISR
+#define AS_IN_IDLE_MODE			((as_mode == AS_MODE_MOTION) || (as_mode == AS_MODE_8G_40HZ) || \
+								 (as_mode == AS_MODE_8G_400HZ) || (as_mode == AS_MODE_FREEFALL))
+
+// Data rates for as_request_rate. All of them use the 2g range.
+#define AS_RATE_100HZ			(0u)		// Default
+#define AS_RATE_400HZ			(1u)
+#define AS_RATE_ADAPTIVE		(2u)		// 100Hz while the wrist moves, motion detection while still
+
 
 // *************************************************************************************************
 // Global Variable section
@@ -113,6 +136,9 @@ extern u8 as_get_z(void);
 
 // *************************************************************************************************
 // Extern section
+#ifdef FEATURE_PROVIDE_ACCEL
+extern u8 as_mode;
+#endif
 
 
 #endif /*VTI_AS_H_*/
@@ -81,6 +81,11 @@ static s16 hLast; // Last altitude estimate in normalized units b/H0/2^15
 // Global flag for proper pressure sensor operation
 u8 ps_ok;
 
+#ifdef CONFIG_WEATHER
+// Difference of sea level and measured pressure at the last reference altitude (Pa)
+static s32 ps_reduction;
+#endif
+
 
 // *************************************************************************************************
 // Extern section
@@ -140,6 +145,20 @@ void ps_start(void)
 
 
 
+// *************************************************************************************************
+// @fn          ps_trigger
+// @brief       Start one conversion, the sensor returns to standby after DRDY
+// @param       none
+// @return      none
+// *************************************************************************************************
+void ps_trigger(void)
+{
+	// Single conversion in low power triggered mode
+	ps_write_register(0x03, 0x0C);
+}
+
+
+
 // *************************************************************************************************
 // @fn          ps_stop
 // @brief       Power down pressure sensor
@@ -463,6 +482,9 @@ void init_pressure_table(void)
 	pRef = 101325/4; // Reference pressure at sea level in 4Pa units
 	hLast = 0;
 #endif
+#ifdef CONFIG_WEATHER
+	ps_reduction = 0;
+#endif
 }
 
 #ifdef FIXEDPOINT
@@ -582,8 +604,30 @@ void update_pressure_table(s16 href, u32 p_meas, u16 t_meas)
 	// The term + f) is for proper rounding.
 	// The <<16 and >>1 operations correct for the 15bit scale of f.
 #endif
+#ifdef CONFIG_WEATHER
+	// Sea level reduction of the weather trend, holds as long as the altitude does not change
+#ifndef FIXEDPOINT
+	ps_reduction = (s32)(p[1] * 100) - (s32)p_meas;
+#else
+	ps_reduction = ((s32)pRef - pLast) * 4;
+#endif
+#endif
 }
 
+#ifdef CONFIG_WEATHER
+// *************************************************************************************************
+// @fn          ps_get_reduction
+// @brief       Pressure to add to a measurement for sea level pressure, from the last reference
+//				altitude given to update_pressure_table(). 0 before the first reference.
+// @param       none
+// @return      s32		Pa
+// *************************************************************************************************
+s32 ps_get_reduction(void)
+{
+	return (ps_reduction);
+}
+#endif
+
 #ifndef FIXEDPOINT
 // *************************************************************************************************
 // @fn          conv_pa_to_meter
@@ -45,11 +45,15 @@
 extern void ps_init(void);
 extern void ps_start(void);
 extern void ps_stop(void);
+extern void ps_trigger(void);
 extern u32 ps_get_pa(void);
 extern u16 ps_get_temp(void);
 
 extern void init_pressure_table(void);
 extern void update_pressure_table(s16 href, u32 p_meas, u16 t_meas);
+#ifdef CONFIG_WEATHER
+extern s32 ps_get_reduction(void);
+#endif
 #ifndef FIXEDPOINT
 extern s16 conv_pa_to_meter(u32 p_meas, u16 t_meas);
 #else
@@ -52,7 +52,16 @@
 #include "ports.h"
 #include "timer.h"
 #include "pmm.h"
+#ifdef CONFIG_DVFS
+#include "dvfs.h"
+#endif
 #include "rf1a.h"
+#include "power.h"
+#include "stack.h"
+#include "crash.h"
+#ifdef CONFIG_PROFILE
+#include "profile.h"
+#endif
 
 // logic
 #include "menu.h"
@@ -87,9 +96,33 @@
 #ifdef CONFIG_INFOMEM
 #include "infomem.h"
 #endif
+#ifdef CONFIG_SETTINGS
+#include "settings.h"
+#endif
 #ifdef CONFIG_STRENGTH
 #include "strength.h"
 #endif
+#ifdef CONFIG_PEDOMETER
+#include "pedometer.h"
+#endif
+#ifdef CONFIG_GESTURE
+#include "gesture.h"
+#endif
+#ifdef CONFIG_IMPACT
+#include "impact.h"
+#endif
+#ifdef CONFIG_WEATHER
+#include "weather.h"
+#endif
+#ifdef CONFIG_ALTI_TRACK
+#include "track.h"
+#endif
+#ifdef CONFIG_HISTORY
+#include "history.h"
+#endif
+#ifdef CONFIG_GAUGE
+#include "gauge.h"
+#endif
 
 #include "mrfi.h"
 #include "nwk_types.h"
@@ -157,6 +190,9 @@ static const addr_t   sMyROMAddress = {THIS_DEVICE_ADDRESS};
 // *************************************************************************************************
 int main(void)
 {
+	// Fill free RAM to measure stack use
+	stack_paint();
+
 	// Init MCU 
 	init_application();
 
@@ -248,6 +284,11 @@ void init_application(void)
 		SFRIFG1 &= ~OFIFG;                      // Clear fault flags
 	} while ((SFRIFG1 & OFIFG));	
 
+#ifdef CONFIG_DVFS
+	// Run at low VCore and 3MHz MCLK unless a module needs more
+	dvfs_init();
+#endif
+
 	
 	// ---------------------------------------------------------------------
 	// Configure port mapping
@@ -361,12 +402,18 @@ void init_global_variables(void)
 	
 	
 	#ifdef CONFIG_INFOMEM
-	if(infomem_ready()==-2)
+	//no or damaged data structure: start with empty memory
+	if(infomem_ready()<0)
 	{
 		infomem_init(INFOMEM_C, INFOMEM_C+2*INFOMEM_SEGMENT_SIZE);
 	}
 	#endif
 	
+#ifdef CONFIG_CRASH_LOG
+	// Store record of the previous run if it ended in a crash
+	crash_restore();
+#endif
+	
 	// Set system time to default value
 	reset_clock();
 	
@@ -390,15 +437,40 @@ void init_global_variables(void)
 	reset_stopwatch();
 #endif
 	
-	// Reset altitude measurement
-#ifdef CONFIG_ALTITUDE
-	reset_altitude_measurement();
-#endif
-	
 	#ifdef FEATURE_PROVIDE_ACCEL
 	// Reset acceleration measurement
 	reset_acceleration();
 	#endif
+
+#ifdef CONFIG_PEDOMETER
+	// Start step counter
+	reset_pedometer();
+#endif
+
+#ifdef CONFIG_GESTURE
+	// Start gesture recognizer
+	reset_gesture();
+#endif
+
+#ifdef CONFIG_IMPACT
+	// Start fall and shock logger
+	reset_impact();
+#endif
+
+#ifdef CONFIG_WEATHER
+	// Start pressure history
+	reset_weather();
+#endif
+
+#ifdef CONFIG_ALTI_TRACK
+	// Statistics of the logged track
+	reset_track();
+#endif
+
+#ifdef CONFIG_HISTORY
+	// Find the day log
+	reset_history();
+#endif
 	
 	// Reset BlueRobin stack
 	//pfs
@@ -415,8 +487,8 @@ void init_global_variables(void)
 #endif
 
 #ifdef CONFIG_PHASE_CLOCK
-	// default program
-	sPhase.program = 0;
+	// Reset sleep phase recorder
+	reset_phase_clock();
 #endif
 
 	// Reset SimpliciTI stack
@@ -425,9 +497,22 @@ void init_global_variables(void)
 	// Reset temperature measurement 
 	reset_temp_measurement();
 
+#ifdef CONFIG_SETTINGS
+	// Overwrite defaults with stored user settings
+	settings_restore();
+#endif
+
+	// Reset altitude measurement (applies restored altitude offset)
+#ifdef CONFIG_ALTITUDE
+	reset_altitude_measurement();
+#endif
+
 	#ifdef CONFIG_BATTERY
 	// Reset battery measurement
 	reset_batt_measurement();
+	#ifdef CONFIG_GAUGE
+	reset_gauge();
+	#endif
 	battery_measurement();
 	#endif
 }
@@ -441,9 +526,18 @@ void init_global_variables(void)
 // *************************************************************************************************
 void wakeup_event(void)
 {
+#ifdef CONFIG_CRASH_LOG
+	crash_trace(CRASH_TRACE_WAKEUP | (button.all_flags & CRASH_TRACE_MASK));
+#endif
+
 	// Enable idle timeout
 	sys.flag.idle_timeout_enabled = 1;
 
+#ifdef CONFIG_SETTINGS
+	// Any accepted button event may change a setting
+	if (button.all_flags && !sys.flag.lock_buttons) settings_changed();
+#endif
+
 	// If buttons are locked, only display "buttons are locked" message
 	if (button.all_flags && sys.flag.lock_buttons)
 	{
@@ -567,6 +661,10 @@ void wakeup_event(void)
 // *************************************************************************************************
 void process_requests(void)
 {
+#ifdef CONFIG_CRASH_LOG
+	crash_trace(CRASH_TRACE_REQUEST | (request.all_flags & CRASH_TRACE_MASK));
+#endif
+
 	// Do temperature measurement
 	if (request.flag.temperature_measurement) temperature_measurement(FILTER_ON);
 	
@@ -577,17 +675,48 @@ void process_requests(void)
 #ifdef CONFIG_ALTI_ACCUMULATOR
 	if (request.flag.altitude_accumulator) altitude_accumulator_periodic();
 #endif
+#ifdef CONFIG_WEATHER
+	if (request.flag.weather) weather_process();
+#endif
 	
 	#ifdef FEATURE_PROVIDE_ACCEL
 	// Do acceleration measurement
 	if (request.flag.acceleration_measurement) do_acceleration_measurement();
+	
+	// Stop a timed out acceleration measurement
+	if (request.flag.acceleration_service && !is_acceleration_measurement()) power_release(POWER_ACCEL, POWER_USER_ACCELERATION);
 	#endif
+
+#ifdef CONFIG_PEDOMETER
+	// Count steps in the last burst of samples
+	if (request.flag.pedometer) pedometer_process();
+#endif
+
+#ifdef CONFIG_GESTURE
+	// Act on a recognized gesture
+	if (request.flag.gesture) gesture_process();
+#endif
+
+#ifdef CONFIG_IMPACT
+	// Log a captured fall or shock
+	if (request.flag.impact) impact_process();
+#endif
+
+#ifdef CONFIG_PHASE_CLOCK
+	// Store sleep epoch, check smart alarm
+	if (request.flag.phase_clock) phase_clock_epoch();
+#endif
 	
 	#ifdef CONFIG_BATTERY
 	// Do voltage measurement
 	if (request.flag.voltage_measurement) battery_measurement();
 	#endif
 	
+#ifdef CONFIG_HISTORY
+	// Add voltage and a temperature sample to the statistics of the day
+	if (request.flag.voltage_measurement) history_minute();
+#endif
+	
 	#ifdef CONFIG_ALARM
 	// Generate alarm (two signals every second)
 	if (request.flag.alarm_buzzer) start_buzzer(2, BUZZER_ON_TICKS, BUZZER_OFF_TICKS);
@@ -609,6 +738,19 @@ void process_requests(void)
 	}
 #endif
 
+#ifdef CONFIG_SETTINGS
+	// Write back cached settings
+	if (request.flag.settings_write) settings_write();
+#endif
+
+#ifdef FEATURE_PROVIDE_ACCEL
+	// Select the acceleration sensor mode after consumer changes made in ISR context or above
+	if (request.flag.acceleration_service && power_is_on(POWER_ACCEL)) as_configure();
+#endif
+
+	// Switch off released peripherals
+	if (request.flag.power_service) power_service();
+
 	// Reset request flag
 	request.all_flags = 0;
 }
@@ -663,6 +805,9 @@ void display_update(void)
 		else if (message.flag.type_lobatt)		memcpy(string, "LOBATT", 6);
 		else if (message.flag.type_no_beep_on)  memcpy(string, " SILNT", 6);
 		else if (message.flag.type_no_beep_off) memcpy(string, "  BEEP", 6);
+		#ifdef CONFIG_WEATHER_ALARM
+		else if (message.flag.type_storm)		memcpy(string, " STORM", 6);
+		#endif
 		#ifdef CONFIG_ALARM 
 		else if (message.flag.type_alarm_off_chime_off)	
 		{
@@ -731,6 +876,17 @@ void display_update(void)
 // *************************************************************************************************
 void to_lpm(void)
 {
+#ifdef CONFIG_CRASH_LOG
+	// CPU reaches idle, main loop is not stuck
+	crash_kick();
+#endif
+
+#ifdef CONFIG_PROFILE
+	// Close active period, interrupts are enabled again together with LPM3
+	__disable_interrupt();
+	profile_sleep();
+#endif
+
 	// Go to LPM3
 	_BIS_SR(LPM3_bits + GIE); 
 	__no_operation();
@@ -870,7 +1026,11 @@ void read_calibration_values(void)
 	u8 * flash_mem;         					// Memory pointer
 	
 	// Read calibration data from Info D memory
+#ifdef EZCHRONOS_HOST
+	flash_mem = INFOD;
+#else
 	flash_mem = (u8 *)0x1800;
+#endif
 	for (i=0; i<CALIBRATION_DATA_LENGTH; i++)
 	{
 		cal_data[i] = *flash_mem++;
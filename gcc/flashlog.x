@@ -0,0 +1,28 @@
+/*
+ * Main memory segments of the data logs (FLASH_SEGMENT in driver/flash.h).
+ *
+ * Added to the default linker script of the device with -T. The logs get their own region at a
+ * fixed address on top of flash, below the segment of the interrupt vectors (0xFE00-0xFFFF), and
+ * not behind the program: there the load data of .data, placed after .text by the default script,
+ * would overlap them. Room for five 512 byte erase segments, ld reports an overflow of the region
+ * when more logs are added. NOLOAD keeps the section out of the image, so programming the watch
+ * leaves the logs erased and the startup code does not touch them.
+ */
+
+MEMORY
+{
+  flashlog (rw) : ORIGIN = 0xF400, LENGTH = 0x0A00
+}
+
+SECTIONS
+{
+  .flashlog (NOLOAD) : ALIGN(512)
+  {
+    *(.flashlog)
+  } > flashlog
+}
+INSERT AFTER .text;
+
+/* The text region of the default script still reaches up to the vectors */
+ASSERT(LOADADDR(.data) + SIZEOF(.data) <= ORIGIN(flashlog),
+       "program and .data load image overlap the flash logs, disable some modules with make config");
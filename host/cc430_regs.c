@@ -0,0 +1,60 @@
+// *************************************************************************************************
+//
+// Peripheral register variables for host builds. See host/include/cc430x613x.h.
+//
+// *************************************************************************************************
+
+#include "cc430x613x.h"
+
+// Special function registers
+volatile uint16_t SFRIFG1;
+
+// Watchdog timer
+volatile uint16_t WDTCTL;
+
+// Digital I/O
+volatile uint8_t P1IN, P1OUT, P1DIR, P1REN, P1SEL, P1IE, P1IES, P1IFG;
+volatile uint8_t P2OUT, P2DIR, P2REN, P2SEL, P2IE, P2IES, P2IFG;
+volatile uint8_t P5DIR, P5SEL;
+volatile uint8_t PJREN;
+#ifndef EZCHRONOS_EMULATOR
+volatile uint8_t P2IN, PJIN, PJOUT, PJDIR;
+#endif
+
+// Flash controller
+volatile uint16_t FCTL1, FCTL3;
+
+// Power management module
+volatile uint8_t PMMCTL0_H, PMMCTL0_L;
+
+// Port mapping controller
+volatile uint16_t PMAPPWD;
+volatile uint8_t PMAPCTL;
+volatile uint8_t P1MAP[8], P2MAP[8];
+
+// Unified clock system
+volatile uint16_t UCSCTL0, UCSCTL1, UCSCTL2, UCSCTL3, UCSCTL4, UCSCTL5, UCSCTL6, UCSCTL7;
+
+// Timer_A
+volatile uint16_t TA0CTL, TA0R, TA0IV;
+volatile uint16_t TA0CCTL0, TA0CCTL1, TA0CCTL2, TA0CCTL3, TA0CCTL4;
+volatile uint16_t TA0CCR0, TA0CCR1, TA0CCR2, TA0CCR3, TA0CCR4;
+volatile uint16_t TA1CTL, TA1R, TA1CCTL0, TA1CCR0;
+
+// Reference and ADC12_A
+volatile uint16_t REFCTL0;
+volatile uint16_t ADC12CTL0, ADC12CTL1, ADC12IE, ADC12IFG, ADC12IV, ADC12MEM0;
+volatile uint8_t ADC12MCTL0;
+
+// LCD_B
+volatile uint16_t LCDBCTL0, LCDBVCTL, LCDBPCTL0, LCDBPCTL1, LCDBMEMCTL, LCDBBLKCTL;
+uint8_t LCDMEM[0x40];
+
+// USCI_A0
+volatile uint8_t UCA0CTL0, UCA0CTL1, UCA0BR0, UCA0BR1, UCA0IFG;
+#ifndef EZCHRONOS_EMULATOR
+volatile uint8_t UCA0RXBUF, UCA0TXBUF;
+#endif
+
+// Information memory segment D
+uint8_t INFOD[128] = { [0 ... 127] = 0xFF };
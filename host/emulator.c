@@ -0,0 +1,1115 @@
+// *************************************************************************************************
+//
+// Host emulator for the complete firmware.
+//
+// Runs the unmodified main loop of ezchronos.c with the logic modules and the display, timer,
+// port and ADC12 drivers against a virtual CC430. The peripheral registers of
+// host/include/cc430x613x.h get just enough behaviour for the firmware to run: Timer0 counts a
+// simulated 32768Hz ACLK while the CPU sleeps, compare events, port 2 edges and ADC12 results
+// call the ISRs, and the LCD memory is decoded back into characters and symbols with the tables
+// of driver/display1.c. Acceleration and pressure sensor are emulated at bus level by
+// host/emulator_drivers.c, so driver/vti_as.c and driver/vti_ps.c run as on target. The radio
+// is not emulated, SimpliciTI modes end without a link.
+//
+// Time runs at real time (a multiple of it with -x) or, with -f, as fast as the host allows.
+// Commands are read from stdin and from a script, results are written to stdout, one line per
+// change:
+//
+//   press <button> [ms]        star num up down backlight, held for 100ms unless given
+//   temp <0.1 degC>            temperature seen by pressure sensor and ADC12
+//   alt <m>                    altitude seen by the pressure sensor
+//   batt <10mV>                battery voltage
+//   accel <x> <y> <z>          acceleration in mg
+//   walk <steps/min>           swing the acceleration with the step frequency, 0 = stop
+//   speed <factor>             time against real time, 0 = as fast as possible
+//   quit
+//
+//   lcd <ms> |<line1>|<line2>|<digits>|<symbols>|<blinking>
+//   buzz <ms> <Hz>             buzzer frequency, 0 = off
+//   light <ms> <0|1>           backlight
+//   cpu <ms> <screen> <wakeups> <cycles> <seconds>     with -p, once per second
+//   rfbsl <ms>                 firmware jumped to the radio updater, run ends
+//
+// <digits> has two hex characters per 7-segment digit, line 1 left to right then line 2, bits
+// 0..6 are segments A..G. Symbols are named as in display.h without prefix. Script lines are
+// "<ms> <command>", '#' starts a comment.
+//
+// The host time spent awake is measured per screen (the pair of menu functions showing line 1
+// and line 2) and scaled to MSP430 cycles with -s as in host/replay.c. The report on stderr
+// lists time, wakeups and CPU load per screen.
+//
+// Usage: emulator [-f] [-x factor] [-t seconds] [-b script] [-s scale] [-p] [-q]
+//
+// *************************************************************************************************
+
+#define _GNU_SOURCE
+
+// *************************************************************************************************
+// Include section
+
+// system
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <setjmp.h>
+#include <time.h>
+#include <dlfcn.h>
+#include <sys/select.h>
+#include "project.h"
+
+// driver
+#include "display.h"
+#include "ports.h"
+
+#include "emulator.h"
+
+
+// *************************************************************************************************
+// Prototypes section
+static void emulator_sleep(void);
+static void emulator_interrupts(void);
+static void emulator_command(const char * line);
+
+
+// *************************************************************************************************
+// Defines section
+
+// Default MSP430 cycles per host nanosecond, see host/replay.c
+#define EMULATOR_SCALE				(25.0)
+
+// P2IN reads without going to sleep before the firmware counts as polling. From then on every
+// read lets one ACLK tick pass.
+#define EMULATOR_POLL_READS			(64u)
+
+// Default button hold time
+#define EMULATOR_PRESS_MS			(100u)
+
+#define EMULATOR_MAX_SCREENS		(64u)
+#define EMULATOR_BUTTONS			(5u)
+#define EMULATOR_DIGITS				(10u)
+
+// Script command
+struct emulator_script
+{
+	u32		ms;
+	char	text[64];
+};
+
+// Time and load per screen
+struct emulator_screen
+{
+	void *		line1;
+	void *		line2;
+	u32			wakeups;
+	uint64_t	ns;
+	uint64_t	ticks;
+};
+
+
+// *************************************************************************************************
+// Global Variable section
+
+uint64_t emulator_now;
+
+// 22.0 degC, 300m, 3.00V, watch lying flat
+struct emulator_sensors sEmulatorSensors = { 300, 220, 300, { 0, 0, 1000 } };
+
+// CPU
+static uint16_t emulator_sr;
+static uint16_t * emulator_irq_sr;			// SR to be restored by the running ISR
+static u32 emulator_poll;
+
+// Peripherals
+static u8 emulator_p2_pins;
+static uint64_t emulator_adc12_done = EMULATOR_NEVER;
+
+// Input
+static const char * const emulator_button_names[EMULATOR_BUTTONS] = { "star", "num", "up", "down", "backlight" };
+static const u8 emulator_button_pins[EMULATOR_BUTTONS] =
+{
+	BUTTON_STAR_PIN, BUTTON_NUM_PIN, BUTTON_UP_PIN, BUTTON_DOWN_PIN, BUTTON_BACKLIGHT_PIN
+};
+static uint64_t emulator_release[EMULATOR_BUTTONS] =
+{
+	EMULATOR_NEVER, EMULATOR_NEVER, EMULATOR_NEVER, EMULATOR_NEVER, EMULATOR_NEVER
+};
+static struct emulator_script * emulator_script;
+static u32 emulator_script_count;
+static u32 emulator_script_next;
+static char emulator_input[512];
+static u32 emulator_input_length;
+static u8 emulator_input_open = 1;
+
+// Pacing
+static double emulator_speed = 1.0;
+static uint64_t emulator_wall_base;
+static uint64_t emulator_sim_base;
+static uint64_t emulator_end = EMULATOR_NEVER;
+static jmp_buf emulator_exit;
+
+// Outputs
+static u8 emulator_lcd_shown[sizeof(LCDMEM) + 2];
+static u8 emulator_lcd_valid;
+static u32 emulator_buzz_hz;
+static u8 emulator_light;
+static u8 emulator_profile;
+static u8 emulator_quiet;
+static double emulator_scale = EMULATOR_SCALE;
+static uint64_t emulator_cpu_next = EMULATOR_NEVER;
+
+// Accounting
+static struct emulator_screen emulator_screens[EMULATOR_MAX_SCREENS];
+static u32 emulator_screen_count;
+static u8 emulator_awake;
+static uint64_t emulator_awake_since;
+
+// LCD symbols in display.h order, 7-segment digits are decoded separately
+static const char * const emulator_symbol_names[] =
+{
+	"AM", "PM", "ARROW_UP", "ARROW_DOWN", "PERCENT", "TOTAL", "AVERAGE", "MAX", "BATTERY",
+	"L1_FT", "L1_K", "L1_M", "L1_I", "L1_PER_S", "L1_PER_H", "L1_DEGREE",
+	"L2_KCAL", "L2_KM", "L2_MI",
+	"HEART", "STOPWATCH", "RECORD", "ALARM", "BEEPER1", "BEEPER2", "BEEPER3",
+	"L1_3", "L1_2", "L1_1", "L1_0", "L1_COL", "L1_DP1", "L1_DP0",
+	"L2_5", "L2_4", "L2_3", "L2_2", "L2_1", "L2_0", "L2_COL1", "L2_COL0", "L2_DP",
+};
+
+static const u8 emulator_digits[EMULATOR_DIGITS] =
+{
+	LCD_SEG_L1_3, LCD_SEG_L1_2, LCD_SEG_L1_1, LCD_SEG_L1_0,
+	LCD_SEG_L2_5, LCD_SEG_L2_4, LCD_SEG_L2_3, LCD_SEG_L2_2, LCD_SEG_L2_1, LCD_SEG_L2_0,
+};
+
+
+// *************************************************************************************************
+// Extern section
+
+// ezchronos.c, built with main renamed
+extern int ezchronos_main(void);
+extern void (*fptr_lcd_function_line1)(u8 line, u8 update);
+extern void (*fptr_lcd_function_line2)(u8 line, u8 update);
+
+// ISRs
+extern void TIMER0_A0_ISR(void);
+extern void TIMER0_A1_5_ISR(void);
+extern void PORT2_ISR(void);
+extern void ADC12ISR(void);
+
+
+// *************************************************************************************************
+// @fn          emulator_clock
+// @brief       Host time for pacing and load measurement.
+// @param       none
+// @return      uint64_t		nanoseconds
+// *************************************************************************************************
+static uint64_t emulator_clock(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000u + now.tv_nsec;
+}
+
+
+// *************************************************************************************************
+// @fn          emulator_screen
+// @brief       Accounting entry of the screen currently shown.
+// @param       none
+// @return      struct emulator_screen *
+// *************************************************************************************************
+static struct emulator_screen * emulator_screen(void)
+{
+	void * line1 = (void *)fptr_lcd_function_line1;
+	void * line2 = (void *)fptr_lcd_function_line2;
+	u32 i;
+
+	for (i=0; i<emulator_screen_count; i++)
+	{
+		if ((emulator_screens[i].line1 == line1) && (emulator_screens[i].line2 == line2)) return &emulator_screens[i];
+	}
+	// Table full: charge the last entry
+	if (emulator_screen_count == EMULATOR_MAX_SCREENS) return &emulator_screens[EMULATOR_MAX_SCREENS-1];
+
+	emulator_screens[i].line1 = line1;
+	emulator_screens[i].line2 = line2;
+	emulator_screen_count++;
+	return &emulator_screens[i];
+}
+
+
+// *************************************************************************************************
+// @fn          emulator_screen_name
+// @brief       Name of a screen from the symbols of its menu functions.
+// @param       struct emulator_screen * s
+//				char * name		Buffer
+//				u32 size
+// @return      char *			name
+// *************************************************************************************************
+static char * emulator_screen_name(const struct emulator_screen * s, char * name, u32 size)
+{
+	Dl_info info[2];
+	const char * part[2];
+	void * fn[2] = { s->line1, s->line2 };
+	char addr[2][20];
+	u8 i;
+
+	for (i=0; i<2; i++)
+	{
+		if (fn[i] == NULL)
+		{
+			part[i] = "-";
+		}
+		else if (dladdr(fn[i], &info[i]) && (info[i].dli_sname != NULL) && (info[i].dli_saddr == fn[i]))
+		{
+			part[i] = info[i].dli_sname;
+		}
+		else
+		{
+			snprintf(addr[i], sizeof(addr[i]), "%p", fn[i]);
+			part[i] = addr[i];
+		}
+	}
+	snprintf(name, size, "%s/%s", part[0], part[1]);
+	return name;
+}
+
+
+// *************************************************************************************************
+// @fn          emulator_awake_begin, emulator_awake_end
+// @brief       Charge host time between CPU wakeup and sleep to the current screen.
+// @param       none
+// @return      none
+// *************************************************************************************************
+static void emulator_awake_begin(void)
+{
+	if (emulator_awake) return;
+	emulator_awake = 1;
+	emulator_awake_since = emulator_clock();
+}
+
+static void emulator_awake_end(void)
+{
+	if (!emulator_awake) return;
+	emulator_awake = 0;
+	emulator_screen()->ns += emulator_clock() - emulator_awake_since;
+}
+
+
+// *************************************************************************************************
+// Intrinsics
+
+void cc430_bis_sr(uint16_t bits)
+{
+	emulator_sr |= bits;
+	if (emulator_sr & CPUOFF) emulator_sleep();
+	else emulator_interrupts();
+}
+
+void cc430_bic_sr(uint16_t bits)
+{
+	emulator_sr &= ~bits;
+}
+
+void cc430_bic_sr_irq(uint16_t bits)
+{
+	if (emulator_irq_sr != NULL) *emulator_irq_sr &= ~bits;
+}
+
+istate_t __get_interrupt_state(void)
+{
+	return emulator_sr & GIE;
+}
+
+void __set_interrupt_state(istate_t state)
+{
+	if (state & GIE) cc430_bis_sr(GIE);
+	else cc430_bic_sr(GIE);
+}
+
+unsigned short __even_in_range(unsigned short value, unsigned short bound)
+{
+	return value;
+}
+
+void __delay_cycles(unsigned long cycles)
+{
+}
+
+
+// *************************************************************************************************
+// @fn          emulator_p2_pin
+// @brief       Drive a port 2 pin from outside. Edges on inputs set P2IFG as selected by P2IES.
+// @param       uint8_t pin		BITx
+//				uint8_t level	0 or 1
+// @return      none
+// *************************************************************************************************
+void emulator_p2_pin(uint8_t pin, uint8_t level)
+{
+	u8 old = emulator_p2_pins;
+	u8 changed;
+
+	if (level) emulator_p2_pins |= pin;
+	else emulator_p2_pins &= ~pin;
+
+	changed = (old ^ emulator_p2_pins) & ~P2DIR;
+	P2IFG |= changed & ((emulator_p2_pins & ~P2IES) | (~emulator_p2_pins & P2IES));
+}
+
+
+// *************************************************************************************************
+// @fn          cc430_p2in
+// @brief       Read P2IN. Outputs read back their P2OUT bit.
+// @param       none
+// @return      uint8_t		P2IN
+// *************************************************************************************************
+static void emulator_run(uint64_t until);
+
+uint8_t cc430_p2in(void)
+{
+	// Firmware is waiting for a pin to change: let time pass
+	if (++emulator_poll > EMULATOR_POLL_READS) emulator_run(emulator_now + 1);
+
+	return (emulator_p2_pins & ~P2DIR) | (P2OUT & P2DIR);
+}
+
+
+// *************************************************************************************************
+// @fn          cc430_lcd_clear
+// @brief       LCDCLRM/LCDCLRBM written: clear LCD or blink memory.
+// @param       uint16_t bit		LCDCLRM or LCDCLRBM value
+// @return      uint16_t			bit
+// *************************************************************************************************
+uint16_t cc430_lcd_clear(uint16_t bit)
+{
+	memset(LCDMEM + ((bit == 0x0002) ? 0 : 0x20), 0, 0x20);
+	return bit;
+}
+
+
+// *************************************************************************************************
+// @fn          cc430_rfbsl
+// @brief       Firmware calls the radio updater in BSL memory. Ends the run.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void cc430_rfbsl(void)
+{
+	printf("rfbsl %u\n", EMULATOR_TICKS_TO_MS(emulator_now));
+	longjmp(emulator_exit, 1);
+}
+
+
+// *************************************************************************************************
+// @fn          emulator_ta0_next
+// @brief       Next compare event of Timer0 with enabled interrupt.
+// @param       none
+// @return      uint64_t		simulated time, EMULATOR_NEVER if none
+// *************************************************************************************************
+static volatile uint16_t * const emulator_ta0_cctl[5] = { &TA0CCTL0, &TA0CCTL1, &TA0CCTL2, &TA0CCTL3, &TA0CCTL4 };
+static volatile uint16_t * const emulator_ta0_ccr[5] = { &TA0CCR0, &TA0CCR1, &TA0CCR2, &TA0CCR3, &TA0CCR4 };
+
+static u8 emulator_ta0_running(void)
+{
+	// Every mode is treated as continuous mode, the firmware uses no other. LPM4 stops ACLK.
+	return ((TA0CTL & (MC0 | MC1)) != 0) && ((emulator_sr & OSCOFF) == 0);
+}
+
+static uint32_t emulator_ta0_distance(u8 n)
+{
+	uint16_t d = *emulator_ta0_ccr[n] - TA0R;
+
+	// Equal now means it has just fired
+	return d ? d : 0x10000u;
+}
+
+static uint64_t emulator_ta0_next(void)
+{
+	uint64_t next = EMULATOR_NEVER;
+	u8 n;
+
+	if (!emulator_ta0_running()) return EMULATOR_NEVER;
+	for (n=0; n<5; n++)
+	{
+		if ((*emulator_ta0_cctl[n] & CCIE) && (emulator_now + emulator_ta0_distance(n) < next))
+		{
+			next = emulator_now + emulator_ta0_distance(n);
+		}
+	}
+	return next;
+}
+
+
+// *************************************************************************************************
+// @fn          emulator_ta0_advance
+// @brief       Count Timer0 and set CCIFG of every compare passed.
+// @param       uint64_t ticks
+// @return      none
+// *************************************************************************************************
+static void emulator_ta0_advance(uint64_t ticks)
+{
+	u8 n;
+
+	if (TA0CTL & TACLR)
+	{
+		TA0R = 0;
+		TA0CTL &= ~TACLR;
+	}
+	if (!emulator_ta0_running() || (ticks == 0)) return;
+
+	for (n=0; n<5; n++)
+	{
+		if (emulator_ta0_distance(n) <= ticks) *emulator_ta0_cctl[n] |= CCIFG;
+	}
+	TA0R += (uint16_t)ticks;
+}
+
+
+// *************************************************************************************************
+// @fn          emulator_pending
+// @brief       Highest priority interrupt that is pending and enabled. Clears the flags the
+//				hardware clears when the interrupt is taken and sets the vector registers.
+// @param       none
+// @return      ISR, NULL if none
+// *************************************************************************************************
+static void (*emulator_pending(void))(void)
+{
+	u8 n;
+
+	if (ADC12IFG & ADC12IE & BIT0)
+	{
+		ADC12IFG &= ~BIT0;
+		ADC12IV = 0x06;
+		return ADC12ISR;
+	}
+	if ((TA0CCTL0 & (CCIE | CCIFG)) == (CCIE | CCIFG))
+	{
+		TA0CCTL0 &= ~CCIFG;
+		return TIMER0_A0_ISR;
+	}
+	for (n=1; n<5; n++)
+	{
+		if ((*emulator_ta0_cctl[n] & (CCIE | CCIFG)) == (CCIE | CCIFG))
+		{
+			*emulator_ta0_cctl[n] &= ~CCIFG;
+			TA0IV = n * 2;
+			return TIMER0_A1_5_ISR;
+		}
+	}
+	if (P2IFG & P2IE) return PORT2_ISR;
+	return NULL;
+}
+
+
+// *************************************************************************************************
+// @fn          emulator_dispatch
+// @brief       Call an ISR like the CPU does: SR is saved and cleared, RETI restores it with the
+//				bits the ISR cleared with _BIC_SR_IRQ.
+// @param       isr
+// @return      none
+// *************************************************************************************************
+static void emulator_dispatch(void (*isr)(void))
+{
+	uint16_t saved = emulator_sr;
+	uint16_t * outer = emulator_irq_sr;
+
+	emulator_irq_sr = &saved;
+	emulator_sr = 0;
+	isr();
+	emulator_sr = saved;
+	emulator_irq_sr = outer;
+	TA0IV = 0;
+	ADC12IV = 0;
+}
+
+
+// *************************************************************************************************
+// @fn          emulator_interrupts
+// @brief       Take pending interrupts while GIE is set and the CPU is running.
+// @param       none
+// @return      none
+// *************************************************************************************************
+static void emulator_interrupts(void)
+{
+	void (*isr)(void);
+
+	while ((emulator_sr & GIE) && ((isr = emulator_pending()) != NULL)) emulator_dispatch(isr);
+}
+
+
+// *************************************************************************************************
+// @fn          emulator_lcd
+// @brief       Print the LCD content if it changed.
+// @param       none
+// @return      none
+// *************************************************************************************************
+static u8 emulator_digit_bits(u8 segment, const u8 * mem)
+{
+	u8 bits = mem[segments_lcdmem[segment] - LCD_MEM_1] & segments_bitmask[segment];
+
+	// Line 2 nibbles are swapped, L2_5 is a lone '1'
+	if (segment == LCD_SEG_L2_5) return bits ? (SEG_B | SEG_C) : 0;
+	if (segment >= LCD_SEG_L2_5) bits = ((bits << 4) & 0xF0) | ((bits >> 4) & 0x0F);
+	return bits;
+}
+
+static char emulator_digit_char(u8 bits)
+{
+	u8 i;
+
+	if (bits == 0) return ' ';
+	if (bits == SEG_G) return '-';
+	for (i=0; i<=('Z'-'0'); i++)
+	{
+		if (lcd_font[i] == bits) return '0' + i;
+	}
+	return '?';
+}
+
+static u8 emulator_digit_abcdefg(u8 bits)
+{
+	static const u8 order[7] = { SEG_A, SEG_B, SEG_C, SEG_D, SEG_E, SEG_F, SEG_G };
+	u8 i, out = 0;
+
+	for (i=0; i<7; i++)
+	{
+		if (bits & order[i]) out |= 1 << i;
+	}
+	return out;
+}
+
+static u8 emulator_symbol_on(u8 symbol, const u8 * mem)
+{
+	u8 mask = segments_bitmask[symbol];
+
+	// PM shares its segment with AM
+	if ((symbol == LCD_SYMB_PM) && emulator_symbol_on(LCD_SYMB_AM, mem)) return 0;
+	return (mem[segments_lcdmem[symbol] - LCD_MEM_1] & mask) == mask;
+}
+
+static void emulator_symbols(const u8 * mem, u8 digits)
+{
+	u8 i, n = 0;
+
+	for (i=0; i<sizeof(emulator_symbol_names)/sizeof(emulator_symbol_names[0]); i++)
+	{
+		if ((i >= LCD_SEG_L1_3) && (i <= LCD_SEG_L1_0) && !digits) continue;
+		if ((i >= LCD_SEG_L2_5) && (i <= LCD_SEG_L2_0) && !digits) continue;
+		if (((i >= LCD_SEG_L1_3) && (i <= LCD_SEG_L1_0)) || ((i >= LCD_SEG_L2_5) && (i <= LCD_SEG_L2_0)))
+		{
+			if (emulator_digit_bits(i, mem) == 0) continue;
+		}
+		else if (!emulator_symbol_on(i, mem))
+		{
+			continue;
+		}
+		printf("%s%s", n++ ? "," : "", emulator_symbol_names[i]);
+	}
+	if (n == 0) printf("-");
+}
+
+static void emulator_lcd(void)
+{
+	static const u8 blank[0x20];
+	const u8 * mem = ((LCDBCTL0 & LCDON) != 0) ? LCDMEM : blank;
+	u8 mode = ((LCDBCTL0 & LCDON) != 0) ? (LCDBBLKCTL & (LCDBLKMOD0 | LCDBLKMOD1)) : 0;
+	u8 state[sizeof(emulator_lcd_shown)];
+	u8 i;
+
+	memcpy(state, LCDMEM, sizeof(LCDMEM));
+	state[sizeof(LCDMEM)] = (LCDBCTL0 & LCDON) != 0;
+	state[sizeof(LCDMEM)+1] = mode;
+	if (emulator_lcd_valid && (memcmp(state, emulator_lcd_shown, sizeof(state)) == 0)) return;
+	memcpy(emulator_lcd_shown, state, sizeof(state));
+	emulator_lcd_valid = 1;
+
+	printf("lcd %u |", EMULATOR_TICKS_TO_MS(emulator_now));
+	for (i=0; i<EMULATOR_DIGITS; i++)
+	{
+		if (i == 4) printf("|");
+		printf("%c", emulator_digit_char(emulator_digit_bits(emulator_digits[i], mem)));
+	}
+	printf("|");
+	for (i=0; i<EMULATOR_DIGITS; i++) printf("%02x", emulator_digit_abcdefg(emulator_digit_bits(emulator_digits[i], mem)));
+	printf("|");
+	emulator_symbols(mem, 0);
+	printf("|");
+	// LCDBLKMOD_1 blinks what is set in the blink memory, LCDBLKMOD_2 everything
+	if (mode == LCDBLKMOD0) emulator_symbols(mem + 0x20, 1);
+	else if (mode == LCDBLKMOD1) printf("ALL");
+	else printf("-");
+	printf("\n");
+}
+
+
+// *************************************************************************************************
+// @fn          emulator_peripherals
+// @brief       Peripheral side effects of register writes, checked whenever the CPU sleeps or
+//				polls, and output of display, buzzer and backlight changes.
+// @param       none
+// @return      none
+// *************************************************************************************************
+static void emulator_peripherals(void)
+{
+	u32 hz;
+	u8 light;
+
+	// Conversion started, ADC12SC resets itself in pulse sample mode
+	if ((ADC12CTL0 & (ADC12ON | ADC12ENC | ADC12SC)) == (ADC12ON | ADC12ENC | ADC12SC))
+	{
+		ADC12CTL0 &= ~ADC12SC;
+		emulator_adc12_done = emulator_now + 1;
+	}
+
+	emulator_lcd();
+
+	// Buzzer: TA1 toggles P2.7 on every CCR0 match
+	hz = ((TA1CTL & (MC0 | MC1)) && (P2SEL & BIT7)) ? EMULATOR_ACLK / (2u * (TA1CCR0 + 1u)) : 0;
+	if (hz != emulator_buzz_hz)
+	{
+		emulator_buzz_hz = hz;
+		printf("buzz %u %u\n", EMULATOR_TICKS_TO_MS(emulator_now), hz);
+	}
+
+	light = (P2DIR & P2OUT & BUTTON_BACKLIGHT_PIN) != 0;
+	if (light != emulator_light)
+	{
+		emulator_light = light;
+		printf("light %u %u\n", EMULATOR_TICKS_TO_MS(emulator_now), light);
+	}
+}
+
+
+// *************************************************************************************************
+// @fn          emulator_read_input
+// @brief       Read what is available on stdin.
+// @param       none
+// @return      none
+// *************************************************************************************************
+static void emulator_read_input(void)
+{
+	ssize_t n;
+
+	if (emulator_input_length == sizeof(emulator_input) - 1) emulator_input_length = 0;
+	n = read(STDIN_FILENO, emulator_input + emulator_input_length, sizeof(emulator_input) - 1 - emulator_input_length);
+	if (n <= 0) emulator_input_open = 0;
+	else emulator_input_length += n;
+}
+
+
+// *************************************************************************************************
+// @fn          emulator_pace
+// @brief       Wait until simulated time 'next' is due in host time, or stdin has input.
+// @param       uint64_t next		Next event
+// @return      uint64_t			Time to advance to, earlier than next if input arrived
+// *************************************************************************************************
+static uint64_t emulator_pace(uint64_t next)
+{
+	struct timeval tv, * timeout;
+	fd_set fds;
+	uint64_t now, due, at;
+
+	for (;;)
+	{
+		now = emulator_clock();
+		if (emulator_speed <= 0.0) due = (next == EMULATOR_NEVER) ? EMULATOR_NEVER : now;
+		else if (next == EMULATOR_NEVER) due = EMULATOR_NEVER;
+		else due = emulator_wall_base + (uint64_t)((double)(next - emulator_sim_base) * 1e9 / EMULATOR_ACLK / emulator_speed);
+
+		if (!emulator_input_open)
+		{
+			if (due == EMULATOR_NEVER)
+			{
+				// Nothing will ever happen
+				longjmp(emulator_exit, 1);
+			}
+			if (due > now)
+			{
+				tv.tv_sec = (due - now) / 1000000000u;
+				tv.tv_usec = ((due - now) % 1000000000u) / 1000u;
+				select(0, NULL, NULL, NULL, &tv);
+				continue;
+			}
+			break;
+		}
+
+		FD_ZERO(&fds);
+		FD_SET(STDIN_FILENO, &fds);
+		timeout = NULL;
+		if (due != EMULATOR_NEVER)
+		{
+			tv.tv_sec = (due > now) ? (due - now) / 1000000000u : 0;
+			tv.tv_usec = (due > now) ? ((due - now) % 1000000000u) / 1000u : 0;
+			timeout = &tv;
+		}
+		if (select(STDIN_FILENO + 1, &fds, NULL, NULL, timeout) > 0)
+		{
+			emulator_read_input();
+
+			// Input takes effect at the simulated time it arrived
+			at = emulator_now;
+			if (emulator_speed > 0.0)
+			{
+				now = emulator_clock();
+				at = emulator_sim_base + (uint64_t)((double)(now - emulator_wall_base) * emulator_speed * EMULATOR_ACLK / 1e9);
+				if (at < emulator_now) at = emulator_now;
+				if (at > next) at = next;
+			}
+			next = at;
+			break;
+		}
+		if (emulator_clock() >= due) break;
+	}
+	return next;
+}
+
+
+// *************************************************************************************************
+// @fn          emulator_events
+// @brief       Handle everything that is due at the current simulated time.
+// @param       none
+// @return      none
+// *************************************************************************************************
+static void emulator_events(void)
+{
+	struct emulator_screen * s;
+	char name[96], * end;
+	u8 i;
+
+	emulator_sensors_run();
+
+	if (emulator_now >= emulator_adc12_done)
+	{
+		emulator_adc12_done = EMULATOR_NEVER;
+		ADC12MEM0 = emulator_adc12_sample(ADC12MCTL0 & 0x0F);
+		ADC12IFG |= BIT0;
+	}
+
+	for (i=0; i<EMULATOR_BUTTONS; i++)
+	{
+		if (emulator_now >= emulator_release[i])
+		{
+			emulator_release[i] = EMULATOR_NEVER;
+			emulator_p2_pin(emulator_button_pins[i], 0);
+		}
+	}
+
+	while ((emulator_script_next < emulator_script_count) &&
+		   (EMULATOR_MS_TO_TICKS(emulator_script[emulator_script_next].ms) <= emulator_now))
+	{
+		emulator_command(emulator_script[emulator_script_next++].text);
+	}
+
+	while ((end = memchr(emulator_input, '\n', emulator_input_length)) != NULL)
+	{
+		*end = 0;
+		emulator_command(emulator_input);
+		emulator_input_length -= end + 1 - emulator_input;
+		memmove(emulator_input, end + 1, emulator_input_length);
+	}
+
+	if (emulator_now >= emulator_cpu_next)
+	{
+		emulator_cpu_next += EMULATOR_ACLK;
+		s = emulator_screen();
+		printf("cpu %u %s %u %.0f %.1f\n", EMULATOR_TICKS_TO_MS(emulator_now), emulator_screen_name(s, name, sizeof(name)),
+				s->wakeups, s->ns * emulator_scale, (double)s->ticks / EMULATOR_ACLK);
+	}
+
+	if (emulator_now >= emulator_end) longjmp(emulator_exit, 1);
+}
+
+
+// *************************************************************************************************
+// @fn          emulator_step
+// @brief       Advance simulated time to the next event, but not past a limit.
+// @param       uint64_t limit
+// @return      none
+// *************************************************************************************************
+static void emulator_step(uint64_t limit)
+{
+	uint64_t next = limit;
+	uint64_t t;
+	u8 awake = emulator_awake;
+	u8 i;
+
+	// Emulator work and pacing are not CPU time of the firmware
+	emulator_awake_end();
+
+	if ((t = emulator_ta0_next()) < next) next = t;
+	if ((t = emulator_sensors_next()) < next) next = t;
+	if (emulator_adc12_done < next) next = emulator_adc12_done;
+	for (i=0; i<EMULATOR_BUTTONS; i++)
+	{
+		if (emulator_release[i] < next) next = emulator_release[i];
+	}
+	if (emulator_script_next < emulator_script_count)
+	{
+		t = EMULATOR_MS_TO_TICKS(emulator_script[emulator_script_next].ms);
+		if (t < next) next = (t > emulator_now) ? t : emulator_now;
+	}
+	if (emulator_cpu_next < next) next = emulator_cpu_next;
+	if (emulator_end < next) next = emulator_end;
+
+	next = emulator_pace(next);
+
+	emulator_screen()->ticks += next - emulator_now;
+	emulator_ta0_advance(next - emulator_now);
+	emulator_now = next;
+	emulator_events();
+
+	if (awake) emulator_awake_begin();
+}
+
+
+// *************************************************************************************************
+// @fn          emulator_sleep
+// @brief       CPU is off: let time pass and take interrupts until an ISR clears CPUOFF on exit.
+// @param       none
+// @return      none
+// *************************************************************************************************
+static void emulator_sleep(void)
+{
+	void (*isr)(void);
+
+	emulator_awake_end();
+	while (emulator_sr & CPUOFF)
+	{
+		emulator_poll = 0;
+		emulator_peripherals();
+		if ((emulator_sr & GIE) && ((isr = emulator_pending()) != NULL))
+		{
+			if (emulator_irq_sr == NULL) emulator_screen()->wakeups++;
+			emulator_awake_begin();
+			emulator_dispatch(isr);
+			emulator_awake_end();
+			continue;
+		}
+		emulator_step(EMULATOR_NEVER);
+	}
+	emulator_awake_begin();
+}
+
+
+// *************************************************************************************************
+// @fn          emulator_run
+// @brief       CPU is busy polling: let time pass and take interrupts as they come.
+// @param       uint64_t until
+// @return      none
+// *************************************************************************************************
+static void emulator_run(uint64_t until)
+{
+	while (emulator_now < until)
+	{
+		emulator_step(until);
+		emulator_peripherals();
+		emulator_interrupts();
+	}
+}
+
+
+// *************************************************************************************************
+// @fn          emulator_command
+// @brief       Execute one input command.
+// @param       const char * line
+// @return      none
+// *************************************************************************************************
+static void emulator_command(const char * line)
+{
+	char cmd[16], arg[16];
+	int a, b, c, n;
+	double f;
+	u8 i;
+
+	n = sscanf(line, "%15s", cmd);
+	if ((n != 1) || (cmd[0] == '#')) return;
+
+	if (strcmp(cmd, "press") == 0)
+	{
+		a = EMULATOR_PRESS_MS;
+		if (sscanf(line, "%*s %15s %d", arg, &a) < 1) goto error;
+		for (i=0; i<EMULATOR_BUTTONS; i++)
+		{
+			if (strcmp(arg, emulator_button_names[i]) == 0) break;
+		}
+		if (i == EMULATOR_BUTTONS) goto error;
+		emulator_p2_pin(emulator_button_pins[i], 1);
+		emulator_release[i] = emulator_now + EMULATOR_MS_TO_TICKS(a);
+	}
+	else if (strcmp(cmd, "temp") == 0)
+	{
+		if (sscanf(line, "%*s %d", &a) != 1) goto error;
+		sEmulatorSensors.temperature = a;
+	}
+	else if (strcmp(cmd, "alt") == 0)
+	{
+		if (sscanf(line, "%*s %d", &a) != 1) goto error;
+		sEmulatorSensors.altitude = a;
+	}
+	else if (strcmp(cmd, "batt") == 0)
+	{
+		if (sscanf(line, "%*s %d", &a) != 1) goto error;
+		sEmulatorSensors.battery = a;
+	}
+	else if (strcmp(cmd, "accel") == 0)
+	{
+		if (sscanf(line, "%*s %d %d %d", &a, &b, &c) != 3) goto error;
+		sEmulatorSensors.accel[0] = a;
+		sEmulatorSensors.accel[1] = b;
+		sEmulatorSensors.accel[2] = c;
+		emulator_sensors_moved();
+	}
+	else if (strcmp(cmd, "walk") == 0)
+	{
+		if ((sscanf(line, "%*s %d", &a) != 1) || (a < 0)) goto error;
+		sEmulatorSensors.cadence = a;
+		emulator_sensors_moved();
+	}
+	else if (strcmp(cmd, "speed") == 0)
+	{
+		if ((sscanf(line, "%*s %lf", &f) != 1) || (f < 0.0)) goto error;
+		emulator_speed = f;
+		emulator_wall_base = emulator_clock();
+		emulator_sim_base = emulator_now;
+	}
+	else if (strcmp(cmd, "quit") == 0)
+	{
+		longjmp(emulator_exit, 1);
+	}
+	else
+	{
+		goto error;
+	}
+	return;
+
+error:
+	fprintf(stderr, "bad command: %s\n", line);
+}
+
+
+// *************************************************************************************************
+// @fn          emulator_load
+// @brief       Read a script. Commands must be in time order.
+// @param       const char * path
+// @return      u8		1 = ok, 0 = error (reported)
+// *************************************************************************************************
+static u8 emulator_load(const char * path)
+{
+	FILE * f = fopen(path, "r");
+	char line[128];
+	u32 size = 0, number = 0;
+	struct emulator_script s;
+	int offset;
+
+	if (f == NULL)
+	{
+		perror(path);
+		return 0;
+	}
+	while (fgets(line, sizeof(line), f))
+	{
+		number++;
+		if ((line[0] == '#') || (strspn(line, " \t\r\n") == strlen(line))) continue;
+
+		line[strcspn(line, "\r\n")] = 0;
+		if (sscanf(line, "%u %n", &s.ms, &offset) != 1) goto error;
+		snprintf(s.text, sizeof(s.text), "%s", line + offset);
+		if (emulator_script_count && (s.ms < emulator_script[emulator_script_count-1].ms)) goto error;
+
+		if (emulator_script_count == size)
+		{
+			size = size ? size * 2 : 64;
+			emulator_script = realloc(emulator_script, size * sizeof(struct emulator_script));
+		}
+		emulator_script[emulator_script_count++] = s;
+	}
+	fclose(f);
+	return 1;
+
+error:
+	fprintf(stderr, "%s:%u: bad command: %s\n", path, number, line);
+	fclose(f);
+	return 0;
+}
+
+
+// *************************************************************************************************
+// @fn          emulator_report
+// @brief       Time, wakeups and CPU load per screen.
+// @param       none
+// @return      none
+// *************************************************************************************************
+static void emulator_report(void)
+{
+	const struct emulator_screen * s;
+	char name[96];
+	double seconds, cycles;
+	u32 i;
+
+	fprintf(stderr, "emulated %.1f s\n", (double)emulator_now / EMULATOR_ACLK);
+	fprintf(stderr, "%-44s %8s %8s %10s %12s %10s\n", "screen", "seconds", "wakeups", "wakeups/s", "cycles", "cycles/s");
+	for (i=0; i<emulator_screen_count; i++)
+	{
+		s = &emulator_screens[i];
+		seconds = (double)s->ticks / EMULATOR_ACLK;
+		cycles = s->ns * emulator_scale;
+		fprintf(stderr, "%-44s %8.1f %8u %10.2f %12.0f %10.0f\n", emulator_screen_name(s, name, sizeof(name)), seconds,
+				s->wakeups, (seconds > 0) ? s->wakeups / seconds : 0.0, cycles, (seconds > 0) ? cycles / seconds : 0.0);
+	}
+}
+
+
+// *************************************************************************************************
+// @fn          main
+// @brief       Start the firmware on the emulated CC430.
+// @param       int argc
+//				char * argv[]
+// @return      int		0 = ok, 2 = usage or input error
+// *************************************************************************************************
+int main(int argc, char * argv[])
+{
+	int c;
+
+	while ((c = getopt(argc, argv, "fx:t:b:s:pq")) != -1)
+	{
+		switch (c)
+		{
+			case 'f':	emulator_speed = 0.0;
+						break;
+			case 'x':	emulator_speed = atof(optarg);
+						break;
+			case 't':	emulator_end = (uint64_t)(atof(optarg) * EMULATOR_ACLK);
+						break;
+			case 'b':	if (!emulator_load(optarg)) return 2;
+						break;
+			case 's':	emulator_scale = atof(optarg);
+						break;
+			case 'p':	emulator_profile = 1;
+						break;
+			case 'q':	emulator_quiet = 1;
+						break;
+			default:	goto usage;
+		}
+	}
+	if ((optind != argc) || (emulator_speed < 0.0)) goto usage;
+
+	setvbuf(stdout, NULL, _IOLBF, 0);
+	if (emulator_profile) emulator_cpu_next = EMULATOR_ACLK;
+
+	// SPI transfers complete immediately
+	UCA0IFG = UCRXIFG;
+	emulator_sensors_init();
+
+	emulator_wall_base = emulator_clock();
+	emulator_awake_begin();
+	if (setjmp(emulator_exit) == 0) ezchronos_main();
+	emulator_awake_end();
+
+	fflush(stdout);
+	if (!emulator_quiet) emulator_report();
+	return 0;
+
+usage:
+	fprintf(stderr, "usage: %s [-f] [-x factor] [-t seconds] [-b script] [-s scale] [-p] [-q]\n", argv[0]);
+	return 2;
+}
@@ -0,0 +1,55 @@
+// *************************************************************************************************
+//
+// Host emulator for the complete firmware. See host/emulator.c.
+//
+// *************************************************************************************************
+
+#ifndef EMULATOR_H_
+#define EMULATOR_H_
+
+// *************************************************************************************************
+// Include section
+
+#include <stdint.h>
+
+
+// *************************************************************************************************
+// Defines section
+
+// Simulated time base is the 32768Hz ACLK, the same unit the firmware timers use
+#define EMULATOR_ACLK				(32768u)
+#define EMULATOR_MS_TO_TICKS(ms)	(((uint64_t)(ms) * EMULATOR_ACLK) / 1000u)
+#define EMULATOR_TICKS_TO_MS(ticks)	((uint32_t)(((ticks) * 1000u) / EMULATOR_ACLK))
+
+// No pending event
+#define EMULATOR_NEVER				(UINT64_MAX)
+
+// Physical values seen by the emulated sensors, changed from the command input
+struct emulator_sensors
+{
+	int32_t		altitude;		// m, pressure sensor
+	int16_t		temperature;	// 0.1 degC, pressure sensor and ADC12 channel 10
+	uint16_t	battery;		// 10mV, ADC12 channel 11
+	int16_t		accel[3];		// mg, acceleration sensor X/Y/Z
+	uint16_t	cadence;		// steps per minute, 0 = not walking
+};
+extern struct emulator_sensors sEmulatorSensors;
+
+
+// *************************************************************************************************
+// Extern section
+
+// Simulated clock in ACLK ticks
+extern uint64_t emulator_now;
+
+// Port 2 pins driven from outside (host/emulator.c)
+extern void emulator_p2_pin(uint8_t pin, uint8_t level);
+
+// Emulated sensors (host/emulator_drivers.c)
+extern void emulator_sensors_init(void);
+extern uint64_t emulator_sensors_next(void);
+extern void emulator_sensors_run(void);
+extern void emulator_sensors_moved(void);
+extern uint16_t emulator_adc12_sample(uint8_t channel);
+
+#endif /*EMULATOR_H_*/
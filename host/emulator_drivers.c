@@ -0,0 +1,606 @@
+// *************************************************************************************************
+//
+// Emulated sensors and driver stand-ins for the host emulator (host/emulator.c).
+//
+// driver/vti_as.c and driver/vti_ps.c run unmodified. The pins they use are served here: the
+// CMA3000 acceleration sensor answers on USCI_A0 while its CSN pin on PJ is low, the SCP1000
+// pressure sensor is a TWI slave on the PJ pins the driver bit-bangs. Both raise their data
+// ready pins on port 2 at their sample rate. ADC12 results are computed from the same physical
+// values. The radio is not emulated: the driver layer below SimpliciTI and BlueRobin is stubbed
+// so that every radio mode ends without a link. The information memory journal and the crash log
+// work on absolute flash addresses and reset registers, they are stubbed as well.
+//
+// *************************************************************************************************
+
+// *************************************************************************************************
+// Include section
+
+// system
+#include <math.h>
+#include "project.h"
+
+// driver
+#include "vti_as.h"
+#include "vti_ps.h"
+#include "pmm.h"
+#include "stack.h"
+#include "infomem.h"
+#include "crash.h"
+
+// logic
+#include "simpliciti.h"
+
+#include "emulator.h"
+
+
+// *************************************************************************************************
+// Defines section
+
+// SCP1000 TWI slave address and registers
+#define PS_ADDRESS				(0x11u)
+#define PS_REG_OPERATION		(0x03u)
+#define PS_REG_RSTR				(0x06u)
+#define PS_REG_STATUS			(0x07u)
+#define PS_REG_DATARD8			(0x7Fu)
+#define PS_REG_DATARD16			(0x80u)
+#define PS_REG_TEMPOUT			(0x81u)
+#define PS_OP_TRIGGERED			(0x0Cu)
+
+// SCP1000 ultra low power mode: first result after 100ms, then one per second. Triggered mode
+// stops after the first result.
+#define PS_FIRST_SAMPLE			EMULATOR_MS_TO_TICKS(100)
+#define PS_SAMPLE_PERIOD		EMULATOR_ACLK
+
+// CMA3000 registers and CTRL modes
+#define AS_REG_WHO_AM_I			(0x00u)
+#define AS_REG_CTRL				(0x02u)
+#define AS_REG_RSTR				(0x04u)
+#define AS_REG_INT_STATUS		(0x05u)
+#define AS_REG_DOUTX			(0x06u)
+#define AS_REG_DOUTZ			(0x08u)
+#define AS_CTRL_G_RANGE_2G		(0x80u)
+#define AS_CTRL_MODE			(0x0Eu)
+#define AS_MODE_MEASURE_100		(0x02u)
+#define AS_MODE_MEASURE_400		(0x04u)
+#define AS_MODE_MEASURE_40		(0x06u)
+#define AS_MODE_MOTION			(0x08u)
+#define AS_MODE_FREEFALL_100	(0x0Au)
+#define AS_MODE_FREEFALL_400	(0x0Cu)
+
+// Free fall is detected below this acceleration magnitude
+#define AS_FREEFALL_MG			(350)
+
+// Motion detection evaluates the acceleration with 10Hz
+#define AS_MOTION_PERIOD		(EMULATOR_ACLK / 10)
+
+// Each step adds a vertical acceleration peak of this height
+#define AS_STEP_MG				(400)
+
+// TWI slave state
+struct emulator_twi
+{
+	u8		scl, sda;				// Line levels at last sample
+	s8		bit;					// Clock within byte, -1 = idle
+	u8		clocked;				// 1 = SCL went high since the last falling edge
+	u8		shift;					// Byte received or being sent
+	u8		byte;					// Bytes in transfer, 0 = device address
+	u8		addressed;				// 1 = our address, acking
+	u8		read;					// 1 = slave sends
+	u8		ack;					// 1 = slave pulls SDA low during ACK clock
+	u8		reg;					// Register pointer
+	u8		tx[2];					// Register content being read
+	u8		tx_count;
+};
+
+
+// *************************************************************************************************
+// Global Variable section
+
+volatile uint8_t cc430_pjout, cc430_pjdir;
+
+// Pressure sensor
+static struct emulator_twi emulator_twi = { 1, 1, -1 };
+static uint64_t emulator_ps_next = EMULATOR_NEVER;
+static u32 emulator_ps_data;				// Pressure in 0.25Pa
+static u16 emulator_ps_temp;				// Temperature in 0.05 degC
+static u8 emulator_ps_sampled;
+static u8 emulator_ps_single;				// Triggered mode, one conversion
+
+// Acceleration sensor
+static u8 emulator_pj_last;
+static u8 emulator_as_ctrl;
+static u8 emulator_as_index;
+static u8 emulator_as_address;
+static u8 emulator_as_tx;
+static u8 emulator_as_tx_pending;
+static u8 emulator_as_rx;
+static uint64_t emulator_as_next = EMULATOR_NEVER;
+
+
+// *************************************************************************************************
+// Pressure sensor
+
+static void emulator_ps_sample(void)
+{
+	double pa = 101325.0 * pow(1.0 - 2.25577e-5 * sEmulatorSensors.altitude, 5.25588);
+
+	emulator_ps_data = (u32)(pa * 4.0 + 0.5) & 0x7FFFF;
+	emulator_ps_temp = (u16)(sEmulatorSensors.temperature * 2) & 0x3FFF;
+	emulator_ps_sampled = 1;
+	emulator_p2_pin(PS_INT_PIN, 1);
+}
+
+static void emulator_ps_write(u8 reg, u8 data)
+{
+	if ((reg == PS_REG_RSTR) && (data & BIT0))
+	{
+		emulator_ps_next = EMULATOR_NEVER;
+		emulator_ps_sampled = 0;
+		emulator_p2_pin(PS_INT_PIN, 0);
+	}
+	else if (reg == PS_REG_OPERATION)
+	{
+		emulator_ps_next = data ? emulator_now + PS_FIRST_SAMPLE : EMULATOR_NEVER;
+		emulator_ps_single = (data == PS_OP_TRIGGERED);
+		if (!data) emulator_p2_pin(PS_INT_PIN, 0);
+	}
+}
+
+static u8 emulator_ps_read(u8 reg, u8 * data)
+{
+	switch (reg)
+	{
+		case PS_REG_STATUS:		data[0] = 0x20;
+								return 1;
+		// EEPROM checksum result until the first conversion
+		case PS_REG_DATARD8:	data[0] = emulator_ps_sampled ? (emulator_ps_data >> 16) : 0x01;
+								return 1;
+		case PS_REG_DATARD16:	data[0] = emulator_ps_data >> 8;
+								data[1] = emulator_ps_data;
+								emulator_p2_pin(PS_INT_PIN, 0);
+								return 2;
+		case PS_REG_TEMPOUT:	data[0] = emulator_ps_temp >> 8;
+								data[1] = emulator_ps_temp;
+								return 2;
+	}
+	data[0] = 0;
+	return 1;
+}
+
+
+// *************************************************************************************************
+// @fn          emulator_twi_sda
+// @brief       SDA level driven by the slave.
+// @param       none
+// @return      u8		0 or 1
+// *************************************************************************************************
+static u8 emulator_twi_sda(void)
+{
+	struct emulator_twi * t = &emulator_twi;
+
+	if (t->bit < 0) return 1;
+	if (t->bit == 8) return !(t->ack && (t->read != 1));
+	if (t->read) return (t->shift >> (7 - t->bit)) & 1;
+	return 1;
+}
+
+
+// *************************************************************************************************
+// @fn          emulator_twi_byte
+// @brief       Byte received by the slave, decide about ACK.
+// @param       none
+// @return      none
+// *************************************************************************************************
+static void emulator_twi_byte(void)
+{
+	struct emulator_twi * t = &emulator_twi;
+
+	if (t->byte == 0)
+	{
+		t->addressed = (t->shift >> 1) == PS_ADDRESS;
+		t->read = 0;
+		if (t->addressed && (t->shift & 1))
+		{
+			t->tx_count = emulator_ps_read(t->reg, t->tx);
+			t->read = 2;			// Starts sending after the ACK clock
+		}
+	}
+	else if (t->byte == 1)
+	{
+		t->reg = t->shift;
+	}
+	else
+	{
+		emulator_ps_write(t->reg, t->shift);
+	}
+	t->ack = t->addressed;
+	t->byte++;
+}
+
+
+// *************************************************************************************************
+// @fn          emulator_twi_sample
+// @brief       Follow the SCL and SDA lines of the pressure sensor bus.
+// @param       none
+// @return      none
+// *************************************************************************************************
+static void emulator_twi_sample(void)
+{
+	struct emulator_twi * t = &emulator_twi;
+	u8 master_sda = (cc430_pjdir & PS_SDA_PIN) ? ((cc430_pjout & PS_SDA_PIN) != 0) : 1;
+	u8 scl = (cc430_pjdir & PS_SCL_PIN) ? ((cc430_pjout & PS_SCL_PIN) != 0) : 1;
+	u8 sda = master_sda & emulator_twi_sda();
+
+	if (scl && t->scl && (sda != t->sda))
+	{
+		// START or STOP
+		t->bit = sda ? -1 : 0;
+		t->clocked = 0;
+		t->byte = 0;
+		t->read = 0;
+		t->ack = 0;
+		t->shift = 0;
+	}
+	else if (scl && !t->scl && (t->bit >= 0))
+	{
+		// Rising edge: data is valid
+		t->clocked = 1;
+		if ((t->bit < 8) && !t->read) t->shift = (t->shift << 1) | sda;
+		if ((t->bit == 8) && (t->read == 1) && sda) t->bit = -1;	// Master NACK, done
+	}
+	else if (!scl && t->scl && (t->bit >= 0) && t->clocked)
+	{
+		// Falling edge: next bit. The one ending a START does not count.
+		t->clocked = 0;
+		if (++t->bit == 8)
+		{
+			if (!t->read) emulator_twi_byte();
+		}
+		else if (t->bit == 9)
+		{
+			t->bit = t->addressed ? 0 : -1;
+			if (t->read == 2) t->read = 1;
+			if (t->read)
+			{
+				t->shift = t->tx_count ? t->tx[0] : 0xFF;
+				t->tx[0] = t->tx[1];
+				if (t->tx_count) t->tx_count--;
+			}
+			t->ack = 0;
+		}
+	}
+	t->scl = scl;
+	t->sda = master_sda & emulator_twi_sda();
+}
+
+
+// *************************************************************************************************
+// Acceleration sensor
+
+static u8 emulator_as_mode(void)
+{
+	return emulator_as_ctrl & AS_CTRL_MODE;
+}
+
+static uint64_t emulator_as_period(void)
+{
+	switch (emulator_as_mode())
+	{
+		case AS_MODE_MEASURE_40:	return EMULATOR_ACLK / 40;
+		case AS_MODE_MEASURE_100:	return EMULATOR_ACLK / 100;
+		case AS_MODE_MEASURE_400:	return EMULATOR_ACLK / 400;
+		case AS_MODE_MOTION:		return AS_MOTION_PERIOD;
+	}
+	return 0;
+}
+
+static void emulator_as_schedule(void)
+{
+	emulator_as_next = emulator_as_period() ? emulator_now + emulator_as_period() : EMULATOR_NEVER;
+}
+
+static u8 emulator_as_count(u8 axis)
+{
+	s32 mg = sEmulatorSensors.accel[axis];
+	s32 count;
+
+	// Walking swings the Z axis with the step frequency
+	if ((axis == 2) && sEmulatorSensors.cadence)
+	{
+		mg += (s32)(AS_STEP_MG * sin(2.0 * M_PI * sEmulatorSensors.cadence / 60.0 * emulator_now / EMULATOR_ACLK));
+	}
+	count = mg / ((emulator_as_ctrl & AS_CTRL_G_RANGE_2G) ? 18 : 71);
+
+	if (count > 127) count = 127;
+	if (count < -128) count = -128;
+	return (u8)count;
+}
+
+static void emulator_as_write(u8 reg, u8 data)
+{
+	if (reg == AS_REG_CTRL)
+	{
+		emulator_as_ctrl = data;
+		emulator_as_schedule();
+	}
+	else if ((reg == AS_REG_RSTR) && (data == 0x04))
+	{
+		// Last byte of the reset sequence 02 0A 04
+		emulator_as_ctrl = 0;
+		emulator_as_next = EMULATOR_NEVER;
+		emulator_p2_pin(AS_INT_PIN, 0);
+	}
+}
+
+static u8 emulator_as_read(u8 reg)
+{
+	switch (reg)
+	{
+		case AS_REG_WHO_AM_I:	return 0x51;
+		case AS_REG_CTRL:		return emulator_as_ctrl;
+		case AS_REG_DOUTX:
+		case AS_REG_DOUTX+1:	return emulator_as_count(reg - AS_REG_DOUTX);
+		case AS_REG_DOUTZ:		emulator_p2_pin(AS_INT_PIN, 0);
+								return emulator_as_count(2);
+		case AS_REG_INT_STATUS:	emulator_p2_pin(AS_INT_PIN, 0);
+								return 0;
+	}
+	return 0;
+}
+
+uint8_t cc430_uca0_rx(void)
+{
+	u8 byte = emulator_as_tx;
+
+	if (!emulator_as_tx_pending) return emulator_as_rx;
+	emulator_as_tx_pending = 0;
+
+	// Only a selected and powered sensor answers
+	if ((cc430_pjout & (AS_CSN_PIN | AS_PWR_PIN)) != AS_PWR_PIN)
+	{
+		emulator_as_rx = 0;
+		return emulator_as_rx;
+	}
+	if (emulator_as_index++ == 0)
+	{
+		emulator_as_address = byte;
+		emulator_as_rx = 0;
+	}
+	else if (emulator_as_address & BIT1)
+	{
+		emulator_as_write(emulator_as_address >> 2, byte);
+		emulator_as_rx = 0;
+	}
+	else
+	{
+		emulator_as_rx = emulator_as_read(emulator_as_address >> 2);
+	}
+	return emulator_as_rx;
+}
+
+volatile uint8_t * cc430_uca0_tx(void)
+{
+	emulator_as_tx_pending = 1;
+	return (volatile uint8_t *)&emulator_as_tx;
+}
+
+
+// *************************************************************************************************
+// @fn          cc430_pj
+// @brief       Port J is accessed. The bus state left by the previous access is sampled first.
+// @param       volatile uint8_t * reg		cc430_pjout or cc430_pjdir
+// @return      volatile uint8_t *			reg
+// *************************************************************************************************
+volatile uint8_t * cc430_pj(volatile uint8_t * reg)
+{
+	u8 pj = cc430_pjout & cc430_pjdir;
+
+	emulator_twi_sample();
+
+	// Deselected, next SPI byte is an address
+	if (pj & AS_CSN_PIN) emulator_as_index = 0;
+
+	// Acceleration sensor powered off
+	if ((emulator_pj_last & AS_PWR_PIN) && !(pj & AS_PWR_PIN))
+	{
+		emulator_as_ctrl = 0;
+		emulator_as_next = EMULATOR_NEVER;
+		emulator_p2_pin(AS_INT_PIN, 0);
+	}
+	emulator_pj_last = pj;
+	return reg;
+}
+
+uint8_t cc430_pjin(void)
+{
+	emulator_twi_sample();
+	return (cc430_pjout & cc430_pjdir) | (~cc430_pjdir & ~PS_SDA_PIN) | (emulator_twi.sda ? PS_SDA_PIN : 0);
+}
+
+
+// *************************************************************************************************
+// Sensor events
+
+void emulator_sensors_init(void)
+{
+	emulator_twi.scl = 1;
+	emulator_twi.sda = 1;
+}
+
+uint64_t emulator_sensors_next(void)
+{
+	return (emulator_ps_next < emulator_as_next) ? emulator_ps_next : emulator_as_next;
+}
+
+void emulator_sensors_run(void)
+{
+	if (emulator_now >= emulator_ps_next)
+	{
+		emulator_ps_next = emulator_ps_single ? EMULATOR_NEVER : emulator_ps_next + PS_SAMPLE_PERIOD;
+		emulator_ps_sample();
+	}
+	if (emulator_now >= emulator_as_next)
+	{
+		emulator_as_next += emulator_as_period();
+		if ((emulator_as_mode() != AS_MODE_MOTION) || sEmulatorSensors.cadence) emulator_p2_pin(AS_INT_PIN, 1);
+	}
+}
+
+void emulator_sensors_moved(void)
+{
+	s32 x = sEmulatorSensors.accel[0], y = sEmulatorSensors.accel[1], z = sEmulatorSensors.accel[2];
+	u8 mode = emulator_as_mode();
+
+	if (mode == AS_MODE_MOTION)
+	{
+		emulator_p2_pin(AS_INT_PIN, 1);
+	}
+	else if ((mode == AS_MODE_FREEFALL_100) || (mode == AS_MODE_FREEFALL_400))
+	{
+		if (x*x + y*y + z*z < AS_FREEFALL_MG * AS_FREEFALL_MG) emulator_p2_pin(AS_INT_PIN, 1);
+	}
+}
+
+uint16_t emulator_adc12_sample(uint8_t channel)
+{
+	s32 adc = 0;
+
+	// Inverse of the conversions in logic/temperature.c and logic/battery.c
+	if (channel == 10) adc = 1855 + ((s32)sEmulatorSensors.temperature + 250) * 4096 / 6670;
+	else if (channel == 11) adc = ((s32)sEmulatorSensors.battery + 10) * 41 / 4;
+
+	if (adc < 0) adc = 0;
+	if (adc > 4095) adc = 4095;
+	return adc;
+}
+
+
+// *************************************************************************************************
+// Radio stand-ins, no RF link on the host
+
+void radio_reset(void)
+{
+}
+
+void radio_powerdown(void)
+{
+}
+
+void open_radio(void)
+{
+}
+
+void close_radio(void)
+{
+}
+
+unsigned char simpliciti_link(void)
+{
+	// No access point in range
+	return 0;
+}
+
+void simpliciti_main_tx_only(void)
+{
+}
+
+void simpliciti_main_sync(void)
+{
+}
+
+void simpliciti_link_peer_rssi(signed char rssi)
+{
+}
+
+void simpliciti_link_temperature(signed short degrees)
+{
+}
+
+
+// *************************************************************************************************
+// Core stand-ins
+
+void SetVCore(unsigned char level)
+{
+}
+
+// No painted stack on the host
+void stack_paint(void)
+{
+}
+
+u16 stack_high_water(void)
+{
+	return (0);
+}
+
+
+#ifdef CONFIG_INFOMEM
+// *************************************************************************************************
+// Information memory stand-ins, an empty store that drops writes. Settings and the doorlock start
+// from their defaults on every run.
+
+s16 infomem_ready(void)
+{
+	return (0);
+}
+
+s16 infomem_init(u16 start, u16 end)
+{
+	return (0);
+}
+
+s16 infomem_app_amount(u8 identifier)
+{
+	return (0);
+}
+
+s16 infomem_app_read(u8 identifier, u16 * data, u8 count, u8 offset)
+{
+	return (0);
+}
+
+s16 infomem_app_replace(u8 identifier, u16 * data, u8 count)
+{
+	return (0);
+}
+
+s16 infomem_app_clear(u8 identifier)
+{
+	return (0);
+}
+#endif
+
+
+#ifdef CONFIG_CRASH_LOG
+// *************************************************************************************************
+// Crash log stand-ins, the emulator has no watchdog and no reset to survive
+
+struct crash sCrash;
+
+void crash_restore(void)
+{
+}
+
+void crash_kick(void)
+{
+}
+
+void crash_tick(void)
+{
+}
+
+void crash_trace(u16 event)
+{
+}
+
+void crash_disarm(void)
+{
+}
+
+u8 crash_read(u16 * record)
+{
+	// No record stored
+	return (0);
+}
+#endif
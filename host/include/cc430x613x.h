@@ -0,0 +1,273 @@
+// *************************************************************************************************
+//
+// Host stand-in for the CC430F613x device header.
+//
+// Used when the firmware is built with the native compiler (EZCHRONOS_HOST). Peripheral
+// registers are plain variables defined in host/cc430_regs.c, so code that writes them
+// compiles and runs but has no side effects. Only registers and bits used by the host
+// builds are provided, bit values are the ones of the device header.
+//
+// The firmware emulator (EZCHRONOS_EMULATOR, host/emulator.c) gives some of them behaviour:
+// SR intrinsics enter the emulator's low power mode, reads of P2IN and UCA0RXBUF and accesses
+// to PJOUT/PJDIR go through the emulated ports and sensor buses.
+//
+// *************************************************************************************************
+
+#ifndef CC430X613X_HOST_H_
+#define CC430X613X_HOST_H_
+
+#include <stdint.h>
+
+// *************************************************************************************************
+// Standard bits
+
+#define BIT0                (0x0001)
+#define BIT1                (0x0002)
+#define BIT2                (0x0004)
+#define BIT3                (0x0008)
+#define BIT4                (0x0010)
+#define BIT5                (0x0020)
+#define BIT6                (0x0040)
+#define BIT7                (0x0080)
+#define BIT8                (0x0100)
+#define BIT9                (0x0200)
+#define BITA                (0x0400)
+#define BITB                (0x0800)
+#define BITC                (0x1000)
+#define BITD                (0x2000)
+#define BITE                (0x4000)
+#define BITF                (0x8000)
+
+// *************************************************************************************************
+// Status register
+
+#define GIE                 (0x0008)
+#define CPUOFF              (0x0010)
+#define OSCOFF              (0x0020)
+#define SCG0                (0x0040)
+#define SCG1                (0x0080)
+
+#define LPM0_bits           (CPUOFF)
+#define LPM3_bits           (SCG1+SCG0+CPUOFF)
+#define LPM4_bits           (SCG1+SCG0+OSCOFF+CPUOFF)
+
+#ifdef EZCHRONOS_EMULATOR
+// Intrinsics, implemented by the emulator
+extern void cc430_bis_sr(uint16_t bits);
+extern void cc430_bic_sr(uint16_t bits);
+extern void cc430_bic_sr_irq(uint16_t bits);
+
+#define _BIS_SR(x)                      cc430_bis_sr(x)
+#define _BIC_SR(x)                      cc430_bic_sr(x)
+#define _BIC_SR_IRQ(x)                  cc430_bic_sr_irq(x)
+#define __bis_SR_register(x)            cc430_bis_sr(x)
+#define __bic_SR_register(x)            cc430_bic_sr(x)
+#define __bic_SR_register_on_exit(x)    cc430_bic_sr_irq(x)
+#define __enable_interrupt()            cc430_bis_sr(GIE)
+#define __disable_interrupt()           cc430_bic_sr(GIE)
+#define __no_operation()
+
+// ISRs are plain functions called by the emulator
+#define interrupt(vector)   void
+#endif
+
+// *************************************************************************************************
+// Special function registers and system reset
+
+extern volatile uint16_t SFRIFG1;
+
+#define OFIFG               (0x0002)
+
+// *************************************************************************************************
+// Watchdog timer
+
+extern volatile uint16_t WDTCTL;
+
+#define WDTPW               (0x5A00)
+#define WDTHOLD             (0x0080)
+#define WDTCNTCL            (0x0008)
+#define WDTSSEL__ACLK       (0x0020)
+#define WDTIS__512K         (0x0003)
+
+// *************************************************************************************************
+// Digital I/O
+
+extern volatile uint8_t P1IN, P1OUT, P1DIR, P1REN, P1SEL, P1IE, P1IES, P1IFG;
+extern volatile uint8_t P2OUT, P2DIR, P2REN, P2SEL, P2IE, P2IES, P2IFG;
+extern volatile uint8_t P5DIR, P5SEL;
+extern volatile uint8_t PJREN;
+
+#ifdef EZCHRONOS_EMULATOR
+// Buttons and sensor interrupt lines change while the firmware polls them. PJ carries the
+// bit-banged pressure sensor bus and the acceleration sensor select, every access is seen by
+// the emulated devices before it takes effect.
+extern uint8_t cc430_p2in(void);
+extern uint8_t cc430_pjin(void);
+extern volatile uint8_t * cc430_pj(volatile uint8_t * reg);
+extern volatile uint8_t cc430_pjout, cc430_pjdir;
+#define P2IN                (cc430_p2in())
+#define PJIN                (cc430_pjin())
+#define PJOUT               (*cc430_pj(&cc430_pjout))
+#define PJDIR               (*cc430_pj(&cc430_pjdir))
+#else
+extern volatile uint8_t P2IN, PJIN, PJOUT, PJDIR;
+#endif
+
+// *************************************************************************************************
+// Flash controller
+
+extern volatile uint16_t FCTL1, FCTL3;
+
+#define FWKEY               (0xA500)
+#define ERASE               (0x0002)
+#define WRT                 (0x0040)
+#define BUSY                (0x0001)
+#define LOCK                (0x0010)
+
+// *************************************************************************************************
+// Power management module
+
+extern volatile uint8_t PMMCTL0_H, PMMCTL0_L;
+
+#define PMMHPMRE            (0x0080)
+
+// *************************************************************************************************
+// Port mapping controller
+
+extern volatile uint16_t PMAPPWD;
+extern volatile uint8_t PMAPCTL;
+extern volatile uint8_t P1MAP[8], P2MAP[8];
+
+#define P1MAP0              (P1MAP[0])
+#define P2MAP0              (P2MAP[0])
+
+#define PMAPRECFG           (0x0002)
+#define PM_TA1CCR0A         (15)
+#define PM_UCA0SOMI         (17)
+#define PM_UCA0SIMO         (18)
+#define PM_UCA0CLK          (19)
+
+// *************************************************************************************************
+// Unified clock system
+
+extern volatile uint16_t UCSCTL0, UCSCTL1, UCSCTL2, UCSCTL3, UCSCTL4, UCSCTL5, UCSCTL6, UCSCTL7;
+
+#define DCORSEL_5           (0x0050)
+#define FLLD_1              (0x1000)
+#define SELA__XT1CLK        (0x0000)
+#define SELS__DCOCLKDIV     (0x0040)
+#define SELM__DCOCLKDIV     (0x0004)
+#define DIVM__1             (0x0000)
+#define DIVM__4             (0x0002)
+#define DIVS__1             (0x0000)
+#define DIVS__4             (0x0020)
+#define XT1OFF              (0x0001)
+#define XCAP_3              (0x000C)
+#define DCOFFG              (0x0001)
+#define XT1LFOFFG           (0x0002)
+#define XT1HFOFFG           (0x0004)
+#define XT2OFFG             (0x0008)
+
+// *************************************************************************************************
+// Timer_A
+
+extern volatile uint16_t TA0CTL, TA0R, TA0IV;
+extern volatile uint16_t TA0CCTL0, TA0CCTL1, TA0CCTL2, TA0CCTL3, TA0CCTL4;
+extern volatile uint16_t TA0CCR0, TA0CCR1, TA0CCR2, TA0CCR3, TA0CCR4;
+extern volatile uint16_t TA1CTL, TA1R, TA1CCTL0, TA1CCR0;
+
+#define TASSEL0             (0x0100)
+#define TASSEL__ACLK        (0x0100)
+#define MC0                 (0x0010)
+#define MC1                 (0x0020)
+#define MC_1                (0x0010)
+#define MC_2                (0x0020)
+#define TACLR               (0x0004)
+#define CCIE                (0x0010)
+#define CCIFG               (0x0001)
+#define OUTMOD_4            (0x0080)
+
+// *************************************************************************************************
+// Reference and ADC12_A
+
+extern volatile uint16_t REFCTL0;
+extern volatile uint16_t ADC12CTL0, ADC12CTL1, ADC12IE, ADC12IFG, ADC12IV, ADC12MEM0;
+extern volatile uint8_t ADC12MCTL0;
+
+#define REFMSTR             (0x0080)
+#define REFON               (0x0001)
+#define REFVSEL_0           (0x0000)
+#define REFVSEL_1           (0x0010)
+#define REFVSEL_3           (0x0030)
+
+#define ADC12SC             (0x0001)
+#define ADC12ENC            (0x0002)
+#define ADC12ON             (0x0010)
+#define ADC12SHT0_8         (0x0800)
+#define ADC12SHT0_10        (0x0A00)
+#define ADC12SHP            (0x0200)
+#define ADC12SREF_1         (0x0010)
+#define ADC12INCH_10        (0x000A)
+#define ADC12INCH_11        (0x000B)
+
+// *************************************************************************************************
+// LCD_B. LCDMEM holds the segment memory at 0x0A20 followed by the blink memory at 0x0A40.
+
+extern volatile uint16_t LCDBCTL0, LCDBVCTL, LCDBPCTL0, LCDBPCTL1, LCDBMEMCTL, LCDBBLKCTL;
+extern uint8_t LCDMEM[0x40];
+
+#define LCDON               (0x0001)
+#define LCD4MUX             (0x0018)
+#define LCDPRE0             (0x0100)
+#define LCDPRE1             (0x0200)
+#define LCDDIV0             (0x0800)
+#define LCDDIV1             (0x1000)
+#define LCDDIV2             (0x2000)
+#ifdef EZCHRONOS_EMULATOR
+// The clear bits take effect when they are written, before the firmware draws again. They are
+// only ever written, so the emulator clears the memory when the constant is evaluated.
+extern uint16_t cc430_lcd_clear(uint16_t bit);
+#define LCDCLRM             (cc430_lcd_clear(0x0002))
+#define LCDCLRBM            (cc430_lcd_clear(0x0004))
+#else
+#define LCDCLRM             (0x0002)
+#define LCDCLRBM            (0x0004)
+#endif
+#define LCDBLKMOD0          (0x0001)
+#define LCDBLKMOD1          (0x0002)
+#define LCDBLKPRE0          (0x0004)
+#define LCDBLKPRE1          (0x0008)
+#define LCDBLKDIV0          (0x0020)
+#define LCDBLKDIV1          (0x0040)
+#define LCDBLKDIV2          (0x0080)
+
+// *************************************************************************************************
+// USCI_A0 in SPI mode
+
+extern volatile uint8_t UCA0CTL0, UCA0CTL1, UCA0BR0, UCA0BR1, UCA0IFG;
+
+#ifdef EZCHRONOS_EMULATOR
+// A read of RXBUF completes the transfer of the byte last written to TXBUF
+extern uint8_t cc430_uca0_rx(void);
+extern volatile uint8_t * cc430_uca0_tx(void);
+#define UCA0RXBUF           (cc430_uca0_rx())
+#define UCA0TXBUF           (*cc430_uca0_tx())
+#else
+extern volatile uint8_t UCA0RXBUF, UCA0TXBUF;
+#endif
+
+#define UCSWRST             (0x0001)
+#define UCSSEL1             (0x0080)
+#define UCSYNC              (0x0001)
+#define UCMST               (0x0008)
+#define UCMSB               (0x0020)
+#define UCCKPH              (0x0080)
+#define UCRXIFG             (0x0001)
+#define UCTXIFG             (0x0002)
+
+// *************************************************************************************************
+// Information memory segment D, erased state after reset
+
+extern uint8_t INFOD[128];
+
+#endif /*CC430X613X_HOST_H_*/
@@ -0,0 +1,991 @@
+// *************************************************************************************************
+//
+// Record/replay harness for the sensor driven logic modules.
+//
+// Replays a recording of raw sensor samples and button events through the unmodified logic
+// modules, as fast as the host allows, and prints what they computed. Driver calls below the
+// logic layer are served by host/replay_drivers.c, the 1Hz tick, Timer0_A1 and the sensor DRDY
+// interrupts are scheduled here on a simulated 32768Hz clock, so every run is deterministic.
+//
+//   altitude     - do_altitude_measurement() on every pressure sample, timeout as in timer.c
+//   vario        - altitude plus display_vario()/chirp() once per second, beep mode "both"
+//   accumulator  - altitude_accumulator_periodic() once per minute, with the statistics of the
+//                  track recorder on every new peak or dip
+//   phase        - motion detection on the acceleration samples, phase_clock_epoch() once a minute
+//   doorlock     - doorlock_sequence() called repeatedly until the recording ends, knocks are
+//                  detected on every acceleration sample as in the port ISR. The first sequence is
+//                  enrolled, the following ones are matched against it
+//   weather      - weather_tick() once per second, weather_process() on its requests and on the
+//                  DRDY of its triggered conversions, one output per stored sample
+//
+// Recording format, one event per line, time in milliseconds, '#' starts a comment:
+//
+//   <ms> P <pressure Pa> <temperature 0.1K>    ps_get_pa(), ps_get_temp()
+//   <ms> A <x> <y> <z>                         as_get_data(), raw counts 0..255
+//   <ms> B <button>                            star num up down backlight star_long num_long
+//
+// Output lines have the same shape, "<ms> <key> <value> ...". An earlier output, or ground
+// truth in that format, can be given as reference: every output value is compared to the last
+// reference line of the same key that is not newer, and the deviation is reported per column.
+//
+// The host time spent inside each module function is measured and scaled to MSP430 cycles with
+// -s (MSP430 cycles per host nanosecond). The default is a rough figure for a 3GHz host against
+// mspgcc -Os code; calibrate it once against the CONFIG_PROFILE active time of the same screen.
+//
+// Usage: replay [-m mode] [-r reference] [-e tolerance] [-h altitude] [-a hh:mm] [-s scale] [-q] recording
+//
+// *************************************************************************************************
+
+// *************************************************************************************************
+// Include section
+
+// system
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <setjmp.h>
+#include <time.h>
+#include "project.h"
+
+// driver
+#include "display.h"
+#include "vti_ps.h"
+#include "vti_as.h"
+#include "ports.h"
+#include "timer.h"
+
+// logic
+#include "altitude.h"
+#include "vario.h"
+#include "phase_clock.h"
+#include "sequence.h"
+#include "weather.h"
+#include "track.h"
+#include "acceleration.h"
+#include "clock.h"
+#include "alarm.h"
+
+#include "replay.h"
+
+
+// *************************************************************************************************
+// Prototypes section
+static u8 replay_step(void);
+static uint64_t replay_pending(u8 * source);
+
+
+// *************************************************************************************************
+// Defines section
+
+#define REPLAY_MAX_VALUES			(1u + DOORLOCK_SEQUENCE_MAX_LENGTH)
+#define REPLAY_MAX_KEYS				(8u)
+
+// Acceleration samples are polled every 60ms
+#define REPLAY_SAMPLE_PERIOD		REPLAY_MS_TO_TICKS(60)
+
+// Change of a raw axis value that the sensor's motion detection reports, about 70mg
+#define REPLAY_MOTION_COUNTS		(4)
+
+// Scheduler sources
+#define REPLAY_SOURCE_TICK			(0u)
+#define REPLAY_SOURCE_EVENT			(1u)
+#define REPLAY_SOURCE_TIMER_A1		(2u)
+#define REPLAY_SOURCE_SAMPLE		(3u)
+
+// Default MSP430 cycles per host nanosecond
+#define REPLAY_SCALE				(25.0)
+
+// Module functions whose cost is measured
+enum
+{
+	COST_ALTITUDE = 0,
+	COST_ACCUMULATOR,
+	COST_VARIO,
+	COST_PHASE,
+	COST_DOORLOCK,
+	COST_DOORLOCK_MATCH,
+	COST_WEATHER,
+	COST_COUNT
+};
+
+// Recorded event
+struct replay_event
+{
+	u32		ms;
+	char	type;
+	s32		value[3];
+};
+
+// Reference results of one key
+struct replay_reference
+{
+	char	key[16];
+	u32		count;
+	u32		next;
+	u32 *	ms;
+	s32 *	value;			// REPLAY_MAX_VALUES per line
+	u8 *	columns;
+	// Deviation of the output from the reference, per column
+	u32		n[REPLAY_MAX_VALUES];
+	s32		max[REPLAY_MAX_VALUES];
+	double	sum[REPLAY_MAX_VALUES];
+	s32		first[REPLAY_MAX_VALUES];
+	s32		last[REPLAY_MAX_VALUES];
+	u32		unmatched;
+};
+
+// Replay mode
+struct replay_mode
+{
+	const char * name;
+	void (*pressure)(void);
+	void (*accel)(void);		// sensor interrupt of an acceleration sample
+	void (*button)(u8 index);
+	void (*tick)(void);
+	void (*sample)(void);		// every REPLAY_SAMPLE_PERIOD
+	void (*run)(void);
+};
+
+
+// *************************************************************************************************
+// Global Variable section
+
+uint64_t replay_now;
+
+static struct replay_event * replay_events;
+static u32 replay_count;
+static u32 replay_next;
+
+// Scheduler
+static uint64_t replay_tick_next;
+static uint64_t replay_a1_next;
+static u16 replay_a1_period;
+static uint64_t replay_sample_next;
+static jmp_buf replay_end;
+static u32 replay_seconds;
+
+// Options
+static const struct replay_mode * replay_mode;
+static u8 replay_quiet;
+static s16 replay_altitude;
+static u8 replay_calibrate;
+static double replay_scale = REPLAY_SCALE;
+static s32 replay_tolerance;
+
+// Results
+static struct replay_reference replay_ref[REPLAY_MAX_KEYS];
+static u8 replay_ref_keys;
+static u32 replay_outputs;
+static struct
+{
+	const char *	name;
+	u32				calls;
+	uint64_t				ns;
+} replay_cost[COST_COUNT] =
+{
+	{ "do_altitude_measurement" },
+	{ "altitude_accumulator_periodic" },
+	{ "display_vario" },
+	{ "phase_clock_epoch" },
+	{ "doorlock_sequence" },
+	{ "sequence_match" },
+	{ "weather_process" },
+};
+static uint64_t replay_harness_ns;
+static uint64_t replay_timer_overhead;
+
+static const char * const replay_buttons[] = { "star", "num", "up", "down", "backlight", "star_long", "num_long" };
+
+
+// *************************************************************************************************
+// Extern section
+
+// driver/vti_ps.c
+extern u8 ps_ok;
+
+// logic/altitude.c, not in altitude.h
+extern u8  alt_accum_enable;
+extern s32 alt_accum__accumtotal;
+extern s32 alt_accum_max;
+extern void altitude_accumulator_start(void);
+
+
+// *************************************************************************************************
+// @fn          replay_clock
+// @brief       Host time for cost measurement.
+// @param       none
+// @return      uint64_t		nanoseconds
+// *************************************************************************************************
+static uint64_t replay_clock(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000u + now.tv_nsec;
+}
+
+
+// *************************************************************************************************
+// @fn          replay_cost_begin, replay_cost_end
+// @brief       Measure host time of one module call, without time spent back in the harness
+//				(idle_loop and delays of blocking modules) and without the clock overhead.
+// @param       u8 id		COST_xxx
+// @return      none
+// *************************************************************************************************
+static uint64_t replay_cost_start;
+static uint64_t replay_cost_harness;
+
+static void replay_cost_begin(void)
+{
+	replay_cost_harness = replay_harness_ns;
+	replay_cost_start = replay_clock();
+}
+
+static void replay_cost_end(u8 id)
+{
+	uint64_t ns = replay_clock() - replay_cost_start - (replay_harness_ns - replay_cost_harness);
+
+	replay_cost[id].calls++;
+	replay_cost[id].ns += (ns > replay_timer_overhead) ? ns - replay_timer_overhead : 0;
+}
+
+
+// *************************************************************************************************
+// @fn          replay_load
+// @brief       Read a recording. Events must be in time order.
+// @param       const char * path
+// @return      u8		1 = ok, 0 = error (reported)
+// *************************************************************************************************
+static u8 replay_load(const char * path)
+{
+	FILE * f = fopen(path, "r");
+	char line[128], name[16];
+	u32 size = 0, number = 0;
+	struct replay_event e;
+	u8 i;
+
+	if (f == NULL)
+	{
+		perror(path);
+		return 0;
+	}
+	while (fgets(line, sizeof(line), f))
+	{
+		number++;
+		if ((line[0] == '#') || (strspn(line, " \t\r\n") == strlen(line))) continue;
+
+		memset(&e, 0, sizeof(e));
+		if (sscanf(line, "%u %c", &e.ms, &e.type) != 2) goto error;
+		switch (e.type)
+		{
+			case 'P':	if (sscanf(line, "%*u %*c %d %d", &e.value[0], &e.value[1]) != 2) goto error;
+						break;
+			case 'A':	if (sscanf(line, "%*u %*c %d %d %d", &e.value[0], &e.value[1], &e.value[2]) != 3) goto error;
+						break;
+			case 'B':	if (sscanf(line, "%*u %*c %15s", name) != 1) goto error;
+						for (i=0; i<sizeof(replay_buttons)/sizeof(replay_buttons[0]); i++)
+						{
+							if (strcmp(name, replay_buttons[i]) == 0) break;
+						}
+						if (i == sizeof(replay_buttons)/sizeof(replay_buttons[0])) goto error;
+						e.value[0] = i;
+						break;
+			default:	goto error;
+		}
+		if (replay_count && (e.ms < replay_events[replay_count-1].ms)) goto error;
+
+		if (replay_count == size)
+		{
+			size = size ? size * 2 : 1024;
+			replay_events = realloc(replay_events, size * sizeof(struct replay_event));
+		}
+		replay_events[replay_count++] = e;
+	}
+	fclose(f);
+	return 1;
+
+error:
+	fprintf(stderr, "%s:%u: bad event: %s", path, number, line);
+	fclose(f);
+	return 0;
+}
+
+
+// *************************************************************************************************
+// @fn          replay_load_reference
+// @brief       Read reference results, lines "<ms> <key> <value> ..." in time order.
+// @param       const char * path
+// @return      u8		1 = ok, 0 = error (reported)
+// *************************************************************************************************
+static u8 replay_load_reference(const char * path)
+{
+	FILE * f = fopen(path, "r");
+	char line[256], key[16], * p;
+	struct replay_reference * r;
+	u32 ms;
+	int used;
+	u8 i, n;
+
+	if (f == NULL)
+	{
+		perror(path);
+		return 0;
+	}
+	while (fgets(line, sizeof(line), f))
+	{
+		if ((line[0] == '#') || (sscanf(line, "%u %15s%n", &ms, key, &used) != 2)) continue;
+
+		for (i=0; (i<replay_ref_keys) && strcmp(replay_ref[i].key, key); i++);
+		if (i == replay_ref_keys)
+		{
+			if (replay_ref_keys == REPLAY_MAX_KEYS) continue;
+			strcpy(replay_ref[replay_ref_keys++].key, key);
+		}
+		r = &replay_ref[i];
+		if ((r->count & 1023) == 0)
+		{
+			r->ms = realloc(r->ms, (r->count + 1024) * sizeof(u32));
+			r->value = realloc(r->value, (r->count + 1024) * REPLAY_MAX_VALUES * sizeof(s32));
+			r->columns = realloc(r->columns, r->count + 1024);
+		}
+		p = line + used;
+		for (n=0; n<REPLAY_MAX_VALUES; n++)
+		{
+			if (sscanf(p, "%d%n", &r->value[r->count * REPLAY_MAX_VALUES + n], &used) != 1) break;
+			p += used;
+		}
+		r->ms[r->count] = ms;
+		r->columns[r->count] = n;
+		r->count++;
+	}
+	fclose(f);
+	return 1;
+}
+
+
+// *************************************************************************************************
+// @fn          replay_output
+// @brief       Print one result line and compare it to the reference.
+// @param       const char * key		result name
+//				u8 count				number of values
+//				const s32 * value		values
+// @return      none
+// *************************************************************************************************
+static void replay_output(const char * key, u8 count, const s32 * value)
+{
+	u32 ms = REPLAY_TICKS_TO_MS(replay_now);
+	struct replay_reference * r;
+	const s32 * ref;
+	s32 d;
+	u8 i;
+
+	replay_outputs++;
+	if (!replay_quiet)
+	{
+		printf("%u %s", ms, key);
+		for (i=0; i<count; i++) printf(" %d", value[i]);
+		printf("\n");
+	}
+
+	for (i=0; (i<replay_ref_keys) && strcmp(replay_ref[i].key, key); i++);
+	if (i == replay_ref_keys) return;
+	r = &replay_ref[i];
+
+	// Last reference line not newer than this output
+	while ((r->next < r->count) && (r->ms[r->next] <= ms)) r->next++;
+	if (r->next == 0)
+	{
+		r->unmatched++;
+		return;
+	}
+	ref = &r->value[(r->next - 1) * REPLAY_MAX_VALUES];
+	for (i=0; (i<count) && (i<r->columns[r->next - 1]); i++)
+	{
+		d = value[i] - ref[i];
+		if (r->n[i] == 0) r->first[i] = d;
+		r->last[i] = d;
+		r->n[i]++;
+		r->sum[i] += (d < 0) ? -d : d;
+		if (((d < 0) ? -d : d) > r->max[i]) r->max[i] = (d < 0) ? -d : d;
+	}
+}
+
+
+// *************************************************************************************************
+// @fn          replay_timer_a1
+// @brief       Timer0_A1_Start()/Timer0_A1_Stop() of the driver stand-ins.
+// @param       u16 ticks		period, 0 = stop
+// @return      none
+// *************************************************************************************************
+void replay_timer_a1(u16 ticks)
+{
+	replay_a1_period = ticks;
+	replay_a1_next = replay_now + ticks;
+}
+
+
+// *************************************************************************************************
+// @fn          replay_idle
+// @brief       idle_loop() of a blocking module: sleep until the next interrupt. Leaves the module
+//				through replay_end when the recording is over.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void replay_idle(void)
+{
+	uint64_t start = replay_clock();
+
+	if (!replay_step()) longjmp(replay_end, 1);
+	replay_harness_ns += replay_clock() - start;
+}
+
+
+// *************************************************************************************************
+// @fn          replay_delay
+// @brief       Timer0_A4_Delay(): interrupts that are due meanwhile are served.
+// @param       u16 ticks		delay
+// @return      none
+// *************************************************************************************************
+void replay_delay(u16 ticks)
+{
+	uint64_t start = replay_clock();
+	uint64_t end = replay_now + ticks;
+	u8 source;
+
+	while ((replay_pending(&source) <= end) && replay_step());
+	replay_now = end;
+	TA0R = (u16)replay_now;
+	replay_harness_ns += replay_clock() - start;
+}
+
+
+// *************************************************************************************************
+// @fn          replay_pending
+// @brief       Find what happens next: recorded event, 1Hz tick, Timer0_A1 or sampling period.
+//				On equal time the recorded event comes first.
+// @param       u8 * source		REPLAY_SOURCE_xxx
+// @return      uint64_t				time in ticks
+// *************************************************************************************************
+static uint64_t replay_pending(u8 * source)
+{
+	uint64_t next = replay_tick_next;
+
+	*source = REPLAY_SOURCE_TICK;
+	if ((replay_next < replay_count) && (REPLAY_MS_TO_TICKS(replay_events[replay_next].ms) <= next))
+	{
+		next = REPLAY_MS_TO_TICKS(replay_events[replay_next].ms);
+		*source = REPLAY_SOURCE_EVENT;
+	}
+	if (replay_a1_period && (replay_a1_next < next))
+	{
+		next = replay_a1_next;
+		*source = REPLAY_SOURCE_TIMER_A1;
+	}
+	if (replay_mode->sample && (replay_sample_next < next))
+	{
+		next = replay_sample_next;
+		*source = REPLAY_SOURCE_SAMPLE;
+	}
+	return next;
+}
+
+
+// *************************************************************************************************
+// @fn          replay_step
+// @brief       Advance the simulated clock to the next event or timer and serve it.
+// @param       none
+// @return      u8		0 = recording is over
+// *************************************************************************************************
+static u8 replay_step(void)
+{
+	struct replay_event * e;
+	u8 source;
+	uint64_t next = replay_pending(&source);
+
+	// Timers are only served while there is recorded input
+	if (next > REPLAY_MS_TO_TICKS(replay_events[replay_count-1].ms)) return 0;
+	replay_now = next;
+	TA0R = (u16)replay_now;
+
+	switch (source)
+	{
+		case REPLAY_SOURCE_TICK:
+				replay_tick_next += REPLAY_ACLK;
+				replay_seconds++;
+				sTime.second = replay_seconds % 60;
+				sTime.minute = (replay_seconds / 60) % 60;
+				sTime.hour = (replay_seconds / 3600) % 24;
+				display.flag.update_time = 1;
+				if (replay_mode->tick) replay_mode->tick();
+				display.flag.update_time = 0;
+				break;
+
+		case REPLAY_SOURCE_EVENT:
+				e = &replay_events[replay_next++];
+				switch (e->type)
+				{
+					case 'P':	sReplaySensors.pa = e->value[0];
+								sReplaySensors.temp = e->value[1];
+								sReplaySensors.pressure_valid = 1;
+								PS_INT_IN |= PS_INT_PIN;
+								if (replay_mode->pressure) replay_mode->pressure();
+								break;
+					case 'A':	sReplaySensors.xyz[0] = e->value[0];
+								sReplaySensors.xyz[1] = e->value[1];
+								sReplaySensors.xyz[2] = e->value[2];
+								request.flag.acceleration_measurement = 1;
+								if (replay_mode->accel) replay_mode->accel();
+								break;
+					case 'B':	button.all_flags |= 1u << e->value[0];
+								if (replay_mode->button) replay_mode->button(e->value[0]);
+								button.all_flags = 0;
+								break;
+				}
+				break;
+
+		case REPLAY_SOURCE_TIMER_A1:
+				replay_a1_next += replay_a1_period;
+				if (fptr_Timer0_A1_function) fptr_Timer0_A1_function();
+				break;
+
+		case REPLAY_SOURCE_SAMPLE:
+				replay_sample_next += REPLAY_SAMPLE_PERIOD;
+				replay_mode->sample();
+				break;
+	}
+	return 1;
+}
+
+
+// *************************************************************************************************
+// Altitude
+
+static void replay_altitude_output(void)
+{
+	s32 v[3];
+
+	v[0] = sAlt.altitude;
+	v[1] = sAlt.pressure;
+	v[2] = sAlt.temperature;
+	replay_output("alt", 3, v);
+}
+
+static void replay_altitude_first(void)
+{
+	// Power-on of the altimeter: pressure table, single conversion, optional calibration
+	ps_ok = 1;
+	reset_altitude_measurement();
+	if (replay_calibrate) update_pressure_table(replay_altitude, sAlt.pressure, sAlt.temperature);
+	replay_calibrate = 0;
+}
+
+static void replay_altitude_pressure(void)
+{
+	if (!ps_ok) replay_altitude_first();
+
+	// Altitude screen stays open, restart the measurement after its timeout as the user would
+	if (!is_altitude_measurement())
+	{
+		sAlt.state = MENU_ITEM_VISIBLE;
+		replay_cost_begin();
+		start_altitude_measurement();
+		replay_cost_end(COST_ALTITUDE);
+	}
+	else
+	{
+		// PORT2 DRDY interrupt sets request.flag.altitude_measurement, served by the main loop
+		replay_cost_begin();
+		do_altitude_measurement(FILTER_ON);
+		replay_cost_end(COST_ALTITUDE);
+	}
+	replay_altitude_output();
+}
+
+static void replay_altitude_tick(void)
+{
+	// Same countdown as the 1Hz timer interrupt
+	if (is_altitude_measurement())
+	{
+		sAlt.timeout--;
+		if (sAlt.timeout == 0) stop_altitude_measurement();
+	}
+}
+
+
+// *************************************************************************************************
+// Vario
+
+static void replay_vario_pressure(void)
+{
+	if (!ps_ok)
+	{
+		replay_altitude_first();
+
+		// Beep mode "both" so that every change is reported by chirp()
+		mx_vario(LINE2);
+		mx_vario(LINE2);
+		mx_vario(LINE2);
+	}
+	replay_altitude_pressure();
+}
+
+static void replay_vario_button(u8 index)
+{
+	// DOWN changes the view, long # the beep mode or clears statistics (menu.c)
+	if (button.flag.down) sx_vario(LINE2);
+	if (button.flag.num_long) mx_vario(LINE2);
+}
+
+static void replay_vario_tick(void)
+{
+	s32 v[4];
+	char * p;
+
+	replay_altitude_tick();
+	if (!ps_ok) return;
+
+	memset(&sReplayOutputs, 0, sizeof(sReplayOutputs));
+	memset(sReplayOutputs.line2, ' ', 6);
+	replay_cost_begin();
+	display_vario(LINE2, DISPLAY_LINE_UPDATE_PARTIAL);
+	replay_cost_end(COST_VARIO);
+
+	// Line 2 as a number, e.g. "-  050" with decimal point is -0.50m/s = -50
+	v[0] = 0;
+	for (p = sReplayOutputs.line2; *p; p++)
+	{
+		if ((*p >= '0') && (*p <= '9')) v[0] = v[0] * 10 + (*p - '0');
+		else if (*p != ' ' && *p != '-') return;
+	}
+	if (strchr(sReplayOutputs.line2, '-')) v[0] = -v[0];
+	replay_output("vario", 1, v);
+
+	if (sReplayOutputs.chirps)
+	{
+		v[0] = sReplayOutputs.chirps;
+		v[1] = sReplayOutputs.chirp_on;
+		v[2] = sReplayOutputs.chirp_off;
+		v[3] = sReplayOutputs.chirp_steps;
+		replay_output("chirp", 4, v);
+	}
+}
+
+
+// *************************************************************************************************
+// Altitude accumulator
+
+static void replay_accumulator_pressure(void)
+{
+	if (ps_ok) return;
+
+	replay_altitude_first();
+	alt_accum_enable = 1;
+	altitude_accumulator_start();
+}
+
+static void replay_accumulator_tick(void)
+{
+	static u8 count;
+	s32 v[6];
+
+	// Once a minute, as requested by the clock tick
+	if ((sTime.second != 0) || !alt_accum_enable) return;
+
+	replay_cost_begin();
+	altitude_accumulator_periodic();
+	replay_cost_end(COST_ACCUMULATOR);
+
+	v[0] = alt_accum__accumtotal;
+	v[1] = alt_accum_max;
+	v[2] = sAlt.altitude;
+	replay_output("accu", 3, v);
+
+	if (sTrack.count != count)
+	{
+		count = sTrack.count;
+		v[0] = sTrack.altitude;
+		v[1] = sTrack.ascent;
+		v[2] = sTrack.descent;
+		v[3] = sTrack.climbs;
+		v[4] = sTrack.climb_gain;
+		v[5] = sTrack.climb_rate;
+		replay_output("track", 6, v);
+	}
+}
+
+
+// *************************************************************************************************
+// Phase clock
+
+static void replay_phase_sample(void)
+{
+	static u8 last[3];
+	static u8 valid;
+	u8 moved = 0;
+	u8 i;
+
+	// Motion detection of the sensor, the recorder only sees the interrupt
+	if (!request.flag.acceleration_measurement) return;
+	request.flag.acceleration_measurement = 0;
+	as_get_data(sAccel.xyz);
+
+	for (i=0; i<3; i++)
+	{
+		if (abs((s16)sAccel.xyz[i] - last[i]) >= REPLAY_MOTION_COUNTS) moved = 1;
+	}
+	if (moved || !valid) memcpy(last, sAccel.xyz, 3);
+	if (moved && valid && (sPhase.state == PHASE_RECORDING)) phase_clock_interrupt();
+	valid = 1;
+}
+
+static void replay_phase_tick(void)
+{
+	s32 v[2];
+
+	// Recording starts with the replay, as if DOWN was pressed at 00:00
+	if (replay_seconds == 1)
+	{
+		reset_phase_clock();
+		sx_phase(LINE2);
+	}
+	if (sPhase.state != PHASE_RECORDING) return;
+
+	phase_clock_tick();
+	if (!request.flag.phase_clock) return;
+	request.flag.phase_clock = 0;
+
+	replay_cost_begin();
+	phase_clock_epoch();
+	replay_cost_end(COST_PHASE);
+
+	v[0] = phase_clock_log(PHASE_LOG_HEADER + sPhase.epochs - 1);
+	replay_output("epoch", 1, v);
+	if (phase_clock_log(PHASE_LOG_WAKE) != FLASH_ERASED)
+	{
+		v[0] = (phase_clock_log(PHASE_LOG_WAKE) << 8) | phase_clock_log(PHASE_LOG_WAKE + 1);
+		v[1] = sAlarm.state;
+		replay_output("wake", 2, v);
+	}
+}
+
+
+// *************************************************************************************************
+// Door lock
+
+static void replay_doorlock_accel(void)
+{
+	// Knocks are detected in the port ISR
+	if (DOORLOCK_CAPTURING) doorlock_sample(as_get_z());
+}
+
+static void replay_doorlock_run(void)
+{
+	static u8 sequence[DOORLOCK_SEQUENCE_MAX_LENGTH];
+	static u8 pattern[1][DOORLOCK_SEQUENCE_MAX_LENGTH];
+	static u8 enrolled = 0;
+	s32 v[REPLAY_MAX_VALUES];
+	u8 i;
+
+	if (setjmp(replay_end)) return;
+	for (;;)
+	{
+		replay_cost_begin();
+		v[0] = doorlock_sequence(sequence);
+		replay_cost_end(COST_DOORLOCK);
+		for (i=0; i<DOORLOCK_SEQUENCE_MAX_LENGTH; i++) v[1+i] = sequence[i];
+		replay_output("doorlock", REPLAY_MAX_VALUES, v);
+		if (v[0] != DOORLOCK_ERROR_SUCCESS) continue;
+
+		// First sequence is the enrolled pattern, the following ones are matched against it
+		if (!enrolled)
+		{
+			memcpy(pattern[0], sequence, DOORLOCK_SEQUENCE_MAX_LENGTH);
+			enrolled = 1;
+			continue;
+		}
+		replay_cost_begin();
+		v[0] = sequence_match(sequence, pattern, 1);
+		replay_cost_end(COST_DOORLOCK_MATCH);
+		v[1] = sequence_distance(pattern[0], sequence);
+		replay_output("match", 2, v);
+	}
+}
+
+// *************************************************************************************************
+// Weather trend
+
+static void replay_weather_process(void)
+{
+	u16 head = sWeather.head;
+	u16 pressure = sWeather.pressure;
+	s32 v[5];
+
+	if (!request.flag.weather) return;
+	request.flag.weather = 0;
+
+	memset(&sReplayOutputs, 0, sizeof(sReplayOutputs));
+	replay_cost_begin();
+	weather_process();
+	replay_cost_end(COST_WEATHER);
+
+	if ((sWeather.head == head) && (sWeather.pressure == pressure)) return;
+	v[0] = (s32)sWeather.pressure * WEATHER_UNIT;
+	v[1] = sWeather.tendency;
+	v[2] = sWeather.level;
+	v[3] = sWeather.forecast;
+	v[4] = sWeather.count;
+	replay_output("weather", 5, v);
+
+	if (sReplayOutputs.chirps)
+	{
+		v[0] = sWeather.tendency;
+		v[1] = sReplayOutputs.chirps;
+		replay_output("storm", 2, v);
+	}
+}
+
+static void replay_weather_pressure(void)
+{
+	// PORT2 DRDY interrupt of a triggered conversion
+	if (sWeather.converting) request.flag.weather = 1;
+	replay_weather_process();
+}
+
+static void replay_weather_tick(void)
+{
+	// Trend runs from power-on
+	if (replay_seconds == 1)
+	{
+		ps_ok = 1;
+		reset_weather();
+	}
+
+	weather_tick();
+	replay_weather_process();
+}
+
+static void replay_run(void)
+{
+	while (replay_step());
+}
+
+static const struct replay_mode replay_modes[] =
+{
+	{ "altitude",		replay_altitude_pressure,		NULL,					NULL,					replay_altitude_tick,		NULL,					replay_run },
+	{ "vario",			replay_vario_pressure,			NULL,					replay_vario_button,	replay_vario_tick,			NULL,					replay_run },
+	{ "accumulator",	replay_accumulator_pressure,	NULL,					NULL,					replay_accumulator_tick,	NULL,					replay_run },
+	{ "phase",			NULL,							NULL,					NULL,					replay_phase_tick,			replay_phase_sample,	replay_run },
+	{ "doorlock",		NULL,							replay_doorlock_accel,	NULL,					NULL,						NULL,					replay_doorlock_run },
+	{ "weather",		replay_weather_pressure,		NULL,					NULL,					replay_weather_tick,		NULL,					replay_run },
+};
+
+
+// *************************************************************************************************
+// @fn          replay_report
+// @brief       Print module cost and deviation from the reference to stderr.
+// @param       double host_s		host run time
+// @return      u8		1 = within tolerance
+// *************************************************************************************************
+static u8 replay_report(double host_s)
+{
+	struct replay_reference * r;
+	u8 ok = 1;
+	u8 i, c;
+
+	fprintf(stderr, "replayed %u events, %u s in %.3f s, %u outputs\n",
+			replay_count, replay_seconds, host_s, replay_outputs);
+	fprintf(stderr, "%-30s %8s %12s %14s\n", "function", "calls", "host ns/call", "msp430 cycles");
+	for (i=0; i<COST_COUNT; i++)
+	{
+		if (replay_cost[i].calls == 0) continue;
+		fprintf(stderr, "%-30s %8u %12.1f %14.0f\n", replay_cost[i].name, replay_cost[i].calls,
+				(double)replay_cost[i].ns / replay_cost[i].calls,
+				(double)replay_cost[i].ns / replay_cost[i].calls * replay_scale);
+	}
+
+	if (replay_ref_keys == 0) return 1;
+	fprintf(stderr, "%-12s %8s %8s %10s %8s %8s\n", "reference", "n", "max |d|", "mean |d|", "first d", "last d");
+	for (i=0; i<replay_ref_keys; i++)
+	{
+		r = &replay_ref[i];
+		for (c=0; c<REPLAY_MAX_VALUES; c++)
+		{
+			if (r->n[c] == 0) continue;
+			fprintf(stderr, "%-9s[%2u] %8u %8d %10.2f %8d %8d\n", r->key, c, r->n[c], r->max[c],
+					r->sum[c] / r->n[c], r->first[c], r->last[c]);
+			if (r->max[c] > replay_tolerance) ok = 0;
+		}
+		if (r->unmatched) fprintf(stderr, "%-12s %u outputs before the first reference line\n", r->key, r->unmatched);
+	}
+	if (!ok) fprintf(stderr, "deviation from reference above %d\n", replay_tolerance);
+	return ok;
+}
+
+
+// *************************************************************************************************
+// @fn          main
+// @brief       Parse options, load recording and reference, replay.
+// @param       int argc, char ** argv
+// @return      int		0 = ok, 1 = deviation above tolerance, 2 = usage or input error
+// *************************************************************************************************
+int main(int argc, char ** argv)
+{
+	const char * reference = NULL;
+	uint64_t start;
+	u8 i;
+	int c;
+
+	replay_mode = &replay_modes[0];
+	while ((c = getopt(argc, argv, "m:r:e:h:a:s:q")) != -1)
+	{
+		switch (c)
+		{
+			case 'm':	for (i=0; i<sizeof(replay_modes)/sizeof(replay_modes[0]); i++)
+						{
+							if (strcmp(optarg, replay_modes[i].name) == 0) replay_mode = &replay_modes[i];
+						}
+						if (strcmp(optarg, replay_mode->name)) goto usage;
+						break;
+			case 'r':	reference = optarg;
+						break;
+			case 'e':	replay_tolerance = atoi(optarg);
+						break;
+			case 'h':	replay_altitude = atoi(optarg);
+						replay_calibrate = 1;
+						break;
+			case 'a':	if (sscanf(optarg, "%hhu:%hhu", &sAlarm.hour, &sAlarm.minute) != 2) goto usage;
+						sAlarm.state = ALARM_ENABLED;
+						break;
+			case 's':	replay_scale = atof(optarg);
+						break;
+			case 'q':	replay_quiet = 1;
+						break;
+			default:	goto usage;
+		}
+	}
+	if (optind != argc - 1) goto usage;
+
+	if (!replay_load(argv[optind])) return 2;
+	if (replay_count == 0)
+	{
+		fprintf(stderr, "%s: no events\n", argv[optind]);
+		return 2;
+	}
+	if (reference && !replay_load_reference(reference)) return 2;
+
+	// Cost of the clock itself
+	start = replay_clock();
+	for (i=0; i<100; i++) replay_clock();
+	replay_timer_overhead = (replay_clock() - start) / 100;
+
+	replay_tick_next = REPLAY_ACLK;
+	replay_sample_next = REPLAY_SAMPLE_PERIOD;
+	start = replay_clock();
+	replay_mode->run();
+	return replay_report((replay_clock() - start) / 1e9) ? 0 : 1;
+
+usage:
+	fprintf(stderr, "usage: %s [-m altitude|vario|accumulator|phase|doorlock|weather] [-r reference] [-e tolerance] [-h altitude] [-a hh:mm] [-s scale] [-q] recording\n", argv[0]);
+	return 2;
+}
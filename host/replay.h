@@ -0,0 +1,57 @@
+// *************************************************************************************************
+//
+// Record/replay harness for the sensor driven logic modules. See host/replay.c.
+//
+// *************************************************************************************************
+
+#ifndef REPLAY_H_
+#define REPLAY_H_
+
+// *************************************************************************************************
+// Include section
+
+#include <stdint.h>
+
+
+// *************************************************************************************************
+// Defines section
+
+// Simulated time base is the 32768Hz ACLK, the same unit the firmware timers use
+#define REPLAY_ACLK					(32768u)
+#define REPLAY_MS_TO_TICKS(ms)		(((uint64_t)(ms) * REPLAY_ACLK) / 1000u)
+#define REPLAY_TICKS_TO_MS(ticks)	((uint32_t)(((ticks) * 1000u) / REPLAY_ACLK))
+
+// Sensor values held by the driver stand-ins, updated from the recording
+struct replay_sensors
+{
+	uint32_t	pa;				// ps_get_pa(), 1Pa
+	uint16_t	temp;			// ps_get_temp(), 0.1K
+	uint8_t		pressure_valid;	// 1 = pressure sensor delivered at least one sample
+	uint8_t		xyz[3];			// as_get_data(), raw counts
+};
+extern struct replay_sensors sReplaySensors;
+
+// Last output of the modules towards display and buzzer
+struct replay_outputs
+{
+	char		line2[7];		// LCD line 2 as written by display_chars()
+	uint8_t		chirps;			// start_buzzer_steps() arguments, cycles = 0 if no call
+	uint16_t	chirp_on;
+	uint16_t	chirp_off;
+	uint8_t		chirp_steps;
+};
+extern struct replay_outputs sReplayOutputs;
+
+
+// *************************************************************************************************
+// Extern section
+
+// Simulated clock in ACLK ticks
+extern uint64_t replay_now;
+
+// Harness services used by the driver stand-ins (host/replay.c)
+extern void replay_idle(void);
+extern void replay_delay(uint16_t ticks);
+extern void replay_timer_a1(uint16_t ticks);
+
+#endif /*REPLAY_H_*/
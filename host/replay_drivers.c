@@ -0,0 +1,254 @@
+// *************************************************************************************************
+//
+// Driver stand-ins for the record/replay harness (host/replay.c).
+//
+// The logic modules under test are compiled unmodified. Everything they call below the logic
+// layer is provided here: sensor reads return the recorded values, display and buzzer calls are
+// captured as outputs, timers and idle_loop() hand control back to the harness scheduler. The
+// globals the rest of the firmware owns on target (sys, request, button, display, ...) are
+// defined here as well.
+//
+// *************************************************************************************************
+
+// *************************************************************************************************
+// Include section
+
+// system
+#include <string.h>
+#include "project.h"
+
+// driver
+#include "display.h"
+#include "vti_ps.h"
+#include "vti_as.h"
+#include "ports.h"
+#include "timer.h"
+#include "buzzer.h"
+#include "power.h"
+#ifdef CONFIG_DVFS
+#include "dvfs.h"
+#endif
+
+// logic
+#include "acceleration.h"
+#include "clock.h"
+#include "date.h"
+#include "user.h"
+#include "alarm.h"
+
+#include "replay.h"
+
+
+// *************************************************************************************************
+// Global Variable section
+
+// Owned by ezchronos.c, ports.c, display.c, timer.c, acceleration.c, clock.c and date.c on target
+volatile s_system_flags sys;
+volatile s_request_flags request;
+volatile s_message_flags message;
+volatile s_button_flags button;
+volatile s_display_flags display;
+void (*fptr_Timer0_A1_function)(void);
+struct accel sAccel;
+struct time sTime;
+struct date sDate;
+u8 itoa_str[8];
+
+struct replay_sensors sReplaySensors;
+struct replay_outputs sReplayOutputs;
+
+// Power domains currently held, one bit per user
+static u16 replay_power[2];
+
+
+// *************************************************************************************************
+// Sensors
+
+u32 ps_get_pa(void)
+{
+	// Conversion result is read, DRDY goes low until the next sample
+	PS_INT_IN &= ~PS_INT_PIN;
+	return sReplaySensors.pa;
+}
+
+u16 ps_get_temp(void)
+{
+	return sReplaySensors.temp;
+}
+
+void as_get_data(u8 * data)
+{
+	memcpy(data, sReplaySensors.xyz, 3);
+}
+
+u8 as_get_x(void)
+{
+	return sReplaySensors.xyz[0];
+}
+
+u8 as_get_y(void)
+{
+	return sReplaySensors.xyz[1];
+}
+
+u8 as_get_z(void)
+{
+	return sReplaySensors.xyz[2];
+}
+
+void as_request_rate(u16 user, u8 rate)
+{
+}
+
+
+// *************************************************************************************************
+// Power domains
+
+void power_acquire(u8 domain, u16 user)
+{
+	replay_power[domain] |= user;
+
+	// Sensor starts converting, first result is there right away
+	if ((domain == POWER_PRESSURE) && sReplaySensors.pressure_valid) PS_INT_IN |= PS_INT_PIN;
+}
+
+void power_release(u8 domain, u16 user)
+{
+	replay_power[domain] &= ~user;
+}
+
+u8 power_is_on(u8 domain)
+{
+	return (replay_power[domain] != 0);
+}
+
+#ifdef CONFIG_DVFS
+void dvfs_acquire(void)
+{
+}
+
+void dvfs_release(void)
+{
+}
+#endif
+
+
+// *************************************************************************************************
+// Timers
+
+void Timer0_A1_Start(u16 ticks)
+{
+	replay_timer_a1(ticks);
+}
+
+void Timer0_A1_Stop(void)
+{
+	replay_timer_a1(0);
+}
+
+void Timer0_A4_Delay(u16 ticks)
+{
+	replay_delay(ticks);
+}
+
+void idle_loop(void)
+{
+	replay_idle();
+}
+
+
+// *************************************************************************************************
+// Display. Only line 2 is kept, the modules under test report their results there.
+
+void clear_display_all(void)
+{
+	memset(sReplayOutputs.line2, ' ', 6);
+}
+
+void clear_line(u8 line)
+{
+	if (line == LINE2) memset(sReplayOutputs.line2, ' ', 6);
+}
+
+void display_chars(u8 segments, u8 * str, u8 mode)
+{
+	u8 length = 0;
+	u8 first = 0;
+
+	switch (segments)
+	{
+		case LCD_SEG_L2_5_0:	first = 0; length = 6; break;
+		case LCD_SEG_L2_4_0:	first = 1; length = 5; break;
+		case LCD_SEG_L2_3_0:	first = 2; length = 4; break;
+		case LCD_SEG_L2_2_0:	first = 3; length = 3; break;
+		case LCD_SEG_L2_1_0:	first = 4; length = 2; break;
+	}
+	while (length-- && *str) sReplayOutputs.line2[first++] = *str++;
+}
+
+void display_char(u8 segment, u8 chr, u8 mode)
+{
+	if ((segment >= LCD_SEG_L2_5) && (segment <= LCD_SEG_L2_0)) sReplayOutputs.line2[segment - LCD_SEG_L2_5] = chr;
+}
+
+void display_symbol(u8 symbol, u8 mode)
+{
+}
+
+void display_value1(u8 segments, u32 value, u8 digits, u8 blanks, u8 disp_mode)
+{
+	display_chars(segments, itoa(value, digits, blanks), SEG_ON);
+}
+
+u8 * itoa(u32 n, u8 digits, u8 blanks)
+{
+	u8 i;
+
+	// Same result as driver/display.c: leading zeros, then up to 'blanks' of them as spaces
+	memcpy(itoa_str, "0000000", 8);
+	if ((digits == 0) || (digits > 7)) return (itoa_str);
+	itoa_str[digits] = 0;
+	for (i = digits; i > 0; i--)
+	{
+		itoa_str[i-1] = n % 10 + '0';
+		n /= 10;
+	}
+	for (i = 0; (itoa_str[i] == '0') && (i < digits-1) && (blanks > 0); i++, blanks--)
+	{
+		itoa_str[i] = ' ';
+	}
+	return (itoa_str);
+}
+
+void set_value(s32 * value, u8 digits, u8 blanks, s32 limitLow, s32 limitHigh, u16 mode, u8 segments, void (*fptr_setValue_display_function1)(u8 segments, u32 value, u8 digits, u8 blanks, u8 disp_mode))
+{
+	// Interactive setting is not replayed, leave value unchanged
+	sys.flag.idle_timeout = 1;
+}
+
+
+// *************************************************************************************************
+// Buzzer
+
+void start_buzzer(u8 cycles, u16 on_time, u16 off_time)
+{
+	start_buzzer_steps(cycles, on_time, off_time, 0);
+}
+
+void start_buzzer_steps(u8 cycles, u16 on_time, u16 off_time, u8 steps)
+{
+	sReplayOutputs.chirps = cycles;
+	sReplayOutputs.chirp_on = on_time;
+	sReplayOutputs.chirp_off = off_time;
+	sReplayOutputs.chirp_steps = steps;
+}
+
+void stop_buzzer(void)
+{
+}
+
+
+// *************************************************************************************************
+// Alarm, read by the smart alarm of phase_clock.c. Disabled unless a mode sets it.
+
+struct alarm sAlarm;
@@ -0,0 +1,626 @@
+// *************************************************************************************************
+//
+// Simulated watch for the host SimpliciTI build.
+//
+// Runs the real end device stack (main_ED_BM.c and the SimpliciTI components) as a native
+// process against contrib/ap_emulator.py over the MRFI_HOST datagram radio. The sync commands
+// are answered by logic/rfsync.c, linked unmodified. This file provides the firmware state and
+// the logs it reads, backed by a simulated clock and fixed synthetic data, and mirrors the TX only
+// callbacks of logic/rfsimpliciti.c with synthetic sensor data:
+//
+//   sync  - ready-to-receive loop, answers every SYNC_AP_CMD_xxx of logic/rfsync.c
+//   acc   - acceleration stream, 33 packets per second
+//   ppt   - button events, each sent as a burst of 4 packets 30ms apart
+//
+// Usage: simpliciti_ed [-m sync|acc|ppt] [-a address] [-t seconds] [-q]
+//
+// The medium is taken from MRFI_HOST_MEDIUM (see mrfi/radios/host/mrfi_radio.c). On exit one
+// line of statistics is printed so that several instances can be compared by a script. The logs
+// are the same on every run, contrib/sync_test.py compares the dump tools against host/test/sync.
+//
+// *************************************************************************************************
+
+// *************************************************************************************************
+// Include section
+
+// system
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+#include "project.h"
+
+// simpliciti
+#include "bsp.h"
+#include "mrfi.h"
+#include "simpliciti.h"
+#include "rfsimpliciti.h"
+
+// driver
+#include "vti_ps.h"
+#include "infomem.h"
+#include "crash.h"
+#include "profile.h"
+#include "stack.h"
+
+// logic
+#include "clock.h"
+#include "date.h"
+#include "alarm.h"
+#include "temperature.h"
+#include "altitude.h"
+#include "phase_clock.h"
+#include "impact.h"
+#include "track.h"
+#include "history.h"
+#ifdef CONFIG_SIDEREAL
+#include "sidereal.h"
+#endif
+
+
+// *************************************************************************************************
+// Defines section
+
+#define ED_MODE_SYNC				(0u)
+#define ED_MODE_ACC					(1u)
+#define ED_MODE_PPT					(2u)
+
+// Interval between simulated button presses, in 0.5 seconds
+#define ED_PPT_INTERVAL				(4u)
+
+// Synthetic logs
+#define ED_SLEEP_EPOCHS				(45u)
+#define ED_SLEEP_WAKE				(40u)
+#define ED_IMPACT_EVENTS			(3u)
+#define ED_TRACK_POINTS				(4u)
+#define ED_HISTORY_DAYS				(3u)
+
+
+// *************************************************************************************************
+// Global Variable section
+
+// Same variables rfsimpliciti.c and the radio driver provide on target
+unsigned char simpliciti_flag;
+unsigned char simpliciti_data[SIMPLICITI_MAX_PAYLOAD_LENGTH];
+unsigned char simpliciti_ed_address[4];
+unsigned char simpliciti_payload_length;
+unsigned char rf_frequoffset;
+
+// Owned by ezchronos.c and the logic modules on target, read and written by logic/rfsync.c
+volatile s_system_flags sys;
+struct time sTime;
+struct date sDate;
+#ifdef CONFIG_ALARM
+struct alarm sAlarm;
+#endif
+struct temp sTemp;
+#ifdef CONFIG_ALTITUDE
+struct alt sAlt;
+#endif
+#ifdef CONFIG_SIDEREAL
+struct sidereal_time sSidereal_time;
+#endif
+struct profile sProfile;
+struct SPhase sPhase;
+struct impact sImpact;
+struct track sTrack;
+
+// Synthetic logs in the formats of the flash segments on target
+static const u8 ed_sleep_header[PHASE_LOG_HEADER] =
+{
+	PHASE_MAGIC, 10, 18, 23, 5, 30, ED_SLEEP_WAKE >> 8, ED_SLEEP_WAKE & 0xFF,
+};
+
+static const u8 ed_impact_log[ED_IMPACT_EVENTS][IMPACT_RECORD] =
+{
+	{ IMPACT_FALL,  10, 17, 14,  2, 33, 2710 >> 8, 2710 & 0xFF },
+	{ IMPACT_SHOCK, 10, 18,  9, 15,  7, 3480 >> 8, 3480 & 0xFF },
+	{ IMPACT_FALL,  10, 18, 18, 40, 59, 1930 >> 8, 1930 & 0xFF },
+};
+
+static const u8 ed_track_header[TRACK_HEADER] =
+{
+	TRACK_MAGIC, 10, 18, 9, 30, 430 >> 8, 430 & 0xFF, 0xFF,
+};
+
+static const struct
+{
+	u8  type;
+	u16 minute;
+	s16 altitude;
+} ed_track_points[ED_TRACK_POINTS] =
+{
+	{ TRACK_PEAK,  42, 612 },
+	{ TRACK_DIP,   65, 540 },
+	{ TRACK_PEAK, 118, 803 },
+	{ TRACK_END,  150, 455 },
+};
+
+static const struct
+{
+	u8  month, day;
+	s16 tmin, tmax, tmean;		// 0.1 degC
+	u16 batt_mean, batt_min;	// mV
+	u16 minutes;
+} ed_history[ED_HISTORY_DAYS + 1] =
+{
+	{ 10, 15,  84, 231, 162, 2981, 2950, 1440 },
+	{ 10, 16,  97, 244, 171, 2979, 2940, 1440 },
+	{ 10, 17, -12, 188,  95, 2974, 2920, 1434 },
+	{ 10, 18,  63, 205, 149, 2972, 2930,  822 },	// today
+};
+
+static const u16 ed_crash_record[CRASH_RECORD_WORDS] =
+{
+	2, 0x16, (CRASH_ISR_TIMER0_A1 << 8) | CRASH_WDT_PRETIMEOUT, 0x8A3E, 0x2BD0, (3 << 8) | 17,
+	CRASH_TRACE_WAKEUP | 0x004, CRASH_TRACE_REQUEST | 0x002, CRASH_TRACE_RADIO | 1, CRASH_TRACE_WAKEUP | 0x010,
+	CRASH_TRACE_REQUEST | 0x008, CRASH_TRACE_RADIO | 0, CRASH_TRACE_WAKEUP | 0x001, CRASH_TRACE_REQUEST | 0x020,
+};
+
+static u8 ed_history_days;
+static u8 ed_history_samples;
+static u8 ed_crash_valid;
+
+static u8 ed_mode = ED_MODE_SYNC;
+static u8 ed_quiet = 0;
+static time_t ed_deadline = 0;
+static struct timespec ed_start;
+
+// Statistics
+static struct
+{
+	u32 linked_ms;
+	u32 data_packets;
+} sStats;
+
+
+// *************************************************************************************************
+// @fn          ed_elapsed_ms
+// @brief       Milliseconds since start.
+// @param       none
+// @return      u32		elapsed time
+// *************************************************************************************************
+static u32 ed_elapsed_ms(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (u32)((now.tv_sec - ed_start.tv_sec) * 1000 + (now.tv_nsec - ed_start.tv_nsec) / 1000000);
+}
+
+
+// *************************************************************************************************
+// @fn          Timer0_A4_Delay
+// @brief       Host version of the low power delay used by the SimpliciTI main loops. Radio frames
+//				keep being received while waiting. Also ends the run once the duration elapsed.
+// @param       u16 ticks		Delay in ACLK ticks
+// @return      none
+// *************************************************************************************************
+void Timer0_A4_Delay(u16 ticks)
+{
+	BSP_HostWait(((u32)ticks * 15625u) / 512u, NULL);
+
+	// 1/1 second clock
+	{
+		static u32 last_second = 0;
+		u32 now = ed_elapsed_ms() / 1000;
+
+		while (last_second < now)
+		{
+			last_second++;
+			if (++sTime.second == 60)
+			{
+				sTime.second = 0;
+				if (++sTime.minute == 60)
+				{
+					sTime.minute = 0;
+					sTime.hour = (sTime.hour + 1) % 24;
+				}
+			}
+		}
+	}
+
+	if (ed_deadline && time(NULL) >= ed_deadline)
+	{
+		simpliciti_flag |= SIMPLICITI_TRIGGER_STOP;
+	}
+}
+
+
+// *************************************************************************************************
+// @fn          simpliciti_get_ed_data_callback
+// @brief       Provide data for the TX only modes. Mirrors logic/rfsimpliciti.c.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void simpliciti_get_ed_data_callback(void)
+{
+	static u8 packet_counter = 0;
+	static u8 button = 0;
+
+	if (ed_mode == ED_MODE_ACC)
+	{
+		// Sensor runs at 100Hz, every 3rd data set is sent
+		float t = ed_elapsed_ms() / 1000.0f;
+
+		Timer0_A4_Delay(CONV_MS_TO_TICKS(30));
+
+		simpliciti_data[1] = (u8)(s8)(40.0f * sinf(t));
+		simpliciti_data[2] = (u8)(s8)(40.0f * cosf(t));
+		simpliciti_data[3] = (u8)(s8)(54.0f + 5.0f * sinf(3.0f * t));
+		simpliciti_flag |= SIMPLICITI_TRIGGER_SEND_DATA;
+		sStats.data_packets++;
+	}
+	else if (ed_mode == ED_MODE_PPT)
+	{
+		// New button event is stored in data
+		if ((packet_counter == 0) && (simpliciti_data[0] & 0xF0) != 0)
+		{
+			packet_counter = 5;
+		}
+
+		// Send packet several times
+		if (packet_counter > 0)
+		{
+			// Clear button event when sending last packet
+			if (--packet_counter == 0)
+			{
+				simpliciti_data[0] &= ~0xF0;
+			}
+			else
+			{
+				Timer0_A4_Delay(CONV_MS_TO_TICKS(30));
+				simpliciti_flag |= SIMPLICITI_TRIGGER_SEND_DATA;
+				sStats.data_packets++;
+			}
+		}
+		else
+		{
+			u8 i;
+
+			// Wait for the next "button press": STAR, NUM, UP in turn
+			for (i=0; i<ED_PPT_INTERVAL; i++) Timer0_A4_Delay(CONV_MS_TO_TICKS(500));
+			simpliciti_data[0] = SIMPLICITI_KEY_EVENTS | (SIMPLICITI_BUTTON_STAR + 0x10 * button);
+			button = (button + 1) % 3;
+		}
+	}
+}
+
+
+// *************************************************************************************************
+// @fn          simpliciti_get_rvc_callback
+// @brief       Callback when data was received in TX only mode. Nothing is expected.
+// @param       u8 len		Length of received data
+// @return      int			1 = stop retrying
+// *************************************************************************************************
+int simpliciti_get_rvc_callback(u8 len)
+{
+	return 0;
+}
+
+
+// *************************************************************************************************
+// @fn          ed_fill_logs
+// @brief       Load the synthetic logs and counters, as if the watch had recorded them.
+// @param       none
+// @return      none
+// *************************************************************************************************
+static void ed_fill_logs(void)
+{
+	u8 i;
+
+	memset(&sProfile, 0, sizeof(sProfile));
+	sProfile.seconds = 86400;
+	for (i=0; i<PROFILE_SOURCES; i++)
+	{
+		sProfile.wakeups[i] = 1000 + 2500 * i;
+		sProfile.active[i]  = 3000 + 1700 * i;
+	}
+	sProfile.wakeups[PROFILE_TIMER0_A0] = 65535;
+	sProfile.airtime[PROFILE_RADIO_RX - 1] = 4915;
+	sProfile.airtime[PROFILE_RADIO_TX - 1] = 1638;
+
+	sPhase.state  = PHASE_OFF;
+	sPhase.epochs = ED_SLEEP_EPOCHS;
+
+	sImpact.count = ED_IMPACT_EVENTS;
+
+	sTrack.count   = ED_TRACK_POINTS;
+	sTrack.ascent  = (612 - 430) + (803 - 540);
+	sTrack.descent = (612 - 540) + (803 - 455);
+	sTrack.climbs  = 2;
+
+	ed_history_days    = ED_HISTORY_DAYS;
+	ed_history_samples = ed_history[ED_HISTORY_DAYS].minutes / HISTORY_SAMPLES_UNIT;
+
+	ed_crash_valid = 1;
+}
+
+
+// *************************************************************************************************
+// @fn          phase_clock_log, phase_clock_clear
+// @brief       Sleep log: header, then one activity byte per epoch. Erased bytes read 0xFF.
+// *************************************************************************************************
+u8 phase_clock_log(u16 offset)
+{
+	u16 epoch;
+
+	if (offset < PHASE_LOG_HEADER) return (sPhase.epochs > 0) ? ed_sleep_header[offset] : 0xFF;
+	epoch = offset - PHASE_LOG_HEADER;
+	if (epoch >= sPhase.epochs) return 0xFF;
+	// Awake, then light and deep sleep in turn, restless before the wake up
+	if (epoch < 4 || epoch >= ED_SLEEP_WAKE) return 20 + (epoch * 7) % 30;
+	return ((epoch / 6) & 1) ? (epoch * 5) % 3 : 3 + (epoch * 11) % 17;
+}
+
+void phase_clock_clear(void)
+{
+	sPhase.epochs = 0;
+}
+
+
+// *************************************************************************************************
+// @fn          impact_log, impact_clear
+// @brief       Fall and shock log, IMPACT_RECORD bytes per event.
+// *************************************************************************************************
+u8 impact_log(u16 offset)
+{
+	if (offset / IMPACT_RECORD >= sImpact.count) return 0xFF;
+	return ed_impact_log[offset / IMPACT_RECORD][offset % IMPACT_RECORD];
+}
+
+void impact_clear(void)
+{
+	sImpact.count = 0;
+}
+
+
+// *************************************************************************************************
+// @fn          track_log, track_clear
+// @brief       Altitude track: header, then TRACK_POINT bytes per point.
+// *************************************************************************************************
+u8 track_log(u16 offset)
+{
+	u16 value;
+	u8 point;
+
+	if (offset < TRACK_HEADER) return (sTrack.count > 0) ? ed_track_header[offset] : 0xFF;
+	point = (offset - TRACK_HEADER) / TRACK_POINT;
+	if (point >= sTrack.count) return 0xFF;
+	if ((offset - TRACK_HEADER) % TRACK_POINT < TRACK_POINT_ALTITUDE)
+	{
+		value = ((u16)ed_track_points[point].type << TRACK_TYPE_SHIFT) | ed_track_points[point].minute;
+	}
+	else
+	{
+		value = (u16)ed_track_points[point].altitude;
+	}
+	return ((offset - TRACK_HEADER) & 1) ? (value & 0xFF) : (value >> 8);
+}
+
+void track_clear(void)
+{
+	memset(&sTrack, 0, sizeof(sTrack));
+}
+
+
+// *************************************************************************************************
+// @fn          history_days, history_today, history_log, history_clear
+// @brief       Daily history, one HISTORY_RECORD per day, the running day kept apart.
+// *************************************************************************************************
+static void ed_history_record(u8 day, u8 * record)
+{
+	record[HISTORY_RECORD_MONTH]		= ed_history[day].month;
+	record[HISTORY_RECORD_DAY]			= ed_history[day].day;
+	record[HISTORY_RECORD_TEMP_MIN]		= ed_history[day].tmin >> 8;
+	record[HISTORY_RECORD_TEMP_MIN+1]	= ed_history[day].tmin & 0xFF;
+	record[HISTORY_RECORD_TEMP_MAX]		= ed_history[day].tmax >> 8;
+	record[HISTORY_RECORD_TEMP_MAX+1]	= ed_history[day].tmax & 0xFF;
+	record[HISTORY_RECORD_TEMP_MEAN]	= ed_history[day].tmean >> 8;
+	record[HISTORY_RECORD_TEMP_MEAN+1]	= ed_history[day].tmean & 0xFF;
+	record[HISTORY_RECORD_BATT_MEAN]	= ed_history[day].batt_mean >> 8;
+	record[HISTORY_RECORD_BATT_MEAN+1]	= ed_history[day].batt_mean & 0xFF;
+	record[HISTORY_RECORD_BATT_MIN]		= ed_history[day].batt_min / 10 - HISTORY_BATT_BASE;
+	record[HISTORY_RECORD_SAMPLES]		= ed_history[day].minutes / HISTORY_SAMPLES_UNIT;
+}
+
+u8 history_days(void)
+{
+	return ed_history_days;
+}
+
+void history_today(u8 * record)
+{
+	ed_history_record(ED_HISTORY_DAYS, record);
+	record[HISTORY_RECORD_SAMPLES] = ed_history_samples;
+}
+
+u8 history_log(u8 day, u8 offset)
+{
+	u8 record[HISTORY_RECORD];
+
+	if (day >= ed_history_days) return 0xFF;
+	ed_history_record(day, record);
+	return record[offset];
+}
+
+void history_clear(void)
+{
+	// The day under way is kept, as on the watch
+	ed_history_days = 0;
+}
+
+
+// *************************************************************************************************
+// @fn          crash_read, infomem_app_clear
+// @brief       Crash record of the last watchdog reset, removed when its infomem app is cleared.
+// *************************************************************************************************
+u8 crash_read(u16 * record)
+{
+	if (!ed_crash_valid) return 0;
+	memcpy(record, ed_crash_record, sizeof(ed_crash_record));
+	return CRASH_RECORD_WORDS;
+}
+
+s16 infomem_app_clear(u8 identifier)
+{
+	if (identifier == CRASH_INFOMEM_ID) ed_crash_valid = 0;
+	return 0;
+}
+
+
+// *************************************************************************************************
+// @fn          profile_reset, stack_high_water
+// @brief       Energy profile counters and stack use.
+// *************************************************************************************************
+void profile_reset(void)
+{
+	memset(&sProfile, 0, sizeof(sProfile));
+}
+
+u16 stack_high_water(void)
+{
+	return 412;
+}
+
+
+// *************************************************************************************************
+// @fn          update_pressure_table, settings_changed, dst_calculate_dates, sync_sidereal
+// @brief       Follow-up of SYNC_AP_CMD_SET_WATCH, nothing to update on the host.
+// *************************************************************************************************
+#ifdef CONFIG_ALTITUDE
+void update_pressure_table(s16 href, u32 p_meas, u16 t_meas)
+{
+}
+#endif
+
+#ifdef CONFIG_SETTINGS
+void settings_changed(void)
+{
+}
+#endif
+
+#if (CONFIG_DST > 0)
+void dst_calculate_dates(void)
+{
+}
+#endif
+
+#ifdef CONFIG_SIDEREAL
+void sync_sidereal(void)
+{
+}
+#endif
+
+
+// *************************************************************************************************
+// @fn          ed_parse_address
+// @brief       Parse an 8 digit hex device address.
+// @param       const char *s		e.g. "edc0bb25"
+// @return      u8					1 = valid
+// *************************************************************************************************
+static u8 ed_parse_address(const char *s)
+{
+	u8 i;
+	unsigned int b;
+
+	if (strlen(s) != 8) return 0;
+	for (i=0; i<4; i++)
+	{
+		if (sscanf(s + 2*i, "%2x", &b) != 1) return 0;
+		simpliciti_ed_address[i] = b;
+	}
+	// 0xFF in the first byte collides with the broadcast filter
+	return (simpliciti_ed_address[0] != 0xFF);
+}
+
+
+// *************************************************************************************************
+// @fn          main
+// @brief       Link to the access point emulator and run the selected SimpliciTI mode.
+// @param       int argc, char **argv
+// @return      int		0 = linked and ran, 1 = could not link, 2 = usage
+// *************************************************************************************************
+int main(int argc, char **argv)
+{
+	static const u8 default_address[4] = THIS_DEVICE_ADDRESS;
+	struct tm *tm;
+	time_t now;
+	int c;
+
+	memcpy(simpliciti_ed_address, default_address, sizeof(default_address));
+
+	while ((c = getopt(argc, argv, "m:a:t:q")) != -1)
+	{
+		switch (c)
+		{
+			case 'm':	if      (!strcmp(optarg, "sync")) ed_mode = ED_MODE_SYNC;
+						else if (!strcmp(optarg, "acc"))  ed_mode = ED_MODE_ACC;
+						else if (!strcmp(optarg, "ppt"))  ed_mode = ED_MODE_PPT;
+						else goto usage;
+						break;
+			case 'a':	if (!ed_parse_address(optarg)) goto usage;
+						break;
+			case 't':	ed_deadline = time(NULL) + atoi(optarg);
+						break;
+			case 'q':	ed_quiet = 1;
+						break;
+			default:	goto usage;
+		}
+	}
+
+	now = time(NULL);
+	tm = localtime(&now);
+	sys.flag.use_metric_units = 1;
+	sTime.hour		= tm->tm_hour;
+	sTime.minute	= tm->tm_min;
+	sTime.second	= tm->tm_sec;
+	sDate.year		= tm->tm_year + 1900;
+	sDate.month		= tm->tm_mon + 1;
+	sDate.day		= tm->tm_mday;
+#ifdef CONFIG_ALARM
+	sAlarm.hour		= 6;
+	sAlarm.minute	= 30;
+#endif
+	sTemp.degrees	= 245;
+#ifdef CONFIG_ALTITUDE
+	sAlt.altitude	= 430;
+#endif
+	ed_fill_logs();
+	clock_gettime(CLOCK_MONOTONIC, &ed_start);
+
+	// Interrupts are enabled while the watch is running
+	BSP_ENABLE_INTERRUPTS();
+	simpliciti_payload_length = 4;
+	simpliciti_link_temperature(sTemp.degrees);
+
+	if (!simpliciti_link())
+	{
+		fprintf(stderr, "simpliciti_ed: no link to access point\n");
+		return 1;
+	}
+	sStats.linked_ms = ed_elapsed_ms();
+	if (!ed_quiet) fprintf(stderr, "simpliciti_ed: linked after %lu ms\n", (unsigned long)sStats.linked_ms);
+
+	if (ed_mode == ED_MODE_SYNC)
+	{
+		simpliciti_main_sync();
+	}
+	else
+	{
+		simpliciti_data[0] = (ed_mode == ED_MODE_ACC) ? SIMPLICITI_MOUSE_EVENTS : SIMPLICITI_KEY_EVENTS;
+		simpliciti_main_tx_only();
+	}
+
+	printf("ed %02x%02x%02x%02x linked_ms %lu data %lu rssi %d pwr %d\n",
+	       simpliciti_ed_address[0], simpliciti_ed_address[1], simpliciti_ed_address[2], simpliciti_ed_address[3],
+	       (unsigned long)sStats.linked_ms, (unsigned long)sStats.data_packets,
+	       simpliciti_link_rssi(), MRFI_GetRFPwrDbm(MRFI_GetRFPwr()));
+	return 0;
+
+usage:
+	fprintf(stderr, "usage: %s [-m sync|acc|ppt] [-a xxxxxxxx] [-t seconds] [-q]\n", argv[0]);
+	return 2;
+}
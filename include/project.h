@@ -121,6 +121,22 @@ typedef union
     u16 altitude_accumulator            : 1;	// 1 = Measure altitude & accumulate it
 #endif
     u16	acceleration_measurement	: 1; 	// 1 = Measure acceleration
+    u16	acceleration_service		: 1; 	// 1 = Acceleration sensor changes that need SPI transfers
+#ifdef CONFIG_PEDOMETER
+    u16 pedometer				: 1;	// 1 = Burst of pedometer samples is ready
+#endif
+#ifdef CONFIG_PHASE_CLOCK
+    u16 phase_clock				: 1;	// 1 = Sleep phase epoch is complete
+#endif
+#ifdef CONFIG_GESTURE
+    u16 gesture					: 1;	// 1 = Gesture recognized
+#endif
+#ifdef CONFIG_IMPACT
+    u16 impact					: 1;	// 1 = Fall or shock captured
+#endif
+#ifdef CONFIG_WEATHER
+    u16 weather					: 1;	// 1 = Weather trend sample is due or converted
+#endif
     u16 alarm_buzzer			: 1;	// 1 = Output buzzer for alarm
 #ifdef CONFIG_EGGTIMER
     u16 eggtimer_buzzer : 1; // 1 = Output buzzer for eggtimer
@@ -128,6 +144,10 @@ typedef union
 #ifdef CONFIG_STRENGTH
     u16 strength_buzzer 		: 1;    // 1 = Output buzzer from strength_data
 #endif
+#ifdef CONFIG_SETTINGS
+    u16 settings_write 			: 1;    // 1 = Write back cached settings
+#endif
+    u16 power_service			: 1;    // 1 = Switch off peripherals after power-down hysteresis
   } flag;
   u16 all_flags;            // Shortcut to all display flags (for reset)
 } s_request_flags;
@@ -153,6 +173,9 @@ typedef union
     u16 type_no_beep_off				: 1;	// 1 = Show "nobeep" text in Line2
     u16 block_line1						: 1;	// 1 = block Line1 from updating until message erase
     u16 block_line2						: 1;	// 1 = block Line2 from updating until message erase
+#ifdef CONFIG_WEATHER_ALARM
+    u16 type_storm						: 1;	// 1 = Show "STORM" text in Line2
+#endif
  } flag;
   u16 all_flags;            // Shortcut to all message flags (for reset)
 } s_message_flags;
@@ -168,14 +191,18 @@ extern volatile s_message_flags message;
 
 // feature dependency calculations
 
-#if defined( CONFIG_PHASE_CLOCK ) || defined( CONFIG_ACCEL) || defined (CONFIG_USE_GPS)
+#if defined( CONFIG_PHASE_CLOCK ) || defined( CONFIG_ACCEL) || defined (CONFIG_USE_GPS) || defined (CONFIG_PEDOMETER) || defined (CONFIG_GESTURE) || defined (CONFIG_IMPACT)
 	#define FEATURE_PROVIDE_ACCEL
 #endif
 
-#if defined (CONFIG_USEPPT) || defined (CONFIG_PHASE_CLOCK) || defined(CONFIG_ACCEL)
+#if defined (CONFIG_USEPPT) || defined(CONFIG_ACCEL)
   #define SIMPLICITI_TX_ONLY_REQ
 #endif
 
+#if defined (CONFIG_PHASE_CLOCK) || defined (CONFIG_IMPACT) || defined (CONFIG_ALTI_TRACK) || defined (CONFIG_HISTORY)
+  #define FEATURE_FLASH_LOG
+#endif
+
 #if defined (CONFIG_ALTITUDE) || defined (CONFIG_VARIO) || defined (CONFIG_ALTI_ACCUMULATOR)
   #define FEATURE_ALTITUDE
 #endif
@@ -184,7 +211,15 @@ extern volatile s_message_flags message;
   #define SIMPLICITI_TX_ONLY_REQ
 #endif
 
-#if defined(CONFIG_INFOMEM) &&  !defined(CONFIG_SIDEREAL)
+#if defined(CONFIG_SETTINGS) && !defined(CONFIG_INFOMEM)
+	#define CONFIG_INFOMEM
+#endif
+
+#if defined(CONFIG_CRASH_LOG) && !defined(CONFIG_INFOMEM)
+	#define CONFIG_INFOMEM
+#endif
+
+#if defined(CONFIG_INFOMEM) &&  !defined(CONFIG_SIDEREAL) && !defined(CONFIG_SETTINGS) && !defined(CONFIG_CRASH_LOG) && !defined(CONFIG_USE_GPS)
 	//undefine feature if it is not used by any option
 	#undef CONFIG_INFOMEM
 #endif
@@ -46,6 +46,7 @@
 // driver
 #include "display.h"
 #include "vti_as.h"
+#include "power.h"
 
 // logic
 #include "acceleration.h"
@@ -204,8 +205,9 @@ void display_acceleration(u8 line, u8 update)
 					// Clear previous acceleration value
 					sAccel.data = 0;
 					
-					// Start sensor
-					as_start();
+					// Start sensor, the display keeps its value while the wrist is still
+					as_request_rate(POWER_USER_ACCELERATION, AS_RATE_ADAPTIVE);
+					power_acquire(POWER_ACCEL, POWER_USER_ACCELERATION);
 					
 					// Set timeout counter
 					sAccel.timeout = ACCEL_MEASUREMENT_TIMEOUT;
@@ -267,7 +269,7 @@ void display_acceleration(u8 line, u8 update)
 		else if (update == DISPLAY_LINE_CLEAR)
 		{
 			// Stop acceleration sensor
-			as_stop();
+			power_release(POWER_ACCEL, POWER_USER_ACCELERATION);
 	
 			// Clear mode
 			sAccel.mode = ACCEL_MODE_OFF;
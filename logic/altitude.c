@@ -54,12 +54,19 @@
 #include "vti_ps.h"
 #include "ports.h"
 #include "timer.h"
+#include "power.h"
+#ifdef CONFIG_DVFS
+#include "dvfs.h"
+#endif
 
 // logic
 #include "user.h"
 #ifdef CONFIG_VARIO
 # include "vario.h"
 #endif
+#ifdef CONFIG_ALTI_TRACK
+#include "track.h"
+#endif
 
 
 // *************************************************************************************************
@@ -77,6 +84,11 @@ struct alt sAlt;
 #ifdef CONFIG_ALTI_ACCUMULATOR
 
 #define	ALT_ACCUM_DIR_THRESHOLD  5 // change in meters needed to switch direction up <-> down
+#ifdef CONFIG_ALTI_TRACK
+#define	ALT_ACCUM_DISPLAYCODE_MAX  4 // last display code, descent and climbs from the track
+#else
+#define	ALT_ACCUM_DISPLAYCODE_MAX  2
+#endif
 
 // The following used by the altitude accumulation function
 u8  alt_accum_enable;		// 1 means the altitude accumulator is enabled, zero means disabled
@@ -87,6 +99,10 @@ u8  alt_accum_direction;	// 1 means we're currently going up (last peakdip was a
 s32 alt_accum_prevalt;		// previous altitude - altitude the last time we read the altimeter 
 s32 alt_accum_max;		// maximum altitude encountered
 u8  alt_accum_displaycode;	// what to display
+#ifdef CONFIG_ALTI_TRACK
+u16 alt_accum_minutes;		// minutes since the accumulator was started
+u16 alt_accum_prevminute;	// minute of alt_accum_prevalt, the time of the next peak or dip
+#endif
 #endif
 
 // *************************************************************************************************
@@ -193,7 +209,7 @@ void start_altitude_measurement(void)
 		PS_INT_IE |= PS_INT_PIN;
 
 		// Start pressure sensor
-		ps_start(); 
+		power_acquire(POWER_PRESSURE, POWER_USER_ALTITUDE);
 
 		// Set timeout counter only if sensor status was OK
 		sAlt.timeout = ALTITUDE_MEASUREMENT_TIMEOUT;
@@ -217,7 +233,7 @@ void stop_altitude_measurement(void)
 	if (!ps_ok) return;
 	
 	// Stop pressure sensor
-	ps_stop();
+	power_release(POWER_PRESSURE, POWER_USER_ALTITUDE);
 	
 	// Disable DRDY IRQ
 	PS_INT_IE  &= ~PS_INT_PIN;
@@ -241,6 +257,11 @@ void do_altitude_measurement(u8 filter)
 
 	// If sensor is not ready, skip data read	
 	if ((PS_INT_IN & PS_INT_PIN) == 0) return;
+
+#ifdef CONFIG_DVFS
+	// Sensor read out and conversion to altitude are the heaviest job of the 1Hz loop
+	dvfs_acquire();
+#endif
 		
 	// Get temperature (format is *10?K) from sensor
 	sAlt.temperature = ps_get_temp();
@@ -277,6 +298,10 @@ void do_altitude_measurement(u8 filter)
    // is just too much unnecessary fluctuation, up to +/- 7Pa seen.
    vario_p_write( pressure );
 #endif
+
+#ifdef CONFIG_DVFS
+	dvfs_release();
+#endif
 }
 
 
@@ -370,6 +395,9 @@ void mx_altitude(u8 line)
 			if (!sys.flag.use_metric_units) altitude = convert_ft_to_m((s16)altitude);
 #endif
 
+			// Keep offset to sensor altitude for the next reset
+			sAlt.altitude_offset += (s16)altitude - sAlt.altitude;
+
 			// Update pressure table
 			update_pressure_table((s16)altitude, sAlt.pressure, sAlt.temperature);
 			
@@ -582,6 +610,10 @@ void altitude_accumulator_periodic (void)
 	// First a quick sanity check. If we're not supposed to be running, something's wrong, so just exit
 	if (alt_accum_enable==0) return;
 
+#ifdef CONFIG_ALTI_TRACK
+	alt_accum_minutes++;
+#endif
+
 	// First thing we need to know is our current altitude. Take 4 measurements & average them.
 	start_altitude_measurement();
 	stop_altitude_measurement();
@@ -597,6 +629,9 @@ void altitude_accumulator_periodic (void)
 		if (currentalt >= alt_accum_prevalt) {
 			// Execute here if we're still going upwards - current alt is greater than previous alt
 			alt_accum_prevalt = currentalt;	// just update our "previous" value for next time
+#ifdef CONFIG_ALTI_TRACK
+			alt_accum_prevminute = alt_accum_minutes;
+#endif
 			return;								// and that's it - we're done
 		}
 		else {
@@ -609,6 +644,9 @@ void altitude_accumulator_periodic (void)
 				alt_accum__accumtotal += alt_accum_prevalt - alt_accum_lastpeakdip;	// accumulate the vertical from that last hill climb
 				alt_accum_lastpeakdip = alt_accum_prevalt;				// peakdip is now a peak elevation
 				alt_accum_direction = 0;						// indicate we're tracking downhill now
+#ifdef CONFIG_ALTI_TRACK
+				track_point(TRACK_PEAK, alt_accum_prevminute, alt_accum_prevalt);	// log the peak
+#endif
 				return;
 			}
 			else	// we've dropped a little, but not enough to trigger any action yet
@@ -620,6 +658,9 @@ void altitude_accumulator_periodic (void)
 		if (currentalt <= alt_accum_prevalt) {
 			// Execute here if we're still going downwards - current alt is less than previous alt
 			alt_accum_prevalt = currentalt;		// just update our "previous" value for next time
+#ifdef CONFIG_ALTI_TRACK
+			alt_accum_prevminute = alt_accum_minutes;
+#endif
 			return;					// and that's it - we're done
 		}
 		else {
@@ -630,6 +671,9 @@ void altitude_accumulator_periodic (void)
 				// gone through a change of direction, so we need to set things up for going uphill now.
 				alt_accum_lastpeakdip = alt_accum_prevalt;	// peakdip is now a dip (valley) elevation
 				alt_accum_direction = 1;			// indicate we're tracking uphill now
+#ifdef CONFIG_ALTI_TRACK
+				track_point(TRACK_DIP, alt_accum_prevminute, alt_accum_prevalt);	// log the dip
+#endif
 				return;
 			}
 			else	// we've ascended a little, but not enough to trigger any action yet
@@ -671,6 +715,12 @@ void altitude_accumulator_start (void)
 	alt_accum_lastpeakdip = temp;		// altitude of the last dip (in this case, as we assume we're going uphill)
 	alt_accum_prevalt = temp;		// previous altitude value
 	alt_accum_max = temp;			// maximum altitude we've encountered so far
+
+#ifdef CONFIG_ALTI_TRACK
+	alt_accum_minutes = 0;
+	alt_accum_prevminute = 0;
+	track_start(temp);			// new track log starting at this altitude
+#endif
 }
 
 
@@ -710,12 +760,14 @@ void display_selection_altaccum (u8 segments, u32 index, u8 digits, u8 blanks)
 // alt_accum_displaycode = 0:  Altitude relative to start point
 // alt_accum_displaycode = 1:  Total accumulated upwards vertical altitude
 // alt_accum_displaycode = 2:  Maximum altitude encountered (max height)
+// alt_accum_displaycode = 3:  Total descent (CONFIG_ALTI_TRACK)
+// alt_accum_displaycode = 4:  Number of climbs (CONFIG_ALTI_TRACK)
 // *************************************************************************************************
 void sx_alt_accumulator(u8 line)
 {
 	alt_accum_displaycode++;
 
-	if (alt_accum_displaycode > 2)
+	if (alt_accum_displaycode > ALT_ACCUM_DISPLAYCODE_MAX)
 		alt_accum_displaycode = 0;
 }
 
@@ -748,7 +800,7 @@ void display_alt_accumulator (u8 line, u8 update)
 
 		// Otherwise the accumulator is running, so display on the second line whatever alt_accum_displaycode
 		// says to display, in metres or feet as appropriate.
-		if (alt_accum_displaycode>2) alt_accum_displaycode=0;		// sanity check
+		if (alt_accum_displaycode>ALT_ACCUM_DISPLAYCODE_MAX) alt_accum_displaycode=0;		// sanity check
 
 		// light up "m" or "ft" display symbol as appropriate
 		if (sys.flag.use_metric_units)
@@ -806,6 +858,38 @@ void display_alt_accumulator (u8 line, u8 update)
 			return;
 		}
 
+#ifdef CONFIG_ALTI_TRACK
+		else if (alt_accum_displaycode==3)
+		{
+			// Display total descent. As with the accumulated gain, include the current descent below
+			// the last peak if we're going downhill
+			display_chars(LCD_SEG_L1_3_0, (u8*)"DESC", SEG_ON);		// top line display message
+			clear_line(LINE2);						// clear the bottom line of the display
+
+			temp = sTrack.descent;
+			if (!alt_accum_direction && (sAlt.altitude<alt_accum_lastpeakdip))
+				temp += alt_accum_lastpeakdip - sAlt.altitude;
+			if (sys.flag.use_metric_units==0) temp = (temp*328)/100;	// convert to feet if necessary
+
+			str = itoa(temp, 5, 4);					// 5 digits, up to 4 leading blank digits
+			display_chars(LCD_SEG_L2_4_0, str, SEG_ON);		// display descent on bottom line (5 digits)
+			return;
+		}
+
+		else if (alt_accum_displaycode==4)
+		{
+			// Display number of climbs finished so far, no unit
+			display_chars(LCD_SEG_L1_3_0, (u8*)"CLMB", SEG_ON);		// top line display message
+			display_symbol(LCD_UNIT_L1_M, SEG_OFF);
+			display_symbol(LCD_UNIT_L1_FT, SEG_OFF);
+			clear_line(LINE2);						// clear the bottom line of the display
+
+			str = itoa(sTrack.climbs, 5, 4);			// 5 digits, up to 4 leading blank digits
+			display_chars(LCD_SEG_L2_4_0, str, SEG_ON);		// display number of climbs on bottom line
+			return;
+		}
+#endif
+
 		else
 		{
 			// Display maximum altitude found so far
@@ -859,6 +943,16 @@ void mx_alt_accumulator(u8 line)
 	if ( (temp_enable==1) && (alt_accum_enable==0) )
 		altitude_accumulator_start();
 
+#ifdef CONFIG_ALTI_TRACK
+	// If it has just been disabled, end the track at the current altitude
+	if ( (temp_enable==0) && (alt_accum_enable==1) )
+	{
+		start_altitude_measurement();
+		stop_altitude_measurement();
+		track_point(TRACK_END, alt_accum_minutes, sAlt.altitude);
+	}
+#endif
+
 	alt_accum_enable = temp_enable;		// global flag that the accumulator is running, or not, as the user selected
 
 	clear_line(LINE2);			// don't display on/off on bottom line any more
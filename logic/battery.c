@@ -51,12 +51,29 @@
 // logic
 #include "menu.h"
 #include "battery.h"
+#ifdef CONFIG_HISTORY
+#include "history.h"
+#endif
+#ifdef CONFIG_GAUGE
+#include "profile.h"
+#include "gauge.h"
+#endif
+#ifdef FEATURE_PROVIDE_ACCEL
+#include "power.h"
+#include "vti_as.h"
+#endif
 
 
 // *************************************************************************************************
 // Prototypes section
 void reset_batt_measurement(void);
 void battery_measurement(void);
+#ifdef CONFIG_HISTORY
+void display_battery_trend(void);
+#endif
+#ifdef CONFIG_GAUGE
+void display_battery_days(void);
+#endif
 
 
 // *************************************************************************************************
@@ -67,6 +84,21 @@ void battery_measurement(void);
 // Global Variable section
 struct batt sBatt;
 
+#if defined(CONFIG_HISTORY) || defined(CONFIG_GAUGE)
+// Views in the order DOWN steps through them
+static const u8 battery_views[] =
+{
+	BATTERY_VIEW_NOW,
+#ifdef CONFIG_HISTORY
+	BATTERY_VIEW_MEAN,
+	BATTERY_VIEW_TREND,
+#endif
+#ifdef CONFIG_GAUGE
+	BATTERY_VIEW_DAYS,
+#endif
+};
+#endif
+
 
 // *************************************************************************************************
 // Extern section
@@ -88,6 +120,8 @@ void reset_batt_measurement(void)
 	
 	// Start with battery voltage of 3.00V 
 	sBatt.voltage = 300;
+	
+	sBatt.view = BATTERY_VIEW_NOW;
 }
 
 
@@ -100,6 +134,7 @@ void reset_batt_measurement(void)
 void battery_measurement(void)
 {
 	u16 voltage;
+	u8 low_battery;
 	
 	// Convert external battery voltage (ADC12INCH_11=AVCC-AVSS/2)
 	//voltage = adc12_single_conversion(REFVSEL_2, ADC12SHT0_10, ADC12SSEL_0, ADC12SREF_1, ADC12INCH_11, ADC12_BATT_CONVERSION_TIME_USEC);
@@ -122,8 +157,19 @@ void battery_measurement(void)
 	// Filter battery voltage
 	sBatt.voltage = ((voltage*2) + (sBatt.voltage*8))/10;
 
+#ifdef CONFIG_GAUGE
+	// Count the charge used, predict the voltage under radio load
+	gauge_update();
+#endif
+	low_battery = sys.flag.low_battery;
+
 	// If battery voltage falls below low battery threshold, set system flag and modify LINE2 display function pointer
+#ifdef CONFIG_GAUGE
+	// Governor: also when the cell could brown out under radio load
+	if ((sBatt.voltage < BATTERY_LOW_THRESHOLD) || sGauge.brownout)
+#else
 	if (sBatt.voltage < BATTERY_LOW_THRESHOLD) 
+#endif
 	{
 		sys.flag.low_battery = 1;
 		
@@ -137,6 +183,12 @@ void battery_measurement(void)
 		// Clear sticky battery icon
 		display_symbol(LCD_SYMB_BATTERY, SEG_OFF);
 	}
+	
+#ifdef FEATURE_PROVIDE_ACCEL
+	// Sensor mode depends on the battery state
+	if ((low_battery != sys.flag.low_battery) && power_is_on(POWER_ACCEL)) as_configure();
+#endif
+
 	// Update LINE2
 	display.flag.line2_full_update = 1;
 	
@@ -147,6 +199,83 @@ void battery_measurement(void)
 
 
 
+#if defined(CONFIG_HISTORY) || defined(CONFIG_GAUGE)
+// *************************************************************************************************
+// @fn          sx_battery
+// @brief       Down button steps through current voltage, mean of today, daily trend and remaining
+//				runtime, as far as they are built.
+// @param       u8 line		LINE2
+// @return      none
+// *************************************************************************************************
+void sx_battery(u8 line)
+{
+	u8 i;
+	
+	if (sBatt.view == BATTERY_VIEW_MEAN) display_symbol(LCD_SYMB_AVERAGE, SEG_OFF);
+	
+	for (i=0; battery_views[i] != sBatt.view; i++);
+	if (++i == sizeof(battery_views)) i = 0;
+	sBatt.view = battery_views[i];
+}
+#endif
+
+
+#ifdef CONFIG_HISTORY
+// *************************************************************************************************
+// @fn          display_battery_trend
+// @brief       Show the trend of the daily mean voltage in mV per day, "----" with too few days.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void display_battery_trend(void)
+{
+	s16 trend = history_battery_trend();
+	
+	if (trend == HISTORY_TREND_UNKNOWN)
+	{
+		display_chars(LCD_SEG_L2_3_0, (u8 *)"----", SEG_ON);
+		return;
+	}
+	
+	// Display result in x.xx format, sign in front
+	display_char(LCD_SEG_L2_4, (trend < 0) ? '-' : ' ', SEG_ON);
+	if (trend < 0) trend = -trend;
+	if (trend > 9999) trend = 9999;
+	display_chars(LCD_SEG_L2_3_0, itoa(trend, 4, 1), SEG_ON);
+	display_symbol(LCD_SEG_L2_DP, SEG_ON);
+}
+#endif
+
+
+#ifdef CONFIG_GAUGE
+// *************************************************************************************************
+// @fn          display_battery_days
+// @brief       Show the remaining runtime as "xxxxD", "----D" until the charge is known.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void display_battery_days(void)
+{
+	u16 days = gauge_days();
+	u8 text[5];
+	u8 * str;
+	u8 i;
+	
+	if (days == GAUGE_DAYS_UNKNOWN)
+	{
+		display_chars(LCD_SEG_L2_4_0, (u8 *)"----D", SEG_ON);
+		return;
+	}
+	
+	if (days > 9999) days = 9999;
+	str = itoa(days, 4, 3);
+	for (i=0; i<4; i++) text[i] = str[i];
+	text[4] = 'D';
+	display_chars(LCD_SEG_L2_4_0, text, SEG_ON);
+}
+#endif
+
+
 // *************************************************************************************************
 // @fn          display_battery_V
 // @brief       Display routine for battery voltage. 
@@ -157,6 +286,7 @@ void battery_measurement(void)
 void display_battery_V(u8 line, u8 update)
 {
 	u8 * str;
+	u16 voltage;
 	
 	// Redraw line
 	if (update == DISPLAY_LINE_UPDATE_FULL)	
@@ -167,18 +297,41 @@ void display_battery_V(u8 line, u8 update)
 		// Menu item is visible
 		sBatt.state = MENU_ITEM_VISIBLE; 
 		
-		// Display result in xx.x format
-		str = itoa(sBatt.voltage, 3, 0);
-
-		display_chars(LCD_SEG_L2_2_0, str, SEG_ON);
-		display_symbol(LCD_SEG_L2_DP, SEG_ON);
+		display_battery_V(line, DISPLAY_LINE_UPDATE_PARTIAL);
 	}
 	else if (update == DISPLAY_LINE_UPDATE_PARTIAL)
 	{
+		voltage = sBatt.voltage;
+		
+#ifdef CONFIG_GAUGE
+		if (sBatt.view == BATTERY_VIEW_DAYS)
+		{
+			display_battery_days();
+			display.flag.update_battery_voltage = 0;
+			return;
+		}
+#endif
+#ifdef CONFIG_HISTORY
+		if (sBatt.view == BATTERY_VIEW_TREND)
+		{
+			display_battery_trend();
+			display.flag.update_battery_voltage = 0;
+			return;
+		}
+		
+		// Mean of today, once the first minute was sampled
+		if ((sBatt.view == BATTERY_VIEW_MEAN) && sHistory.samples)
+		{
+			voltage = sHistory.batt_sum / sHistory.samples;
+			display_symbol(LCD_SYMB_AVERAGE, SEG_ON);
+		}
+#endif
+
 		// Display result in xx.x format
-		str = itoa(sBatt.voltage, 3, 0);
+		str = itoa(voltage, 3, 0);
 
 		display_chars(LCD_SEG_L2_2_0, str, SEG_ON);
+		display_symbol(LCD_SEG_L2_DP, SEG_ON);
 			
 		display.flag.update_battery_voltage = 0;
 	}
@@ -189,6 +342,9 @@ void display_battery_V(u8 line, u8 update)
 		
 		// Clear function-specific symbols
 		display_symbol(LCD_SYMB_BATTERY, SEG_OFF);
+#ifdef CONFIG_HISTORY
+		if (sBatt.view == BATTERY_VIEW_MEAN) display_symbol(LCD_SYMB_AVERAGE, SEG_OFF);
+#endif
 	}
 }
 
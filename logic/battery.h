@@ -49,6 +49,7 @@ extern void reset_batt_measurement(void);
 extern void battery_measurement(void);
 
 // Menu functions
+extern void sx_battery(u8 line);
 extern void display_battery_V(u8 line, u8 update);
 
 
@@ -64,6 +65,12 @@ extern void display_battery_V(u8 line, u8 update);
 // Show "lobatt" message every n seconds
 #define BATTERY_LOW_MESSAGE_CYCLE		(15u)
 
+// Display views, DOWN steps through the ones that are built
+#define BATTERY_VIEW_NOW				(0u)
+#define BATTERY_VIEW_MEAN				(1u)	// Mean of today (CONFIG_HISTORY)
+#define BATTERY_VIEW_TREND				(2u)	// Trend of the daily mean (CONFIG_HISTORY)
+#define BATTERY_VIEW_DAYS				(3u)	// Remaining runtime (CONFIG_GAUGE)
+
 
 // *************************************************************************************************
 // Global Variable section
@@ -80,6 +87,9 @@ struct batt
 	
 	// Battery voltage offset
 	s16			offset;
+	
+	// Selected view, BATTERY_VIEW_xxx
+	u8			view;
 };
 extern struct batt sBatt;
 
@@ -45,6 +45,7 @@
 // driver
 #include "display.h"
 #include "radio.h"
+#include "power.h"
 #include "ports.h"
 #include "timer.h"
 #include "rf1a.h"
@@ -165,7 +166,7 @@ void sx_bluerobin(u8 line)
 		if (sBlueRobin.state == BLUEROBIN_OFF)
 		{
 			// Init BlueRobin timer and radio
-			open_radio();
+			power_acquire(POWER_RADIO, POWER_USER_BLUEROBIN);
 
 			// Initialize BR library
 			BRRX_Init_v();
@@ -674,7 +675,7 @@ void stop_bluerobin(void)
 	BRRX_Stop_v(HR_CHANNEL);
 
 	// Powerdown radio
-	close_radio();
+	power_release(POWER_RADIO, POWER_USER_BLUEROBIN);
 	
 	// Force full display update to clear heart rate and speed data
 	sBlueRobin.heartrate 		= 0;
@@ -0,0 +1,281 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// *************************************************************************************************
+// Fuel gauge for the CR2032. The charge drawn since the last battery measurement is counted from
+// the energy profiler: LPM3 time, CPU active time, radio airtime and on-time of the sensors. After
+// a reset the remaining charge is taken from the temperature compensated voltage curve, on the 
+// steep end of the curve the voltage corrects the count. The remaining runtime follows from the
+// mean current. The governor predicts the cell voltage under radio load from the internal 
+// resistance and raises the low battery state before the radio could brown out the supply.
+// *************************************************************************************************
+
+
+// *************************************************************************************************
+// Include section
+
+// system
+#include "project.h"
+
+#ifdef CONFIG_GAUGE
+
+// driver
+#include "profile.h"
+
+// logic
+#include "gauge.h"
+#include "battery.h"
+#include "temperature.h"
+
+
+// *************************************************************************************************
+// Prototypes section
+void reset_gauge(void);
+void gauge_update(void);
+u16 gauge_days(void);
+u32 gauge_charge(void);
+u8 gauge_percent(u16 voltage);
+
+
+// *************************************************************************************************
+// Defines section
+
+
+// *************************************************************************************************
+// Global Variable section
+struct gauge sGauge;
+
+static const u16 gauge_curve_mv[GAUGE_CURVE_POINTS] 		= GAUGE_CURVE_MV;
+static const u8 gauge_curve_percent[GAUGE_CURVE_POINTS] 	= GAUGE_CURVE_PERCENT;
+static const u16 gauge_domain_ua[PROFILE_DOMAINS] 			= GAUGE_DOMAIN_UA;
+
+
+// *************************************************************************************************
+// Extern section
+
+
+// *************************************************************************************************
+// @fn          gauge_delta
+// @brief       Increase of a profile counter since the last call. A counter that went back was 
+//				cleared over the sync protocol, all of its value is new.
+// @param       u32 now			Counter value
+//				u32 * last		Value at the last call, updated
+// @return      u32				Increase
+// *************************************************************************************************
+static u32 gauge_delta(u32 now, u32 * last)
+{
+	u32 delta = (now >= *last) ? (now - *last) : now;
+	
+	*last = now;
+	return (delta);
+}
+
+
+// *************************************************************************************************
+// @fn          gauge_ticks
+// @brief       Charge drawn with a current for a time in ACLK ticks, without overflow for hours.
+// @param       u32 ticks		ACLK ticks (30.5us)
+//				u16 ua			Current in uA
+// @return      u32				Charge in uAs
+// *************************************************************************************************
+static u32 gauge_ticks(u32 ticks, u16 ua)
+{
+	return ((ticks >> 15) * ua + (((ticks & 0x7FFFul) * ua) >> 15));
+}
+
+
+// *************************************************************************************************
+// @fn          reset_gauge
+// @brief       Start counting. The charge is unknown until the battery voltage has settled.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void reset_gauge(void)
+{
+	sGauge.remaining 	= 0;
+	sGauge.current 		= 0;
+	sGauge.temp_timeout = 0;
+	sGauge.settle 		= GAUGE_SETTLE;
+	sGauge.percent 		= 100;
+	sGauge.brownout 	= 0;
+	
+	// Start from the current profile counters
+	gauge_charge();
+}
+
+
+// *************************************************************************************************
+// @fn          gauge_charge
+// @brief       Charge drawn since the last call from the profile counters, updates the mean current.
+// @param       none
+// @return      u32			Charge in uAs
+// *************************************************************************************************
+u32 gauge_charge(void)
+{
+	istate_t state;
+	u32 seconds, active = 0, radio, rx, tx, powered[PROFILE_DOMAINS];
+	u32 charge;
+	u8 i;
+	
+	// Counters are updated in ISRs
+	state = __get_interrupt_state();
+	__disable_interrupt();
+	seconds = gauge_delta(sProfile.seconds, &sGauge.seconds);
+	for (i=0; i<PROFILE_SOURCES; i++)
+	{
+		if (i != PROFILE_RADIO) active += sProfile.active[i];
+	}
+	active = gauge_delta(active, &sGauge.active);
+	radio  = gauge_delta(sProfile.active[PROFILE_RADIO], &sGauge.radio_active);
+	rx 	   = gauge_delta(sProfile.airtime[PROFILE_RADIO_RX - 1], &sGauge.airtime[0]);
+	tx 	   = gauge_delta(sProfile.airtime[PROFILE_RADIO_TX - 1], &sGauge.airtime[1]);
+	for (i=0; i<PROFILE_DOMAINS; i++) powered[i] = gauge_delta(sProfile.powered[i], &sGauge.powered[i]);
+	__set_interrupt_state(state);
+	
+	charge  = seconds * GAUGE_SLEEP_NA / 1000;
+	charge += gauge_ticks(active, GAUGE_ACTIVE_UA);
+	charge += gauge_ticks(radio, GAUGE_RADIO_ACTIVE_UA);
+	charge += gauge_ticks(rx, GAUGE_RX_UA);
+	charge += gauge_ticks(tx, GAUGE_TX_UA);
+	for (i=0; i<PROFILE_DOMAINS; i++) charge += powered[i] * gauge_domain_ua[i];
+	
+	// Mean current in 0.1uA, the first interval starts the filter
+	if (seconds)
+	{
+		if (sGauge.current == 0) sGauge.current = (charge * 10 / seconds) << GAUGE_CURRENT_SHIFT;
+		else sGauge.current += charge * 10 / seconds - (sGauge.current >> GAUGE_CURRENT_SHIFT);
+	}
+	
+	return (charge);
+}
+
+
+// *************************************************************************************************
+// @fn          gauge_percent
+// @brief       Remaining charge from the voltage curve, linear between its points.
+// @param       u16 voltage		Battery voltage at 20degC in mV
+// @return      u8				Remaining charge in percent
+// *************************************************************************************************
+u8 gauge_percent(u16 voltage)
+{
+	u8 i;
+	
+	if (voltage >= gauge_curve_mv[0]) return (gauge_curve_percent[0]);
+	
+	for (i=1; i<GAUGE_CURVE_POINTS; i++)
+	{
+		if (voltage >= gauge_curve_mv[i])
+		{
+			return (gauge_curve_percent[i] + (u16)(voltage - gauge_curve_mv[i]) * 
+					(gauge_curve_percent[i-1] - gauge_curve_percent[i]) / (gauge_curve_mv[i-1] - gauge_curve_mv[i]));
+		}
+	}
+	return (0);
+}
+
+
+// *************************************************************************************************
+// @fn          gauge_update
+// @brief       Count the charge drawn since the last call and check the voltage under radio load.
+//				Called with every battery measurement, after the voltage was filtered.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void gauge_update(void)
+{
+	u32 charge, estimate, r;
+	u16 voltage;
+	
+	charge = gauge_charge();
+	
+	// Temperature changes slowly, sample it now and then
+	if (sGauge.temp_timeout == 0)
+	{
+		sGauge.temperature 	= temperature_sample();
+		sGauge.temp_timeout = GAUGE_TEMP_INTERVAL;
+	}
+	sGauge.temp_timeout--;
+	
+	// Remaining charge from the voltage as it would be at 20degC
+	voltage = sBatt.voltage * 10;
+	if (sGauge.temperature < GAUGE_TEMP_REF) 
+	{
+		voltage += (GAUGE_TEMP_REF - sGauge.temperature) * GAUGE_TEMP_MV_PER_DEGC / 10;
+	}
+	sGauge.percent = gauge_percent(voltage);
+	estimate = (GAUGE_CAPACITY / 100) * sGauge.percent;
+	
+	if (sGauge.settle)
+	{
+		// Filtered voltage is still on its way from the start value
+		if (--sGauge.settle == 0) sGauge.remaining = estimate;
+	}
+	else
+	{
+		sGauge.remaining -= (charge < sGauge.remaining) ? charge : sGauge.remaining;
+		
+		// Steep end of the curve is more reliable than the count
+		if ((sGauge.percent < GAUGE_KNEE_PERCENT) && (estimate < sGauge.remaining)) sGauge.remaining = estimate;
+	}
+	
+	// Internal resistance rises towards the end of the cell and in the cold
+	r = GAUGE_R_FRESH + GAUGE_R_EMPTY / (sGauge.percent + 4);
+	if (sGauge.temperature < GAUGE_TEMP_REF) 
+	{
+		r = r * (2 * GAUGE_TEMP_REF - sGauge.temperature) / GAUGE_TEMP_REF;
+	}
+	sGauge.brownout = (sBatt.voltage * 10ul < GAUGE_BROWNOUT_MV + GAUGE_RADIO_MA * r);
+}
+
+
+// *************************************************************************************************
+// @fn          gauge_days
+// @brief       Remaining runtime at the mean current.
+// @param       none
+// @return      u16			Days, GAUGE_DAYS_UNKNOWN while the charge or the current is not known
+// *************************************************************************************************
+u16 gauge_days(void)
+{
+	u32 current = sGauge.current >> GAUGE_CURRENT_SHIFT;
+	u32 days;
+	
+	if (sGauge.settle || (current == 0)) return (GAUGE_DAYS_UNKNOWN);
+	
+	// uAs / (0.1uA * 8640) = uAs / (uA * 86400s)
+	days = sGauge.remaining / (current * 8640ul);
+	if (days >= GAUGE_DAYS_UNKNOWN) days = GAUGE_DAYS_UNKNOWN - 1;
+	return ((u16)days);
+}
+
+
+#endif /* CONFIG_GAUGE */
@@ -0,0 +1,141 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+#ifndef GAUGE_H_
+#define GAUGE_H_
+
+// *************************************************************************************************
+// Include section
+
+
+// *************************************************************************************************
+// Prototypes section
+extern void reset_gauge(void);
+extern void gauge_update(void);
+extern u16 gauge_days(void);
+
+
+// *************************************************************************************************
+// Defines section
+
+// CR2032 capacity in uAs (220mAh)
+#define GAUGE_CAPACITY				(220ul * 3600ul * 1000ul)
+
+// Currents in uA at the operating points of the firmware, as in contrib/energy_budget.py
+#define GAUGE_SLEEP_NA				(3500ul)	// LPM3 with RTC, LCD and idle sensors, in nA
+#define GAUGE_ACTIVE_UA				(650ul)		// CPU at 3MHz
+#define GAUGE_RADIO_ACTIVE_UA		(2600ul)	// CPU at 12MHz while serving the radio
+#define GAUGE_RX_UA					(16000ul)
+#define GAUGE_TX_UA					(17000ul)
+
+// Currents of the power domains while they are on, POWER_ACCEL .. POWER_RADIO. Acceleration 
+// sensor as a mean over the modes in use, radio core idle with the crystal running.
+#define GAUGE_DOMAIN_UA				{ 50u, 25u, 100u, 1700u }
+
+// Voltage under the load of the ADC conversion over remaining charge of a CR2032 at 20degC, 
+// mV and percent, highest voltage first
+#define GAUGE_CURVE_POINTS			(8u)
+#define GAUGE_CURVE_MV				{ 3000u, 2900u, 2850u, 2800u, 2700u, 2600u, 2500u, 2400u }
+#define GAUGE_CURVE_PERCENT			{  100u,   80u,   60u,   40u,   20u,   10u,    5u,    0u }
+
+// The cell voltage drops by 2mV per degC below 20degC at the same charge
+#define GAUGE_TEMP_REF				(200)		// 0.1 degC
+#define GAUGE_TEMP_MV_PER_DEGC		(2)
+
+// Below this charge the voltage curve is steep enough to correct the counted charge
+#define GAUGE_KNEE_PERCENT			(20u)
+
+// Internal resistance in Ohm: GAUGE_R_FRESH + GAUGE_R_EMPTY / (percent + 4), doubling from 20degC
+// to 0degC
+#define GAUGE_R_FRESH				(10u)
+#define GAUGE_R_EMPTY				(300u)
+
+// Governor: the radio draws GAUGE_RADIO_MA more than the ADC conversion. The radio and the 400Hz 
+// sensor modes are off while the cell would drop below GAUGE_BROWNOUT_MV under that load.
+#define GAUGE_RADIO_MA				(16u)
+#define GAUGE_BROWNOUT_MV			(2100u)
+
+// Minutes until the filtered battery voltage has settled after a reset, the charge is then 
+// taken from the voltage curve
+#define GAUGE_SETTLE				(15u)
+
+// Minutes between two temperature samples
+#define GAUGE_TEMP_INTERVAL			(10u)
+
+// Mean current filter, about one hour at one update per minute
+#define GAUGE_CURRENT_SHIFT			(6u)
+
+// Runtime shown before the charge is known and above 9999 days
+#define GAUGE_DAYS_UNKNOWN			(0xFFFFu)
+
+
+// *************************************************************************************************
+// Global Variable section
+struct gauge
+{
+	// Remaining charge in uAs, 0 before the charge is known
+	u32			remaining;
+	
+	// Mean current in 0.1uA
+	u32			current;
+	
+	// Profile counters at the last update
+	u32			seconds;
+	u32			active;
+	u32			radio_active;
+	u32			airtime[2];
+	u32			powered[PROFILE_DOMAINS];
+	
+	// Temperature in 0.1 degC and minutes until the next sample
+	s16			temperature;
+	u8			temp_timeout;
+	
+	// Minutes until the charge is taken from the voltage curve
+	u8			settle;
+	
+	// Remaining charge in percent from the voltage curve
+	u8			percent;
+	
+	// 1 = the radio would pull the cell below GAUGE_BROWNOUT_MV
+	u8			brownout;
+};
+extern struct gauge sGauge;
+
+
+// *************************************************************************************************
+// Extern section
+
+
+#endif /*GAUGE_H_*/
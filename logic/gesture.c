@@ -0,0 +1,282 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Gesture recognizer on the acceleration sensor: wrist raise, tap and double tap. Every motion 
+// interrupt starts a short burst of 40Hz samples, which are classified in the port ISR with a few
+// compares per sample. Only a recognized gesture wakes the main loop, where it is mapped to the 
+// action selected with make config. Samples of the pedometer are seen as well, so a raise is also
+// recognized while walking.
+// *************************************************************************************************
+
+
+// *************************************************************************************************
+// Include section
+
+// system
+#include "project.h"
+
+#ifdef CONFIG_GESTURE
+
+// driver
+#include "display.h"
+#include "ports.h"
+#include "vti_as.h"
+#include "power.h"
+
+// logic
+#include "gesture.h"
+#include "menu.h"
+#ifdef CONFIG_ALARM
+#include "alarm.h"
+#endif
+#ifdef CONFIG_EGGTIMER
+#include "eggtimer.h"
+#endif
+
+
+// *************************************************************************************************
+// Prototypes section
+u8 gesture_quiet(s8 * a, s8 * b, s8 limit);
+
+
+// *************************************************************************************************
+// Defines section
+
+#ifndef CONFIG_GESTURE_RAISE
+#define CONFIG_GESTURE_RAISE		(GESTURE_ACTION_BACKLIGHT)
+#endif
+#ifndef CONFIG_GESTURE_TAP
+#define CONFIG_GESTURE_TAP			(GESTURE_ACTION_NONE)
+#endif
+#ifndef CONFIG_GESTURE_DOUBLE_TAP
+#define CONFIG_GESTURE_DOUBLE_TAP	(GESTURE_ACTION_SILENCE)
+#endif
+
+
+// *************************************************************************************************
+// Global Variable section
+struct gesture sGesture;
+
+// Action per gesture, indexed by GESTURE_xxx
+static const u8 gesture_action[] = 
+{ 
+	GESTURE_ACTION_NONE, CONFIG_GESTURE_RAISE, CONFIG_GESTURE_TAP, CONFIG_GESTURE_DOUBLE_TAP 
+};
+
+
+// *************************************************************************************************
+// Extern section
+
+
+// *************************************************************************************************
+// @fn          reset_gesture
+// @brief       Start waiting for gestures.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void reset_gesture(void)
+{
+	sGesture.face_up	= 0;
+	sGesture.down		= 1;
+	sGesture.settle		= 0;
+	sGesture.taps		= 0;
+	sGesture.window		= 0;
+	sGesture.burst		= 0;
+	sGesture.result		= GESTURE_NONE;
+	
+	power_acquire(POWER_ACCEL, POWER_USER_GESTURE);
+}
+
+
+// *************************************************************************************************
+// @fn          gesture_motion
+// @brief       Motion interrupt of the acceleration sensor, start a burst of samples. The 
+//				interrupt may already be the first tap: it is checked against the last sample 
+//				before it. Called from the port ISR.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void gesture_motion(void)
+{
+	if (!sGesture.settle)
+	{
+		sGesture.before_tap[0] = sGesture.last[0];
+		sGesture.before_tap[1] = sGesture.last[1];
+		sGesture.before_tap[2] = sGesture.last[2];
+		sGesture.settle = GESTURE_SETTLE;
+	}
+	sGesture.burst = GESTURE_BURST;
+	as_idle_sampling(POWER_USER_GESTURE, 1);
+}
+
+
+// *************************************************************************************************
+// @fn          gesture_quiet
+// @brief       Compare two samples.
+// @param       s8 * a, s8 * b		X/Y/Z samples
+//				s8 limit			Largest difference per axis
+// @return      u8		1 = all axes within limit
+// *************************************************************************************************
+u8 gesture_quiet(s8 * a, s8 * b, s8 limit)
+{
+	u8 i;
+	s8 diff;
+	
+	for (i=0; i<3; i++)
+	{
+		diff = a[i] - b[i];
+		if ((diff > limit) || (diff < -limit)) return (0);
+	}
+	return (1);
+}
+
+
+// *************************************************************************************************
+// @fn          gesture_sample
+// @brief       Classify one 8g/40Hz sample. Called from the port ISR.
+// @param       u8 * xyz		X/Y/Z acceleration in 71mg
+// @return      u8		1 = a gesture was recognized, act on it in the main loop
+// *************************************************************************************************
+u8 gesture_sample(u8 * xyz)
+{
+	s8 * s = (s8 *)xyz;
+	u8 result = GESTURE_NONE;
+	
+	// Raise: display facing up after the wrist was in another position
+	if ((s[2] >= GESTURE_FACE_UP_Z) && (s[0] <= GESTURE_LEVEL) && (s[0] >= -GESTURE_LEVEL) &&
+		(s[1] <= GESTURE_LEVEL) && (s[1] >= -GESTURE_LEVEL))
+	{
+		if (++sGesture.face_up == GESTURE_HOLD && sGesture.down)
+		{
+			sGesture.down = 0;
+			result = GESTURE_RAISE;
+		}
+		if (sGesture.face_up > GESTURE_HOLD) sGesture.face_up = GESTURE_HOLD;
+	}
+	else
+	{
+		sGesture.face_up = 0;
+		sGesture.down = 1;
+	}
+	
+	// Taps: a jerk that leaves the orientation as it was
+	if (sGesture.settle)
+	{
+		if (--sGesture.settle == 0)
+		{
+			if (!gesture_quiet(s, sGesture.before_tap, GESTURE_QUIET))
+			{
+				// Moved the arm
+				sGesture.taps = 0;
+				sGesture.window = 0;
+			}
+			else if (++sGesture.taps == 2)
+			{
+				sGesture.taps = 0;
+				sGesture.window = 0;
+				result = GESTURE_DOUBLE_TAP;
+			}
+			else
+			{
+				sGesture.window = GESTURE_DOUBLE_TAP_WINDOW;
+			}
+		}
+	}
+	else if (!gesture_quiet(s, sGesture.last, GESTURE_JERK - 1))
+	{
+		sGesture.before_tap[0] = sGesture.last[0];
+		sGesture.before_tap[1] = sGesture.last[1];
+		sGesture.before_tap[2] = sGesture.last[2];
+		sGesture.settle = GESTURE_SETTLE;
+	}
+	else if (sGesture.window && (--sGesture.window == 0))
+	{
+		sGesture.taps = 0;
+		result = GESTURE_TAP;
+	}
+	
+	// Keep sampling while the arm moves and until a tap is decided
+	if (sGesture.burst)
+	{
+		if (!gesture_quiet(s, sGesture.last, GESTURE_MOVE - 1) || sGesture.settle || sGesture.window)
+		{
+			sGesture.burst = GESTURE_BURST;
+		}
+		else if (--sGesture.burst == 0)
+		{
+			as_idle_sampling(POWER_USER_GESTURE, 0);
+		}
+	}
+	
+	sGesture.last[0] = s[0];
+	sGesture.last[1] = s[1];
+	sGesture.last[2] = s[2];
+	
+	if (result == GESTURE_NONE) return (0);
+	sGesture.result = result;
+	return (1);
+}
+
+
+// *************************************************************************************************
+// @fn          gesture_process
+// @brief       Run the action selected for the last recognized gesture.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void gesture_process(void)
+{
+	u8 action = gesture_action[sGesture.result];
+	
+	sGesture.result = GESTURE_NONE;
+	
+	switch (action)
+	{
+		case GESTURE_ACTION_BACKLIGHT:	backlight_on();
+										break;
+		case GESTURE_ACTION_MENU:		if (sys.flag.lock_buttons) break;
+										ptrMenu_L1->nx_function(LINE1);
+										display.flag.line1_full_update = 1;
+										break;
+		case GESTURE_ACTION_SILENCE:	
+										#ifdef CONFIG_ALARM
+										if (sAlarm.state == ALARM_ON) stop_alarm();
+										#endif
+										#ifdef CONFIG_EGGTIMER
+										if (sEggtimer.state == EGGTIMER_ALARM) stop_eggtimer_alarm();
+										#endif
+										break;
+	}
+}
+
+#endif /* CONFIG_GESTURE */
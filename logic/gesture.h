@@ -0,0 +1,116 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+#ifndef GESTURE_H_
+#define GESTURE_H_
+
+// *************************************************************************************************
+// Include section
+
+
+// *************************************************************************************************
+// Prototypes section
+extern void reset_gesture(void);
+extern void gesture_motion(void);
+extern u8 gesture_sample(u8 * xyz);
+extern void gesture_process(void);
+
+
+// *************************************************************************************************
+// Defines section
+
+// Recognized gestures
+#define GESTURE_NONE				(0u)
+#define GESTURE_RAISE				(1u)	// Wrist raised and turned, display faces up
+#define GESTURE_TAP					(2u)
+#define GESTURE_DOUBLE_TAP			(3u)
+
+// Actions, selected per gesture with make config
+#define GESTURE_ACTION_NONE			(0u)
+#define GESTURE_ACTION_BACKLIGHT	(1u)
+#define GESTURE_ACTION_MENU			(2u)	// Next Line1 menu item, as button STAR
+#define GESTURE_ACTION_SILENCE		(3u)	// Stop alarm and eggtimer buzzer
+
+// Samples at 40Hz after the last movement before the sensor returns to motion detection
+#define GESTURE_BURST				(24u)
+
+// Orientation in counts of 71mg. The display faces up when Z is above 0.7g and X, Y are within
+// 0.43g, for GESTURE_HOLD samples after the wrist was seen in another position.
+#define GESTURE_FACE_UP_Z			(10)
+#define GESTURE_LEVEL				(6)
+#define GESTURE_HOLD				(4u)
+
+// Change between two samples that counts as movement (140mg) and as a tap (570mg). A tap leaves
+// the orientation within GESTURE_QUIET of the one before it, checked GESTURE_SETTLE samples later.
+#define GESTURE_MOVE				(2)
+#define GESTURE_JERK				(8)
+#define GESTURE_QUIET				(3)
+#define GESTURE_SETTLE				(3u)
+
+// Samples to wait for the second tap of a double tap, 400ms
+#define GESTURE_DOUBLE_TAP_WINDOW	(16u)
+
+
+// *************************************************************************************************
+// Global Variable section
+struct gesture
+{
+	// Last sample and the one before the pending tap
+	s8			last[3];
+	s8			before_tap[3];
+	
+	// Samples in a row with the display facing up, 1 = wrist was down since the last raise
+	u8			face_up;
+	u8			down;
+	
+	// Samples until a tap is checked, confirmed taps, samples left for the next tap
+	u8			settle;
+	u8			taps;
+	u8			window;
+	
+	// Samples left until motion detection, 0 = not sampling
+	u8			burst;
+	
+	// GESTURE_xxx for the main loop
+	u8			result;
+};
+extern struct gesture sGesture;
+
+
+// *************************************************************************************************
+// Extern section
+
+
+#endif /*GESTURE_H_*/
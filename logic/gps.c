@@ -24,6 +24,9 @@
 #include "ports.h"
 #include "display.h"
 #include "timer.h"
+#ifdef CONFIG_INFOMEM
+#include "infomem.h"
+#endif
 
 // logic
 #include "menu.h"
@@ -58,9 +61,21 @@ void doorlock_signal_failure();
 void doorlock_signal_timeout();
 void doorlock_signal_invalid();
 
-u8 verify_code();
+u8 verify_code(u8 patterns[][DOORLOCK_SEQUENCE_MAX_LENGTH], u8 count);
+void doorlock_load(void);
+void doorlock_enroll(u8 patterns[][DOORLOCK_SEQUENCE_MAX_LENGTH], u8 count);
 
-u8 sequence_saved[DOORLOCK_SEQUENCE_MAX_LENGTH] = {0};
+// Enrolled knock patterns: variants of the one valid code, all replaced by NEW CODE
+struct doorlock_patterns
+{
+	u8		pattern[DOORLOCK_PATTERNS][DOORLOCK_SEQUENCE_MAX_LENGTH];
+	u8		count;
+	u8		next;		// unused since NEW CODE replaces all patterns, keeps the stored layout
+};
+#define DOORLOCK_INFOMEM_WORDS		((sizeof(struct doorlock_patterns) + 1) / 2)
+
+struct doorlock_patterns sDoorlockPatterns;
+u8 doorlock_loaded = 0;
 u8 sequence[DOORLOCK_SEQUENCE_MAX_LENGTH] = {0};
 
 // *************************************************************************************************
@@ -77,6 +92,8 @@ void sx_gps(u8 line)
 	u8 i = 0;
 	u16 avg = 0;
 
+	doorlock_load();
+
 	// Enable idle timeout
 	sys.flag.idle_timeout_enabled = 1;
 
@@ -109,7 +126,7 @@ void sx_gps(u8 line)
 			 display_chars(LCD_SEG_L1_3_0, (u8*)"CODE", SEG_ON);
 			 display_chars(LCD_SEG_L2_4_0, (u8*)"PLEAS", SEG_ON);
 
-			error = verify_code();
+			error = verify_code(sDoorlockPatterns.pattern, sDoorlockPatterns.count);
 			if (error==DOORLOCK_ERROR_SUCCESS){
 				if (sys.flag.low_battery) break;
 				 // display_sync(LINE2, DISPLAY_LINE_UPDATE_FULL);
@@ -150,9 +167,12 @@ void sx_gps(u8 line)
 // *************************************************************************************************
 void mx_gps(u8 line)
 {
+	u8 sequence_new[2][DOORLOCK_SEQUENCE_MAX_LENGTH];
 	u8 error = DOORLOCK_ERROR_SUCCESS;
 
-	if (sequence_saved[0] != 0)
+	doorlock_load();
+
+	if (sDoorlockPatterns.count != 0)
 				{
 					// Clear display
 					 clear_display_all();
@@ -160,7 +180,7 @@ void mx_gps(u8 line)
 					 display_chars(LCD_SEG_L1_3_0, (u8*)" OLD", SEG_ON);
 					 display_chars(LCD_SEG_L2_4_0, (u8*)"CODE", SEG_ON);
 
-					 error = verify_code();
+					 error = verify_code(sDoorlockPatterns.pattern, sDoorlockPatterns.count);
 					 if (error != DOORLOCK_ERROR_SUCCESS ) return;
 				}
 					// Clear display
@@ -168,21 +188,23 @@ void mx_gps(u8 line)
 
 					 display_chars(LCD_SEG_L1_3_0, (u8*)" NEW", SEG_ON);
 					 display_chars(LCD_SEG_L2_4_0, (u8*)"CODE", SEG_ON);
-					sequence_saved[0] = 0;
-					error = verify_code();
+					error = verify_code(NULL, 0);
 					if (error == DOORLOCK_ERROR_SUCCESS ) {
-						memcpy(sequence_saved,sequence,DOORLOCK_SEQUENCE_MAX_LENGTH);
+						memcpy(sequence_new[0],sequence,DOORLOCK_SEQUENCE_MAX_LENGTH);
 
 
 						display_chars(LCD_SEG_L1_3_0, (u8*)"CODE", SEG_ON);
 						display_chars(LCD_SEG_L2_4_0, (u8*)"AGAIN", SEG_ON);
-						error = verify_code();
-						if (error == DOORLOCK_ERROR_SUCCESS ) memcpy(sequence_saved,sequence,DOORLOCK_SEQUENCE_MAX_LENGTH);
+						error = verify_code(sequence_new, 1);
+						// Both knocks replace the old code, it no longer opens
+						if (error == DOORLOCK_ERROR_SUCCESS ) {
+							memcpy(sequence_new[1],sequence,DOORLOCK_SEQUENCE_MAX_LENGTH);
+							doorlock_enroll(sequence_new, 2);
+						}
 						else {
 							display_chars(LCD_SEG_L1_3_0, (u8*)"CODE", SEG_ON);
 							display_chars(LCD_SEG_L2_4_0, (u8*)"FAIL", SEG_ON);
 							doorlock_signal_failure();
-							sequence_saved[0] = 0;
 							}
 					}
 
@@ -262,7 +284,14 @@ void doorlock_signal_invalid()
     stop_buzzer();
 }
 
-u8 verify_code()
+// *************************************************************************************************
+// @fn          verify_code
+// @brief       Record a knock sequence and match it against the given patterns.
+// @param       patterns		patterns to match
+//				u8 count		number of patterns, 0 = accept any sequence
+// @return      doorlock error code
+// *************************************************************************************************
+u8 verify_code(u8 patterns[][DOORLOCK_SEQUENCE_MAX_LENGTH], u8 count)
 {
 	u8 error=DOORLOCK_ERROR_FAILURE;
 
@@ -272,15 +301,8 @@ u8 verify_code()
 
 		  if (error == DOORLOCK_ERROR_SUCCESS)
 			{
-				//display_chars(LCD_SEG_L1_3_0, (u8*)"CODE", SEG_ON);
-				//display_chars(LCD_SEG_L2_4_0, (u8*)"  OK", SEG_ON);
-				//doorlock_signal_success();
-
-				if (sequence_saved[0] != 0){
-					error = sequence_compare(sequence_saved,sequence);
-				}
-				else {
-					error = DOORLOCK_ERROR_SUCCESS;
+				if (count != 0){
+					error = sequence_match(sequence, patterns, count);
 				}
 
 				if (error == DOORLOCK_ERROR_SUCCESS){
@@ -294,8 +316,6 @@ u8 verify_code()
 					 display_chars(LCD_SEG_L2_4_0, (u8*)"MATCH", SEG_ON);
 					 doorlock_signal_failure();
 				}
-
-			   // memcpy(sequence_saved,sequence,DOORLOCK_SEQUENCE_MAX_LENGTH);
 			}
 			else
 			{
@@ -306,4 +326,60 @@ u8 verify_code()
 	return DOORLOCK_ERROR_FAILURE;
 
 }
+
+
+// *************************************************************************************************
+// @fn          doorlock_load
+// @brief       Read the enrolled patterns from information memory once. Without the information
+//				memory driver, patterns are lost on reset.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void doorlock_load(void)
+{
+	if (doorlock_loaded) return;
+	doorlock_loaded = 1;
+
+	memset(&sDoorlockPatterns, 0, sizeof(sDoorlockPatterns));
+
+	#ifdef CONFIG_INFOMEM
+	u16 buf[DOORLOCK_INFOMEM_WORDS];
+
+	if (infomem_app_amount(DOORLOCK_INFOMEM_ID) != DOORLOCK_INFOMEM_WORDS) return;
+	if (infomem_app_read(DOORLOCK_INFOMEM_ID, buf, DOORLOCK_INFOMEM_WORDS, 0) != DOORLOCK_INFOMEM_WORDS) return;
+	memcpy(&sDoorlockPatterns, buf, sizeof(sDoorlockPatterns));
+
+	// Ignore a record that does not make sense
+	if (sDoorlockPatterns.count > DOORLOCK_PATTERNS || sDoorlockPatterns.next >= DOORLOCK_PATTERNS)
+	{
+		memset(&sDoorlockPatterns, 0, sizeof(sDoorlockPatterns));
+	}
+	#endif
+}
+
+
+// *************************************************************************************************
+// @fn          doorlock_enroll
+// @brief       Replace all patterns by the knocks of a new code and store them in information
+//				memory. The knocks are variants of the same code, a sequence that matches any of
+//				them opens. Patterns of the previous code are dropped.
+// @param       u8 patterns[][]	normalized sequences of the new code
+//				u8 count		number of sequences, 1 .. DOORLOCK_PATTERNS
+// @return      none
+// *************************************************************************************************
+void doorlock_enroll(u8 patterns[][DOORLOCK_SEQUENCE_MAX_LENGTH], u8 count)
+{
+	memset(&sDoorlockPatterns, 0, sizeof(sDoorlockPatterns));
+	memcpy(sDoorlockPatterns.pattern, patterns, count * DOORLOCK_SEQUENCE_MAX_LENGTH);
+	sDoorlockPatterns.count = count;
+
+	#ifdef CONFIG_INFOMEM
+	u16 buf[DOORLOCK_INFOMEM_WORDS];
+
+	buf[DOORLOCK_INFOMEM_WORDS - 1] = 0;
+	memcpy(buf, &sDoorlockPatterns, sizeof(sDoorlockPatterns));
+	infomem_app_replace(DOORLOCK_INFOMEM_ID, buf, DOORLOCK_INFOMEM_WORDS);
+	#endif
+}
+
 #endif // CONFIG_USE_GPS
\ No newline at end of file
@@ -0,0 +1,334 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// Daily temperature and battery statistics. The 1/min battery measurement also samples the
+// temperature, min, max and sum of both are kept for the day under way. At the first sample of a
+// new day the finished day is written to a flash log of at least HISTORY_DAYS days, shown in the
+// temperature and battery menus and uploaded in sync mode (SYNC_AP_CMD_GET_HISTORY).
+// *************************************************************************************************
+
+
+// *************************************************************************************************
+// Include section
+
+// system
+#include "project.h"
+
+#ifdef CONFIG_HISTORY
+
+// driver
+#include "display.h"
+#include "flash.h"
+
+// logic
+#include "history.h"
+#include "temperature.h"
+#include "battery.h"
+#include "date.h"
+
+
+// *************************************************************************************************
+// Prototypes section
+void history_store(void);
+
+
+// *************************************************************************************************
+// Defines section
+
+
+// *************************************************************************************************
+// Global Variable section
+struct history sHistory;
+
+// Day logs, written in turn
+static FLASH_SEGMENT(history_log0);
+static FLASH_SEGMENT(history_log1);
+static u8 * const history_segments[2] = { history_log0, history_log1 };
+
+
+// *************************************************************************************************
+// Extern section
+
+
+// *************************************************************************************************
+// @fn          history_count
+// @brief       Count the days in a segment.
+// @param       u8 segment		0, 1
+// @return      u8				days, 0 for an unused segment
+// *************************************************************************************************
+static u8 history_count(u8 segment)
+{
+	u8 * log = history_segments[segment];
+	u8 count = 0;
+	
+	if (log[0] != HISTORY_MAGIC) return (0);
+	while ((count < HISTORY_RECORDS) && (log[HISTORY_HEADER + count * HISTORY_RECORD] != FLASH_ERASED)) count++;
+	return (count);
+}
+
+
+// *************************************************************************************************
+// @fn          reset_history
+// @brief       Find the segment written last and start a new day.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void reset_history(void)
+{
+	u8 * log0 = history_segments[0];
+	u8 * log1 = history_segments[1];
+	
+	sHistory.samples = 0;
+	sHistory.temp_view = HISTORY_VIEW_NOW;
+	
+	// The newer segment has the higher generation
+	if (log1[0] == HISTORY_MAGIC && (log0[0] != HISTORY_MAGIC || (s8)(log1[1] - log0[1]) > 0))
+	{
+		sHistory.segment = 1;
+	}
+	else
+	{
+		sHistory.segment = 0;
+	}
+	sHistory.count[0] = history_count(0);
+	sHistory.count[1] = history_count(1);
+}
+
+
+// *************************************************************************************************
+// @fn          history_minute
+// @brief       Add the samples of the 1/min battery measurement to the statistics of the day. 
+//				Stores the day before at the first sample of a new day.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void history_minute(void)
+{
+	s16 temperature;
+	u16 voltage;
+	
+	if (sHistory.samples && ((sHistory.day != sDate.day) || (sHistory.month != sDate.month)))
+	{
+		history_store();
+		sHistory.samples = 0;
+	}
+	
+	temperature = temperature_sample();
+	voltage = sBatt.voltage;
+	
+	if (!sHistory.samples)
+	{
+		sHistory.month 	  = sDate.month;
+		sHistory.day 	  = sDate.day;
+		sHistory.temp_min = temperature;
+		sHistory.temp_max = temperature;
+		sHistory.temp_sum = 0;
+		sHistory.batt_min = voltage;
+		sHistory.batt_sum = 0;
+	}
+	
+	if (temperature < sHistory.temp_min) sHistory.temp_min = temperature;
+	if (temperature > sHistory.temp_max) sHistory.temp_max = temperature;
+	if (voltage < sHistory.batt_min) 	 sHistory.batt_min = voltage;
+	sHistory.temp_sum += temperature;
+	sHistory.batt_sum += voltage;
+	sHistory.samples++;
+	
+	// New data is available --> do display update
+	display.flag.update_temperature = 1;
+}
+
+
+// *************************************************************************************************
+// @fn          history_today
+// @brief       Statistics of the day under way in the format of the log.
+// @param       u8 * record		HISTORY_RECORD bytes, all 0 before the first sample
+// @return      none
+// *************************************************************************************************
+void history_today(u8 * record)
+{
+	s16 mean;
+	u16 batt;
+	u8 i;
+	
+	if (!sHistory.samples)
+	{
+		for (i=0; i<HISTORY_RECORD; i++) record[i] = 0;
+		return;
+	}
+	
+	record[HISTORY_RECORD_MONTH] = sHistory.month;
+	record[HISTORY_RECORD_DAY] 	 = sHistory.day;
+	record[HISTORY_RECORD_TEMP_MIN] 	= (u16)sHistory.temp_min >> 8;
+	record[HISTORY_RECORD_TEMP_MIN+1] 	= sHistory.temp_min & 0xFF;
+	record[HISTORY_RECORD_TEMP_MAX] 	= (u16)sHistory.temp_max >> 8;
+	record[HISTORY_RECORD_TEMP_MAX+1] 	= sHistory.temp_max & 0xFF;
+	mean = sHistory.temp_sum / (s16)sHistory.samples;
+	record[HISTORY_RECORD_TEMP_MEAN] 	= (u16)mean >> 8;
+	record[HISTORY_RECORD_TEMP_MEAN+1] 	= mean & 0xFF;
+	batt = sHistory.batt_sum * 10 / sHistory.samples;
+	record[HISTORY_RECORD_BATT_MEAN] 	= batt >> 8;
+	record[HISTORY_RECORD_BATT_MEAN+1] 	= batt & 0xFF;
+	batt = sHistory.batt_min;
+	if (batt < HISTORY_BATT_BASE) batt = HISTORY_BATT_BASE;
+	if (batt > HISTORY_BATT_BASE + 0xFE) batt = HISTORY_BATT_BASE + 0xFE;
+	record[HISTORY_RECORD_BATT_MIN] = batt - HISTORY_BATT_BASE;
+	record[HISTORY_RECORD_SAMPLES] 	= sHistory.samples / HISTORY_SAMPLES_UNIT;
+}
+
+
+// *************************************************************************************************
+// @fn          history_store
+// @brief       Write the statistics of the day to the log. A full segment continues in the other 
+//				one, which is erased.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void history_store(void)
+{
+	u8 record[HISTORY_RECORD];
+	u8 header[HISTORY_HEADER];
+	u8 * log;
+	u8 * other;
+	u8 count;
+	
+	history_today(record);
+	
+	log = history_segments[sHistory.segment];
+	count = sHistory.count[sHistory.segment];
+	
+	// Start a segment that is unused or continue in the other one when full
+	if ((log[0] != HISTORY_MAGIC) || (count >= HISTORY_RECORDS))
+	{
+		if (count >= HISTORY_RECORDS) sHistory.segment ^= 1;
+		log = history_segments[sHistory.segment];
+		other = history_segments[sHistory.segment ^ 1];
+		
+		header[0] = HISTORY_MAGIC;
+		header[1] = (other[0] == HISTORY_MAGIC) ? other[1] + 1 : 0;
+		flash_erase(log);
+		flash_write(log, header, HISTORY_HEADER);
+		count = 0;
+	}
+	
+	flash_write(&log[HISTORY_HEADER + count * HISTORY_RECORD], record, HISTORY_RECORD);
+	sHistory.count[sHistory.segment] = count + 1;
+}
+
+
+// *************************************************************************************************
+// @fn          history_days
+// @brief       Number of days shown and uploaded.
+// @param       none
+// @return      u8		0 .. HISTORY_DAYS
+// *************************************************************************************************
+u8 history_days(void)
+{
+	u8 days = sHistory.count[0] + sHistory.count[1];
+	
+	return ((days < HISTORY_DAYS) ? days : HISTORY_DAYS);
+}
+
+
+// *************************************************************************************************
+// @fn          history_log
+// @brief       Read a day of the log.
+// @param       u8 day			0 = oldest of the history_days() last days
+//				u8 offset		HISTORY_RECORD_xxx
+// @return      u8				log byte
+// *************************************************************************************************
+u8 history_log(u8 day, u8 offset)
+{
+	u8 segment = sHistory.segment;
+	u8 back = history_days() - 1 - day;
+	
+	// Days before the ones of the segment written last are at the end of the other one
+	if (back >= sHistory.count[segment])
+	{
+		back -= sHistory.count[segment];
+		segment ^= 1;
+	}
+	return (history_segments[segment][HISTORY_HEADER + (sHistory.count[segment] - 1 - back) * HISTORY_RECORD + offset]);
+}
+
+
+// *************************************************************************************************
+// @fn          history_battery_trend
+// @brief       Least squares slope of the daily mean battery voltage.
+// @param       none
+// @return      s16		0.01mV per day, HISTORY_TREND_UNKNOWN with less than 3 days
+// *************************************************************************************************
+s16 history_battery_trend(void)
+{
+	u8 days = history_days();
+	u8 i;
+	s32 y, y0 = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+	s32 den, slope;
+	
+	if (days < 3) return (HISTORY_TREND_UNKNOWN);
+	
+	for (i=0; i<days; i++)
+	{
+		// Relative to the first day to keep the sums small
+		y = (history_log(i, HISTORY_RECORD_BATT_MEAN) << 8) | history_log(i, HISTORY_RECORD_BATT_MEAN + 1);
+		if (i == 0) y0 = y;
+		y -= y0;
+		sx  += i;
+		sy  += y;
+		sxx += i * i;
+		sxy += i * y;
+	}
+	den = days * sxx - sx * sx;
+	slope = (days * sxy - sx * sy) * 100 / den;
+	
+	if (slope > 32767) slope = 32767;
+	if (slope < -32767) slope = -32767;
+	return ((s16)slope);
+}
+
+
+// *************************************************************************************************
+// @fn          history_clear
+// @brief       Erase an uploaded log. The day under way is kept.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void history_clear(void)
+{
+	flash_erase(history_segments[0]);
+	flash_erase(history_segments[1]);
+	sHistory.segment = 0;
+	sHistory.count[0] = 0;
+	sHistory.count[1] = 0;
+}
+
+#endif /* CONFIG_HISTORY */
@@ -0,0 +1,129 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+#ifndef HISTORY_H_
+#define HISTORY_H_
+
+// *************************************************************************************************
+// Include section
+
+
+// *************************************************************************************************
+// Prototypes section
+extern void reset_history(void);
+extern void history_minute(void);
+extern void history_today(u8 * record);
+extern u8 history_days(void);
+extern u8 history_log(u8 day, u8 offset);
+extern s16 history_battery_trend(void);
+extern void history_clear(void);
+
+
+// *************************************************************************************************
+// Defines section
+
+// Statistics of a day, min/max/mean of one temperature and one battery sample per minute
+#define HISTORY_RECORD_MONTH		(0u)	// Date of the day
+#define HISTORY_RECORD_DAY			(1u)
+#define HISTORY_RECORD_TEMP_MIN		(2u)	// Temperature in 0.1 degC, MSB first
+#define HISTORY_RECORD_TEMP_MAX		(4u)
+#define HISTORY_RECORD_TEMP_MEAN	(6u)
+#define HISTORY_RECORD_BATT_MEAN	(8u)	// Battery voltage in mV, MSB first
+#define HISTORY_RECORD_BATT_MIN		(10u)	// Battery voltage in 10mV above HISTORY_BATT_BASE
+#define HISTORY_RECORD_SAMPLES		(11u)	// Minutes sampled / HISTORY_SAMPLES_UNIT
+#define HISTORY_RECORD				(12u)
+
+#define HISTORY_BATT_BASE			(100u)
+#define HISTORY_SAMPLES_UNIT		(6u)
+
+// Days are kept in two flash segments that are filled in turn, so the older one still holds the
+// days before when the newer one is erased. A segment starts with HISTORY_MAGIC and a generation
+// that is one above the one of the other segment.
+#define HISTORY_MAGIC				(0x48u)
+#define HISTORY_HEADER				(2u)
+#define HISTORY_RECORDS				((FLASH_SEGMENT_SIZE - HISTORY_HEADER) / HISTORY_RECORD)
+
+// Battery trend with too few days
+#define HISTORY_TREND_UNKNOWN		(-32768)
+
+// Days shown and uploaded
+#define HISTORY_DAYS				(30u)
+
+// Sync upload: page 0 carries the number of days and the statistics of today, the following
+// pages one day each
+#define HISTORY_PAGES(days)			(1u + (days))
+
+// Display views of the temperature menu
+#define HISTORY_VIEW_NOW			(0u)
+#define HISTORY_VIEW_MAX			(1u)
+#define HISTORY_VIEW_MIN			(2u)
+#define HISTORY_VIEW_MEAN			(3u)
+
+
+// *************************************************************************************************
+// Global Variable section
+struct history
+{
+	// Date of the day under way
+	u8			month;
+	u8			day;
+	
+	// Minutes sampled today
+	u16			samples;
+	
+	// Temperature in 0.1 degC
+	s16			temp_min;
+	s16			temp_max;
+	s32			temp_sum;
+	
+	// Battery voltage in 10mV
+	u16			batt_min;
+	u32			batt_sum;
+	
+	// Segment written last and days in each segment
+	u8			segment;
+	u8			count[2];
+	
+	// Selected view of the temperature menu
+	u8			temp_view;
+};
+extern struct history sHistory;
+
+
+// *************************************************************************************************
+// Extern section
+
+
+#endif /*HISTORY_H_*/
@@ -0,0 +1,269 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// Free fall and shock logger on the acceleration sensor. While it is the only idle consumer, the
+// sensor waits in its free fall detection mode and the CPU sleeps until the interrupt. A fall or a
+// shock seen in the 40Hz samples of the pedometer and gesture recognizer starts one second of 8g/
+// 400Hz samples in the port ISR to find the peak. The main loop then writes the event with time
+// and peak to a flash log, which is uploaded in sync mode (SYNC_AP_CMD_GET_IMPACT).
+// *************************************************************************************************
+
+
+// *************************************************************************************************
+// Include section
+
+// system
+#include "project.h"
+
+#ifdef CONFIG_IMPACT
+
+// driver
+#include "vti_as.h"
+#include "power.h"
+#include "flash.h"
+
+// logic
+#include "impact.h"
+#include "clock.h"
+#include "date.h"
+
+
+// *************************************************************************************************
+// Prototypes section
+void impact_start(u8 type);
+u16 impact_sqrt(u16 value);
+
+
+// *************************************************************************************************
+// Defines section
+
+
+// *************************************************************************************************
+// Global Variable section
+struct impact sImpact;
+
+// Event log
+static FLASH_SEGMENT(impact_events);
+
+
+// *************************************************************************************************
+// Extern section
+
+
+// *************************************************************************************************
+// @fn          reset_impact
+// @brief       Count the logged events and start watching for falls and shocks. A segment that
+//				does not hold a log is erased.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void reset_impact(void)
+{
+	u8 type;
+	
+	sImpact.type = 0;
+	sImpact.capture = 0;
+	
+	sImpact.count = 0;
+	while (sImpact.count < IMPACT_RECORDS)
+	{
+		type = impact_events[sImpact.count * IMPACT_RECORD + IMPACT_RECORD_TYPE];
+		if (type == FLASH_ERASED) break;
+		
+		// Not written by the logger, the segment was not erased when the watch was programmed
+		if ((type != IMPACT_FALL) && (type != IMPACT_SHOCK))
+		{
+			impact_clear();
+			break;
+		}
+		sImpact.count++;
+	}
+	
+	power_acquire(POWER_ACCEL, POWER_USER_IMPACT);
+}
+
+
+// *************************************************************************************************
+// @fn          impact_start
+// @brief       Note time of an event and capture its peak at 400Hz. An event that is still 
+//				captured or not yet logged hides the new one. Called from the port ISR.
+// @param       u8 type		IMPACT_FALL, IMPACT_SHOCK
+// @return      none
+// *************************************************************************************************
+void impact_start(u8 type)
+{
+	if (sImpact.type) return;
+	
+	sImpact.type 	= type;
+	sImpact.time[0] = sDate.month;
+	sImpact.time[1] = sDate.day;
+	sImpact.time[2] = sTime.hour;
+	sImpact.time[3] = sTime.minute;
+	sImpact.time[4] = sTime.second;
+	sImpact.peak 	= 0;
+	sImpact.capture = IMPACT_CAPTURE;
+	as_idle_sampling(POWER_USER_IMPACT, 1);
+}
+
+
+// *************************************************************************************************
+// @fn          impact_freefall
+// @brief       Free fall interrupt of the acceleration sensor. Called from the port ISR.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void impact_freefall(void)
+{
+	impact_start(IMPACT_FALL);
+}
+
+
+// *************************************************************************************************
+// @fn          impact_sample
+// @brief       Check one 8g sample for a shock, or track the peak of the event under capture.
+//				Called from the port ISR.
+// @param       u8 * xyz		X/Y/Z acceleration in 71mg
+// @return      u8		1 = capture done, log the event in the main loop
+// *************************************************************************************************
+u8 impact_sample(u8 * xyz)
+{
+	s8 * s = (s8 *)xyz;
+	u16 square;
+	
+	square = (u16)(s[0]*s[0]) + (u16)(s[1]*s[1]) + (u16)(s[2]*s[2]);
+	
+	if (!sImpact.capture)
+	{
+		if (square > IMPACT_SHOCK_SQUARE) impact_start(IMPACT_SHOCK);
+		else return (0);
+	}
+	
+	if (square > sImpact.peak) sImpact.peak = square;
+	if (--sImpact.capture) return (0);
+	
+	as_idle_sampling(POWER_USER_IMPACT, 0);
+	return (1);
+}
+
+
+// *************************************************************************************************
+// @fn          impact_sqrt
+// @brief       Integer square root.
+// @param       u16 value
+// @return      u16		floor of the square root
+// *************************************************************************************************
+u16 impact_sqrt(u16 value)
+{
+	u16 root = 0;
+	u16 bit = 1u << 14;
+	
+	while (bit > value) bit >>= 2;
+	while (bit)
+	{
+		if (value >= root + bit)
+		{
+			value -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else
+		{
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return (root);
+}
+
+
+// *************************************************************************************************
+// @fn          impact_process
+// @brief       Write the captured event to the log. A full log is restarted with its newest events.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void impact_process(void)
+{
+	u8 record[IMPACT_RECORD];
+	u8 keep[IMPACT_KEEP * IMPACT_RECORD];
+	u16 peak, i;
+	
+	if (!sImpact.type || sImpact.capture) return;
+	
+	peak = impact_sqrt(sImpact.peak) * 71;
+	
+	record[IMPACT_RECORD_TYPE] = sImpact.type;
+	for (i=0; i<sizeof(sImpact.time); i++) record[IMPACT_RECORD_MONTH + i] = sImpact.time[i];
+	record[IMPACT_RECORD_PEAK] 	 = peak >> 8;
+	record[IMPACT_RECORD_PEAK+1] = peak & 0xFF;
+	
+	if (sImpact.count >= IMPACT_RECORDS)
+	{
+		for (i=0; i<sizeof(keep); i++) keep[i] = impact_events[(IMPACT_RECORDS - IMPACT_KEEP) * IMPACT_RECORD + i];
+		flash_erase(impact_events);
+		flash_write(impact_events, keep, sizeof(keep));
+		sImpact.count = IMPACT_KEEP;
+	}
+	
+	flash_write(&impact_events[sImpact.count * IMPACT_RECORD], record, IMPACT_RECORD);
+	sImpact.count++;
+	
+	// Ready for the next event
+	sImpact.type = 0;
+}
+
+
+// *************************************************************************************************
+// @fn          impact_log
+// @brief       Read the log for upload.
+// @param       u16 offset		record * IMPACT_RECORD + IMPACT_RECORD_xxx
+// @return      u8				log byte, FLASH_ERASED past the end of the log
+// *************************************************************************************************
+u8 impact_log(u16 offset)
+{
+	if (offset >= FLASH_SEGMENT_SIZE) return (FLASH_ERASED);
+	return (impact_events[offset]);
+}
+
+
+// *************************************************************************************************
+// @fn          impact_clear
+// @brief       Erase an uploaded log.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void impact_clear(void)
+{
+	flash_erase(impact_events);
+	sImpact.count = 0;
+}
+
+#endif /* CONFIG_IMPACT */
@@ -0,0 +1,112 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+#ifndef IMPACT_H_
+#define IMPACT_H_
+
+// *************************************************************************************************
+// Include section
+
+
+// *************************************************************************************************
+// Prototypes section
+extern void reset_impact(void);
+extern void impact_freefall(void);
+extern u8 impact_sample(u8 * xyz);
+extern void impact_process(void);
+extern u8 impact_log(u16 offset);
+extern void impact_clear(void);
+
+
+// *************************************************************************************************
+// Defines section
+
+// Event types
+#define IMPACT_FALL					(1u)	// Free fall interrupt of the sensor, peak of the landing
+#define IMPACT_SHOCK				(2u)	// Sample above IMPACT_SHOCK_COUNTS, peak of the shock
+
+// Samples at 8g/400Hz taken after an event to find its peak, 1s
+#define IMPACT_CAPTURE				(400u)
+
+// A sample counts as shock above 3g, squared magnitude in counts of 71mg
+#define IMPACT_SHOCK_COUNTS			(42u)
+#define IMPACT_SHOCK_SQUARE			(IMPACT_SHOCK_COUNTS * IMPACT_SHOCK_COUNTS)
+
+// Events are kept in one flash segment, records of IMPACT_RECORD bytes. Unwritten records read
+// FLASH_ERASED, so the number of events is found again after a reset. A full log is erased and 
+// restarted with its newest IMPACT_KEEP events.
+#define IMPACT_RECORD_TYPE			(0u)	// IMPACT_xxx
+#define IMPACT_RECORD_MONTH			(1u)	// Date and time of the event
+#define IMPACT_RECORD_DAY			(2u)
+#define IMPACT_RECORD_HOUR			(3u)
+#define IMPACT_RECORD_MINUTE		(4u)
+#define IMPACT_RECORD_SECOND		(5u)
+#define IMPACT_RECORD_PEAK			(6u)	// Peak acceleration in mg, MSB first
+#define IMPACT_RECORD				(8u)
+#define IMPACT_RECORDS				(FLASH_SEGMENT_SIZE / IMPACT_RECORD)
+#define IMPACT_KEEP					(8u)
+
+// Sync upload: page 0 carries the number of events, the following pages two records each
+#define IMPACT_RECORDS_PER_PAGE		(2u)
+#define IMPACT_PAGES(count)			(1u + ((count) + IMPACT_RECORDS_PER_PAGE - 1u) / IMPACT_RECORDS_PER_PAGE)
+
+
+// *************************************************************************************************
+// Global Variable section
+struct impact
+{
+	// Event under capture or waiting for the main loop, IMPACT_xxx, 0 = none
+	volatile u8	type;
+	
+	// Date and time of the event
+	u8			time[IMPACT_RECORD_PEAK - IMPACT_RECORD_MONTH];
+	
+	// 400Hz samples left to capture, 0 = not capturing
+	u16			capture;
+	
+	// Largest squared magnitude seen during the capture
+	u16			peak;
+	
+	// Events in the log
+	u8			count;
+};
+extern struct impact sImpact;
+
+
+// *************************************************************************************************
+// Extern section
+
+
+#endif /*IMPACT_H_*/
@@ -96,6 +96,14 @@
 #include "gps.h"
 #endif
 
+#ifdef CONFIG_PEDOMETER
+#include "pedometer.h"
+#endif
+
+#ifdef CONFIG_WEATHER
+#include "weather.h"
+#endif
+
 
 // *************************************************************************************************
 // Defines section
@@ -168,7 +176,7 @@ u8 update_sidereal(void)
 //
 //	LINE1: 	[Time] -> Alarm -> Temperature -> Altitude -> AltitudeAccumulator -> Heart rate -> Speed -> Acceleration
 //
-//	LINE2: 	[Date] -> Stopwatch -> Battery  -> ACC -> PPT -> SYNC -> Calories/Distance --> RFBSL
+//	LINE2: 	[Date] -> Stopwatch -> Pedometer -> Battery  -> ACC -> PPT -> SYNC -> Calories/Distance --> RFBSL
 // *************************************************************************************************
 
 // Line1 - Time
@@ -207,7 +215,11 @@ const struct menu menu_L1_Alarm =
 // Line1 - Temperature
 const struct menu menu_L1_Temperature =
 {
+#ifdef CONFIG_HISTORY
+	FUNCTION(sx_temperature),			// direct function
+#else
 	FUNCTION(dummy),					// direct function
+#endif
 	FUNCTION(mx_temperature),			// sub menu function
 	FUNCTION(menu_skip_next),			// next item function
 	FUNCTION(display_temperature),		// display function
@@ -314,6 +326,28 @@ const struct menu menu_L2_Eggtimer =
         FUNCTION(update_eggtimer),      // new display data
 };
 #endif
+#ifdef CONFIG_PEDOMETER
+// Line2 - Pedometer (steps of the day, cadence)
+const struct menu menu_L2_Pedometer =
+{
+	FUNCTION(sx_pedometer),			// direct function
+	FUNCTION(dummy),				// sub menu function
+	FUNCTION(menu_skip_next),		// next item function
+	FUNCTION(display_pedometer),	// display function
+	FUNCTION(update_time),			// new display data
+};
+#endif
+#ifdef CONFIG_WEATHER
+// Line2 - Weather (pressure, 3 hour tendency, forecast)
+const struct menu menu_L2_Weather =
+{
+	FUNCTION(sx_weather),			// direct function
+	FUNCTION(dummy),				// sub menu function
+	FUNCTION(menu_skip_next),		// next item function
+	FUNCTION(display_weather),		// display function
+	FUNCTION(update_time),			// new display data
+};
+#endif
 // Line2 - Battery 
 #ifdef CONFIG_BATTERY
 const struct menu menu_L2_Battery =
@@ -324,7 +358,11 @@ const struct menu menu_L2_Battery =
 	FUNCTION(nx_rfbsl), // next item function
 	FUNCTION(display_discret_rfbsl),
 	#else
+	#if defined(CONFIG_HISTORY) || defined(CONFIG_GAUGE)
+	FUNCTION(sx_battery), // direct function
+	#else
 	FUNCTION(dummy), // sub menu function
+	#endif
 	FUNCTION(dummy), // direct function
 	FUNCTION(menu_skip_next), // next item function
 	FUNCTION(display_battery_V), // display function
@@ -333,7 +371,7 @@ const struct menu menu_L2_Battery =
 };
 #endif
 #ifdef CONFIG_PHASE_CLOCK
-// Line2 - ACC (acceleration data + button events via SimpliciTI)
+// Line2 - SLEEP (sleep phase recorder)
 const struct menu menu_L2_Phase =
 {
 	FUNCTION(sx_phase),				// direct function
@@ -372,7 +410,11 @@ const struct menu menu_L2_Ppt =
 const struct menu menu_L2_Sync =
 {
 	FUNCTION(sx_sync),				// direct function
+#ifdef CONFIG_PROFILE
+	FUNCTION(mx_profile),			// sub menu function
+#else
 	FUNCTION(dummy),				// sub menu function
+#endif
 	FUNCTION(menu_skip_next),		// next item function
 	FUNCTION(display_sync),			// display function
 	FUNCTION(update_time),			// new display data
@@ -485,6 +527,12 @@ const struct menu *menu_L2[]={
 	#ifdef CONFIG_EGGTIMER
 	&menu_L2_Eggtimer,
 	#endif
+	#ifdef CONFIG_PEDOMETER
+	&menu_L2_Pedometer,
+	#endif
+	#ifdef CONFIG_WEATHER
+	&menu_L2_Weather,
+	#endif
 	#ifdef CONFIG_BATTERY
 	&menu_L2_Battery,
 	#endif
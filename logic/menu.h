@@ -126,6 +126,9 @@ extern const struct menu menu_L2_Prout;
 #ifdef CONFIG_VARIO
 extern const struct menu menu_L2_Vario;
 #endif
+#ifdef CONFIG_WEATHER
+extern const struct menu menu_L2_Weather;
+#endif
 
 #ifdef CONFIG_USE_GPS
 extern const struct menu menu_L2_Gps;
@@ -0,0 +1,302 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Step counter running on the acceleration sensor at all times. The sensor waits in motion 
+// detection mode and is switched to 40Hz sampling by the first motion interrupt. Samples are read
+// in the port ISR and handed to the main loop in bursts, where a peak detector counts steps.
+// After some seconds without step, the sensor goes back to motion detection.
+// *************************************************************************************************
+
+
+// *************************************************************************************************
+// Include section
+
+// system
+#include "project.h"
+
+#ifdef CONFIG_PEDOMETER
+
+// driver
+#include "display.h"
+#include "vti_as.h"
+#include "power.h"
+
+// logic
+#include "pedometer.h"
+#include "date.h"
+
+
+// *************************************************************************************************
+// Prototypes section
+void pedometer_new_day(void);
+void pedometer_detect(u8 magnitude);
+
+
+// *************************************************************************************************
+// Defines section
+
+// Cadence in steps per minute from the step interval in 1/16 samples of 25ms
+#define PEDOMETER_CADENCE(interval)	((u8)((40u * 60u * 16u) / (interval)))
+
+
+// *************************************************************************************************
+// Global Variable section
+struct pedometer sPedometer;
+
+
+// *************************************************************************************************
+// Extern section
+
+
+// *************************************************************************************************
+// @fn          reset_pedometer
+// @brief       Reset step count and start the acceleration sensor in motion detection mode.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void reset_pedometer(void)
+{
+	sPedometer.steps 	= 0;
+	sPedometer.cadence 	= 0;
+	sPedometer.day 		= sDate.day;
+	sPedometer.view		= PEDOMETER_VIEW_STEPS;
+	sPedometer.since	= PEDOMETER_STILL;
+	sPedometer.run		= 0;
+	
+	as_idle_sampling(POWER_USER_PEDOMETER, 0);
+	power_acquire(POWER_ACCEL, POWER_USER_PEDOMETER);
+}
+
+
+// *************************************************************************************************
+// @fn          pedometer_motion
+// @brief       Motion interrupt of the acceleration sensor, start sampling. Called from the port ISR.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void pedometer_motion(void)
+{
+	// Start a new walk: seed the baseline with the first sample, allow 2s for the first step
+	sPedometer.baseline = 0;
+	sPedometer.since	= PEDOMETER_MAX_INTERVAL;
+	sPedometer.count	= 0;
+	as_idle_sampling(POWER_USER_PEDOMETER, 1);
+}
+
+
+// *************************************************************************************************
+// @fn          pedometer_sample
+// @brief       Store the magnitude of one 8g/40Hz sample. Called from the port ISR.
+// @param       u8 * xyz		X/Y/Z acceleration in 71mg
+// @return      u8		1 = a burst of samples is complete, process it in the main loop
+// *************************************************************************************************
+u8 pedometer_sample(u8 * xyz)
+{
+	u8 axis[3], i;
+	u16 sum, max;
+	
+	axis[0] = xyz[0];
+	axis[1] = xyz[1];
+	axis[2] = xyz[2];
+	
+	// Magnitude estimated as max + 5/16 * (sum of the other two), within 10% of the true length
+	sum = 0;
+	max = 0;
+	for (i=0; i<3; i++)
+	{
+		if (axis[i] & BIT7) axis[i] = -axis[i];
+		sum += axis[i];
+		if (axis[i] > max) max = axis[i];
+	}
+	max += ((sum - max) * 5) >> 4;
+	if (max > 255) max = 255;
+	
+	sPedometer.sample[sPedometer.fill][sPedometer.count] = max;
+	if (++sPedometer.count < PEDOMETER_BURST) return (0);
+	
+	// Burst complete, continue with the other half
+	sPedometer.fill ^= 1;
+	sPedometer.count = 0;
+	return (1);
+}
+
+
+// *************************************************************************************************
+// @fn          pedometer_detect
+// @brief       Step detector for one sample. A step is a rise of the magnitude above the slowly
+//				following gravity baseline. Crossings are only counted at a plausible interval 
+//				and after PEDOMETER_REGULATION steps in a row.
+// @param       u8 magnitude		Acceleration magnitude in 71mg
+// @return      none
+// *************************************************************************************************
+void pedometer_detect(u8 magnitude)
+{
+	s16 x = (s16)magnitude << 4;
+	s16 d;
+	u8 since;
+	
+	if (sPedometer.baseline == 0)
+	{
+		sPedometer.baseline = x;
+		sPedometer.smooth 	= x;
+	}
+	sPedometer.baseline += (x - sPedometer.baseline) >> 5;
+	sPedometer.smooth 	+= (x - sPedometer.smooth) >> 1;
+	d = sPedometer.smooth - sPedometer.baseline;
+	
+	if (sPedometer.since < 255) sPedometer.since++;
+	
+	// Wait until the magnitude has fallen back to the baseline
+	if (sPedometer.above)
+	{
+		if (d < 0) sPedometer.above = 0;
+		return;
+	}
+	if (d < (s16)PEDOMETER_THRESHOLD) return;
+	sPedometer.above = 1;
+	
+	// Ignore bounces of the last step
+	since = sPedometer.since;
+	if (since < PEDOMETER_MIN_INTERVAL) return;
+	sPedometer.since = 0;
+	
+	if (since > PEDOMETER_MAX_INTERVAL)
+	{
+		// First step of a walk
+		sPedometer.run = 1;
+	}
+	else if (sPedometer.run < PEDOMETER_REGULATION)
+	{
+		if (sPedometer.run == 1) 	sPedometer.interval = (u16)since << 4;
+		else 						sPedometer.interval += (((s16)since << 4) - (s16)sPedometer.interval) >> 2;
+		
+		// Walk confirmed, count the steps held back so far
+		if (++sPedometer.run == PEDOMETER_REGULATION) sPedometer.steps += PEDOMETER_REGULATION;
+	}
+	else
+	{
+		sPedometer.interval += (((s16)since << 4) - (s16)sPedometer.interval) >> 2;
+		sPedometer.steps++;
+	}
+}
+
+
+// *************************************************************************************************
+// @fn          pedometer_new_day
+// @brief       Start counting from zero on a new day.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void pedometer_new_day(void)
+{
+	if (sPedometer.day != sDate.day)
+	{
+		sPedometer.steps = 0;
+		sPedometer.day = sDate.day;
+	}
+}
+
+
+// *************************************************************************************************
+// @fn          pedometer_process
+// @brief       Run the step detector over the last burst of samples. Switch the sensor back to
+//				motion detection when no step was seen for PEDOMETER_STILL samples.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void pedometer_process(void)
+{
+	u8 * sample = sPedometer.sample[sPedometer.fill ^ 1];
+	u8 i;
+	
+	pedometer_new_day();
+	
+	for (i=0; i<PEDOMETER_BURST; i++) pedometer_detect(sample[i]);
+	
+	if (sPedometer.since >= PEDOMETER_STILL)
+	{
+		sPedometer.run = 0;
+		as_idle_sampling(POWER_USER_PEDOMETER, 0);
+	}
+	
+	if (sPedometer.run >= PEDOMETER_REGULATION) sPedometer.cadence = PEDOMETER_CADENCE(sPedometer.interval);
+	else										sPedometer.cadence = 0;
+}
+
+
+// *************************************************************************************************
+// @fn          sx_pedometer
+// @brief       Button DOWN toggles between steps and cadence.
+// @param       u8 line		LINE2
+// @return      none
+// *************************************************************************************************
+void sx_pedometer(u8 line)
+{
+	sPedometer.view ^= 1;
+	display.flag.line2_full_update = 1;
+}
+
+
+// *************************************************************************************************
+// @fn          display_pedometer
+// @brief       Display steps of the day (TOTAL) or current cadence in steps per minute (AVERAGE).
+// @param       u8 line		LINE2
+//				u8 update		DISPLAY_LINE_UPDATE_FULL, DISPLAY_LINE_UPDATE_PARTIAL, DISPLAY_LINE_CLEAR
+// @return      none
+// *************************************************************************************************
+void display_pedometer(u8 line, u8 update)
+{
+	if (update == DISPLAY_LINE_CLEAR)
+	{
+		display_symbol(LCD_SYMB_TOTAL, SEG_OFF);
+		display_symbol(LCD_SYMB_AVERAGE, SEG_OFF);
+		return;
+	}
+	
+	pedometer_new_day();
+	
+	if (sPedometer.view == PEDOMETER_VIEW_STEPS)
+	{
+		display_chars(LCD_SEG_L2_5_0, itoa(sPedometer.steps, 6, 5), SEG_ON);
+		display_symbol(LCD_SYMB_AVERAGE, SEG_OFF);
+		display_symbol(LCD_SYMB_TOTAL, SEG_ON);
+	}
+	else
+	{
+		display_chars(LCD_SEG_L2_5_0, itoa(sPedometer.cadence, 6, 5), SEG_ON);
+		display_symbol(LCD_SYMB_TOTAL, SEG_OFF);
+		display_symbol(LCD_SYMB_AVERAGE, SEG_ON);
+	}
+}
+
+#endif /* CONFIG_PEDOMETER */
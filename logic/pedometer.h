@@ -0,0 +1,107 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef PEDOMETER_H_
+#define PEDOMETER_H_
+
+// *************************************************************************************************
+// Include section
+
+
+// *************************************************************************************************
+// Prototypes section
+extern void reset_pedometer(void);
+extern void pedometer_motion(void);
+extern u8 pedometer_sample(u8 * xyz);
+extern void pedometer_process(void);
+extern void sx_pedometer(u8 line);
+extern void display_pedometer(u8 line, u8 update);
+
+
+// *************************************************************************************************
+// Defines section
+
+// Samples collected by the port ISR before the main loop is woken, 0.8s at 40Hz
+#define PEDOMETER_BURST				(32u)
+
+// Step detector, in samples of 25ms and in 1/16 of the 71mg sensor resolution
+#define PEDOMETER_THRESHOLD			(3u*16u)	// Rise above the gravity baseline that counts as step
+#define PEDOMETER_MIN_INTERVAL		(10u)		// 250ms, faster crossings are bounces of one step
+#define PEDOMETER_MAX_INTERVAL		(80u)		// 2s, longer pauses start a new walk
+#define PEDOMETER_STILL				(160u)		// 4s without step: back to motion detection
+
+// Steps in a row with plausible interval before a walk is counted, filters single arm movements
+#define PEDOMETER_REGULATION		(4u)
+
+#define PEDOMETER_VIEW_STEPS		(0u)
+#define PEDOMETER_VIEW_CADENCE		(1u)
+
+
+// *************************************************************************************************
+// Global Variable section
+struct pedometer
+{
+	// Steps counted today
+	u32			steps;
+	
+	// Steps per minute, 0 while still
+	u8			cadence;
+	
+	// Day of month the step count belongs to
+	u8			day;
+
+	// PEDOMETER_VIEW_STEPS, PEDOMETER_VIEW_CADENCE
+	u8			view;
+
+	// Magnitude samples, the ISR fills one half while the other one is processed
+	u8			sample[2][PEDOMETER_BURST];
+	u8			fill;
+	u8			count;
+
+	// Step detector state: gravity baseline and smoothed magnitude in 1/16 counts
+	s16			baseline;
+	s16			smooth;
+	u8			above;
+	u8			since;
+	u8			run;
+	u16			interval;
+};
+extern struct pedometer sPedometer;
+
+
+// *************************************************************************************************
+// Extern section
+
+
+#endif /*PEDOMETER_H_*/
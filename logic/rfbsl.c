@@ -54,6 +54,15 @@
 #include "bluerobin.h"
 #endif
 #include "rfsimpliciti.h"
+#ifdef CONFIG_SETTINGS
+#include "settings.h"
+#endif
+#ifdef CONFIG_DVFS
+#include "dvfs.h"
+#endif
+#ifdef CONFIG_CRASH_LOG
+#include "crash.h"
+#endif
 
 
 // *************************************************************************************************
@@ -99,6 +108,21 @@ void mx_rfbsl(u8 line)
 	// Write RAM to indicate we will be downloading the RAM Updater first
 	display_chars(LCD_SEG_L1_3_0, (u8 *)" RAM", SEG_ON);
 	
+#ifdef CONFIG_SETTINGS
+	// Save pending settings, the update may not return here
+	settings_flush();
+#endif
+
+#ifdef CONFIG_DVFS
+	// RFBSL expects the boot clock setup, it does not return
+	dvfs_acquire();
+#endif
+
+#ifdef CONFIG_CRASH_LOG
+	// The update ends with a reset, do not record it as crash
+	crash_disarm();
+#endif
+
 	// Call RFBSL
 	CALL_RFSBL();
 
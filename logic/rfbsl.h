@@ -51,7 +51,13 @@ extern void display_discret_rfbsl(u8 line, u8 update);
 // Defines section
 
 // Entry point of of the Flash Updater in BSL memory
+#ifdef EZCHRONOS_HOST
+// No updater on the host, the emulator ends the run instead
+extern void cc430_rfbsl(void);
+#define CALL_RFSBL()   cc430_rfbsl()
+#else
 #define CALL_RFSBL()   ((void (*)())0x1000)()
+#endif
 
 
 #endif /*RFBSL_H_*/
@@ -51,6 +51,7 @@
 #include "ports.h"
 #include "timer.h"
 #include "radio.h"
+#include "power.h"
 
 // logic
 #ifdef FEATURE_PROVIDE_ACCEL
@@ -81,11 +82,18 @@
 #include "dst.h"
 #endif
 
+#ifdef CONFIG_PROFILE
+#include "profile.h"
+#include "stack.h"
+#endif
+
 // *************************************************************************************************
 // Defines section
 
-// Each packet index requires 2 bytes, so we can have 9 packet indizes in 18 bytes usable payload
-#define BM_SYNC_BURST_PACKETS_IN_DATA		(9u)
+#ifdef CONFIG_PROFILE
+// Count and active time per source, then RX, TX, uptime and stack high water mark
+#define PROFILE_VIEWS						(PROFILE_SOURCES * 2 + 4)
+#endif
 
 // *************************************************************************************************
 // Prototypes section
@@ -93,6 +101,9 @@ void simpliciti_get_data_callback(void);
 void start_simpliciti_tx_only(simpliciti_mode_t mode);
 void start_simpliciti_sync(void);
 int simpliciti_get_rvc_callback(u8 len) __attribute__((noinline));
+#ifdef CONFIG_PROFILE
+void display_profile(u8 view);
+#endif
 
 
 // *************************************************************************************************
@@ -111,26 +122,17 @@ unsigned char simpliciti_ed_address[4];
 // Length of data 
 unsigned char simpliciti_payload_length;
 
-// 1 = send one or more reply packets, 0 = no need to reply
-//unsigned char simpliciti_reply;
-unsigned char simpliciti_reply_count;
-
-// 1 = send packets sequentially from burst_start to burst_end, 2 = send packets addressed by their index
-u8 		burst_mode;
-
-// Start and end index of packets to send out
-u16		burst_start, burst_end;
-
-// Array containing requested packets
-u16		burst_packet[BM_SYNC_BURST_PACKETS_IN_DATA];
-
-// Current packet index
-u8		burst_packet_index;
-
+#ifdef CONFIG_PROFILE
+// Line1 labels of the profile viewer
+static const u8 profile_label[PROFILE_SOURCES][4] = { "TA0", "TA1", "BTN", "ADC", "RAD", "ACC", "PRS", "OTH" };
+static const u8 profile_label_total[4][5] = { "RX T", "TX T", "UP S", "STK " };
+#endif
 
 // *************************************************************************************************
 // Extern section
 extern void (*fptr_lcd_function_line1)(u8 line, u8 update);
+extern void to_lpm(void);
+extern void idle_loop(void);
 
 
 // *************************************************************************************************
@@ -240,14 +242,6 @@ void start_simpliciti_tx_only(simpliciti_mode_t mode)
 		simpliciti_data[0] = SIMPLICITI_MOUSE_EVENTS;
         start_as = 1;
 	}
-#endif
-#ifdef CONFIG_PHASE_CLOCK
-    if (mode == SIMPLICITI_PHASE_CLOCK_START || mode == SIMPLICITI_PHASE_CLOCK)
-    {
-        if(mode == SIMPLICITI_PHASE_CLOCK)
-            start_as = 1;
-    	display_symbol(LCD_ICON_RECORD, SEG_ON_BLINK_ON);
-    }
 #endif
 	if (mode == SIMPLICITI_BUTTONS)
 	{
@@ -265,8 +259,15 @@ void start_simpliciti_tx_only(simpliciti_mode_t mode)
 	// Debounce button event
 	Timer0_A4_Delay(CONV_MS_TO_TICKS(BUTTONS_DEBOUNCE_TIME_OUT));
 	
+	// Get updated temperature for radio calibration
+	temperature_measurement(FILTER_OFF);
+	simpliciti_link_temperature(sTemp.degrees);
+
+	// System tick is frozen while SimpliciTI runs, drop lingering peripherals now
+	power_idle();
+
 	// Prepare radio for RF communication
-	open_radio();
+	power_acquire(POWER_RADIO, POWER_USER_SIMPLICITI);
 
 	// Set SimpliciTI mode
 	sRFsmpl.mode = mode;
@@ -282,7 +283,7 @@ void start_simpliciti_tx_only(simpliciti_mode_t mode)
 		if (start_as)
 		{
 			// Start acceleration sensor
-			as_start();
+			power_acquire(POWER_ACCEL, POWER_USER_SIMPLICITI);
 		}
 		#endif
 
@@ -295,11 +296,11 @@ void start_simpliciti_tx_only(simpliciti_mode_t mode)
 
 	#ifdef FEATURE_PROVIDE_ACCEL
 	// Stop acceleration sensor
-	as_stop();
+	power_release(POWER_ACCEL, POWER_USER_SIMPLICITI);
 	#endif
 
 	// Powerdown radio
-	close_radio();
+	power_release(POWER_RADIO, POWER_USER_SIMPLICITI);
 	
 	// Clear last button events
 	Timer0_A4_Delay(CONV_MS_TO_TICKS(BUTTONS_DEBOUNCE_TIME_OUT));
@@ -311,13 +312,6 @@ void start_simpliciti_tx_only(simpliciti_mode_t mode)
 	display_symbol(LCD_ICON_BEEPER2, SEG_OFF_BLINK_OFF);
 	display_symbol(LCD_ICON_BEEPER3, SEG_OFF_BLINK_OFF);
 
-#ifdef CONFIG_PHASE_CLOCK
-    if (mode == SIMPLICITI_PHASE_CLOCK || mode == SIMPLICITI_PHASE_CLOCK_START)
-    {
-        display_symbol(LCD_ICON_RECORD, SEG_OFF_BLINK_OFF);
-
-    }
-#endif
 	
  	// Clean up line 1
 	clear_line(LINE1);  	
@@ -378,6 +372,114 @@ void display_sync(u8 line, u8 update)
 }
 
 
+#ifdef CONFIG_PROFILE
+// *************************************************************************************************
+// @fn          mx_profile
+// @brief       Hidden energy profile viewer. Button UP/DOWN steps through wakeup count and active
+//				time of each wakeup source, radio airtime and uptime. STAR or NUM exits.
+// @param       u8 line			LINE2
+// @return      none
+// *************************************************************************************************
+void mx_profile(u8 line)
+{
+	u8 view = 0;
+	u8 update = 1;
+	
+	// Clear display
+	clear_display_all();
+	
+	while (1)
+	{
+		// Idle timeout or button STAR/NUM: exit
+		if (sys.flag.idle_timeout) break;
+		if (button.flag.star || button.flag.num) break;
+		
+		// Button UP/DOWN: next/previous view
+		if (button.flag.up)
+		{
+			if (++view >= PROFILE_VIEWS) view = 0;
+			button.flag.up = 0;
+			update = 1;
+		}
+		if (button.flag.down)
+		{
+			if (view-- == 0) view = PROFILE_VIEWS - 1;
+			button.flag.down = 0;
+			update = 1;
+		}
+		
+		// Refresh once per second, the counters keep running
+		if (display.flag.update_time)
+		{
+			display.flag.update_time = 0;
+			update = 1;
+		}
+		
+		if (update)
+		{
+			display_profile(view);
+			update = 0;
+		}
+		
+		idle_loop();
+	}
+	
+	// Clear button flags
+	button.all_flags = 0;
+}
+
+
+// *************************************************************************************************
+// @fn          display_profile
+// @brief       Show one profile counter. Times are shown in ms, uptime in s, stack in bytes.
+// @param       u8 view			0 .. PROFILE_VIEWS-1
+// @return      none
+// *************************************************************************************************
+void display_profile(u8 view)
+{
+	istate_t s;
+	u8 label[5];
+	u8 src;
+	u32 value;
+	
+	s = __get_interrupt_state();
+	__disable_interrupt();
+	if (view < PROFILE_SOURCES * 2)
+	{
+		src = view >> 1;
+		memcpy(label, profile_label[src], 3);
+		if (view & 1)
+		{
+			label[3] = 'T';
+			value = sProfile.active[src];
+		}
+		else
+		{
+			label[3] = 'N';
+			value = sProfile.wakeups[src];
+		}
+		label[4] = 0;
+	}
+	else
+	{
+		src = view - PROFILE_SOURCES * 2;
+		memcpy(label, profile_label_total[src], 5);
+		if (src < 2) 		value = sProfile.airtime[src];
+		else if (src == 2)	value = sProfile.seconds;
+		else				value = stack_high_water();
+	}
+	__set_interrupt_state(s);
+	
+	// Convert ACLK ticks to ms
+	if (label[3] == 'T') value = (value >> 15) * 1000 + (((value & 0x7FFF) * 1000) >> 15);
+	if (value > 999999) value = 999999;
+	
+	display_chars(LCD_SEG_L1_3_0, label, SEG_ON);
+	display_chars(LCD_SEG_L2_5_0, itoa(value, 6, 5), SEG_ON);
+}
+#endif
+
+
 // *************************************************************************************************
 // @fn          is_rf
 // @brief       Returns TRUE if SimpliciTI receiver is connected. 
@@ -401,8 +503,6 @@ u8 is_rf(void)
 void simpliciti_get_ed_data_callback(void)
 {
 	static u8 packet_counter = 0;
-    u8 i;
-    u16 res;
 WDTCTL = WDTPW + WDTHOLD;
 #ifdef CONFIG_ACCEL
 	if (sRFsmpl.mode == SIMPLICITI_ACCELERATION)
@@ -435,101 +535,6 @@ WDTCTL = WDTPW + WDTHOLD;
 			}
 		}
 	}
-#endif
-#ifdef CONFIG_PHASE_CLOCK
-	if (sRFsmpl.mode == SIMPLICITI_PHASE_CLOCK_START)
-	{
-		/* Initialisation phase. Get a Session id and send the
-		   program wanted */
-		//display_chars(LCD_SEG_L1_3_2, itoa(packet_counter, 2, ' '), SEG_ON);
-		
-		if(packet_counter == 30) {
-			simpliciti_flag |= SIMPLICITI_TRIGGER_STOP;
-			packet_counter = 0;
-			return;
-		}
-		display_symbol(LCD_ICON_BEEPER1, SEG_ON_BLINK_ON);
-		display_symbol(LCD_ICON_BEEPER2, SEG_ON_BLINK_ON);
-
-		// send hw address so he recognices us and we will get a session id
-		simpliciti_data[0] = SIMPLICITI_PHASE_CLOCK_START_EVENTS;
-		// put 2 bytes of watch id into the package
-		WATCH_ID(simpliciti_data, 1);
-		// FIXME: TODO set program  
-		simpliciti_data[3] = sPhase.program;
-		simpliciti_flag |= SIMPLICITI_TRIGGER_SEND_DATA | SIMPLICITI_TRIGGER_RECEIVE_DATA;
-		packet_counter ++;
-		
-	}
-	else if (sRFsmpl.mode == SIMPLICITI_PHASE_CLOCK)
-	{
-		//display_symbol(LCD_ICON_BEEPER1, SEG_ON_BLINK_ON);
-		// Wait for next sample
-		display_symbol(LCD_ICON_RECORD, SEG_ON);
-		Timer0_A4_Delay(CONV_MS_TO_TICKS(60));	
-		// Read from sensor if DRDY pin indicates new data (set in PORT2 ISR)
-		if (request.flag.acceleration_measurement && ((AS_INT_IN & AS_INT_PIN) == AS_INT_PIN))
-		{
-			// Clear flag
-			request.flag.acceleration_measurement = 0;
-			
-			// Get data from sensor
-			as_get_data(sAccel.xyz);
-			
-			// push messured data onto the stack
-			if (sPhase.data_nr > SLEEP_DATA_BUFFER-1) {
-				phase_clock_calcpoint();
-				display_symbol(LCD_ICON_BEEPER1, SEG_OFF);
-				display_symbol(LCD_ICON_BEEPER2, SEG_OFF);
-				display_symbol(LCD_ICON_BEEPER3, SEG_OFF);
-
-			} else {
-				// copy current value onto the stack
-				//memcpy(&sPhase.data[sPhase.data_nr][0], &sAccel.xyz, sizeof(u8)*3);
-				sPhase.data[sPhase.data_nr][0] = sAccel.xyz[0];
-				sPhase.data[sPhase.data_nr][1] = sAccel.xyz[1];
-				sPhase.data[sPhase.data_nr][2] = sAccel.xyz[2];
-				//simpliciti_data[3] = sAccel.xyz[2];
-				sPhase.data_nr++;
-			}
-//str = itoa(accel_data, 3, 0);
-
-			if ((sPhase.out_nr > SLEEP_OUT_BUFFER-1))
-			{
-				// Reset counter
-				sPhase.out_nr = 0;
-				res = 0;
-
-				for(i=0; i < SLEEP_OUT_BUFFER; i++) {
-					//if (((2**17)-1))
-					// FIXME: overflow detection ?
-					res += sPhase.out[i];
-				}
-				packet_counter = (packet_counter+1)%SLEEP_MAX_PACKET_COUNTER;
-				simpliciti_data[3] =  (sPhase.session << (8-SLEEP_RF_ID_BIT_LENGHT)) | packet_counter;
-				simpliciti_data[2] =  res  & 0xFF;
-				simpliciti_data[1] =  (res >> 8) & 0xFF;
-				simpliciti_data[0] = SIMPLICITI_PHASE_CLOCK_EVENTS;
-
-				simpliciti_payload_length = 4;
-
-				display_symbol(LCD_ICON_BEEPER1, SEG_ON_BLINK_ON);
-				display_symbol(LCD_ICON_BEEPER2, SEG_ON_BLINK_ON);
-				display_symbol(LCD_ICON_BEEPER3, SEG_ON_BLINK_ON);
-
-                open_radio();
-                
-				simpliciti_flag |= SIMPLICITI_TRIGGER_SEND_DATA;
-			} else if (sPhase.out_nr == 0) {
-                // shutoff radio. no need to let it run for so long
-                close_radio();
-            }
-
-
-            sRFsmpl.timeout = SIMPLICITI_TIMEOUT; 
-
-		}
-    }
 #endif
 	if (sRFsmpl.mode == SIMPLICITI_BUTTONS) // transmit only button events
 	{
@@ -557,8 +562,7 @@ WDTCTL = WDTPW + WDTHOLD;
 		else
 		{
 			// Wait in LPM3 for next button press
-			_BIS_SR(LPM3_bits + GIE); 	
-			__no_operation();
+			to_lpm();
 		}
 	}
 	
@@ -582,21 +586,8 @@ WDTCTL = WDTPW + WDTHOLD;
 #ifdef SIMPLICITI_TX_ONLY_REQ
 int simpliciti_get_rvc_callback(u8 len)
 {
-
-	switch (simpliciti_data[0])
-	{
-#ifdef CONFIG_PHASE_CLOCK
-        case SIMPLICITI_PHASE_CLOCK_START_RESPONSE:	// Send watch parameters
-            sPhase.session = simpliciti_data[1];
-            sRFsmpl.mode = SIMPLICITI_PHASE_CLOCK;
-            simpliciti_data[0] = 0x00;
-            simpliciti_data[1] = 0x00;
-            simpliciti_data[2] = 0x00;
-            as_start();
-            return 1;
-#endif
-    }
-    return 0;
+	// No tx only mode expects data from the access point
+	return 0;
 }
 #endif
 
@@ -613,8 +604,9 @@ void start_simpliciti_sync(void)
 	//fptr_lcd_function_line1(LINE1, DISPLAY_LINE_CLEAR);
 	
 	#ifdef FEATURE_PROVIDE_ACCEL
-	// Stop acceleration sensor
-	as_stop();
+	// Stop acceleration measurement of the menu, it restarts when the menu is redrawn
+	sAccel.timeout = 0;
+	power_release(POWER_ACCEL, POWER_USER_ACCELERATION);
 	#endif
 
 	// Get updated altitude
@@ -625,6 +617,7 @@ void start_simpliciti_sync(void)
 		
 	// Get updated temperature	
 	temperature_measurement(FILTER_OFF);
+	simpliciti_link_temperature(sTemp.degrees);
 
 	// Turn on beeper icon to show activity
 	display_symbol(LCD_ICON_BEEPER1, SEG_ON_BLINK_ON);
@@ -634,8 +627,11 @@ void start_simpliciti_sync(void)
 	// Debounce button event
 	Timer0_A4_Delay(CONV_MS_TO_TICKS(BUTTONS_DEBOUNCE_TIME_OUT));
 
+	// System tick is frozen while SimpliciTI runs, drop lingering peripherals now
+	power_idle();
+
 	// Prepare radio for RF communication
-	open_radio();
+	power_acquire(POWER_RADIO, POWER_USER_SIMPLICITI);
 
 	// Set SimpliciTI mode
 	sRFsmpl.mode = SIMPLICITI_SYNC;
@@ -656,7 +652,7 @@ void start_simpliciti_sync(void)
 	sRFsmpl.mode = SIMPLICITI_OFF;
 
 	// Powerdown radio
-	close_radio();
+	power_release(POWER_RADIO, POWER_USER_SIMPLICITI);
 	
 	// Clear last button events
 	Timer0_A4_Delay(CONV_MS_TO_TICKS(BUTTONS_DEBOUNCE_TIME_OUT));
@@ -671,158 +667,3 @@ void start_simpliciti_sync(void)
 	// Force full display update
 	display.flag.full_update = 1;	
 }
-
-
-
-// *************************************************************************************************
-// @fn          simpliciti_sync_decode_ap_cmd_callback
-// @brief       For SYNC mode only: Decode command from access point and trigger actions. 
-// @param       none
-// @return      none
-// *************************************************************************************************
-void simpliciti_sync_decode_ap_cmd_callback(void)
-{
-	u8 i;
-	s16 t1, offset;
-	
-	// Default behaviour is to send no reply packets
-	simpliciti_reply_count = 0;
-	
-	switch (simpliciti_data[0])
-	{
-		case SYNC_AP_CMD_NOP:			break;
-
-		case SYNC_AP_CMD_GET_STATUS:	// Send watch parameters
-										simpliciti_data[0]  = SYNC_ED_TYPE_STATUS;
-										// Send single reply packet
-										simpliciti_reply_count = 1;
-										break;
-
-		case SYNC_AP_CMD_SET_WATCH:		// Set watch parameters
-										sys.flag.use_metric_units = (simpliciti_data[1] >> 7) & 0x01;
-										sTime.hour 			= simpliciti_data[1] & 0x7F;
-										sTime.minute 		= simpliciti_data[2];
-										sTime.second 		= simpliciti_data[3];
-										sDate.year 			= (simpliciti_data[4]<<8) + simpliciti_data[5];
-										sDate.month 		= simpliciti_data[6];
-										sDate.day 			= simpliciti_data[7];
-										#ifdef CONFIG_ALARM
-										sAlarm.hour			= simpliciti_data[8];
-										sAlarm.minute		= simpliciti_data[9];
-										#endif
-
-                                        #if (CONFIG_DST > 0)
-                                        dst_calculate_dates();
-                                        #endif
-										// Set temperature and temperature offset
-										t1 = (s16)((simpliciti_data[10]<<8) + simpliciti_data[11]);
-										offset = t1 - (sTemp.degrees - sTemp.offset);
-										sTemp.offset  = offset;	
-										sTemp.degrees = t1;									
-										// Set altitude
-#ifdef CONFIG_ALTITUDE
-										sAlt.altitude = (s16)((simpliciti_data[12]<<8) + simpliciti_data[13]);
-										update_pressure_table(sAlt.altitude, sAlt.pressure, sAlt.temperature);
-#endif
-#ifdef CONFIG_SIDEREAL
-										if(sSidereal_time.sync>0)
-											sync_sidereal();
-#endif
-#ifdef CONFIG_USE_SYNC_TOSET_TIME
-										simpliciti_flag |= SIMPLICITI_TRIGGER_STOP;
-#endif
-										break;
-												
-		case SYNC_AP_CMD_GET_MEMORY_BLOCKS_MODE_1:	
-										// Send sequential packets out in a burst 
-										simpliciti_data[0]  = SYNC_ED_TYPE_MEMORY;
-										// Get burst start and end packet
-										burst_start = (simpliciti_data[1]<<8)+simpliciti_data[2];
-										burst_end   = (simpliciti_data[3]<<8)+simpliciti_data[4];
-										// Set burst mode
-										burst_mode = 1;
-										// Number of packets to send
-										simpliciti_reply_count = burst_end - burst_start;
-										break;
-
-		case SYNC_AP_CMD_GET_MEMORY_BLOCKS_MODE_2:	
-										// Send specified packets out in a burst 
-										simpliciti_data[0]  = SYNC_ED_TYPE_MEMORY;
-										// Store the requested packets
-										for (i=0; i<BM_SYNC_BURST_PACKETS_IN_DATA; i++)
-										{
-											burst_packet[i] = (simpliciti_data[i*2+1]<<8)+simpliciti_data[i*2+2];
-										}
-										// Set burst mode
-										burst_mode = 2;
-										// Number of packets to send
-										simpliciti_reply_count = BM_SYNC_BURST_PACKETS_IN_DATA;
-										break;
-		
-		case SYNC_AP_CMD_ERASE_MEMORY:	// Erase data logger memory
-										break;
-										
-		case SYNC_AP_CMD_EXIT:			// Exit sync mode
-										simpliciti_flag |= SIMPLICITI_TRIGGER_STOP;
-										break;										
-	}
-	
-}
-
-
-// *************************************************************************************************
-// @fn          simpliciti_sync_get_data_callback
-// @brief       For SYNC mode only: Access point has requested data. Copy this data into the TX buffer now. 
-// @param       u16 index		Index used for memory requests
-// @return      none
-// *************************************************************************************************
-void simpliciti_sync_get_data_callback(unsigned int index)
-{
-	u8 i;
-	
-	// simpliciti_data[0] contains data type and needs to be returned to AP
-	switch (simpliciti_data[0])
-	{
-		case SYNC_ED_TYPE_STATUS:		// Assemble status packet
-										simpliciti_data[1]  = (sys.flag.use_metric_units << 7) | (sTime.hour & 0x7F);
-										simpliciti_data[2]  = sTime.minute;
-										simpliciti_data[3]  = sTime.second;
-										simpliciti_data[4]  = sDate.year >> 8;
-										simpliciti_data[5]  = sDate.year & 0xFF;
-										simpliciti_data[6]  = sDate.month;
-										simpliciti_data[7]  = sDate.day;
-										#ifdef CONFIG_ALARM
-										simpliciti_data[8]  = sAlarm.hour;
-										simpliciti_data[9]  = sAlarm.minute;
-										#else
-										simpliciti_data[8]  = 4;
-										simpliciti_data[9]  = 30;
-										#endif
-										simpliciti_data[10] = sTemp.degrees >> 8;
-										simpliciti_data[11] = sTemp.degrees & 0xFF;
-#ifdef CONFIG_ALTITUDE
-										simpliciti_data[12] = sAlt.altitude >> 8;
-										simpliciti_data[13] = sAlt.altitude & 0xFF;
-#endif
-										break;
-										
-		case SYNC_ED_TYPE_MEMORY:		
-										if (burst_mode == 1)
-										{
-											// Set burst packet address
-											simpliciti_data[1] = ((burst_start + index) >> 8) & 0xFF;
-											simpliciti_data[2] = (burst_start + index) & 0xFF;
-											// Assemble payload
-											for (i=3; i<BM_SYNC_DATA_LENGTH; i++) simpliciti_data[i] = index;
-										} 
-										else if (burst_mode == 2)
-										{
-											// Set burst packet address
-											simpliciti_data[1] = (burst_packet[index] >> 8) & 0xFF;
-											simpliciti_data[2] = burst_packet[index] & 0xFF;
-											// Assemble payload
-											for (i=3; i<BM_SYNC_DATA_LENGTH; i++) simpliciti_data[i] = index;
-										}
-										break;
-	}
-}
@@ -49,6 +49,7 @@ extern void sx_sync(u8 line);
 extern void display_rf(u8 line, u8 update);
 extern void display_ppt(u8 line, u8 update);
 extern void display_sync(u8 line, u8 update);
+extern void mx_profile(u8 line);
 extern void send_smpl_data(u16 data);
 extern u8 is_rf(void);
 
@@ -64,10 +65,6 @@ typedef enum
 #endif
   SIMPLICITI_BUTTONS,		// Transmitting button events
   SIMPLICITI_SYNC,			// Syncing
-#ifdef CONFIG_PHASE_CLOCK
-  SIMPLICITI_PHASE_CLOCK_START,	// Start new phase
-  SIMPLICITI_PHASE_CLOCK,	// Phase Clock is running
-#endif
 } simpliciti_mode_t;
 
 // Stop SimpliciTI transmission after 60 minutes to save power
@@ -81,8 +78,6 @@ typedef enum
 // SimpliciTI mode flag
 #define SIMPLICITI_MOUSE_EVENTS             (0x01)
 #define SIMPLICITI_KEY_EVENTS               (0x02)
-#define SIMPLICITI_PHASE_CLOCK_EVENTS   	(0x03)
-#define SIMPLICITI_PHASE_CLOCK_START_EVENTS	(0x04)
 
 // notify the ap that sync mode started
 #define SIMPLICITI_SYNC_STARTED_EVENTS      (0x10)
@@ -93,9 +88,6 @@ typedef enum
 		dst[offset+1] = simpliciti_ed_address[2] ^ simpliciti_ed_address[3];
 
 
-
-#define SIMPLICITI_PHASE_CLOCK_START_RESPONSE	(0x54)
-
 // *************************************************************************************************
 // Global Variable section
 struct RFsmpl
@@ -0,0 +1,561 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// *************************************************************************************************
+// SimpliciTI sync mode: commands of the access point and the reply packets of the watch.
+// Kept apart from the SimpliciTI menu in rfsimpliciti.c, host/simpliciti_ed.c links this file
+// to run the same packet code against contrib/ap_emulator.py.
+// *************************************************************************************************
+
+
+// *************************************************************************************************
+// Include section
+
+// system
+#include "project.h"
+
+// driver
+#include "vti_ps.h"
+
+// logic
+#include "simpliciti.h"
+#include "clock.h"
+#include "date.h"
+#include "alarm.h"
+#include "temperature.h"
+#include "altitude.h"
+
+#ifdef CONFIG_PHASE_CLOCK
+#include "phase_clock.h"
+#endif
+
+#ifdef CONFIG_IMPACT
+#include "impact.h"
+#endif
+
+#ifdef CONFIG_ALTI_TRACK
+#include "track.h"
+#endif
+
+#ifdef CONFIG_HISTORY
+#include "history.h"
+#endif
+
+#ifdef CONFIG_SIDEREAL
+#include "sidereal.h"
+#endif
+
+#ifdef CONFIG_CRASH_LOG
+#include "infomem.h"
+#include "crash.h"
+#endif
+
+#if (CONFIG_DST > 0)
+#include "dst.h"
+#endif
+
+#ifdef CONFIG_SETTINGS
+#include "settings.h"
+#endif
+
+#ifdef CONFIG_PROFILE
+#include "profile.h"
+#include "stack.h"
+#endif
+
+
+// *************************************************************************************************
+// Defines section
+
+// Each packet index requires 2 bytes, so we can have 9 packet indizes in 18 bytes usable payload
+#define BM_SYNC_BURST_PACKETS_IN_DATA		(9u)
+
+
+// *************************************************************************************************
+// Prototypes section
+u8 simpliciti_erase_log(u8 type, u16 count);
+#ifdef CONFIG_PROFILE
+void simpliciti_put_u32(u8 * data, u32 value);
+#endif
+
+
+// *************************************************************************************************
+// Global Variable section
+
+// 1 = send one or more reply packets, 0 = no need to reply
+//unsigned char simpliciti_reply;
+unsigned char simpliciti_reply_count;
+
+// 1 = send packets sequentially from burst_start to burst_end, 2 = send packets addressed by their index
+u8 		burst_mode;
+
+// Start and end index of packets to send out
+u16		burst_start, burst_end;
+
+// Array containing requested packets
+u16		burst_packet[BM_SYNC_BURST_PACKETS_IN_DATA];
+
+// Current packet index
+u8		burst_packet_index;
+
+
+// *************************************************************************************************
+// @fn          simpliciti_sync_decode_ap_cmd_callback
+// @brief       For SYNC mode only: Decode command from access point and trigger actions. 
+// @param       none
+// @return      none
+// *************************************************************************************************
+void simpliciti_sync_decode_ap_cmd_callback(void)
+{
+	u8 i;
+	s16 t1, offset;
+	
+	// Default behaviour is to send no reply packets
+	simpliciti_reply_count = 0;
+	
+	switch (simpliciti_data[0])
+	{
+		case SYNC_AP_CMD_NOP:			break;
+
+		case SYNC_AP_CMD_GET_STATUS:	// Send watch parameters
+										simpliciti_data[0]  = SYNC_ED_TYPE_STATUS;
+										// Send single reply packet
+										simpliciti_reply_count = 1;
+										break;
+
+		case SYNC_AP_CMD_SET_WATCH:		// Set watch parameters
+										sys.flag.use_metric_units = (simpliciti_data[1] >> 7) & 0x01;
+#ifdef CONFIG_SETTINGS
+										settings_changed();
+#endif
+										sTime.hour 			= simpliciti_data[1] & 0x7F;
+										sTime.minute 		= simpliciti_data[2];
+										sTime.second 		= simpliciti_data[3];
+										sDate.year 			= (simpliciti_data[4]<<8) + simpliciti_data[5];
+										sDate.month 		= simpliciti_data[6];
+										sDate.day 			= simpliciti_data[7];
+										#ifdef CONFIG_ALARM
+										sAlarm.hour			= simpliciti_data[8];
+										sAlarm.minute		= simpliciti_data[9];
+										#endif
+
+                                        #if (CONFIG_DST > 0)
+                                        dst_calculate_dates();
+                                        #endif
+										// Set temperature and temperature offset
+										t1 = (s16)((simpliciti_data[10]<<8) + simpliciti_data[11]);
+										offset = t1 - (sTemp.degrees - sTemp.offset);
+										sTemp.offset  = offset;	
+										sTemp.degrees = t1;									
+										// Set altitude
+#ifdef CONFIG_ALTITUDE
+										t1 = (s16)((simpliciti_data[12]<<8) + simpliciti_data[13]);
+										// Keep offset to sensor altitude for the next reset
+										sAlt.altitude_offset += t1 - sAlt.altitude;
+										sAlt.altitude = t1;
+										update_pressure_table(sAlt.altitude, sAlt.pressure, sAlt.temperature);
+#endif
+#ifdef CONFIG_SIDEREAL
+										if(sSidereal_time.sync>0)
+											sync_sidereal();
+#endif
+#ifdef CONFIG_USE_SYNC_TOSET_TIME
+										simpliciti_flag |= SIMPLICITI_TRIGGER_STOP;
+#endif
+										break;
+												
+		case SYNC_AP_CMD_GET_MEMORY_BLOCKS_MODE_1:	
+										// Send sequential packets out in a burst 
+										simpliciti_data[0]  = SYNC_ED_TYPE_MEMORY;
+										// Get burst start and end packet
+										burst_start = (simpliciti_data[1]<<8)+simpliciti_data[2];
+										burst_end   = (simpliciti_data[3]<<8)+simpliciti_data[4];
+										// Set burst mode
+										burst_mode = 1;
+										// Number of packets to send
+										simpliciti_reply_count = burst_end - burst_start;
+										break;
+
+		case SYNC_AP_CMD_GET_MEMORY_BLOCKS_MODE_2:	
+										// Send specified packets out in a burst 
+										simpliciti_data[0]  = SYNC_ED_TYPE_MEMORY;
+										// Store the requested packets
+										for (i=0; i<BM_SYNC_BURST_PACKETS_IN_DATA; i++)
+										{
+											burst_packet[i] = (simpliciti_data[i*2+1]<<8)+simpliciti_data[i*2+2];
+										}
+										// Set burst mode
+										burst_mode = 2;
+										// Number of packets to send
+										simpliciti_reply_count = BM_SYNC_BURST_PACKETS_IN_DATA;
+										break;
+		
+		case SYNC_AP_CMD_ERASE_MEMORY:	// Erase data logger memory
+										break;
+										
+		case SYNC_AP_CMD_EXIT:			// Exit sync mode
+										simpliciti_flag |= SIMPLICITI_TRIGGER_STOP;
+										break;										
+
+		case SYNC_AP_CMD_LINK_RSSI:		// Adapt output power to what the access point receives
+										simpliciti_link_peer_rssi((s8)simpliciti_data[1]);
+										break;
+
+		case SYNC_AP_CMD_ERASE_LOG:		// Erase a log the access point has received
+										simpliciti_data[2]  = simpliciti_erase_log(simpliciti_data[1], (simpliciti_data[2]<<8) + simpliciti_data[3]);
+										simpliciti_data[0]  = SYNC_ED_TYPE_ERASE;
+										simpliciti_reply_count = 1;
+										break;
+
+#ifdef CONFIG_PROFILE
+		case SYNC_AP_CMD_GET_PROFILE:	// Send energy profile counters
+										simpliciti_data[0]  = SYNC_ED_TYPE_PROFILE;
+										simpliciti_reply_count = PROFILE_PAGES;
+										break;
+#endif
+
+#ifdef CONFIG_CRASH_LOG
+		case SYNC_AP_CMD_GET_CRASH:		// Send crash record
+										simpliciti_data[0]  = SYNC_ED_TYPE_CRASH;
+										simpliciti_reply_count = 2;
+										break;
+#endif
+
+#ifdef CONFIG_PHASE_CLOCK
+		case SYNC_AP_CMD_GET_SLEEP:		// Send sleep log
+										simpliciti_data[0]  = SYNC_ED_TYPE_SLEEP;
+										simpliciti_reply_count = PHASE_PAGES(sPhase.epochs);
+										break;
+#endif
+
+#ifdef CONFIG_IMPACT
+		case SYNC_AP_CMD_GET_IMPACT:	// Send fall and shock log
+										simpliciti_data[0]  = SYNC_ED_TYPE_IMPACT;
+										simpliciti_reply_count = IMPACT_PAGES(sImpact.count);
+										break;
+#endif
+
+#ifdef CONFIG_ALTI_TRACK
+		case SYNC_AP_CMD_GET_TRACK:		// Send altitude track
+										simpliciti_data[0]  = SYNC_ED_TYPE_TRACK;
+										simpliciti_reply_count = TRACK_PAGES(sTrack.count);
+										break;
+#endif
+
+#ifdef CONFIG_HISTORY
+		case SYNC_AP_CMD_GET_HISTORY:	// Send daily temperature and battery history
+										simpliciti_data[0]  = SYNC_ED_TYPE_HISTORY;
+										simpliciti_reply_count = HISTORY_PAGES(history_days());
+										break;
+#endif
+	}
+	
+}
+
+
+// *************************************************************************************************
+// @fn          simpliciti_sync_get_data_callback
+// @brief       For SYNC mode only: Access point has requested data. Copy this data into the TX buffer now. 
+// @param       u16 index		Index used for memory requests
+// @return      none
+// *************************************************************************************************
+void simpliciti_sync_get_data_callback(unsigned int index)
+{
+	u8 i;
+	
+	// simpliciti_data[0] contains data type and needs to be returned to AP
+	switch (simpliciti_data[0])
+	{
+		case SYNC_ED_TYPE_STATUS:		// Assemble status packet
+										simpliciti_data[1]  = (sys.flag.use_metric_units << 7) | (sTime.hour & 0x7F);
+										simpliciti_data[2]  = sTime.minute;
+										simpliciti_data[3]  = sTime.second;
+										simpliciti_data[4]  = sDate.year >> 8;
+										simpliciti_data[5]  = sDate.year & 0xFF;
+										simpliciti_data[6]  = sDate.month;
+										simpliciti_data[7]  = sDate.day;
+										#ifdef CONFIG_ALARM
+										simpliciti_data[8]  = sAlarm.hour;
+										simpliciti_data[9]  = sAlarm.minute;
+										#else
+										simpliciti_data[8]  = 4;
+										simpliciti_data[9]  = 30;
+										#endif
+										simpliciti_data[10] = sTemp.degrees >> 8;
+										simpliciti_data[11] = sTemp.degrees & 0xFF;
+#ifdef CONFIG_ALTITUDE
+										simpliciti_data[12] = sAlt.altitude >> 8;
+										simpliciti_data[13] = sAlt.altitude & 0xFF;
+#endif
+										break;
+										
+		case SYNC_ED_TYPE_ERASE:		// Log type and result are set by the command
+										for (i=3; i<BM_SYNC_DATA_LENGTH; i++) simpliciti_data[i] = 0;
+										break;
+
+		case SYNC_ED_TYPE_MEMORY:		
+										if (burst_mode == 1)
+										{
+											// Set burst packet address
+											simpliciti_data[1] = ((burst_start + index) >> 8) & 0xFF;
+											simpliciti_data[2] = (burst_start + index) & 0xFF;
+											// Assemble payload
+											for (i=3; i<BM_SYNC_DATA_LENGTH; i++) simpliciti_data[i] = index;
+										} 
+										else if (burst_mode == 2)
+										{
+											// Set burst packet address
+											simpliciti_data[1] = (burst_packet[index] >> 8) & 0xFF;
+											simpliciti_data[2] = burst_packet[index] & 0xFF;
+											// Assemble payload
+											for (i=3; i<BM_SYNC_DATA_LENGTH; i++) simpliciti_data[i] = index;
+										}
+										break;
+
+#ifdef CONFIG_PROFILE
+		case SYNC_ED_TYPE_PROFILE:		// Page 0: uptime, RX and TX airtime, number of sources, stack use
+										// Page n: wakeups and active time of sources 2n-2 and 2n-1
+										for (i=1; i<BM_SYNC_DATA_LENGTH; i++) simpliciti_data[i] = 0;
+										simpliciti_data[1] = index;
+										if (index == 0)
+										{
+											simpliciti_put_u32(&simpliciti_data[2], sProfile.seconds);
+											simpliciti_put_u32(&simpliciti_data[6], sProfile.airtime[0]);
+											simpliciti_put_u32(&simpliciti_data[10], sProfile.airtime[1]);
+											simpliciti_data[14] = PROFILE_SOURCES;
+											simpliciti_data[15] = stack_high_water() >> 8;
+											simpliciti_data[16] = stack_high_water() & 0xFF;
+										}
+										else
+										{
+											for (i=0; i<PROFILE_SOURCES_PER_PAGE; i++)
+											{
+												u8 src = (index - 1) * PROFILE_SOURCES_PER_PAGE + i;
+												if (src >= PROFILE_SOURCES) break;
+												simpliciti_data[2 + i*6] = sProfile.wakeups[src] >> 8;
+												simpliciti_data[3 + i*6] = sProfile.wakeups[src] & 0xFF;
+												simpliciti_put_u32(&simpliciti_data[4 + i*6], sProfile.active[src]);
+											}
+										}
+										break;
+#endif
+
+#ifdef CONFIG_CRASH_LOG
+		case SYNC_ED_TYPE_CRASH:		// Page 0: count, reset cause, isr/watchdog, pc, sp, time
+										// Page 1: trace, oldest entry first
+										{
+											u16 record[CRASH_RECORD_WORDS];
+											u8 first = (index == 0) ? 0 : 6;
+											u8 words = (index == 0) ? 6 : CRASH_TRACE_LENGTH;
+											
+											for (i=1; i<BM_SYNC_DATA_LENGTH; i++) simpliciti_data[i] = 0;
+											simpliciti_data[1] = index;
+											if (crash_read(record) == 0) break;
+											for (i=0; i<words; i++)
+											{
+												simpliciti_data[2 + i*2] = record[first + i] >> 8;
+												simpliciti_data[3 + i*2] = record[first + i] & 0xFF;
+											}
+										}
+										break;
+#endif
+
+#ifdef CONFIG_PHASE_CLOCK
+		case SYNC_ED_TYPE_SLEEP:		// Page 0: log header, number of epochs, recording state
+										// Page n: activity of epochs 16n-16 .. 16n-1
+										for (i=1; i<BM_SYNC_DATA_LENGTH; i++) simpliciti_data[i] = 0;
+										simpliciti_data[1] = index;
+										if (index == 0)
+										{
+											for (i=0; i<PHASE_LOG_HEADER; i++) simpliciti_data[2 + i] = phase_clock_log(i);
+											simpliciti_data[10] = sPhase.epochs >> 8;
+											simpliciti_data[11] = sPhase.epochs & 0xFF;
+											simpliciti_data[12] = sPhase.state;
+										}
+										else
+										{
+											for (i=0; i<PHASE_EPOCHS_PER_PAGE; i++)
+											{
+												simpliciti_data[2 + i] = phase_clock_log(PHASE_LOG_HEADER + (index - 1) * PHASE_EPOCHS_PER_PAGE + i);
+											}
+										}
+										break;
+#endif
+
+#ifdef CONFIG_IMPACT
+		case SYNC_ED_TYPE_IMPACT:		// Page 0: number of events
+										// Page n: records of events 2n-2 and 2n-1
+										for (i=1; i<BM_SYNC_DATA_LENGTH; i++) simpliciti_data[i] = 0;
+										simpliciti_data[1] = index;
+										if (index == 0)
+										{
+											simpliciti_data[2] = sImpact.count;
+										}
+										else
+										{
+											for (i=0; i<IMPACT_RECORDS_PER_PAGE * IMPACT_RECORD; i++)
+											{
+												simpliciti_data[2 + i] = impact_log((index - 1) * IMPACT_RECORDS_PER_PAGE * IMPACT_RECORD + i);
+											}
+										}
+										break;
+#endif
+
+#ifdef CONFIG_ALTI_TRACK
+		case SYNC_ED_TYPE_TRACK:		// Page 0: track header, number of points, ascent, descent, climbs
+										// Page n: points 4n-4 .. 4n-1
+										for (i=1; i<BM_SYNC_DATA_LENGTH; i++) simpliciti_data[i] = 0;
+										simpliciti_data[1] = index;
+										if (index == 0)
+										{
+											for (i=0; i<TRACK_HEADER; i++) simpliciti_data[2 + i] = track_log(i);
+											simpliciti_data[10] = sTrack.count;
+											simpliciti_data[11] = sTrack.ascent >> 8;
+											simpliciti_data[12] = sTrack.ascent & 0xFF;
+											simpliciti_data[13] = sTrack.descent >> 8;
+											simpliciti_data[14] = sTrack.descent & 0xFF;
+											simpliciti_data[15] = sTrack.climbs;
+										}
+										else
+										{
+											for (i=0; i<TRACK_POINTS_PER_PAGE * TRACK_POINT; i++)
+											{
+												simpliciti_data[2 + i] = track_log(TRACK_HEADER + (index - 1) * TRACK_POINTS_PER_PAGE * TRACK_POINT + i);
+											}
+										}
+										break;
+#endif
+
+#ifdef CONFIG_HISTORY
+		case SYNC_ED_TYPE_HISTORY:		// Page 0: number of days, today in the format of a day
+										// Page n: day n-1, oldest first
+										for (i=1; i<BM_SYNC_DATA_LENGTH; i++) simpliciti_data[i] = 0;
+										simpliciti_data[1] = index;
+										if (index == 0)
+										{
+											simpliciti_data[2] = history_days();
+											history_today(&simpliciti_data[3]);
+										}
+										else
+										{
+											for (i=0; i<HISTORY_RECORD; i++) simpliciti_data[2 + i] = history_log(index - 1, i);
+										}
+										break;
+#endif
+	}
+}
+
+
+// *************************************************************************************************
+// @fn          simpliciti_erase_log
+// @brief       Erase a log after the access point has received all its pages. The log is kept when
+//				its number of entries differs from the download, an entry added since is not lost.
+// @param       u8 type			SYNC_ED_TYPE_xxx of the log
+//				u16 count		Number of entries on page 0 of the download
+// @return      u8				1 = log erased or already empty, 0 = log kept
+// *************************************************************************************************
+u8 simpliciti_erase_log(u8 type, u16 count)
+{
+#ifdef CONFIG_CRASH_LOG
+	u16 record[CRASH_RECORD_WORDS];
+#endif
+
+	switch (type)
+	{
+#ifdef CONFIG_PROFILE
+		case SYNC_ED_TYPE_PROFILE:		// Start a new measurement period, the counters never stand still
+										profile_reset();
+										return 1;
+#endif
+
+#ifdef CONFIG_CRASH_LOG
+		case SYNC_ED_TYPE_CRASH:		// Count of crashes, a watchdog reset since the download adds one
+										if (crash_read(record) == 0) return 1;
+										if (record[0] != count) return 0;
+										infomem_app_clear(CRASH_INFOMEM_ID);
+										return 1;
+#endif
+
+#ifdef CONFIG_PHASE_CLOCK
+		case SYNC_ED_TYPE_SLEEP:		// A night that is still recorded is kept
+										if (sPhase.state == PHASE_RECORDING) return 0;
+										if (sPhase.epochs == 0) return 1;
+										if (sPhase.epochs != count) return 0;
+										phase_clock_clear();
+										return 1;
+#endif
+
+#ifdef CONFIG_IMPACT
+		case SYNC_ED_TYPE_IMPACT:		// Number of events, a fall or shock since the download adds one
+										if (sImpact.count == 0) return 1;
+										if (sImpact.count != count) return 0;
+										impact_clear();
+										return 1;
+#endif
+
+#ifdef CONFIG_ALTI_TRACK
+		case SYNC_ED_TYPE_TRACK:		// Number of points, a running track may have added one
+										if (sTrack.count == 0) return 1;
+										if (sTrack.count != count) return 0;
+										track_clear();
+										return 1;
+#endif
+
+#ifdef CONFIG_HISTORY
+		case SYNC_ED_TYPE_HISTORY:		// Number of days, a day completed since the download adds one
+										if (history_days() == 0) return 1;
+										if (history_days() != count) return 0;
+										history_clear();
+										return 1;
+#endif
+	}
+	return 0;
+}
+
+
+#ifdef CONFIG_PROFILE
+// *************************************************************************************************
+// @fn          simpliciti_put_u32
+// @brief       Store a 32-bit value MSB first in a sync packet.
+// @param       u8 * data		Destination
+//				u32 value		Value
+// @return      none
+// *************************************************************************************************
+void simpliciti_put_u32(u8 * data, u32 value)
+{
+	data[0] = value >> 24;
+	data[1] = value >> 16;
+	data[2] = value >> 8;
+	data[3] = value;
+}
+#endif
@@ -19,6 +19,7 @@
 #include "display.h"
 #include "timer.h"
 #include "vti_as.h"
+#include "power.h"
 #include "buzzer.h"
 // logic
 #include "sequence.h"
@@ -48,192 +49,169 @@
 extern void idle_loop(void);
 
 u8 doorlock_sequence(u8 sequence[DOORLOCK_SEQUENCE_MAX_LENGTH]);
+u8 doorlock_sample(u8 z);
 void doorlock_sequence_timer(void);
-void doorlock_sequence_pause_timer(void);
+u16 sequence_distance(u8* sequence_a, u8* sequence_b);
+u8 sequence_length(u8* sequence);
 u8 sequence_compare(u8* sequence_a, u8* sequence_b);
+u8 sequence_match(u8* sequence, u8 patterns[][DOORLOCK_SEQUENCE_MAX_LENGTH], u8 count);
 
 
 // *************************************************************************************************
 // Global variable section
 
-volatile u8 doorlock_sequence_pause = 0;
+struct doorlock sDoorlock;
 volatile u8 doorlock_sequence_timeout = 0;
 
 // *************************************************************************************************
 // @fn          doorlock_sequence
-// @brief       collects door unlock code sequence using accelerometer
+// @brief       collects door unlock code sequence using accelerometer. Knocks are detected and 
+//				timed in the port ISR, the CPU sleeps between knocks.
 // @param       normalized code sequence (output)
 // @return      doorlock error code
 // *************************************************************************************************
 u8 doorlock_sequence(u8 sequence[DOORLOCK_SEQUENCE_MAX_LENGTH])
 {
-	s16 previous_delta = 0;
-	s16 delta = 0, ddelta = 0;
-	u8 previous_raw = 0;
-	u8 length = 0;
+	u8 error = DOORLOCK_ERROR_SUCCESS;
 	u8 max = 0;
-	u8 raw = 0;
 	u8 i = 0;
-	float ratio = 0.0f;
 
 	// initialize
 	memset(sequence, 0, sizeof(u8) * DOORLOCK_SEQUENCE_MAX_LENGTH);
-	doorlock_sequence_pause = 0;
+	memset(sDoorlock.pause, 0, sizeof(sDoorlock.pause));
+	sDoorlock.length = 0;
+	sDoorlock.knocked = 0;
+	sDoorlock.previous_z = 0;
+	sDoorlock.previous_delta = 0;
 
 	// setup timeout
 	doorlock_sequence_timeout = DOORLOCK_SEQUENCE_TIMEOUT;
-
-	// start acceleration measurement
-	//as_start(AS_MODE_2G_400HZ);
-	as_start();
-
 	fptr_Timer0_A1_function = doorlock_sequence_timer;
 	Timer0_A1_Start(32768u);
-	//Timer0_A1_Start();
-
 
-	for(;;)
-	{
-
-		    // Reset IRQ flags
-		BUTTONS_IFG &= ~ALL_BUTTONS;
+	// Disable button interrupts
+	BUTTONS_IFG &= ~ALL_BUTTONS;
+	BUTTONS_IE &= ~ALL_BUTTONS;
 
-			// Enable button interrupts
-		BUTTONS_IE &= ~ALL_BUTTONS;
+	// start acceleration measurement, knocks are short
+	sDoorlock.state = DOORLOCK_STATE_WAIT;
+	as_request_rate(POWER_USER_SEQUENCE, AS_RATE_400HZ);
+	power_acquire(POWER_ACCEL, POWER_USER_SEQUENCE);
 
+	// Woken up by knocks, end of sequence and timeout
+	while ((sDoorlock.state != DOORLOCK_STATE_DONE) && doorlock_sequence_timeout)
+	{
 		idle_loop();
 
-
-
-		if (!doorlock_sequence_timeout)
+		if (sDoorlock.knocked)
 		{
-			as_stop();
-			// Reset IRQ flags
-				BUTTONS_IFG &= ~ALL_BUTTONS;
+			sDoorlock.knocked = 0;
+			
+			// No more timeout after the first knock
+			Timer0_A1_Stop();
+			doorlock_sequence_timeout = 1;
 
-				// Enable button interrupts
-				BUTTONS_IE |= ALL_BUTTONS;
-			return DOORLOCK_ERROR_TIMEOUT;
+			// successfully detected a knock, beep once to signal that
+			display_symbol(LCD_ICON_RECORD, SEG_ON);
+			start_buzzer(1, CONV_MS_TO_TICKS(20), CONV_MS_TO_TICKS(10));
 		}
+	}
 
-		// were we interrupted because pause is too long?
-		if (doorlock_sequence_pause <= DOORLOCK_SEQUENCE_PAUSE_MAX_LENGTH)
-		{
-			// look for accelerometer data ready event
-			if (!request.flag.acceleration_measurement)
-			{
-				continue;
-			}
-
-			request.flag.acceleration_measurement = 0;
-
-			// read accelerometer z-a
-			raw = as_get_z();
-			delta = raw - previous_raw;
-			ddelta = delta - previous_delta;
-			previous_raw = raw;
-			previous_delta = delta;
-
-			// proceed if the acceleration is big enough
-			if (ddelta < DOORLOCK_SEQUENCE_TAP_THRESHOLD &&
-				ddelta > -DOORLOCK_SEQUENCE_TAP_THRESHOLD)
-			{
-				continue;
-			}
-
-			Timer0_A1_Stop();
+	sDoorlock.state = DOORLOCK_STATE_OFF;
+	power_release(POWER_ACCEL, POWER_USER_SEQUENCE);
+	Timer0_A1_Stop();
+	display_symbol(LCD_ICON_RECORD, SEG_OFF);
 
-			// first tap?
-			if (length == 0)
-			{
-				// reset timer
-				doorlock_sequence_timeout = 1; // no more timeout
-
-				// reset pause length
-				doorlock_sequence_pause = 0;
-				++ length;
-
-				// successfully detected a knock, beep once to signal that
-				display_symbol(LCD_ICON_RECORD, SEG_ON);
-				start_buzzer(1, CONV_MS_TO_TICKS(20), CONV_MS_TO_TICKS(10));
-				Timer0_A4_Delay(CONV_MS_TO_TICKS(30));
-				stop_buzzer();
-				display_symbol(LCD_ICON_RECORD, SEG_OFF);
-
-				// start pause timer
-				fptr_Timer0_A1_function = doorlock_sequence_pause_timer;
-				Timer0_A1_Start(DOORLOCK_SEQUENCE_PAUSE_RESOLUTION);
-				continue;
-			}
-
-			// is pause long enough to qualify?
-			if (doorlock_sequence_pause > DOORLOCK_SEQUENCE_PAUSE_MIN_LENGTH)
-			{
-				sequence[length - 1] = doorlock_sequence_pause;
-				++ length;
-				if (doorlock_sequence_pause > max)
-				{
-					// also get the biggest pause
-					max = doorlock_sequence_pause;
-				}
-
-				// successfully detected a knock, beep once to signal that
-				display_symbol(LCD_ICON_RECORD, SEG_ON);
-				start_buzzer(1, CONV_MS_TO_TICKS(20), CONV_MS_TO_TICKS(10));
-				Timer0_A4_Delay(CONV_MS_TO_TICKS(30));
-				stop_buzzer();
-				display_symbol(LCD_ICON_RECORD, SEG_OFF);
-			}
-
-			doorlock_sequence_pause = 0;
-
-			// is the sequence full?
-			if (length <= DOORLOCK_SEQUENCE_MAX_LENGTH)
-			{
-				// start pause timer
-				fptr_Timer0_A1_function = doorlock_sequence_pause_timer;
-				Timer0_A1_Start(DOORLOCK_SEQUENCE_PAUSE_RESOLUTION);
-				continue;
-			}
-
-			// if sequnce is full, we stop
-			as_stop();
-		}
-		else
+	if (sDoorlock.length == 0)
+	{
+		error = DOORLOCK_ERROR_TIMEOUT;
+	}
+	// is sequence too short?
+	else if (sDoorlock.length <= DOORLOCK_SEQUENCE_MIN_LENGTH)
+	{
+		error = DOORLOCK_ERROR_FAILURE;
+	}
+	else
+	{
+		// normalize all pauses to the longest one
+		for (i = 0; i < DOORLOCK_SEQUENCE_MAX_LENGTH; i++)
 		{
-			// if pause timeout we stop
-			as_stop();
-
-			doorlock_sequence_pause = 0;
-
-			// is sequence too short?
-			if (length <= DOORLOCK_SEQUENCE_MIN_LENGTH)
-			{
-				// reset data when exiting this state
-				memset(sequence, 0, sizeof(u8) * DOORLOCK_SEQUENCE_MAX_LENGTH);
-				// Reset IRQ flags
-					BUTTONS_IFG &= ~ALL_BUTTONS;
-
-					// Enable button interrupts
-					BUTTONS_IE |= ALL_BUTTONS;
-				return DOORLOCK_ERROR_FAILURE;
-			}
+			if (sDoorlock.pause[i] > max) max = sDoorlock.pause[i];
 		}
-
-		// normalize all pauses
-		ratio = 255.0f / (float)max;
 		for (i = 0; i < DOORLOCK_SEQUENCE_MAX_LENGTH; i++)
 		{
-			sequence[i] *= ratio;
+			sequence[i] = ((u16)sDoorlock.pause[i] * 255u + max / 2) / max;
 		}
-		// Reset IRQ flags
-			BUTTONS_IFG &= ~ALL_BUTTONS;
+	}
 
-			// Enable button interrupts
-			BUTTONS_IE |= ALL_BUTTONS;
-		return DOORLOCK_ERROR_SUCCESS;
+	// Reset IRQ flags
+	BUTTONS_IFG &= ~ALL_BUTTONS;
+
+	// Enable button interrupts
+	BUTTONS_IE |= ALL_BUTTONS;
+	return error;
+}
+
+
+// *************************************************************************************************
+// @fn          doorlock_sample
+// @brief       Look for a knock in a 400Hz sample and time the pause before it. Called from the 
+//				port ISR while the sequence is captured.
+// @param       u8 z		z-axis acceleration
+// @return      u8			1 = main loop has to react (knock or end of sequence)
+// *************************************************************************************************
+u8 doorlock_sample(u8 z)
+{
+	s16 delta, ddelta;
+	u16 now, pause;
+
+	// Free running ACLK counter, read until two values match
+	do
+	{
+		now = TA0R;
+	}
+	while (now != TA0R);
+	pause = now - sDoorlock.last_knock;
+
+	delta = z - sDoorlock.previous_z;
+	ddelta = delta - sDoorlock.previous_delta;
+	sDoorlock.previous_z = z;
+	sDoorlock.previous_delta = delta;
+
+	// pause too long, sequence is complete
+	if ((sDoorlock.state == DOORLOCK_STATE_CAPTURE) && (pause > DOORLOCK_PAUSE_MAX_TICKS))
+	{
+		sDoorlock.state = DOORLOCK_STATE_DONE;
+		return (1);
+	}
+
+	// proceed if the acceleration is big enough
+	if (ddelta < DOORLOCK_SEQUENCE_TAP_THRESHOLD && ddelta > -DOORLOCK_SEQUENCE_TAP_THRESHOLD)
+	{
+		return (0);
+	}
+
+	// Ringing of the same knock restarts the pause
+	sDoorlock.last_knock = now;
+
+	// first tap?
+	if (sDoorlock.state == DOORLOCK_STATE_WAIT)
+	{
+		sDoorlock.state = DOORLOCK_STATE_CAPTURE;
+		sDoorlock.length = 1;
+		sDoorlock.knocked = 1;
+		return (1);
 	}
 
+	// is pause long enough to qualify?
+	if (pause <= DOORLOCK_PAUSE_MIN_TICKS) return (0);
+
+	sDoorlock.pause[sDoorlock.length - 1] = pause / DOORLOCK_SEQUENCE_PAUSE_RESOLUTION;
+	sDoorlock.knocked = 1;
+
+	// if sequence is full, we stop
+	if (++sDoorlock.length > DOORLOCK_SEQUENCE_MAX_LENGTH) sDoorlock.state = DOORLOCK_STATE_DONE;
+	return (1);
 }
 
 
@@ -256,57 +234,116 @@ void doorlock_sequence_timer(void)
 	}
 }
 
+
 // *************************************************************************************************
-// @fn          doorlock_sequence_pause_timer
-// @brief       timer callback to time the length of a pause
-// @param       none
-// @return      none
+// @fn          sequence_length
+// @brief       Number of pauses in a normalized sequence.
+// @param       u8* sequence	normalized sequence, unused pauses are 0
+// @return      u8				number of pauses
 // *************************************************************************************************
-void doorlock_sequence_pause_timer(void)
+u8 sequence_length(u8* sequence)
 {
-	if (doorlock_sequence_pause > DOORLOCK_SEQUENCE_PAUSE_MAX_LENGTH)
-    {
-            // stop timer
-            Timer0_A1_Stop();
-    }
-    else
-    {
-            // Increment pause length
-            ++ doorlock_sequence_pause;
-    }
+	u8 i = 0;
+
+	while ((i < DOORLOCK_SEQUENCE_MAX_LENGTH) && sequence[i]) i++;
+	return i;
 }
 
-u8 sequence_compare(u8* sequence_a, u8* sequence_b)
-{
-	u8 i = 0;
 
-	for (i = 0; i < DOORLOCK_SEQUENCE_MAX_LENGTH; i++)
-    {
-		if (sequence_a[i] > sequence_b[i])
-		{
-			if (sequence_a[i] - sequence_b[i] > DOORLOCK_SEQUENCE_SIMILARITY)
-			{
-				break;
-			}
-		}
-		else
+// *************************************************************************************************
+// @fn          sequence_distance
+// @brief       Dynamic time warping distance of two normalized sequences: sum of the pause 
+//				differences along the cheapest alignment plus the warp penalty for every pause 
+//				that is stretched over two, so a knock too many or too few does not fail the 
+//				whole sequence. Two rows of the cost matrix are kept.
+// @param       u8* sequence_a, u8* sequence_b		normalized sequences
+// @return      u16				distance, 0xFFFF if one of the sequences is empty
+// *************************************************************************************************
+u16 sequence_distance(u8* sequence_a, u8* sequence_b)
+{
+	u16 row[2][DOORLOCK_SEQUENCE_MAX_LENGTH + 1];
+	u16 best;
+	u8 length_a = sequence_length(sequence_a);
+	u8 length_b = sequence_length(sequence_b);
+	u16 *p, *c, *t;
+	u8 i, j;
+
+	if (length_a == 0 || length_b == 0) return 0xFFFF;
+
+	// Row 0: only the corner is reachable
+	p = row[0];
+	c = row[1];
+	p[0] = 0;
+	for (j = 1; j <= length_b; j++) p[j] = 0xFFFF;
+
+	for (i = 1; i <= length_a; i++)
+	{
+		c[0] = 0xFFFF;
+		for (j = 1; j <= length_b; j++)
 		{
-			if (sequence_b[i] - sequence_a[i] > DOORLOCK_SEQUENCE_SIMILARITY)
-			{
-				break;
-			}
+			// cheapest of match, insertion and deletion
+			best = p[j - 1];
+			if ((p[j] != 0xFFFF) && (p[j] + DOORLOCK_SEQUENCE_WARP_PENALTY < best)) best = p[j] + DOORLOCK_SEQUENCE_WARP_PENALTY;
+			if ((c[j - 1] != 0xFFFF) && (c[j - 1] + DOORLOCK_SEQUENCE_WARP_PENALTY < best)) best = c[j - 1] + DOORLOCK_SEQUENCE_WARP_PENALTY;
+
+			if (sequence_a[i - 1] > sequence_b[j - 1])	c[j] = best + (sequence_a[i - 1] - sequence_b[j - 1]);
+			else										c[j] = best + (sequence_b[j - 1] - sequence_a[i - 1]);
 		}
-    }
+		t = p;
+		p = c;
+		c = t;
+	}
+
+	return p[length_b];
+}
 
-	if (i == DOORLOCK_SEQUENCE_MAX_LENGTH)
+
+// *************************************************************************************************
+// @fn          sequence_compare
+// @brief       Check if two normalized sequences are the same knock pattern.
+// @param       u8* sequence_a, u8* sequence_b		normalized sequences
+// @return      doorlock error code
+// *************************************************************************************************
+u8 sequence_compare(u8* sequence_a, u8* sequence_b)
+{
+	u8 length_a = sequence_length(sequence_a);
+	u8 length_b = sequence_length(sequence_b);
+	u8 length = (length_a > length_b) ? length_a : length_b;
+
+	if (length_a + DOORLOCK_SEQUENCE_LENGTH_SLACK < length_b || 
+		length_b + DOORLOCK_SEQUENCE_LENGTH_SLACK < length_a)
+	{
+		return DOORLOCK_ERROR_FAILURE;
+	}
+
+	if (sequence_distance(sequence_a, sequence_b) <= (u16)length * DOORLOCK_SEQUENCE_SIMILARITY)
 	{
-		//request.flag.lock_unlock = 1;
-		//auth_signal_success();
 		return DOORLOCK_ERROR_SUCCESS;
 	}
-	//auth_signal_failure();
-		return DOORLOCK_ERROR_FAILURE;
+	return DOORLOCK_ERROR_FAILURE;
+}
 
+
+// *************************************************************************************************
+// @fn          sequence_match
+// @brief       Compare a sequence with the enrolled patterns.
+// @param       u8* sequence		normalized sequence
+//				patterns			enrolled patterns
+//				u8 count			number of enrolled patterns
+// @return      doorlock error code
+// *************************************************************************************************
+u8 sequence_match(u8* sequence, u8 patterns[][DOORLOCK_SEQUENCE_MAX_LENGTH], u8 count)
+{
+	u8 i;
+
+	for (i = 0; i < count; i++)
+	{
+		if (sequence_compare(patterns[i], sequence) == DOORLOCK_ERROR_SUCCESS)
+		{
+			return DOORLOCK_ERROR_SUCCESS;
+		}
+	}
+	return DOORLOCK_ERROR_FAILURE;
 }
 
-#endif // CONFIG_USE_GPS
\ No newline at end of file
+#endif // CONFIG_USE_GPS
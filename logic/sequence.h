@@ -16,8 +16,9 @@
 
 // *************************************************************************************************
 // Defines section
-// Defines section
-#define DOORLOCK_SEQUENCE_SIMILARITY (50u)
+
+// Largest mean deviation per pause between two normalized sequences (255 = longest pause)
+#define DOORLOCK_SEQUENCE_SIMILARITY (40u)
 
 // Setting section
 // sequence limits
@@ -29,24 +30,73 @@
 #define	DOORLOCK_SEQUENCE_TAP_THRESHOLD				(120)
 #define	DOORLOCK_SEQUENCE_TIMEOUT					(30u)
 
+// Pause limits in ACLK ticks of the free running Timer0_A
+#define DOORLOCK_PAUSE_MAX_TICKS		(DOORLOCK_SEQUENCE_PAUSE_MAX_LENGTH * DOORLOCK_SEQUENCE_PAUSE_RESOLUTION)
+#define DOORLOCK_PAUSE_MIN_TICKS		(DOORLOCK_SEQUENCE_PAUSE_MIN_LENGTH * DOORLOCK_SEQUENCE_PAUSE_RESOLUTION)
+
+// A sequence may have one pause more or less than the pattern it matches. Every pause that is
+// aligned to more than one pause of the other sequence adds the warp penalty to the distance.
+#define DOORLOCK_SEQUENCE_LENGTH_SLACK				(1u)
+#define DOORLOCK_SEQUENCE_WARP_PENALTY				(2u * DOORLOCK_SEQUENCE_SIMILARITY)
+
+// Knock patterns kept in information memory. They are variants of one code: NEW CODE replaces
+// all of them by its two knocks, so a changed code stops opening at once.
+#define DOORLOCK_PATTERNS							(4u)
+#define DOORLOCK_INFOMEM_ID							(0x13)
+
 // error codes
 #define DOORLOCK_ERROR_SUCCESS						(0u)
 #define DOORLOCK_ERROR_FAILURE						(1u)
 #define DOORLOCK_ERROR_TIMEOUT						(2u)
 #define DOORLOCK_ERROR_INVALID						(3u)
 
+// Knock capture states
+#define DOORLOCK_STATE_OFF							(0u)
+#define DOORLOCK_STATE_WAIT							(1u)	// Waiting for the first knock
+#define DOORLOCK_STATE_CAPTURE						(2u)	// Timing the pauses
+#define DOORLOCK_STATE_DONE							(3u)	// Pause too long or sequence full
+
+#define DOORLOCK_CAPTURING			((sDoorlock.state == DOORLOCK_STATE_WAIT) || (sDoorlock.state == DOORLOCK_STATE_CAPTURE))
 
 
 // random bits collection interval
 #define DOORLOCK_RANDOM_INTERVAL					(150u)
 
 
+// *************************************************************************************************
+// Global Variable section
+
+// Knock capture, the sensor samples are read in the port ISR
+struct doorlock
+{
+	// DOORLOCK_STATE_xxx
+	volatile u8	state;
+	
+	// Knocks so far, 1 = a knock was seen since the main loop last looked
+	u8			length;
+	volatile u8	knocked;
+	
+	// Z sample and its change for the second difference
+	u8			previous_z;
+	s16			previous_delta;
+	
+	// TA0R at the last knock
+	u16			last_knock;
+	
+	// Pauses between knocks in 5ms
+	u8			pause[DOORLOCK_SEQUENCE_MAX_LENGTH];
+};
+extern struct doorlock sDoorlock;
+
 
 // *************************************************************************************************
 // Prototypes section
 
 extern u8 doorlock_sequence(u8 sequence[DOORLOCK_SEQUENCE_MAX_LENGTH]);
+extern u8 doorlock_sample(u8 z);
+extern u16 sequence_distance(u8* sequence_a, u8* sequence_b);
 extern u8 sequence_compare(u8* sequence_a, u8* sequence_b);
+extern u8 sequence_match(u8* sequence, u8 patterns[][DOORLOCK_SEQUENCE_MAX_LENGTH], u8 count);
 
 
 //***************************************************************************************************
@@ -0,0 +1,299 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// *************************************************************************************************
+// Persistent settings registry. Module fields listed in settings_table are cached in RAM and
+// written back to information memory as one record after a quiet period or before the radio 
+// is started.
+// *************************************************************************************************
+
+
+// *************************************************************************************************
+// Include section
+
+// system
+#include "project.h"
+
+#ifdef CONFIG_SETTINGS
+
+#include <string.h>
+
+// driver
+#include "display.h"
+#include "infomem.h"
+
+// logic
+#include "clock.h"
+#ifdef CONFIG_ALARM
+#include "alarm.h"
+#endif
+#ifdef CONFIG_ALTITUDE
+#include "altitude.h"
+#endif
+#ifdef CONFIG_EGGTIMER
+#include "eggtimer.h"
+#endif
+#ifdef CONFIG_VARIO
+#include "vario.h"
+#endif
+#include "settings.h"
+
+
+// *************************************************************************************************
+// Prototypes section
+u16 settings_flags_mask(void);
+u8 settings_pack(u16 * image);
+
+
+// *************************************************************************************************
+// Defines section
+
+#define SETTINGS_COUNT			(sizeof(settings_table)/sizeof(struct setting))
+
+
+// *************************************************************************************************
+// Global Variable section
+
+// Persistent fields. The record layout follows this table, so adding or removing an entry
+// makes the watch ignore a record written by an older firmware.
+// Packed size must fit into SETTINGS_MAX_WORDS minus the two header words.
+static const struct setting settings_table[] =
+{
+	{ &sTime.line1ViewStyle,		1 },
+	{ &sTime.line2ViewStyle,		1 },
+#ifdef CONFIG_ALARM
+	{ &sAlarm.state,				1 },
+	{ &sAlarm.hourly,				1 },
+	{ &sAlarm.hour,					1 },
+	{ &sAlarm.minute,				1 },
+#endif
+#ifdef CONFIG_ALTITUDE
+	{ &sAlt.altitude_offset,		sizeof(sAlt.altitude_offset) },
+#endif
+#ifdef CONFIG_EGGTIMER
+	{ &sEggtimer.default_hours,		1 },
+	{ &sEggtimer.default_minutes,	1 },
+	{ &sEggtimer.default_seconds,	1 },
+#endif
+#ifdef CONFIG_VARIO
+	{ &sVario,						sizeof(sVario) },
+#endif
+};
+
+// Seconds left until cached settings are written back (0 = nothing pending)
+static volatile u8 settings_delay;
+
+
+// *************************************************************************************************
+// Extern section
+
+
+// *************************************************************************************************
+// @fn          settings_flags_mask
+// @brief       Return the system flags that are user settings.
+// @param       none
+// @return      u16		Mask for sys.all_flags
+// *************************************************************************************************
+u16 settings_flags_mask(void)
+{
+	s_system_flags mask;
+	
+	mask.all_flags = 0;
+	mask.flag.lock_buttons = 1;
+	mask.flag.no_beep = 1;
+#ifndef CONFIG_METRIC_ONLY
+	mask.flag.use_metric_units = 1;
+#endif
+#if (OPTION_TIME_DISPLAY == CLOCK_DISPLAY_SELECT)
+	mask.flag.am_pm_time = 1;
+#endif
+
+	return mask.all_flags;
+}
+
+
+// *************************************************************************************************
+// @fn          settings_pack
+// @brief       Build the settings record from the current RAM values.
+//				Word 0 holds the layout (entry count, byte count), word 1 the system flags,
+//				followed by the packed fields.
+// @param       u16 * image		Buffer of SETTINGS_MAX_WORDS words
+// @return      u8				Record size in words
+// *************************************************************************************************
+u8 settings_pack(u16 * image)
+{
+	u8 * ptr = (u8 *)(image + 2);
+	u8 bytes;
+	u8 i;
+	
+	for (i=0; i<SETTINGS_COUNT; i++)
+	{
+		memcpy(ptr, settings_table[i].data, settings_table[i].size);
+		ptr += settings_table[i].size;
+	}
+	bytes = ptr - (u8 *)(image + 2);
+	
+	// Pad last word so that the record compares equal after a read back
+	if (bytes & 1) *ptr = 0;
+	
+	image[0] = (SETTINGS_COUNT << 8) | bytes;
+	image[1] = sys.all_flags & settings_flags_mask();
+	
+	return 2 + (bytes + 1) / 2;
+}
+
+
+// *************************************************************************************************
+// @fn          settings_restore
+// @brief       Restore all persistent fields from information memory. Call after the modules 
+//				have been reset to their defaults.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void settings_restore(void)
+{
+	u16 image[SETTINGS_MAX_WORDS];
+	u16 layout;
+	u16 mask;
+	u8 * ptr;
+	u8 words;
+	u8 i;
+	
+	// Record layout of this firmware
+	words  = settings_pack(image);
+	layout = image[0];
+	
+	// Ignore missing records and records of a different layout
+	if (infomem_app_amount(SETTINGS_INFOMEM_ID) != words) return;
+	if (infomem_app_read(SETTINGS_INFOMEM_ID, image, words, 0) != words) return;
+	if (image[0] != layout) return;
+	
+	ptr = (u8 *)(image + 2);
+	for (i=0; i<SETTINGS_COUNT; i++)
+	{
+		memcpy(settings_table[i].data, ptr, settings_table[i].size);
+		ptr += settings_table[i].size;
+	}
+	
+	mask = settings_flags_mask();
+	sys.all_flags = (sys.all_flags & ~mask) | (image[1] & mask);
+
+#ifdef CONFIG_ALARM
+	// Record may have been written while the alarm was ringing
+	if (sAlarm.state == ALARM_ON) sAlarm.state = ALARM_ENABLED;
+#endif
+
+#ifdef CONFIG_EGGTIMER
+	// Load restored defaults into the eggtimer
+	set_eggtimer_to_defaults();
+#endif
+}
+
+
+// *************************************************************************************************
+// @fn          settings_changed
+// @brief       Mark settings as modified. Write back happens SETTINGS_WRITE_DELAY seconds after 
+//				the last call. Can be called from ISR.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void settings_changed(void)
+{
+	settings_delay = SETTINGS_WRITE_DELAY;
+}
+
+
+// *************************************************************************************************
+// @fn          settings_tick
+// @brief       Count down write back delay. Called once per second from timer ISR.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void settings_tick(void)
+{
+	if (settings_delay != 0)
+	{
+		if (--settings_delay == 0) request.flag.settings_write = 1;
+	}
+}
+
+
+// *************************************************************************************************
+// @fn          settings_flush
+// @brief       Write back pending settings now, e.g. before the radio is started.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void settings_flush(void)
+{
+	if (settings_delay != 0 || request.flag.settings_write)
+	{
+		request.flag.settings_write = 0;
+		settings_write();
+	}
+}
+
+
+// *************************************************************************************************
+// @fn          settings_write
+// @brief       Write settings record to information memory. Flash is only touched if the record
+//				differs from the stored one.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void settings_write(void)
+{
+	u16 image[SETTINGS_MAX_WORDS];
+	u16 stored;
+	u8 words;
+	u8 i;
+	
+	settings_delay = 0;
+	words = settings_pack(image);
+	
+	if (infomem_app_amount(SETTINGS_INFOMEM_ID) == words)
+	{
+		for (i=0; i<words; i++)
+		{
+			if (infomem_app_read(SETTINGS_INFOMEM_ID, &stored, 1, i) != 1) break;
+			if (stored != image[i]) break;
+		}
+		
+		// Nothing changed
+		if (i == words) return;
+	}
+	
+	infomem_app_replace(SETTINGS_INFOMEM_ID, image, words);
+}
+
+#endif /* CONFIG_SETTINGS */
@@ -51,11 +51,17 @@
 
 // logic
 #include "user.h"
+#ifdef CONFIG_HISTORY
+#include "history.h"
+#endif
 
 
 // *************************************************************************************************
 // Prototypes section
 u8 is_temp_measurement(void);
+#ifdef CONFIG_HISTORY
+void display_temperature_view(u8 mode);
+#endif
 
 #ifndef CONFIG_METRIC_ONLY
 s16 convert_C_to_F(s16 value);
@@ -92,12 +98,12 @@ void reset_temp_measurement(void)
 
 
 // *************************************************************************************************
-// @fn          temperature_measurement
+// @fn          temperature_sample
 // @brief       Init ADC12. Do single conversion of temperature sensor voltage. Turn off ADC12.
 // @param       none
-// @return      none
+// @return      s16		Calibrated temperature (C) in 2.1 format
 // *************************************************************************************************
-void temperature_measurement(u8 filter)
+s16 temperature_sample(void)
 {
 	u16 adc_result;
 	volatile s32 temperature;
@@ -114,6 +120,22 @@ void temperature_measurement(u8 filter)
 	// Add temperature offset
 	temperature += sTemp.offset;	
 	
+	return ((s16)temperature);
+}
+
+
+// *************************************************************************************************
+// @fn          temperature_measurement
+// @brief       Measure temperature and update the displayed value.
+// @param       u8 filter		FILTER_ON, FILTER_OFF
+// @return      none
+// *************************************************************************************************
+void temperature_measurement(u8 filter)
+{
+	s16 temperature;
+	
+	temperature = temperature_sample();
+	
 	// Store measured temperature 
 	if (filter == FILTER_ON)
 	{
@@ -124,7 +146,7 @@ void temperature_measurement(u8 filter)
 	else
 	{
 		// Override filter 
-		sTemp.degrees = (s16)temperature;
+		sTemp.degrees = temperature;
 	}
 
 	// New data is available --> do display update
@@ -182,6 +204,42 @@ u8 is_temp_measurement(void)
 }
 
 
+#ifdef CONFIG_HISTORY
+// *************************************************************************************************
+// @fn          sx_temperature
+// @brief       Up button steps through current temperature and maximum, minimum and mean of today.
+// @param       u8 line		LINE1
+// @return      none
+// *************************************************************************************************
+void sx_temperature(u8 line)
+{
+	display_temperature_view(SEG_OFF_BLINK_OFF);
+	if (++sHistory.temp_view > HISTORY_VIEW_MEAN) sHistory.temp_view = HISTORY_VIEW_NOW;
+}
+
+
+// *************************************************************************************************
+// @fn          display_temperature_view
+// @brief       Symbol of the selected statistics. There is no MIN symbol, a blinking MAX marks the
+//				minimum. Symbols are shared with Line2, only the one of the view is touched.
+// @param       u8 mode		SEG_ON, SEG_OFF_BLINK_OFF
+// @return      none
+// *************************************************************************************************
+void display_temperature_view(u8 mode)
+{
+	switch (sHistory.temp_view)
+	{
+		case HISTORY_VIEW_MAX:	display_symbol(LCD_SYMB_MAX, mode);
+								break;
+		case HISTORY_VIEW_MIN:	display_symbol(LCD_SYMB_MAX, (mode == SEG_ON) ? SEG_ON_BLINK_ON : mode);
+								break;
+		case HISTORY_VIEW_MEAN:	display_symbol(LCD_SYMB_AVERAGE, mode);
+								break;
+	}
+}
+#endif
+
+
 // *************************************************************************************************
 // @fn          mx_temperature
 // @brief       Mx button handler to set the temperature offset. 
@@ -303,17 +361,24 @@ void display_temperature(u8 line, u8 update)
 	}
 	else if (update == DISPLAY_LINE_UPDATE_PARTIAL)
 	{
-		// When using English units, convert C to F (temp*1.8+32)
-#ifdef CONFIG_METRIC_ONLY
 		temperature = sTemp.degrees;
-#else
-		if (!sys.flag.use_metric_units)
+		
+#ifdef CONFIG_HISTORY
+		// Statistics of today, once the first minute was sampled
+		if (sHistory.samples && (sHistory.temp_view != HISTORY_VIEW_NOW))
 		{
-		    temperature = convert_C_to_F(sTemp.degrees);              
+			if (sHistory.temp_view == HISTORY_VIEW_MAX) 		temperature = sHistory.temp_max;
+			else if (sHistory.temp_view == HISTORY_VIEW_MIN) 	temperature = sHistory.temp_min;
+			else 												temperature = sHistory.temp_sum / (s16)sHistory.samples;
+			display_temperature_view(SEG_ON);
 		}
-		else
+#endif
+		
+		// When using English units, convert C to F (temp*1.8+32)
+#ifndef CONFIG_METRIC_ONLY
+		if (!sys.flag.use_metric_units)
 		{
-			temperature = sTemp.degrees;
+		    temperature = convert_C_to_F(temperature);              
 		}
 #endif 
 		
@@ -350,5 +415,8 @@ void display_temperature(u8 line, u8 update)
 		display_symbol(LCD_SYMB_ARROW_DOWN, SEG_OFF);
 		display_symbol(LCD_UNIT_L1_DEGREE, SEG_OFF);
 		display_symbol(LCD_SEG_L1_DP1, SEG_OFF);
+#ifdef CONFIG_HISTORY
+		display_temperature_view(SEG_OFF_BLINK_OFF);
+#endif
 	}
 }
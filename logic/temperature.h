@@ -46,9 +46,11 @@
 // internal functions
 extern void reset_temp_measurement(void);
 extern u8 is_temp_measurement(void);
+extern s16 temperature_sample(void);
 extern void temperature_measurement(u8 filter);
 
 // menu functions
+extern void sx_temperature(u8 line);
 extern void mx_temperature(u8 line);
 extern void display_temperature(u8 line, u8 update);
 
@@ -50,8 +50,12 @@
 #include "vti_as.h"
 #endif
 #include "vti_ps.h"
+#include "power.h"
 #include "ports.h"
 #include "timer.h"
+#ifdef CONFIG_CRASH_LOG
+#include "crash.h"
+#endif
 
 // logic
 #ifdef FEATURE_PROVIDE_ACCEL
@@ -72,6 +76,7 @@
 // Prototype section
 void display_all_on(void);
 void display_all_off(void);
+extern void to_lpm(void);
 
 
 // *************************************************************************************************
@@ -113,8 +118,7 @@ void test_mode(void)
 	WDTCTL = WDTPW + WDTHOLD;
 
 	// Wait for button press 
-	_BIS_SR(LPM3_bits + GIE); 
-	__no_operation();
+	to_lpm();
 
 	// Clear display
 	display_all_off();
@@ -178,7 +182,7 @@ void test_mode(void)
 								break;
 						case 3: // Acceleration measurement
 #ifdef FEATURE_PROVIDE_ACCEL
-								as_start();
+								power_acquire(POWER_ACCEL, POWER_USER_TEST);
 								for (i=0; i<4; i++)
 								{
 									Timer0_A4_Delay(CONV_MS_TO_TICKS(250));
@@ -188,7 +192,7 @@ void test_mode(void)
 									str = itoa( sAccel.xyz[2], 3, 0);
 									display_chars(LCD_SEG_L2_2_0, str, SEG_ON);
 								}
-								as_stop();
+								power_release(POWER_ACCEL, POWER_USER_TEST);
 #endif
 								break;
 						//pfs
@@ -251,6 +255,10 @@ void test_mode(void)
 					_BIS_SR(LPM4_bits + GIE);
 					__no_operation();
 				
+#ifdef CONFIG_CRASH_LOG
+					// Intended reset, do not record it as crash
+					crash_disarm();
+#endif
 					// Force watchdog reset for a clean restart 
 					WDTCTL = 1; 
 				}
@@ -260,8 +268,7 @@ void test_mode(void)
 				WDTCTL = WDTPW + WDTIS__512K + WDTSSEL__ACLK + WDTCNTCL;
 #endif
 				// To LPM3
-				_BIS_SR(LPM3_bits + GIE);  
-				__no_operation();
+				to_lpm();
 			}
 		}
 		else
@@ -278,7 +285,7 @@ void test_mode(void)
 
 void display_all_on(void)
 {
-	u8 * lcdptr = (u8*)0x0A20;
+	u8 * lcdptr = LCD_MEM_1;
 	u8 i;
 	
 	for (i=1; i<=12; i++) 
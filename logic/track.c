@@ -0,0 +1,259 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// Altitude track recorder. Every peak and dip the altitude accumulator confirms is appended with
+// its time to a flash log, no extra measurements are taken. Ascent, descent and climb statistics
+// are updated with each point and rebuilt from the log after a reset. The track is uploaded in 
+// sync mode (SYNC_AP_CMD_GET_TRACK).
+// *************************************************************************************************
+
+
+// *************************************************************************************************
+// Include section
+
+// system
+#include "project.h"
+
+#ifdef CONFIG_ALTI_TRACK
+
+// driver
+#include "flash.h"
+
+// logic
+#include "track.h"
+#include "clock.h"
+#include "date.h"
+
+
+// *************************************************************************************************
+// Prototypes section
+void track_update(u16 minute, s16 altitude);
+
+
+// *************************************************************************************************
+// Defines section
+
+
+// *************************************************************************************************
+// Global Variable section
+struct track sTrack;
+
+// Header and points
+static FLASH_SEGMENT(track_points);
+
+
+// *************************************************************************************************
+// Extern section
+
+
+// *************************************************************************************************
+// @fn          track_read
+// @brief       Read a 16-bit value of the log, MSB first.
+// @param       u16 offset		log offset
+// @return      u16
+// *************************************************************************************************
+static u16 track_read(u16 offset)
+{
+	return ((track_points[offset] << 8) | track_points[offset + 1]);
+}
+
+
+// *************************************************************************************************
+// @fn          track_begin
+// @brief       Clear the statistics for a track that starts at the given altitude.
+// @param       s16 altitude	start altitude in m
+// @return      none
+// *************************************************************************************************
+static void track_begin(s16 altitude)
+{
+	sTrack.count 	  = 0;
+	sTrack.altitude   = altitude;
+	sTrack.minute 	  = 0;
+	sTrack.ascent 	  = 0;
+	sTrack.descent 	  = 0;
+	sTrack.max 		  = altitude;
+	sTrack.min 		  = altitude;
+	sTrack.climbs 	  = 0;
+	sTrack.climb_gain = 0;
+	sTrack.climb_rate = 0;
+}
+
+
+// *************************************************************************************************
+// @fn          reset_track
+// @brief       Rebuild the statistics of the logged track.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void reset_track(void)
+{
+	u16 offset, time;
+	
+	track_begin(0);
+	if (track_points[TRACK_HEADER_MAGIC] != TRACK_MAGIC) return;
+	
+	track_begin((s16)track_read(TRACK_HEADER_START));
+	for (offset = TRACK_HEADER; offset < FLASH_SEGMENT_SIZE; offset += TRACK_POINT)
+	{
+		time = track_read(offset + TRACK_POINT_TIME);
+		if (time == 0xFFFF) break;
+		track_update(time & TRACK_MINUTE_MAX, (s16)track_read(offset + TRACK_POINT_ALTITUDE));
+		sTrack.count++;
+	}
+}
+
+
+// *************************************************************************************************
+// @fn          track_update
+// @brief       Add the leg from the last point to the statistics. A leg that gains altitude is a 
+//				climb, the accumulator ends it with a peak or the end of the track.
+// @param       u16 minute		minutes since the start
+//				s16 altitude	altitude in m
+// @return      none
+// *************************************************************************************************
+void track_update(u16 minute, s16 altitude)
+{
+	u16 gain, rate;
+	
+	if (altitude > sTrack.altitude)
+	{
+		gain = altitude - sTrack.altitude;
+		sTrack.ascent += gain;
+		sTrack.climbs++;
+		if (gain > sTrack.climb_gain) sTrack.climb_gain = gain;
+		if (minute > sTrack.minute)
+		{
+			rate = (u32)gain * 60 / (minute - sTrack.minute);
+			if (rate > sTrack.climb_rate) sTrack.climb_rate = rate;
+		}
+	}
+	else
+	{
+		sTrack.descent += sTrack.altitude - altitude;
+	}
+	
+	if (altitude > sTrack.max) sTrack.max = altitude;
+	if (altitude < sTrack.min) sTrack.min = altitude;
+	sTrack.altitude = altitude;
+	sTrack.minute   = minute;
+}
+
+
+// *************************************************************************************************
+// @fn          track_start
+// @brief       Erase the log and start a new track. Called when the accumulator is switched on.
+// @param       s16 altitude	start altitude in m
+// @return      none
+// *************************************************************************************************
+void track_start(s16 altitude)
+{
+	u8 header[TRACK_HEADER];
+	
+	header[TRACK_HEADER_MAGIC] 	= TRACK_MAGIC;
+	header[TRACK_HEADER_MONTH] 	= sDate.month;
+	header[TRACK_HEADER_DAY] 	= sDate.day;
+	header[TRACK_HEADER_HOUR] 	= sTime.hour;
+	header[TRACK_HEADER_MINUTE] = sTime.minute;
+	header[TRACK_HEADER_START] 	 = (u16)altitude >> 8;
+	header[TRACK_HEADER_START+1] = altitude & 0xFF;
+	header[TRACK_HEADER_START+2] = FLASH_ERASED;
+	
+	flash_erase(track_points);
+	flash_write(track_points, header, TRACK_HEADER);
+	track_begin(altitude);
+	sTrack.running = 1;
+}
+
+
+// *************************************************************************************************
+// @fn          track_point
+// @brief       Append a point to the log and update the statistics. Called by the accumulator
+//				on each peak and dip and with TRACK_END when it is switched off.
+// @param       u8 type			TRACK_PEAK, TRACK_DIP, TRACK_END
+//				u16 minute		minutes since the start, saturates after 11 days
+//				s16 altitude	altitude in m
+// @return      none
+// *************************************************************************************************
+void track_point(u8 type, u16 minute, s16 altitude)
+{
+	u8 point[TRACK_POINT];
+	u16 time;
+	
+	if (minute > TRACK_MINUTE_MAX) minute = TRACK_MINUTE_MAX;
+	track_update(minute, altitude);
+	if (type == TRACK_END) sTrack.running = 0;
+	
+	// Full, or no track started since the last reset
+	if ((sTrack.count >= TRACK_POINTS) || (track_points[TRACK_HEADER_MAGIC] != TRACK_MAGIC)) return;
+	
+	time = ((u16)type << TRACK_TYPE_SHIFT) | minute;
+	point[TRACK_POINT_TIME] 	  = time >> 8;
+	point[TRACK_POINT_TIME+1] 	  = time & 0xFF;
+	point[TRACK_POINT_ALTITUDE]   = (u16)altitude >> 8;
+	point[TRACK_POINT_ALTITUDE+1] = altitude & 0xFF;
+	flash_write(&track_points[TRACK_HEADER + sTrack.count * TRACK_POINT], point, TRACK_POINT);
+	sTrack.count++;
+}
+
+
+// *************************************************************************************************
+// @fn          track_log
+// @brief       Read the log for upload.
+// @param       u16 offset		TRACK_HEADER_xxx, or TRACK_HEADER + point * TRACK_POINT + TRACK_POINT_xxx
+// @return      u8				log byte, FLASH_ERASED past the end of the log
+// *************************************************************************************************
+u8 track_log(u16 offset)
+{
+	if (offset >= FLASH_SEGMENT_SIZE) return (FLASH_ERASED);
+	return (track_points[offset]);
+}
+
+
+// *************************************************************************************************
+// @fn          track_clear
+// @brief       Erase an uploaded track. A running track keeps its header and statistics, its
+//				next points are logged from the start of the segment.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void track_clear(void)
+{
+	u8 header[TRACK_HEADER];
+	u8 i;
+	
+	for (i=0; i<TRACK_HEADER; i++) header[i] = track_points[i];
+	flash_erase(track_points);
+	if (sTrack.running) flash_write(track_points, header, TRACK_HEADER);
+	sTrack.count = 0;
+}
+
+#endif /* CONFIG_ALTI_TRACK */
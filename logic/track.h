@@ -0,0 +1,118 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+#ifndef TRACK_H_
+#define TRACK_H_
+
+// *************************************************************************************************
+// Include section
+
+
+// *************************************************************************************************
+// Prototypes section
+extern void reset_track(void);
+extern void track_start(s16 altitude);
+extern void track_point(u8 type, u16 minute, s16 altitude);
+extern u8 track_log(u16 offset);
+extern void track_clear(void);
+
+
+// *************************************************************************************************
+// Defines section
+
+// Point types
+#define TRACK_PEAK					(1u)	// Top of a climb, confirmed by the accumulator
+#define TRACK_DIP					(2u)	// Bottom of a descent, confirmed by the accumulator
+#define TRACK_END					(3u)	// Accumulator switched off
+
+// The track is kept in one flash segment, a header followed by points of TRACK_POINT bytes. 
+// Unwritten points read FLASH_ERASED, so the track is found again after a reset. Points beyond
+// TRACK_POINTS are not logged, the statistics still count them.
+#define TRACK_MAGIC					(0x7Au)
+#define TRACK_HEADER_MAGIC			(0u)
+#define TRACK_HEADER_MONTH			(1u)	// Date and time the accumulator was started
+#define TRACK_HEADER_DAY			(2u)
+#define TRACK_HEADER_HOUR			(3u)
+#define TRACK_HEADER_MINUTE			(4u)
+#define TRACK_HEADER_START			(5u)	// Start altitude in m, MSB first
+#define TRACK_HEADER				(8u)
+
+#define TRACK_POINT_TIME			(0u)	// Type in bits 15-14, minutes since the start in bits 13-0
+#define TRACK_POINT_ALTITUDE		(2u)	// Altitude in m, MSB first
+#define TRACK_POINT					(4u)
+#define TRACK_POINTS				((FLASH_SEGMENT_SIZE - TRACK_HEADER) / TRACK_POINT)
+#define TRACK_TYPE_SHIFT			(14u)
+#define TRACK_MINUTE_MAX			((1u << TRACK_TYPE_SHIFT) - 1u)
+
+// Sync upload: page 0 carries header and statistics, the following pages four points each
+#define TRACK_POINTS_PER_PAGE		(4u)
+#define TRACK_PAGES(count)			(1u + ((count) + TRACK_POINTS_PER_PAGE - 1u) / TRACK_POINTS_PER_PAGE)
+
+
+// *************************************************************************************************
+// Global Variable section
+struct track
+{
+	// Points in the log
+	u8			count;
+	
+	// Altitude and time of the start or the last point
+	s16			altitude;
+	u16			minute;
+	
+	// Total ascent and descent between the points in m
+	u16			ascent;
+	u16			descent;
+	
+	// Highest and lowest point in m
+	s16			max;
+	s16			min;
+	
+	// Climbs, gain of the largest climb in m and best climb rate in m/h
+	u8			climbs;
+	u16			climb_gain;
+	u16			climb_rate;
+	
+	// 1 = accumulator on, points are logged until TRACK_END
+	u8			running;
+};
+extern struct track sTrack;
+
+
+// *************************************************************************************************
+// Extern section
+
+
+#endif /*TRACK_H_*/
@@ -82,8 +82,6 @@ struct
    u32 pressure;  // updated by altitude.c - need a mutex ?
    u32 prev_pa;   // pressure at last scan
    u8 p_valid;    // mutex for pressure field
-   u8 view_mode;  // view mode, controlled by "v" key
-   u8 beep_mode;  // beeper mode, controlled by "#" key
    struct
      {
 #if VARIO_VZ
@@ -103,6 +101,8 @@ struct
      } stats;
 } G_vario;
 
+struct vario_mode sVario;
+
 //
 // Note the beepmode enum changes are reflected in the beepmode symbol.
 // For visual feedback during settings, the beeper2 symbol is turned on
@@ -168,8 +168,8 @@ _clear_stats( void )
 extern void
 sx_vario(u8 line)
 {
-   G_vario.view_mode++;
-   G_vario.view_mode %= VARIO_VIEWMODE_MAX;
+   sVario.view_mode++;
+   sVario.view_mode %= VARIO_VIEWMODE_MAX;
 }
 
 //
@@ -179,14 +179,14 @@ sx_vario(u8 line)
 extern void
 mx_vario(u8 line)
 {
-   switch( G_vario.view_mode )
+   switch( sVario.view_mode )
      {
       case VARIO_VIEWMODE_ALT_M:
 #if VARIO_ALT_PA
       case VARIO_VIEWMODE_ALT_PA:
 #endif
-	G_vario.beep_mode++;
-	G_vario.beep_mode %= VARIO_BEEPMODE_MAX;
+	sVario.beep_mode++;
+	sVario.beep_mode %= VARIO_BEEPMODE_MAX;
 	break;
 
 #if VARIO_VZ
@@ -374,11 +374,11 @@ display_vario( u8 line, u8 update )
       case DISPLAY_LINE_UPDATE_FULL:
 
 	display_symbol( LCD_ICON_BEEPER1,
-			( G_vario.beep_mode ) ? SEG_ON : SEG_OFF );
+			( sVario.beep_mode ) ? SEG_ON : SEG_OFF );
 
 	display_symbol( LCD_ICON_BEEPER2,
-			(  ( G_vario.beep_mode == VARIO_BEEPMODE_ASCENT_0 )
-			|| ( G_vario.beep_mode == VARIO_BEEPMODE_BOTH ))
+			(  ( sVario.beep_mode == VARIO_BEEPMODE_ASCENT_0 )
+			|| ( sVario.beep_mode == VARIO_BEEPMODE_BOTH ))
 			  ? SEG_ON : SEG_OFF );
 	//
 	// fall through to partial update
@@ -466,7 +466,7 @@ display_vario( u8 line, u8 update )
 	
 	// Now see what value to display.
 
-	switch( G_vario.view_mode )
+	switch( sVario.view_mode )
 	  {
 	   case VARIO_VIEWMODE_ALT_M:
 	     //
@@ -524,7 +524,7 @@ display_vario( u8 line, u8 update )
 	  } // switch view mode
 
 	// If beeper is enabled, beep.
-	switch ( G_vario.beep_mode )
+	switch ( sVario.beep_mode )
 	  {
 	   case VARIO_BEEPMODE_ASCENT_0:
 	     if ( diff >= 0 ) chirp( diff );
@@ -64,4 +64,12 @@ extern void display_vario(u8 line, u8 update);
 // external function to update the pressure value.
 extern void vario_p_write(u32);
 
+// user selected modes, kept over reset by the settings module.
+struct vario_mode
+{
+   u8 view_mode;  // view mode, controlled by "v" key
+   u8 beep_mode;  // beeper mode, controlled by "#" key
+};
+extern struct vario_mode sVario;
+
 #endif
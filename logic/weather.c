@@ -0,0 +1,329 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// Free fall and shock logger on the acceleration sensor. While it is the only idle consumer, the
+// Barometric weather trend, running at all times. Every 10 minutes the pressure sensor does one
+// triggered low power conversion and goes back to standby, the sample is kept as change to the 
+// previous one in a 48 hour RAM ring. The 3 hour tendency and the pressure relative to the mean of
+// the history give a simple forecast, a rapid fall raises the storm alarm.
+// *************************************************************************************************
+
+
+// *************************************************************************************************
+// Include section
+
+// system
+#include "project.h"
+
+#ifdef CONFIG_WEATHER
+
+// driver
+#include "display.h"
+#include "vti_ps.h"
+#include "ports.h"
+#include "power.h"
+#include "buzzer.h"
+
+// logic
+#include "weather.h"
+
+
+// *************************************************************************************************
+// Prototypes section
+void weather_store(u32 pa);
+void weather_forecast(void);
+
+
+// *************************************************************************************************
+// Defines section
+
+// First sample some seconds after reset, when the pressure sensor is initialized
+#define WEATHER_FIRST				(5u)
+
+
+// *************************************************************************************************
+// Global Variable section
+struct weather sWeather;
+
+// Oldest sample of the ring in WEATHER_UNIT and sum of all samples, for the mean in O(1)
+static u16 weather_oldest;
+static u32 weather_sum;
+
+// Forecast symbols on Line2
+static const u8 weather_text[][5] = { " ----", " FAIR", "CLOUD", " RAIN", "STORM" };
+
+
+// *************************************************************************************************
+// Extern section
+extern u8 ps_ok;
+
+
+// *************************************************************************************************
+// @fn          reset_weather
+// @brief       Clear the pressure history and schedule the first sample.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void reset_weather(void)
+{
+	sWeather.timer		= WEATHER_FIRST;
+	sWeather.due		= 0;
+	sWeather.converting	= 0;
+	sWeather.pressure	= 0;
+	sWeather.head		= 0;
+	sWeather.count		= 0;
+	sWeather.tendency	= 0;
+	sWeather.level		= 0;
+	sWeather.forecast	= WEATHER_UNKNOWN;
+	sWeather.storm		= 0;
+	sWeather.view		= WEATHER_VIEW_PRESSURE;
+}
+
+
+// *************************************************************************************************
+// @fn          weather_tick
+// @brief       Count down to the next sample. Called from the 1Hz timer ISR.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void weather_tick(void)
+{
+	// In case the DRDY interrupt was missed due to debouncing, get data now
+	if (sWeather.converting && ((PS_INT_IN & PS_INT_PIN) == PS_INT_PIN)) request.flag.weather = 1;
+	
+	if (--sWeather.timer) return;
+	sWeather.timer = WEATHER_PERIOD;
+	sWeather.due = 1;
+	request.flag.weather = 1;
+}
+
+
+// *************************************************************************************************
+// @fn          weather_process
+// @brief       Start a due conversion, store its result. While the altimeter keeps the sensor 
+//				sampling, its newest conversion is used.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void weather_process(void)
+{
+	// Result of the triggered conversion
+	if (sWeather.converting && ((PS_INT_IN & PS_INT_PIN) == PS_INT_PIN))
+	{
+		sWeather.converting = 0;
+		if (!power_is_on(POWER_PRESSURE)) PS_INT_IE &= ~PS_INT_PIN;
+		weather_store(ps_get_pa());
+	}
+	
+	if (!sWeather.due) return;
+	sWeather.due = 0;
+	
+	if (power_is_on(POWER_PRESSURE))
+	{
+		weather_store(ps_get_pa());
+	}
+	else if (ps_ok)
+	{
+		// One conversion, the sensor is back in standby when DRDY rises. A conversion that did
+		// not finish is simply triggered again.
+		sWeather.converting = 1;
+		PS_INT_IFG &= ~PS_INT_PIN;
+		PS_INT_IE |= PS_INT_PIN;
+		ps_trigger();
+	}
+}
+
+
+// *************************************************************************************************
+// @fn          weather_store
+// @brief       Add a sample to the ring and update the forecast.
+// @param       u32 pa		Pressure (Pa)
+// @return      none
+// *************************************************************************************************
+void weather_store(u32 pa)
+{
+	u16 pressure = (u16)((pa + WEATHER_UNIT/2) / WEATHER_UNIT);
+	s16 delta;
+	
+	// First sample starts the history
+	if (sWeather.pressure == 0)
+	{
+		sWeather.pressure = pressure;
+		weather_oldest = pressure;
+		weather_sum = pressure;
+		return;
+	}
+	
+	// Change against the stored value, so that a clamped step is caught up by the next ones
+	delta = pressure - sWeather.pressure;
+	if (delta > WEATHER_DELTA_MAX) 			delta = WEATHER_DELTA_MAX;
+	else if (delta < -WEATHER_DELTA_MAX) 	delta = -WEATHER_DELTA_MAX;
+	
+	// Full ring: the oldest delta is overwritten, the oldest sample moves one step on
+	if (sWeather.count == WEATHER_HISTORY)
+	{
+		weather_sum -= weather_oldest;
+		weather_oldest += sWeather.delta[sWeather.head];
+	}
+	else
+	{
+		sWeather.count++;
+	}
+	
+	sWeather.delta[sWeather.head] = delta;
+	if (++sWeather.head == WEATHER_HISTORY) sWeather.head = 0;
+	sWeather.pressure += delta;
+	weather_sum += sWeather.pressure;
+	
+	weather_forecast();
+}
+
+
+// *************************************************************************************************
+// @fn          weather_forecast
+// @brief       3 hour tendency, pressure relative to the mean of the history, forecast symbol and
+//				storm alarm.
+// @param       none
+// @return      none
+// *************************************************************************************************
+void weather_forecast(void)
+{
+	s16 tendency = 0;
+	u16 index = sWeather.head;
+	u8 i;
+	
+	if (sWeather.count < WEATHER_TENDENCY) return;
+	
+	for (i=0; i<WEATHER_TENDENCY; i++)
+	{
+		if (index == 0) index = WEATHER_HISTORY;
+		tendency += sWeather.delta[--index];
+	}
+	sWeather.tendency = tendency * WEATHER_UNIT;
+	sWeather.level = ((s16)sWeather.pressure - (s16)(weather_sum / (sWeather.count + 1))) * WEATHER_UNIT;
+	
+	if (sWeather.tendency <= WEATHER_STORM)
+	{
+		sWeather.forecast = WEATHER_STORMY;
+	}
+	else if ((sWeather.tendency <= WEATHER_FALL) || ((sWeather.tendency < WEATHER_RISE) && (sWeather.level <= WEATHER_LOW)))
+	{
+		sWeather.forecast = WEATHER_RAIN;
+	}
+	else if ((sWeather.tendency >= WEATHER_RISE) || (sWeather.level >= WEATHER_HIGH))
+	{
+		sWeather.forecast = WEATHER_FAIR;
+	}
+	else
+	{
+		sWeather.forecast = WEATHER_CLOUD;
+	}
+	
+	// Storm alarm once per fall
+	if ((sWeather.forecast == WEATHER_STORMY) && !sWeather.storm)
+	{
+		sWeather.storm = 1;
+#ifdef CONFIG_WEATHER_ALARM
+		start_buzzer(6, CONV_MS_TO_TICKS(150), CONV_MS_TO_TICKS(100));
+		message.flag.prepare = 1;
+		message.flag.type_storm = 1;
+#endif
+	}
+	else if (sWeather.tendency > WEATHER_STORM_CLEAR)
+	{
+		sWeather.storm = 0;
+	}
+}
+
+
+// *************************************************************************************************
+// @fn          sx_weather
+// @brief       Button DOWN steps through pressure, tendency and forecast.
+// @param       u8 line		LINE2
+// @return      none
+// *************************************************************************************************
+void sx_weather(u8 line)
+{
+	if (++sWeather.view == WEATHER_VIEWS) sWeather.view = WEATHER_VIEW_PRESSURE;
+	display.flag.line2_full_update = 1;
+}
+
+
+// *************************************************************************************************
+// @fn          display_weather
+// @brief       Display pressure in hPa, reduced to sea level when the altimeter was calibrated,
+//				3 hour tendency in hPa with arrow, or forecast symbol.
+// @param       u8 line		LINE2
+//				u8 update		DISPLAY_LINE_UPDATE_FULL, DISPLAY_LINE_UPDATE_PARTIAL, DISPLAY_LINE_CLEAR
+// @return      none
+// *************************************************************************************************
+void display_weather(u8 line, u8 update)
+{
+	u16 tendency;
+	
+	if (update == DISPLAY_LINE_CLEAR)
+	{
+		display_symbol(LCD_SEG_L2_DP, SEG_OFF);
+		display_symbol(LCD_SYMB_ARROW_UP, SEG_OFF);
+		display_symbol(LCD_SYMB_ARROW_DOWN, SEG_OFF);
+		return;
+	}
+	
+	if ((sWeather.view == WEATHER_VIEW_TENDENCY) && (sWeather.count >= WEATHER_TENDENCY))
+	{
+		tendency = (sWeather.tendency < 0) ? -sWeather.tendency : sWeather.tendency;
+		display_chars(LCD_SEG_L2_5_4, (u8*)"  ", SEG_ON);
+		display_chars(LCD_SEG_L2_3_0, itoa(tendency, 4, 1), SEG_ON);
+		display_symbol(LCD_SEG_L2_DP, SEG_ON);
+		display_symbol(LCD_SYMB_ARROW_UP, (sWeather.tendency > 0) ? SEG_ON : SEG_OFF);
+		display_symbol(LCD_SYMB_ARROW_DOWN, (sWeather.tendency < 0) ? SEG_ON : SEG_OFF);
+		return;
+	}
+	
+	display_symbol(LCD_SYMB_ARROW_UP, SEG_OFF);
+	display_symbol(LCD_SYMB_ARROW_DOWN, SEG_OFF);
+	
+	if ((sWeather.view == WEATHER_VIEW_PRESSURE) && sWeather.pressure)
+	{
+		display_chars(LCD_SEG_L2_5_0, itoa((u32)sWeather.pressure * WEATHER_UNIT + ps_get_reduction(), 6, 1), SEG_ON);
+		display_symbol(LCD_SEG_L2_DP, SEG_ON);
+	}
+	else
+	{
+		// Forecast, or "----" while there are not enough samples
+		display_symbol(LCD_SEG_L2_DP, SEG_OFF);
+		display_char(LCD_SEG_L2_5, ' ', SEG_ON);
+		display_chars(LCD_SEG_L2_4_0, (u8*)weather_text[(sWeather.view == WEATHER_VIEW_FORECAST) ? sWeather.forecast : WEATHER_UNKNOWN], SEG_ON);
+	}
+}
+
+#endif /* CONFIG_WEATHER */
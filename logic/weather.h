@@ -0,0 +1,127 @@
+// *************************************************************************************************
+//
+//	Copyright (C) 2009 Texas Instruments Incorporated - http://www.ti.com/ 
+//	 
+//	 
+//	  Redistribution and use in source and binary forms, with or without 
+//	  modification, are permitted provided that the following conditions 
+//	  are met:
+//	
+//	    Redistributions of source code must retain the above copyright 
+//	    notice, this list of conditions and the following disclaimer.
+//	 
+//	    Redistributions in binary form must reproduce the above copyright
+//	    notice, this list of conditions and the following disclaimer in the 
+//	    documentation and/or other materials provided with the   
+//	    distribution.
+//	 
+//	    Neither the name of Texas Instruments Incorporated nor the names of
+//	    its contributors may be used to endorse or promote products derived
+//	    from this software without specific prior written permission.
+//	
+//	  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+//	  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+//	  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//	  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+//	  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+//	  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//	  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//	  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//	  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//	  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//	  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+
+#ifndef WEATHER_H_
+#define WEATHER_H_
+
+// *************************************************************************************************
+// Include section
+
+
+// *************************************************************************************************
+// Prototypes section
+extern void reset_weather(void);
+extern void weather_tick(void);
+extern void weather_process(void);
+extern void sx_weather(u8 line);
+extern void display_weather(u8 line, u8 update);
+
+
+// *************************************************************************************************
+// Defines section
+
+// One pressure sample every 10 minutes, 48 hours of history
+#define WEATHER_PERIOD				(600u)
+#define WEATHER_HISTORY				(288u)
+
+// Pressure is kept in units of 4Pa, the change between two samples in one signed byte
+#define WEATHER_UNIT				(4u)
+#define WEATHER_DELTA_MAX			(127)
+
+// Tendency over the last 3 hours of samples
+#define WEATHER_TENDENCY			(18u)
+
+// Forecast thresholds in Pa: 3 hour tendency, and pressure relative to the mean of the history
+#define WEATHER_RISE				(150)
+#define WEATHER_FALL				(-150)
+#define WEATHER_STORM				(-400)		// Storm alarm on a fall of 4hPa in 3 hours
+#define WEATHER_STORM_CLEAR			(-200)		// Alarm is armed again above this tendency
+#define WEATHER_HIGH				(300)
+#define WEATHER_LOW					(-300)
+
+// Forecast symbols
+#define WEATHER_UNKNOWN				(0u)		// Less than 3 hours of history
+#define WEATHER_FAIR				(1u)
+#define WEATHER_CLOUD				(2u)
+#define WEATHER_RAIN				(3u)
+#define WEATHER_STORMY				(4u)
+
+#define WEATHER_VIEW_PRESSURE		(0u)
+#define WEATHER_VIEW_TENDENCY		(1u)
+#define WEATHER_VIEW_FORECAST		(2u)
+#define WEATHER_VIEWS				(3u)
+
+
+// *************************************************************************************************
+// Global Variable section
+struct weather
+{
+	// Seconds until the next sample
+	u16			timer;
+	
+	// Sample is due, a triggered conversion is running
+	u8			due;
+	volatile u8	converting;
+
+	// Newest sample in WEATHER_UNIT, rebuilt from the deltas so that clamping does not add up
+	u16			pressure;
+	
+	// Change to the previous sample in WEATHER_UNIT, ring of WEATHER_HISTORY
+	s8			delta[WEATHER_HISTORY];
+	u16			head;
+	u16			count;
+
+	// Pressure change over the last 3 hours and pressure relative to the mean of the history, Pa
+	s16			tendency;
+	s16			level;
+	
+	// WEATHER_xxx forecast symbol
+	u8			forecast;
+
+	// Storm alarm was raised, armed again when the fall slows down
+	u8			storm;
+
+	// WEATHER_VIEW_xxx
+	u8			view;
+};
+extern struct weather sWeather;
+
+
+// *************************************************************************************************
+// Extern section
+
+
+#endif /*WEATHER_H_*/
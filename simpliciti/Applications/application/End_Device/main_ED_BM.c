@@ -47,6 +47,21 @@
 
 #define TIMEOUT					(10u)
 
+// Link quality management: RSSI (dBm) our frames should at least arrive with at the access point
+#define LQM_TARGET_RSSI			(-80)
+
+// Extra margin (dB) the next lower power level must keep before stepping down
+#define LQM_HYSTERESIS			(4)
+
+// Assumed access point output power (dBm) when estimating path loss from received frames
+#define LQM_AP_TX_DBM			(1)
+
+// Received frames after which an RSSI echoed by the access point is no longer preferred
+#define LQM_PEER_RSSI_MAX_AGE	(8u)
+
+// Samples needed before stepping the output power down
+#define LQM_MIN_SAMPLES			(4u)
+
 // Conversion from msec to ACLK timer ticks
 #define CONV_MS_TO_TICKS(msec)         			(((msec) * 32768) / 1000) 
 
@@ -73,6 +88,149 @@ extern unsigned char simpliciti_payload_length;
 // Global Variable section
 static linkID_t sLinkID1;
 
+// Running link statistics of sLinkID1
+static struct
+{
+  int16_t pathloss;     // Filtered path loss in 1/4 dB
+  int16_t rssi;         // Filtered RSSI of received frames in 1/4 dBm
+  uint8_t lqi;          // Filtered LQI of received frames
+  uint8_t samples;      // Number of path loss samples, saturates
+  uint8_t peer_age;     // Frames received since last RSSI echo from access point
+} sLinkQuality;
+
+
+// *************************************************************************************************
+// @fn          lqm_reset
+// @brief       Forget link statistics and go back to full output power.
+// @param       none
+// @return      none
+// *************************************************************************************************
+static void lqm_reset(void)
+{
+  sLinkQuality.samples  = 0;
+  sLinkQuality.peer_age = LQM_PEER_RSSI_MAX_AGE;
+  
+  // MRFI_Init() already selects full power, so usually there is nothing to write
+  if (MRFI_GetRFPwr() != MRFI_NUM_POWER_SETTINGS - 1)
+  {
+    MRFI_SetRFPwr(MRFI_NUM_POWER_SETTINGS - 1);
+  }
+}
+
+
+// *************************************************************************************************
+// @fn          lqm_apply
+// @brief       Filter a new path loss sample and select the lowest output power that still keeps
+//				LQM_TARGET_RSSI at the access point. Power goes up at once, but down only one
+//				step per sample and only with LQM_HYSTERESIS dB to spare.
+// @param       int16_t pathloss		Path loss sample in dB
+// @return      none
+// *************************************************************************************************
+static void lqm_apply(int16_t pathloss)
+{
+  uint8_t level = MRFI_GetRFPwr();
+  uint8_t i;
+  int16_t pl;
+
+  if (sLinkQuality.samples == 0)
+  {
+    sLinkQuality.pathloss = pathloss * 4;
+  }
+  else
+  {
+    sLinkQuality.pathloss += (pathloss * 4 - sLinkQuality.pathloss) / 4;
+  }
+  if (sLinkQuality.samples < 0xFF) sLinkQuality.samples++;
+
+  pl = (sLinkQuality.pathloss + 2) / 4;
+
+  for (i=0; i<MRFI_NUM_POWER_SETTINGS-1; i++)
+  {
+    if (MRFI_GetRFPwrDbm(i) - pl >= LQM_TARGET_RSSI + ((i < level) ? LQM_HYSTERESIS : 0)) break;
+  }
+
+  if (i < level)
+  {
+    // Need some confidence before reducing power
+    if (sLinkQuality.samples < LQM_MIN_SAMPLES) return;
+    i = level - 1;
+  }
+  if (i != level) MRFI_SetRFPwr(i);
+}
+
+
+// *************************************************************************************************
+// @fn          lqm_rx_update
+// @brief       Update link statistics with the signal info of the last frame received on sLinkID1.
+//				Without a fresh echo from the access point, the path loss is estimated from our own
+//				received RSSI assuming a symmetric link.
+// @param       none
+// @return      none
+// *************************************************************************************************
+static void lqm_rx_update(void)
+{
+  ioctlRadioSiginfo_t sig;
+
+  sig.lid = sLinkID1;
+  if (SMPL_Ioctl(IOCTL_OBJ_RADIO, IOCTL_ACT_RADIO_SIGINFO, &sig) != SMPL_SUCCESS) return;
+
+  if (sLinkQuality.samples == 0)
+  {
+    sLinkQuality.rssi = sig.sigInfo.rssi * 4;
+    sLinkQuality.lqi  = sig.sigInfo.lqi;
+  }
+  else
+  {
+    sLinkQuality.rssi += (sig.sigInfo.rssi * 4 - sLinkQuality.rssi) / 4;
+    sLinkQuality.lqi   = sLinkQuality.lqi - (sLinkQuality.lqi >> 2) + (sig.sigInfo.lqi >> 2);
+  }
+
+  if (sLinkQuality.peer_age < LQM_PEER_RSSI_MAX_AGE)
+  {
+    sLinkQuality.peer_age++;
+    return;
+  }
+  lqm_apply(LQM_AP_TX_DBM - sig.sigInfo.rssi);
+}
+
+
+// *************************************************************************************************
+// @fn          simpliciti_link_peer_rssi
+// @brief       Access point reported the RSSI it received our last frame with.
+// @param       int8_t rssi		RSSI in dBm
+// @return      none
+// *************************************************************************************************
+void simpliciti_link_peer_rssi(int8_t rssi)
+{
+  sLinkQuality.peer_age = 0;
+  lqm_apply(MRFI_GetRFPwrDbm(MRFI_GetRFPwr()) - rssi);
+}
+
+
+// *************************************************************************************************
+// @fn          simpliciti_link_rssi
+// @brief       Filtered RSSI of frames received from the access point.
+// @param       none
+// @return      int8_t		RSSI in dBm
+// *************************************************************************************************
+int8_t simpliciti_link_rssi(void)
+{
+  return (int8_t)(sLinkQuality.rssi / 4);
+}
+
+
+// *************************************************************************************************
+// @fn          simpliciti_link_temperature
+// @brief       Current temperature for the radio synthesizer calibration cache.
+//				Must be called before simpliciti_link().
+// @param       int16_t degrees		Temperature in 1/10 degree Celsius
+// @return      none
+// *************************************************************************************************
+void simpliciti_link_temperature(int16_t degrees)
+{
+  MRFI_SetCalTemp(degrees);
+}
+
 
 
 // *************************************************************************************************
@@ -87,7 +245,6 @@ unsigned char simpliciti_link(void)
   uint8_t timeout;
   addr_t lAddr;
   uint8_t i;
-  uint8_t pwr;
   uint8_t phase = 0;
   
   // Configure timer
@@ -113,8 +270,8 @@ unsigned char simpliciti_link(void)
     if (phase == 0) {
         if(SMPL_SUCCESS == SMPL_Init(0)) {
             phase = 1;
-            pwr = IOCTL_LEVEL_2;
-            SMPL_Ioctl(IOCTL_OBJ_RADIO, IOCTL_ACT_RADIO_SETPWR, &pwr);
+            // Link at full power, link quality management lowers it later on
+            lqm_reset();
 
             /* Unconditional link to AP which is listening due to successful join. */
             timeout = 0;
@@ -221,7 +378,7 @@ unsigned char simpliciti_link(void)
 // *************************************************************************************************
 void simpliciti_main_tx_only(void)
 {
-	uint8_t len, i;
+	uint8_t len, i, rx;
 	uint8_t ed_data[2];
 
 	while(1)
@@ -271,8 +428,11 @@ void simpliciti_main_tx_only(void)
 					// Wait shortly for host reply
 					NWK_DELAY(10);
 
+					rx = 0;
 					while (SMPL_Receive(sLinkID1, simpliciti_data, &len) == SMPL_SUCCESS) 
 					{
+						rx = 1;
+						lqm_rx_update();
 						if (len > 0)
 						{
 							// Decode received data
@@ -284,6 +444,8 @@ void simpliciti_main_tx_only(void)
 							}
 						}
 					}
+					// No reply: maybe we are too weak, retry at full power
+					if (!rx) lqm_reset();
                     Timer0_A4_Delay(CONV_MS_TO_TICKS(500));
 				}
 			}
@@ -348,6 +510,8 @@ void simpliciti_main_sync(void)
 		// Check if a command packet was received
 		while (SMPL_Receive(sLinkID1, simpliciti_data, &len) == SMPL_SUCCESS)
 		{
+			lqm_rx_update();
+			
 			// Decode received data
 			contacted = 1;
 			if (len > 0)
@@ -47,12 +47,17 @@
 #define NUM_CONNECTIONS  1
 
 /*  ***  Size of low level queues for sent and received frames. Affects RAM usage  ***  */
+/* Queue operations are O(1) so the depth only costs RAM. Both sizes can be overridden
+ * on the compiler command line (e.g. -DSIZE_INFRAME_Q=4), up to 254 frames each.
+ */
 
 /* AP needs larger input frame queue if it is supporting store-and-forward
  * clients because the forwarded messages are held here. Two is probably enough
  * for an End Device
  */
+#ifndef SIZE_INFRAME_Q
 #define SIZE_INFRAME_Q  2
+#endif
 
 /* The output frame queue can be small since Tx is done synchronously. Actually
  * 1 is probably enough. If an Access Point device is also hosting an End Device 
@@ -60,7 +65,9 @@
  * frames in this case are held here. In that case the output frame queue should 
  * be bigger. 
  */
+#ifndef SIZE_OUTFRAME_Q
 #define SIZE_OUTFRAME_Q  2
+#endif
 
 /* This device's address. The first byte is used as a filter on the CC1100/CC2500
  * radios so THE FIRST BYTE MUST NOT BE either 0x00 or 0xFF. Also, for these radios
@@ -61,6 +61,16 @@ static void Bsp_SetClocks(void);
 #define BSP_TIMER_CLK_MHZ   12       /* 12 MHz MCLKC and SMCLK */
 #define BSP_DELAY_MAX_USEC  (0xFFFF/BSP_TIMER_CLK_MHZ)
 
+/* ACLK ticks per microsecond as 16.16 fixed point: 32768 / 1000000 * 65536 */
+#define BSP_SLEEP_ACLK_PER_USEC_Q16   2147UL
+
+/* ------------------------------------------------------------------------------------------------
+ *                                            External Functions
+ * ------------------------------------------------------------------------------------------------
+ */
+/* see driver/timer.h */
+void Timer0_A4_Sleep(unsigned short ticks, volatile unsigned char * abort);
+
 /**************************************************************************************************
  * @fn          SetVCore
  *
@@ -287,3 +297,30 @@ void BSP_Delay(uint16_t usec)
   TA1CTL &= ~(MC_1);
   TA1CCTL0 &= ~CCIFG;  
 }
+
+/**************************************************************************************************
+ * @fn          BSP_Sleep
+ *
+ * @brief       Delay for the requested amount of time in LPM3. The firmware one-time delay
+ *              compare of TA0 (Timer0_A4_Sleep) ends the delay, TA1 is left alone because it
+ *              is the buzzer PWM timer. Any other interrupt that clears the LPM bits on exit
+ *              (1Hz tick, radio) makes the loop re-check the abort flag, so a delay can be cut
+ *              short from ISR context. Resolution is one ACLK tick (~30.5us), the delay errs
+ *              on the side of being too long.
+ *
+ *              Must not be called with interrupts disabled (e.g. from an ISR); the caller
+ *              has to fall back to BSP_Delay() in that case.
+ *
+ * @param       usec   - # of microseconds to delay.
+ * @param       pAbort - optional early-out flag, checked after every wakeup. May be NULL.
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+void BSP_Sleep(uint16_t usec, volatile uint8_t * pAbort)
+{
+  /* Rounded up by two ticks, Timer0_A4_Sleep() may return one tick early */
+  uint16_t ticks = (uint16_t)(((uint32_t)usec * BSP_SLEEP_ACLK_PER_USEC_Q16) >> 16) + 2;
+
+  Timer0_A4_Sleep(ticks, pAbort);
+}
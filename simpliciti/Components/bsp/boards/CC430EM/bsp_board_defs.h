@@ -69,9 +69,31 @@
 #define BSP_BOARD_C               "bsp_board.c"
 #define BSP_INIT_BOARD()          BSP_InitBoard()
 #define BSP_DELAY_USECS(x)        BSP_Delay(x)
+#define BSP_SLEEP_USECS(x,abort)  BSP_Sleep(x,abort)
 
 void BSP_InitBoard(void);
 void BSP_Delay(uint16_t usec);
+void BSP_Sleep(uint16_t usec, volatile uint8_t * pAbort);
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                    Energy Profiling Hooks
+ * ------------------------------------------------------------------------------------------------
+ */
+#include "config.h"
+
+#ifdef CONFIG_PROFILE
+/* see driver/profile.h */
+void profile_radio(unsigned char state);
+
+#define BSP_PROFILE_RADIO_IDLE()  profile_radio(0)
+#define BSP_PROFILE_RADIO_RX()    profile_radio(1)
+#define BSP_PROFILE_RADIO_TX()    profile_radio(2)
+#else
+#define BSP_PROFILE_RADIO_IDLE()
+#define BSP_PROFILE_RADIO_RX()
+#define BSP_PROFILE_RADIO_TX()
+#endif
 
 /* ************************************************************************************************
  *                                   Compile Time Integrity Checks
@@ -0,0 +1,169 @@
+/**************************************************************************************************
+  Host (POSIX) board file.
+
+  Time and interrupts are emulated with select(): while the stack "waits" in BSP_Delay(),
+  BSP_Sleep() or BSP_HostWait(), the registered receive handler is run each time its file
+  descriptor becomes readable and the emulated interrupt enable flag is set.  Outside of those
+  calls nothing preempts the stack, which is a stricter model than the target but keeps the
+  code free of real concurrency.
+**************************************************************************************************/
+
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+ *   BSP (Board Support Package)
+ *   Target : Host (POSIX)
+ *   Board code file.
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+ */
+
+/* ------------------------------------------------------------------------------------------------
+ *                                            Includes
+ * ------------------------------------------------------------------------------------------------
+ */
+#include <sys/select.h>
+#include <time.h>
+#include "bsp.h"
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                        Global Variables
+ * ------------------------------------------------------------------------------------------------
+ */
+volatile uint8_t bspHostIntEnabled = 0;
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                        Local Variables
+ * ------------------------------------------------------------------------------------------------
+ */
+static int sIsrFd = -1;
+static void (*sIsr)(void) = NULL;
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                        Local Functions
+ * ------------------------------------------------------------------------------------------------
+ */
+static uint64_t bspHostNowUsec(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)(ts.tv_nsec / 1000);
+}
+
+
+/**************************************************************************************************
+ * @fn          BSP_InitBoard
+ *
+ * @brief       Initialize the board.  Nothing to do on the host.
+ *
+ * @param       none
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+void BSP_InitBoard(void)
+{
+}
+
+
+/**************************************************************************************************
+ * @fn          BSP_HostSetIsr
+ *
+ * @brief       Register the emulated interrupt source.
+ *
+ * @param       fd  - descriptor whose readability raises the interrupt
+ *              isr - handler; must consume the pending input
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+void BSP_HostSetIsr(int fd, void (*isr)(void))
+{
+  sIsrFd = fd;
+  sIsr   = isr;
+}
+
+
+/**************************************************************************************************
+ * @fn          BSP_HostWait
+ *
+ * @brief       Let 'usec' microseconds of host time pass.  The emulated ISR runs whenever its
+ *              input is ready and interrupts are enabled.  Returns early if *pAbort is set,
+ *              which can only happen from the ISR.
+ *
+ * @param       usec   - time to wait
+ *              pAbort - abort flag, may be NULL
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+void BSP_HostWait(uint32_t usec, volatile uint8_t * pAbort)
+{
+  uint64_t deadline = bspHostNowUsec() + usec;
+
+  for (;;)
+  {
+    struct timeval tv;
+    fd_set         rd;
+    uint64_t       now = bspHostNowUsec();
+    int            nfds = 0;
+
+    if ((pAbort && *pAbort) || (now >= deadline))
+    {
+      return;
+    }
+
+    tv.tv_sec  = (deadline - now) / 1000000u;
+    tv.tv_usec = (deadline - now) % 1000000u;
+
+    FD_ZERO(&rd);
+    if (sIsr && (sIsrFd >= 0) && bspHostIntEnabled)
+    {
+      FD_SET(sIsrFd, &rd);
+      nfds = sIsrFd + 1;
+    }
+
+    if ((select(nfds, &rd, NULL, NULL, &tv) > 0) && FD_ISSET(sIsrFd, &rd))
+    {
+      sIsr();
+    }
+  }
+}
+
+
+/**************************************************************************************************
+ * @fn          BSP_Delay
+ *
+ * @brief       Delay for the requested amount of time.
+ *
+ * @param       # of microseconds to delay.
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+void BSP_Delay(uint16_t usec)
+{
+  BSP_HostWait(usec, NULL);
+}
+
+
+/**************************************************************************************************
+ * @fn          BSP_Sleep
+ *
+ * @brief       Sleep for the requested amount of time or until *pAbort is set.
+ *
+ * @param       usec   - microseconds to sleep
+ *              pAbort - abort flag, may be NULL
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+void BSP_Sleep(uint16_t usec, volatile uint8_t * pAbort)
+{
+  BSP_HostWait(usec, pAbort);
+}
+
+
+/**************************************************************************************************
+*/
@@ -0,0 +1,66 @@
+/**************************************************************************************************
+  Host (POSIX) board definition file.  Used by the native SimpliciTI build ("make
+  simpliciti_host") together with the MRFI_HOST radio.
+**************************************************************************************************/
+
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+ *   BSP (Board Support Package)
+ *   Target : Host (POSIX)
+ *   Board definition file.
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+ */
+
+#ifndef BSP_BOARD_DEFS_H
+#define BSP_BOARD_DEFS_H
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                     Board Unique Define
+ * ------------------------------------------------------------------------------------------------
+ */
+#define BSP_BOARD_HOST
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                           Mcu
+ * ------------------------------------------------------------------------------------------------
+ */
+#include "mcus/bsp_host_defs.h"
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                          Clock
+ * ------------------------------------------------------------------------------------------------
+ */
+#include "bsp_config.h"
+#define __bsp_CLOCK_MHZ__         BSP_CONFIG_CLOCK_MHZ
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                     Board Initialization
+ * ------------------------------------------------------------------------------------------------
+ */
+#define BSP_BOARD_C               "bsp_board.c"
+#define BSP_INIT_BOARD()          BSP_InitBoard()
+#define BSP_DELAY_USECS(x)        BSP_Delay(x)
+#define BSP_SLEEP_USECS(x,abort)  BSP_Sleep(x,abort)
+
+void BSP_InitBoard(void);
+void BSP_Delay(uint16_t usec);
+void BSP_Sleep(uint16_t usec, volatile uint8_t * pAbort);
+
+/* ------------------------------------------------------------------------------------------------
+ *                                     Emulated Interrupts
+ * ------------------------------------------------------------------------------------------------
+ */
+/* Register the handler run when 'fd' becomes readable (the radio receive "interrupt"). */
+void BSP_HostSetIsr(int fd, void (*isr)(void));
+
+/* Let host time pass, running the emulated ISR while interrupts are enabled.  Returns early
+ * once *pAbort becomes non-zero (pAbort may be NULL).
+ */
+void BSP_HostWait(uint32_t usec, volatile uint8_t * pAbort);
+
+/**************************************************************************************************
+ */
+#endif
@@ -0,0 +1,41 @@
+/**************************************************************************************************
+  Host (POSIX) button definition file.
+**************************************************************************************************/
+
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+ *   BSP (Board Support Package)
+ *   Target : Host (POSIX)
+ *   Button definition file.
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+ */
+
+#ifndef BSP_BUTTON_DEFS_H
+#define BSP_BUTTON_DEFS_H
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                           Includes
+ * ------------------------------------------------------------------------------------------------
+ */
+#include "bsp_board_defs.h"
+#include "bsp_macros.h"
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                      Button Configuration
+ * ------------------------------------------------------------------------------------------------
+ */
+#define __bsp_NUM_BUTTONS__                   0
+#define __bsp_BUTTON_DEBOUNCE_WAIT__(expr)    st( ; )
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                Include Generic Button Macros
+ * ------------------------------------------------------------------------------------------------
+ */
+#include "code/bsp_generic_buttons.h"
+
+
+/**************************************************************************************************
+ */
+#endif
@@ -0,0 +1,20 @@
+/**************************************************************************************************
+  Host (POSIX) board configuration file.
+**************************************************************************************************/
+
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+ *   BSP (Board Support Package)
+ *   Target : Host (POSIX)
+ *   Board configuration file.
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+ */
+
+#ifndef BSP_CONFIG_H
+#define BSP_CONFIG_H
+
+/* Only used for timing calculations in code that is not built for the host radio. */
+#define BSP_CONFIG_CLOCK_MHZ   12
+
+/**************************************************************************************************
+ */
+#endif
@@ -0,0 +1,28 @@
+/**************************************************************************************************
+  Host (POSIX) driver definition file.
+**************************************************************************************************/
+
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+ *   BSP (Board Support Package)
+ *   Target : Host (POSIX)
+ *   Driver definition file.
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+ */
+
+#ifndef BSP_DRIVER_DEFS_H
+#define BSP_DRIVER_DEFS_H
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                     Driver Initialization
+ * ------------------------------------------------------------------------------------------------
+ */
+#define BSP_DRIVERS_C               "bsp_drivers.c"
+#define BSP_INIT_DRIVERS()          BSP_InitDrivers()
+
+void BSP_InitDrivers(void);
+
+
+/**************************************************************************************************
+ */
+#endif
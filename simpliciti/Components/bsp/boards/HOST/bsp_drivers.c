@@ -0,0 +1,35 @@
+/**************************************************************************************************
+  Host (POSIX) top-level driver file.
+**************************************************************************************************/
+
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+ *   BSP (Board Support Package)
+ *   Target : Host (POSIX)
+ *   Top-level driver file.
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+ */
+
+/* ------------------------------------------------------------------------------------------------
+ *                                            Includes
+ * ------------------------------------------------------------------------------------------------
+ */
+#include "bsp_driver_defs.h"
+
+
+/**************************************************************************************************
+ * @fn          BSP_InitDrivers
+ *
+ * @brief       Initialize all enabled BSP drivers.  The host board has no LEDs or buttons.
+ *
+ * @param       none
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+void BSP_InitDrivers(void)
+{
+}
+
+
+/**************************************************************************************************
+*/
@@ -0,0 +1,40 @@
+/**************************************************************************************************
+  Host (POSIX) LED definition file.
+**************************************************************************************************/
+
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+ *   BSP (Board Support Package)
+ *   Target : Host (POSIX)
+ *   LED definition file.
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+ */
+
+#ifndef BSP_LED_DEFS_H
+#define BSP_LED_DEFS_H
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                           Includes
+ * ------------------------------------------------------------------------------------------------
+ */
+#include "bsp_board_defs.h"
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                      Configuration
+ * ------------------------------------------------------------------------------------------------
+ */
+#define __bsp_NUM_LEDS__               0
+#define __bsp_LED_BLINK_LOOP_COUNT__   0
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                 Include Generic LED Macros
+ * ------------------------------------------------------------------------------------------------
+ */
+#include "code/bsp_generic_leds.h"
+
+
+/**************************************************************************************************
+ */
+#endif
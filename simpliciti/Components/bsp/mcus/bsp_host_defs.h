@@ -0,0 +1,79 @@
+/**************************************************************************************************
+  Host (POSIX) definition file for building the SimpliciTI stack as a native process.
+
+  The "MCU" is the host CPU.  Interrupts are emulated: the interrupt enable flag below gates
+  delivery of the radio receive callback, which the board file only runs from inside its
+  delay/sleep primitives, so critical sections behave as they do on target.
+**************************************************************************************************/
+
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+ *   BSP (Board Support Package)
+ *   MCU : Host (POSIX)
+ *   Microcontroller definition file.
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+ */
+
+#ifndef BSP_HOST_DEFS_H
+#define BSP_HOST_DEFS_H
+
+/* ------------------------------------------------------------------------------------------------
+ *                                          Defines
+ * ------------------------------------------------------------------------------------------------
+ */
+#define BSP_MCU_HOST
+
+/* ------------------------------------------------------------------------------------------------
+ *                                     Compiler Abstraction
+ * ------------------------------------------------------------------------------------------------
+ */
+#include <stdint.h>
+#include <stdlib.h>
+
+/* bsp.h defines ntohs() and friends as macros, so the socket headers used by the host radio
+ * have to be seen first and their own macro versions dropped.
+ */
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netdb.h>
+#undef ntohs
+#undef htons
+#undef ntohl
+#undef htonl
+
+#define BSP_COMPILER_HOST
+
+extern volatile uint8_t bspHostIntEnabled;
+
+#define __bsp_ISTATE_T__                  uint8_t
+#define __bsp_ISR_FUNCTION__(f,v)         void f(void)
+
+#define __bsp_ENABLE_INTERRUPTS__()       (bspHostIntEnabled = 1)
+#define __bsp_DISABLE_INTERRUPTS__()      (bspHostIntEnabled = 0)
+#define __bsp_INTERRUPTS_ARE_ENABLED__()  (bspHostIntEnabled)
+
+#define __bsp_GET_ISTATE__()              (bspHostIntEnabled)
+#define __bsp_RESTORE_ISTATE__(x)         (bspHostIntEnabled = (x))
+
+/* a failed assert must not spin forever in a test run */
+#define BSP_ASSERT_HANDLER()              abort()
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                          Common
+ * ------------------------------------------------------------------------------------------------
+ */
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define __bsp_LITTLE_ENDIAN__   0
+#else
+#define __bsp_LITTLE_ENDIAN__   1
+#endif
+#define __bsp_CODE_MEMSPACE__   /* blank */
+#define __bsp_XDATA_MEMSPACE__  /* blank */
+
+#ifndef NULL
+#define NULL 0
+#endif
+
+/**************************************************************************************************
+ */
+#endif
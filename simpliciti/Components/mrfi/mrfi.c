@@ -78,6 +78,10 @@
 #elif (defined MRFI_RADIO_FAMILY6)
 #include "radios/family6/mrfi_radio.c"
 
+/* ----- Host radio ----- */
+#elif (defined MRFI_RADIO_FAMILY_HOST)
+#include "radios/host/mrfi_radio.c"
+
 #else
 #error "ERROR: Radio family is not defined."
 #endif
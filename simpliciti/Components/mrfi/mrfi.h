@@ -163,6 +163,7 @@ void    MRFI_RxOn(void);
 void    MRFI_RxIdle(void);
 int8_t  MRFI_Rssi(void);
 void    MRFI_SetLogicalChannel(uint8_t);
+void    MRFI_SetCalTemp(int16_t);
 uint8_t MRFI_SetRxAddrFilter(uint8_t *);
 void    MRFI_EnableRxAddrFilter(void);
 void    MRFI_DisableRxAddrFilter(void);
@@ -173,6 +174,8 @@ void    MRFI_DelayMs(uint16_t);
 void    MRFI_ReplyDelay(void);
 void    MRFI_PostKillSem(void);
 void    MRFI_SetRFPwr(uint8_t);
+uint8_t MRFI_GetRFPwr(void);
+int8_t  MRFI_GetRFPwrDbm(uint8_t);
 
 /* ------------------------------------------------------------------------------------------------
  *                                       Global Constants
@@ -96,6 +96,10 @@
 
 #define MRFI_RADIO_FAMILY6
 
+/* ------ Host radio ------ */
+#elif (defined MRFI_HOST)   /* Datagram socket loopback for native test builds */
+#define MRFI_RADIO_FAMILY_HOST
+
 #else
 #error "ERROR: Unknown or missing radio selection."
 #endif
@@ -105,7 +109,9 @@
  *                                Radio Family 1 / Radio Family 2 / Radio Family 5
  * ------------------------------------------------------------------------------------------------
  */
-#if (defined MRFI_RADIO_FAMILY1) || (defined MRFI_RADIO_FAMILY2) || (defined MRFI_RADIO_FAMILY5)
+/* The host radio carries the family 5 frame so captures match what the watch sends. */
+#if (defined MRFI_RADIO_FAMILY1) || (defined MRFI_RADIO_FAMILY2) || (defined MRFI_RADIO_FAMILY5) || \
+    (defined MRFI_RADIO_FAMILY_HOST)
 
 #define __mrfi_LENGTH_FIELD_SIZE__      1
 #define __mrfi_ADDR_SIZE__              4
@@ -118,7 +124,12 @@
 #define __mrfi_RX_METRICS_LQI_MASK__    0x7F
 
 #define __mrfi_NUM_LOGICAL_CHANS__      4
+/* [BM] Family 5 (CC430) has extra low power steps for adaptive output power */
+#if (defined MRFI_RADIO_FAMILY5) || (defined MRFI_RADIO_FAMILY_HOST)
+#define __mrfi_NUM_POWER_SETTINGS__     5
+#else
 #define __mrfi_NUM_POWER_SETTINGS__     3
+#endif
 
 #define __mrfi_BACKOFF_PERIOD_USECS__   250
 
@@ -203,7 +214,8 @@
                                               (defined MRFI_CC2431) + \
                                               (defined MRFI_CC2520) + \
                                               (defined MRFI_CC430)  + \
-                                              (defined MRFI_CC2530))
+                                              (defined MRFI_CC2530) + \
+                                              (defined MRFI_HOST))
 #if (MRFI_NUM_SUPPORTED_RADIOS_SELECTED == 0)
 #error "ERROR: A valid radio is not selected."
 #elif (MRFI_NUM_SUPPORTED_RADIOS_SELECTED > 1)
@@ -216,7 +228,8 @@
     (!defined MRFI_RADIO_FAMILY3) && \
     (!defined MRFI_RADIO_FAMILY4) && \
     (!defined MRFI_RADIO_FAMILY5) && \
-    (!defined MRFI_RADIO_FAMILY6)
+    (!defined MRFI_RADIO_FAMILY6) && \
+    (!defined MRFI_RADIO_FAMILY_HOST)
 #error "ERROR: A radio family has not been assigned."
 #endif
 
@@ -95,10 +95,16 @@ BSP_STATIC_ASSERT(MRFI_ADDR_SIZE == ((sizeof(mrfiBroadcastAddr)/sizeof(mrfiBroad
 #define MRFI_SETTING_IOCFG1     30
 
 /* Main Radio Control State Machine control configuration:
- * Auto Calibrate - when going from IDLE to RX/TX
+ * [BM] No auto calibration - frequency synthesizer calibration is done manually
+ *      once per channel and temperature band and restored from mrfiFsCalCache.
  * XOSC is OFF in Sleep state.
  */
-#define MRFI_SETTING_MCSM0      (0x10)
+#define MRFI_SETTING_MCSM0      (0x00)
+
+/* Width of a calibration temperature band in 1/10 degree Celsius. The synthesizer
+ * is recalibrated when the temperature leaves the band the cached values were taken in.
+ */
+#define MRFI_FSCAL_TEMP_BAND    80
 
 /* Main Radio Control State Machine control configuration:
  * - Remain RX state after RX
@@ -126,6 +132,14 @@ BSP_STATIC_ASSERT(MRFI_ADDR_SIZE == ((sizeof(mrfiBroadcastAddr)/sizeof(mrfiBroad
  */
 #define MRFI_MAX_DELAY_US 16 /* usec */
 
+/* Shortest delay that is done in LPM3 on the BSP sleep timer instead of busy-waiting.
+ * Below this the ACLK granularity (~30.5us) and the LPM3 wakeup cost outweigh the gain.
+ */
+#define MRFI_MIN_SLEEP_US 100 /* usec */
+
+/* Longest single BSP sleep. Keeps the ACLK tick count well inside 16 bits. */
+#define MRFI_MAX_SLEEP_MS 50  /* msec */
+
 /* Packet automation control - base value is power up value whick has APPEND_STATUS enabled; no CRC autoflush */
 #define PKTCTRL1_BASE_VALUE         BV(2)
 #define PKTCTRL1_ADDR_FILTER_OFF    PKTCTRL1_BASE_VALUE
@@ -302,8 +316,19 @@ BSP_STATIC_ASSERT(__mrfi_NUM_LOGICAL_CHANS__ == ((sizeof(mrfiLogicalChanTable)/s
  */
 static const uint8_t mrfiRFPowerTable[] =
 {
+// [BM] Extra -30dBm and -15dBm steps used by the adaptive power control of the end device
+#ifdef ISM_LF
+  0x12,
+#else
+  0x03,
+#endif
 // [BM] Changed default output power to comply with dongle settings
   0x0F,
+#ifdef ISM_LF
+  0x1D,
+#else
+  0x1E,
+#endif
   0x27,
 // [BM] Increase output power from -0.3dBm to +1.4dBm (433MHz) / +1.1dBm (868MHz) / +1.3dBm (915MHz) to compensate antenna loss  
 #ifdef ISM_EU 
@@ -330,6 +355,21 @@ static const uint8_t mrfiRFPowerTable[] =
 /* verify number of table entries matches the corresponding #define */
 BSP_STATIC_ASSERT(__mrfi_NUM_POWER_SETTINGS__ == ((sizeof(mrfiRFPowerTable)/sizeof(mrfiRFPowerTable[0])) * sizeof(mrfiRFPowerTable[0])));
 
+/*
+ *  Approximate output power in dBm of each mrfiRFPowerTable entry. Used by link
+ *  quality management to estimate how strong our frames arrive at the peer.
+ */
+static const int8_t mrfiRFPowerDbm[] =
+{
+  -30,
+  -20,
+  -15,
+  -10,
+  1
+};
+
+BSP_STATIC_ASSERT(__mrfi_NUM_POWER_SETTINGS__ == (sizeof(mrfiRFPowerDbm)/sizeof(mrfiRFPowerDbm[0])));
+
 /* ------------------------------------------------------------------------------------------------
  *                                       Local Prototypes
  * ------------------------------------------------------------------------------------------------
@@ -341,6 +381,7 @@ static void Mrfi_RxModeOff(void);
 static void Mrfi_DelayUsec(uint16_t howLong);
 static void Mrfi_DelayUsecSem(uint16_t howLong);
 static int8_t Mrfi_CalculateRssi(uint8_t rawValue);
+static void Mrfi_FsCalUpdate(void);
 static uint8_t Mrfi_RxAddrIsFiltered(uint8_t * pAddr);
 
 
@@ -349,6 +390,20 @@ static uint8_t Mrfi_RxAddrIsFiltered(uint8_t * pAddr);
  * ------------------------------------------------------------------------------------------------
  */
 static uint8_t mrfiRadioState  = MRFI_RADIO_STATE_UNKNOWN;
+static uint8_t mrfiRFPowerLevel = MRFI_NUM_POWER_SETTINGS - 1;
+
+/* frequency synthesizer calibration cache, one entry per logical channel */
+static struct
+{
+  uint8_t valid;
+  int8_t  band;
+  uint8_t fscal3;
+  uint8_t fscal2;
+  uint8_t fscal1;
+} mrfiFsCalCache[MRFI_NUM_LOGICAL_CHANS];
+static uint8_t mrfiLogicalChan = 0;
+static int8_t  mrfiFsCalBand   = 0;
+static uint8_t mrfiFsCalDirty  = 1;
 static mrfiPacket_t mrfiIncomingPacket;
 static uint8_t mrfiRndSeed = 0;
 
@@ -480,6 +535,9 @@ void MRFI_Init(void)
   // [BM] Apply global frequency offset to FSCTRL0
   MRFI_STROBE_IDLE_AND_WAIT();
   MRFI_RADIO_REG_WRITE(FSCTRL0, rf_frequoffset);
+
+  /* radio reset wiped the calibration registers; MRFI_SetLogicalChannel() restores them */
+  mrfiFsCalDirty = 1;
   
   /* set default channel */
   MRFI_SetLogicalChannel( 0 );
@@ -632,6 +690,7 @@ uint8_t MRFI_Transmit(mrfiPacket_t * pPacket, uint8_t txType)
   {
     /* Issue the TX strobe. */
     MRFI_STROBE( STX );
+    BSP_PROFILE_RADIO_TX();
 
     /* Wait for transmit to complete */
     while(!MRFI_SYNC_PIN_INT_FLAG_IS_SET());
@@ -666,6 +725,7 @@ uint8_t MRFI_Transmit(mrfiPacket_t * pPacket, uint8_t txType)
        * Rx interrupt, which we don't want in this case.
        */
       MRFI_STROBE( SRX );
+      BSP_PROFILE_RADIO_RX();
 
       /* wait for the rssi to be valid. */
       MRFI_RSSI_VALID_WAIT();
@@ -681,6 +741,7 @@ uint8_t MRFI_Transmit(mrfiPacket_t * pPacket, uint8_t txType)
 
       /* send strobe to initiate transmit */
       MRFI_STROBE( STX );
+      BSP_PROFILE_RADIO_TX();
 
       /* Delay long enough for the PA_PD signal to indicate a
        * successful transmit. This is the 250 XOSC periods
@@ -727,6 +788,7 @@ uint8_t MRFI_Transmit(mrfiPacket_t * pPacket, uint8_t txType)
          * sync signal status which we are not using during the TX operation.
          */
         MRFI_STROBE_IDLE_AND_WAIT();
+        BSP_PROFILE_RADIO_IDLE();
 
         /* flush the receive FIFO of any residual data */
         MRFI_STROBE( SFRX );
@@ -760,6 +822,7 @@ uint8_t MRFI_Transmit(mrfiPacket_t * pPacket, uint8_t txType)
    * the next transmit can start with a clean slate.
    */
   MRFI_STROBE( SFTX );
+  BSP_PROFILE_RADIO_IDLE();
 
   /* If the radio was in RX state when transmit was attempted,
    * put it back to Rx On state.
@@ -1015,6 +1078,7 @@ static void Mrfi_RxModeOn(void)
 
   /* send strobe to enter receive mode */
   MRFI_STROBE( SRX );
+  BSP_PROFILE_RADIO_RX();
 
   /* enable receive interrupts */
   MRFI_ENABLE_SYNC_PIN_INT();
@@ -1061,6 +1125,7 @@ static void Mrfi_RxModeOff(void)
 
   /* turn off radio */
   MRFI_STROBE_IDLE_AND_WAIT();
+  BSP_PROFILE_RADIO_IDLE();
 
   /* flush the receive FIFO of any residual data */
   MRFI_STROBE( SFRX );
@@ -1157,6 +1222,9 @@ void MRFI_WakeUp(void)
 
   /* enter idle mode */
   mrfiRadioState = MRFI_RADIO_STATE_IDLE;
+
+  /* calibration registers survive sleep, only channel or temperature changes need work */
+  Mrfi_FsCalUpdate();
 }
 
 
@@ -1369,12 +1437,13 @@ static void Mrfi_RandomBackoffDelay(void)
 /****************************************************************************************************
  * @fn          Mrfi_DelayUsec
  *
- * @brief       Execute a delay loop using HW timer. The macro actually used to do the delay
- *              is not thread-safe. This routine makes the delay execution thread-safe by breaking
- *              up the requested delay up into small chunks and executing each chunk as a critical
- *              section. The chunk size is choosen to be the smallest value used by MRFI. The delay
- *              is only approximate because of the overhead computations. It errs on the side of
- *              being too long.
+ * @brief       Execute a delay loop using HW timer. Delays of at least MRFI_MIN_SLEEP_US are
+ *              done in LPM3 on the BSP sleep timer when interrupts are enabled. Otherwise the
+ *              macro actually used to do the delay is not thread-safe. This routine makes the
+ *              delay execution thread-safe by breaking up the requested delay up into small
+ *              chunks and executing each chunk as a critical section. The chunk size is choosen
+ *              to be the smallest value used by MRFI. The delay is only approximate because of
+ *              the overhead computations. It errs on the side of being too long.
  *
  * input parameters
  * @param   howLong - number of microseconds to delay
@@ -1387,6 +1456,12 @@ static void Mrfi_DelayUsec(uint16_t howLong)
   bspIState_t s;
   uint16_t count = howLong/MRFI_MAX_DELAY_US;
 
+  if ((howLong >= MRFI_MIN_SLEEP_US) && BSP_INTERRUPTS_ARE_ENABLED())
+  {
+    BSP_SLEEP_USECS(howLong, NULL);
+    return;
+  }
+
   if (howLong)
   {
     do
@@ -1420,6 +1495,13 @@ static void Mrfi_DelayUsecSem(uint16_t howLong)
   bspIState_t s;
   uint16_t count = howLong/MRFI_MAX_DELAY_US;
 
+  /* The radio ISR wakes the sleep loop, so a posted kill semaphore ends the delay early */
+  if ((howLong >= MRFI_MIN_SLEEP_US) && BSP_INTERRUPTS_ARE_ENABLED())
+  {
+    BSP_SLEEP_USECS(howLong, &sKillSem);
+    return;
+  }
+
   if (howLong)
   {
     do
@@ -1449,10 +1531,24 @@ static void Mrfi_DelayUsecSem(uint16_t howLong)
  */
 void MRFI_DelayMs(uint16_t milliseconds)
 {
+  uint16_t chunk;
+
+  if (!BSP_INTERRUPTS_ARE_ENABLED())
+  {
+    while (milliseconds)
+    {
+      Mrfi_DelayUsec( APP_USEC_VALUE );
+      milliseconds--;
+    }
+    return;
+  }
+
+  /* Sleep in as few LPM3 periods as possible instead of one wakeup per millisecond */
   while (milliseconds)
   {
-    Mrfi_DelayUsec( APP_USEC_VALUE );
-    milliseconds--;
+    chunk = (milliseconds > MRFI_MAX_SLEEP_MS) ? MRFI_MAX_SLEEP_MS : milliseconds;
+    BSP_SLEEP_USECS(chunk * APP_USEC_VALUE, NULL);
+    milliseconds -= chunk;
   }
 }
 
@@ -1478,6 +1574,18 @@ void MRFI_ReplyDelay(void)
   sReplyDelayContext = 1;
   BSP_EXIT_CRITICAL_SECTION(s);
 
+  if (BSP_INTERRUPTS_ARE_ENABLED())
+  {
+    /* One LPM3 period for the whole reply delay, ended early by MRFI_PostKillSem() */
+    while (milliseconds && !sKillSem)
+    {
+      uint16_t chunk = (milliseconds > MRFI_MAX_SLEEP_MS) ? MRFI_MAX_SLEEP_MS : milliseconds;
+
+      BSP_SLEEP_USECS(chunk * APP_USEC_VALUE, &sKillSem);
+      milliseconds -= chunk;
+    }
+  }
+
   while (milliseconds)
   {
     Mrfi_DelayUsecSem( APP_USEC_VALUE );
@@ -1552,6 +1660,17 @@ void MRFI_SetLogicalChannel(uint8_t chan)
 
   MRFI_RADIO_REG_WRITE( CHANNR, mrfiLogicalChanTable[chan] );
 
+  /* new channel needs its own synthesizer calibration, deferred to wakeup if radio is off */
+  if (chan != mrfiLogicalChan)
+  {
+    mrfiLogicalChan = chan;
+    mrfiFsCalDirty  = 1;
+  }
+  if (mrfiRadioState != MRFI_RADIO_STATE_OFF)
+  {
+    Mrfi_FsCalUpdate();
+  }
+
   /* turn radio back on if it was on before channel change */
   if(mrfiRadioState == MRFI_RADIO_STATE_RX)
   {
@@ -1559,6 +1678,79 @@ void MRFI_SetLogicalChannel(uint8_t chan)
   }
 }
 
+/**************************************************************************************************
+ * @fn          MRFI_SetCalTemp
+ *
+ * @brief       Tell MRFI the current temperature. Cached synthesizer calibrations are only
+ *              used within the temperature band they were taken in. Takes effect on the next
+ *              wakeup or channel change.
+ *
+ * @param       degrees - temperature in 1/10 degree Celsius
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+void MRFI_SetCalTemp(int16_t degrees)
+{
+  int8_t band;
+
+  /* round towards minus infinity so that bands do not double in size around 0 */
+  if (degrees < 0)
+  {
+    degrees -= MRFI_FSCAL_TEMP_BAND - 1;
+  }
+  band = (int8_t)(degrees / MRFI_FSCAL_TEMP_BAND);
+
+  if (band != mrfiFsCalBand)
+  {
+    mrfiFsCalBand  = band;
+    mrfiFsCalDirty = 1;
+  }
+}
+
+/**************************************************************************************************
+ * @fn          Mrfi_FsCalUpdate
+ *
+ * @brief       Make sure the synthesizer calibration registers match the current channel and
+ *              temperature band. Restores FSCAL3/2/1 from the cache, or runs a manual
+ *              calibration (SCAL) on a cache miss and stores the result. Radio must be IDLE.
+ *
+ * @param       none
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+static void Mrfi_FsCalUpdate(void)
+{
+  uint8_t i = mrfiLogicalChan;
+
+  if (!mrfiFsCalDirty)
+  {
+    return;
+  }
+
+  if (mrfiFsCalCache[i].valid && (mrfiFsCalCache[i].band == mrfiFsCalBand))
+  {
+    MRFI_RADIO_REG_WRITE( FSCAL3, mrfiFsCalCache[i].fscal3 );
+    MRFI_RADIO_REG_WRITE( FSCAL2, mrfiFsCalCache[i].fscal2 );
+    MRFI_RADIO_REG_WRITE( FSCAL1, mrfiFsCalCache[i].fscal1 );
+  }
+  else
+  {
+    /* calibrate and wait until radio is back in IDLE */
+    MRFI_STROBE( SCAL );
+    while (MRFI_STROBE( SNOP ) & 0xF0) ;
+
+    mrfiFsCalCache[i].fscal3 = MRFI_RADIO_REG_READ( FSCAL3 );
+    mrfiFsCalCache[i].fscal2 = MRFI_RADIO_REG_READ( FSCAL2 );
+    mrfiFsCalCache[i].fscal1 = MRFI_RADIO_REG_READ( FSCAL1 );
+    mrfiFsCalCache[i].band   = mrfiFsCalBand;
+    mrfiFsCalCache[i].valid  = 1;
+  }
+
+  mrfiFsCalDirty = 0;
+}
+
 /**************************************************************************************************
  * @fn          MRFI_SetRFPwr
  *
@@ -1575,9 +1767,42 @@ void MRFI_SetRFPwr(uint8_t level)
   MRFI_ASSERT( level < MRFI_NUM_POWER_SETTINGS );
 
   MRFI_RADIO_REG_WRITE(PATABLE, mrfiRFPowerTable[level]);
+  mrfiRFPowerLevel = level;
 
   return;
 }
+
+/**************************************************************************************************
+ * @fn          MRFI_GetRFPwr
+ *
+ * @brief       Get current output RF power level.
+ *
+ * @param       none
+ *
+ * @return      power level last set with MRFI_SetRFPwr()
+ **************************************************************************************************
+ */
+uint8_t MRFI_GetRFPwr(void)
+{
+  return mrfiRFPowerLevel;
+}
+
+/**************************************************************************************************
+ * @fn          MRFI_GetRFPwrDbm
+ *
+ * @brief       Get approximate output power of a power level.
+ *
+ * @param       level - power level
+ *
+ * @return      output power in dBm
+ **************************************************************************************************
+ */
+int8_t MRFI_GetRFPwrDbm(uint8_t level)
+{
+  MRFI_ASSERT( level < MRFI_NUM_POWER_SETTINGS );
+
+  return mrfiRFPowerDbm[level];
+}
 /**************************************************************************************************
  * @fn          MRFI_SetRxAddrFilter
  *
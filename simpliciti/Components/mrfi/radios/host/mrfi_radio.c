@@ -0,0 +1,675 @@
+/**************************************************************************************************
+  Host radio: MRFI over a datagram socket.
+
+  Lets the SimpliciTI stack run as a native process against an access point emulator
+  (contrib/ap_emulator.py) instead of RF hardware.  Every MRFI frame travels as one datagram
+  to the medium address given by the MRFI_HOST_MEDIUM environment variable:
+
+      "host:port"   UDP (default 127.0.0.1:47100)
+      "/path"       UNIX datagram socket
+
+  Each datagram is a 4 byte header followed by the MRFI frame, starting with its length byte:
+
+      [0] MRFI_HOST_MAGIC
+      [1] logical channel
+      [2] transmit: output power in dBm     receive: RSSI in dBm at this radio
+      [3] transmit: power setting index     receive: LQI (0..127)
+
+  The emulator decides what the radio "hears" (loss, RSSI), so this file only enforces what the
+  silicon would: frames are received in RX state on the current channel and pass the address
+  filter, anything else is dropped.
+**************************************************************************************************/
+
+/* =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+ *   MRFI (Minimal RF Interface)
+ *   Radios: Host (datagram socket)
+ *   Primary code file for supported radios.
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+ */
+
+/* ------------------------------------------------------------------------------------------------
+ *                                          Includes
+ * ------------------------------------------------------------------------------------------------
+ */
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "mrfi.h"
+#include "bsp.h"
+#include "mrfi_defs.h"
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                    Global Constants
+ * ------------------------------------------------------------------------------------------------
+ */
+const uint8_t mrfiBroadcastAddr[] = { 0xFF, 0xFF, 0xFF, 0xFF };
+
+/* verify number of table entries matches the corresponding #define */
+BSP_STATIC_ASSERT(__mrfi_ADDR_SIZE__ == ((sizeof(mrfiBroadcastAddr)/sizeof(mrfiBroadcastAddr[0])) * sizeof(mrfiBroadcastAddr[0])));
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                    Local Constants
+ * ------------------------------------------------------------------------------------------------
+ */
+#define MRFI_HOST_MAGIC             0x5A
+#define MRFI_HOST_HDR_SIZE          4
+#define MRFI_HOST_DEFAULT_MEDIUM    "127.0.0.1:47100"
+
+/* Round trip of the emulator is far below the RF reply delay; keep the same order of magnitude
+ * so the NWK retry logic sees realistic timing.
+ */
+#ifndef MRFI_HOST_REPLY_DELAY_MS
+#define MRFI_HOST_REPLY_DELAY_MS    10
+#endif
+
+#define MRFI_LENGTH_FIELD_OFS       __mrfi_LENGTH_FIELD_OFS__
+#define MRFI_LENGTH_FIELD_SIZE      __mrfi_LENGTH_FIELD_SIZE__
+#define MRFI_HEADER_SIZE            __mrfi_HEADER_SIZE__
+#define MRFI_RX_METRICS_CRC_OK_MASK __mrfi_RX_METRICS_CRC_OK_MASK__
+#define MRFI_RX_METRICS_LQI_MASK    __mrfi_RX_METRICS_LQI_MASK__
+
+/* same output steps as the CC430 so link quality management behaves identically */
+static const int8_t mrfiRFPowerDbm[] = { -30, -20, -15, -10, 1 };
+
+BSP_STATIC_ASSERT(__mrfi_NUM_POWER_SETTINGS__ == (sizeof(mrfiRFPowerDbm)/sizeof(mrfiRFPowerDbm[0])));
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                       Local Prototypes
+ * ------------------------------------------------------------------------------------------------
+ */
+static void    Mrfi_HostOpen(void);
+static void    Mrfi_HostRxIsr(void);
+static uint8_t Mrfi_RxAddrIsFiltered(uint8_t * pAddr);
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                       Local Variables
+ * ------------------------------------------------------------------------------------------------
+ */
+static uint8_t mrfiRadioState   = MRFI_RADIO_STATE_UNKNOWN;
+static uint8_t mrfiRFPowerLevel = MRFI_NUM_POWER_SETTINGS - 1;
+static uint8_t mrfiLogicalChan  = 0;
+static int8_t  mrfiLastRssi     = -128;
+static mrfiPacket_t mrfiIncomingPacket;
+
+static volatile uint8_t sKillSem = 0;
+static volatile uint8_t sReplyDelayContext = 0;
+
+static uint8_t mrfiRxFilterEnabled = 0;
+static uint8_t mrfiRxFilterAddr[MRFI_ADDR_SIZE] = { 0xFF };
+
+static int mrfiHostFd = -1;
+static struct sockaddr_storage mrfiHostMedium;
+static socklen_t mrfiHostMediumLen = 0;
+
+/* [BM] provided by the application, meaningless without a synthesizer */
+extern unsigned char rf_frequoffset;
+
+
+/**************************************************************************************************
+ * @fn          Mrfi_HostOpen
+ *
+ * @brief       Open the datagram socket towards the medium.  Kept open across MRFI_Init()
+ *              calls so the emulator sees one stable source address per simulated radio.
+ *
+ * @param       none
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+static void Mrfi_HostOpen(void)
+{
+  const char * medium = getenv("MRFI_HOST_MEDIUM");
+
+  if (mrfiHostFd >= 0)
+  {
+    return;
+  }
+  if (!medium || !*medium)
+  {
+    medium = MRFI_HOST_DEFAULT_MEDIUM;
+  }
+
+  memset(&mrfiHostMedium, 0, sizeof(mrfiHostMedium));
+  if (medium[0] == '/')
+  {
+    struct sockaddr_un * un = (struct sockaddr_un *)&mrfiHostMedium;
+    sa_family_t          family = AF_UNIX;
+
+    un->sun_family = AF_UNIX;
+    strncpy(un->sun_path, medium, sizeof(un->sun_path) - 1);
+    mrfiHostMediumLen = sizeof(*un);
+
+    mrfiHostFd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    /* autobind to an abstract address so the emulator can reply */
+    if (mrfiHostFd >= 0)
+    {
+      bind(mrfiHostFd, (struct sockaddr *)&family, sizeof(family));
+    }
+  }
+  else
+  {
+    struct addrinfo   hints;
+    struct addrinfo * res;
+    char              host[64];
+    const char      * colon = strrchr(medium, ':');
+    size_t            n = colon ? (size_t)(colon - medium) : strlen(medium);
+
+    if (n >= sizeof(host))
+    {
+      n = sizeof(host) - 1;
+    }
+    memcpy(host, medium, n);
+    host[n] = 0;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    if (getaddrinfo(host, colon ? colon + 1 : "47100", &hints, &res))
+    {
+      fprintf(stderr, "mrfi: bad MRFI_HOST_MEDIUM '%s'\n", medium);
+      abort();
+    }
+    memcpy(&mrfiHostMedium, res->ai_addr, res->ai_addrlen);
+    mrfiHostMediumLen = res->ai_addrlen;
+
+    mrfiHostFd = socket(res->ai_family, SOCK_DGRAM, 0);
+    freeaddrinfo(res);
+  }
+
+  if (mrfiHostFd < 0)
+  {
+    perror("mrfi: socket");
+    abort();
+  }
+
+  BSP_HostSetIsr(mrfiHostFd, Mrfi_HostRxIsr);
+}
+
+
+/**************************************************************************************************
+ * @fn          MRFI_Init
+ *
+ * @brief       Initialize MRFI.
+ *
+ * @param       none
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+void MRFI_Init(void)
+{
+  (void)rf_frequoffset;
+
+  Mrfi_HostOpen();
+
+  memset(&mrfiIncomingPacket, 0, sizeof(mrfiIncomingPacket));
+  mrfiRadioState = MRFI_RADIO_STATE_IDLE;
+  MRFI_SetLogicalChannel(0);
+
+  srand((unsigned)getpid());
+}
+
+
+/**************************************************************************************************
+ * @fn          MRFI_Transmit
+ *
+ * @brief       Transmit a packet.  There is no shared channel to sense, so CCA always succeeds.
+ *
+ * @param       pPacket - pointer to packet to transmit
+ *              txType  - FORCED or CCA
+ *
+ * @return      Return code indicates success or failure of transmit:
+ *                  MRFI_TX_RESULT_SUCCESS - transmit succeeded
+ *                  MRFI_TX_RESULT_FAILED  - transmit failed because the medium is unreachable
+ **************************************************************************************************
+ */
+uint8_t MRFI_Transmit(mrfiPacket_t * pPacket, uint8_t txType)
+{
+  uint8_t buf[MRFI_HOST_HDR_SIZE + MRFI_MAX_FRAME_SIZE];
+  uint8_t len = pPacket->frame[MRFI_LENGTH_FIELD_OFS] + MRFI_LENGTH_FIELD_SIZE;
+
+  (void)txType;
+  MRFI_ASSERT( mrfiRadioState != MRFI_RADIO_STATE_OFF );
+  MRFI_ASSERT( len <= MRFI_MAX_FRAME_SIZE );
+
+  buf[0] = MRFI_HOST_MAGIC;
+  buf[1] = mrfiLogicalChan;
+  buf[2] = (uint8_t)mrfiRFPowerDbm[mrfiRFPowerLevel];
+  buf[3] = mrfiRFPowerLevel;
+  memcpy(&buf[MRFI_HOST_HDR_SIZE], pPacket->frame, len);
+
+  if (sendto(mrfiHostFd, buf, MRFI_HOST_HDR_SIZE + len, 0,
+             (struct sockaddr *)&mrfiHostMedium, mrfiHostMediumLen) < 0)
+  {
+    return( MRFI_TX_RESULT_FAILED );
+  }
+
+  return( MRFI_TX_RESULT_SUCCESS );
+}
+
+
+/**************************************************************************************************
+ * @fn          MRFI_Receive
+ *
+ * @brief       Copies last packet received to the location specified.
+ *              This function is meant to be called by the upper layer receive ISR.
+ *
+ * @param       pPacket - pointer to location of where to copy received packet
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+void MRFI_Receive(mrfiPacket_t * pPacket)
+{
+  *pPacket = mrfiIncomingPacket;
+}
+
+
+/**************************************************************************************************
+ * @fn          Mrfi_HostRxIsr
+ *
+ * @brief       Emulated receive interrupt.  Reads one datagram and hands it to the upper layer
+ *              if the radio would have received it.
+ *
+ * @param       none
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+static void Mrfi_HostRxIsr(void)
+{
+  uint8_t buf[MRFI_HOST_HDR_SIZE + MRFI_MAX_FRAME_SIZE + 1];
+  ssize_t n = recv(mrfiHostFd, buf, sizeof(buf), 0);
+  uint8_t frameLen;
+
+  if ((n < MRFI_HOST_HDR_SIZE + MRFI_LENGTH_FIELD_SIZE) || (buf[0] != MRFI_HOST_MAGIC))
+  {
+    return;
+  }
+
+  /* What the radio would not have heard.  Datagrams are only consumed while time passes, so a
+   * reply that races the transition to RX is still received, like a peer's turnaround time.
+   */
+  if ((mrfiRadioState != MRFI_RADIO_STATE_RX) || (buf[1] != mrfiLogicalChan))
+  {
+    return;
+  }
+
+  frameLen = buf[MRFI_HOST_HDR_SIZE + MRFI_LENGTH_FIELD_OFS];
+  if ((frameLen < MRFI_HEADER_SIZE) ||
+      (frameLen + MRFI_LENGTH_FIELD_SIZE > MRFI_MAX_FRAME_SIZE) ||
+      (n != MRFI_HOST_HDR_SIZE + MRFI_LENGTH_FIELD_SIZE + frameLen))
+  {
+    return;
+  }
+
+  memcpy(mrfiIncomingPacket.frame, &buf[MRFI_HOST_HDR_SIZE], frameLen + MRFI_LENGTH_FIELD_SIZE);
+
+  if (Mrfi_RxAddrIsFiltered(MRFI_P_DST_ADDR(&mrfiIncomingPacket)))
+  {
+    return;
+  }
+
+  mrfiLastRssi = (int8_t)buf[2];
+  mrfiIncomingPacket.rxMetrics[MRFI_RX_METRICS_RSSI_OFS]    = buf[2];
+  mrfiIncomingPacket.rxMetrics[MRFI_RX_METRICS_CRC_LQI_OFS] = buf[3] & MRFI_RX_METRICS_LQI_MASK;
+
+  MRFI_RxCompleteISR();
+}
+
+
+/**************************************************************************************************
+ * @fn          MRFI_RxOn
+ *
+ * @brief       Turn on the receiver.  No harm is done if this function is called when
+ *              receiver is already on.
+ *
+ * @param       none
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+void MRFI_RxOn(void)
+{
+  MRFI_ASSERT( mrfiRadioState != MRFI_RADIO_STATE_OFF );
+
+  if (mrfiRadioState == MRFI_RADIO_STATE_IDLE)
+  {
+    mrfiRadioState = MRFI_RADIO_STATE_RX;
+  }
+}
+
+
+/**************************************************************************************************
+ * @fn          MRFI_RxIdle
+ *
+ * @brief       Put radio in idle mode (receiver if off).  No harm is done this function is
+ *              called when radio is already idle.
+ *
+ * @param       none
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+void MRFI_RxIdle(void)
+{
+  MRFI_ASSERT( mrfiRadioState != MRFI_RADIO_STATE_OFF );
+
+  mrfiRadioState = MRFI_RADIO_STATE_IDLE;
+}
+
+
+/**************************************************************************************************
+ * @fn          MRFI_Sleep
+ *
+ * @brief       Request radio go to sleep.
+ *
+ * @param       none
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+void MRFI_Sleep(void)
+{
+  mrfiRadioState = MRFI_RADIO_STATE_OFF;
+}
+
+
+/**************************************************************************************************
+ * @fn          MRFI_WakeUp
+ *
+ * @brief       Wake up radio from sleep state.
+ *
+ * @param       none
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+void MRFI_WakeUp(void)
+{
+  if (mrfiRadioState == MRFI_RADIO_STATE_OFF)
+  {
+    mrfiRadioState = MRFI_RADIO_STATE_IDLE;
+  }
+}
+
+
+/**************************************************************************************************
+ * @fn          MRFI_Rssi
+ *
+ * @brief       Returns the RSSI of the last received frame; there is no live channel to sample.
+ *
+ * @param       none
+ *
+ * @return      RSSI value in dBm.
+ **************************************************************************************************
+ */
+int8_t MRFI_Rssi(void)
+{
+  return( mrfiLastRssi );
+}
+
+
+/**************************************************************************************************
+ * @fn          MRFI_RandomByte
+ *
+ * @brief       Returns a random byte.
+ *
+ * @param       none
+ *
+ * @return      a random byte
+ **************************************************************************************************
+ */
+uint8_t MRFI_RandomByte(void)
+{
+  return( (uint8_t)rand() );
+}
+
+
+/**************************************************************************************************
+ * @fn          MRFI_DelayMs
+ *
+ * @brief       Delay the specified number of milliseconds.
+ *
+ * @param       milliseconds - delay time
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+void MRFI_DelayMs(uint16_t milliseconds)
+{
+  BSP_HostWait((uint32_t)milliseconds * 1000, NULL);
+}
+
+
+/**************************************************************************************************
+ * @fn          MRFI_ReplyDelay
+ *
+ * @brief       Delay number of milliseconds scaled by data rate. Check semaphore for
+ *              early-out. Run in a separate thread when the reply delay is
+ *              invoked. Cleans up after itself.
+ *
+ * @param       none
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+void MRFI_ReplyDelay(void)
+{
+  sReplyDelayContext = 1;
+  BSP_HostWait((uint32_t)MRFI_HOST_REPLY_DELAY_MS * 1000, &sKillSem);
+  sKillSem           = 0;
+  sReplyDelayContext = 0;
+}
+
+
+/**************************************************************************************************
+ * @fn          MRFI_PostKillSem
+ *
+ * @brief       Post to the loop-kill semaphore that will be checked by the iteration loops
+ *              that control the delay thread.
+ *
+ * @param       none
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+void MRFI_PostKillSem(void)
+{
+  if (sReplyDelayContext)
+  {
+    sKillSem = 1;
+  }
+}
+
+
+/**************************************************************************************************
+ * @fn          MRFI_GetRadioState
+ *
+ * @brief       Returns the current radio state.
+ *
+ * @param       none
+ *
+ * @return      radio state - off/idle/rx
+ **************************************************************************************************
+ */
+uint8_t MRFI_GetRadioState(void)
+{
+  return mrfiRadioState;
+}
+
+
+/**************************************************************************************************
+ * @fn          MRFI_SetLogicalChannel
+ *
+ * @brief       Set logical channel.
+ *
+ * @param       chan - logical channel number
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+void MRFI_SetLogicalChannel(uint8_t chan)
+{
+  MRFI_ASSERT( chan < MRFI_NUM_LOGICAL_CHANS );
+
+  mrfiLogicalChan = chan;
+}
+
+
+/**************************************************************************************************
+ * @fn          MRFI_SetCalTemp
+ *
+ * @brief       Temperature hint for synthesizer calibration.  Nothing to calibrate here.
+ *
+ * @param       degrees - die temperature in 0.1 degC
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+void MRFI_SetCalTemp(int16_t degrees)
+{
+  (void)degrees;
+}
+
+
+/**************************************************************************************************
+ * @fn          MRFI_SetRFPwr
+ *
+ * @brief       Set output power level.  Reported to the emulator with every frame.
+ *
+ * @param       level - power level index
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+void MRFI_SetRFPwr(uint8_t level)
+{
+  MRFI_ASSERT( level < MRFI_NUM_POWER_SETTINGS );
+
+  mrfiRFPowerLevel = level;
+}
+
+
+/**************************************************************************************************
+ * @fn          MRFI_GetRFPwr
+ *
+ * @brief       Get output power level.
+ *
+ * @param       none
+ *
+ * @return      current power level index
+ **************************************************************************************************
+ */
+uint8_t MRFI_GetRFPwr(void)
+{
+  return( mrfiRFPowerLevel );
+}
+
+
+/**************************************************************************************************
+ * @fn          MRFI_GetRFPwrDbm
+ *
+ * @brief       Output power in dBm for a power level index.
+ *
+ * @param       level - power level index
+ *
+ * @return      output power in dBm
+ **************************************************************************************************
+ */
+int8_t MRFI_GetRFPwrDbm(uint8_t level)
+{
+  MRFI_ASSERT( level < MRFI_NUM_POWER_SETTINGS );
+
+  return( mrfiRFPowerDbm[level] );
+}
+
+
+/**************************************************************************************************
+ * @fn          MRFI_SetRxAddrFilter
+ *
+ * @brief       Set the address used for filtering received packets.
+ *
+ * @param       pAddr - pointer to address to use for filtering
+ *
+ * @return      zero     : successfully set filter address
+ *              non-zero : illegal address
+ **************************************************************************************************
+ */
+uint8_t MRFI_SetRxAddrFilter(uint8_t * pAddr)
+{
+  /* keep the hardware restriction so host and target accept the same addresses */
+  if (pAddr[0] == mrfiBroadcastAddr[0])
+  {
+    return( 1 );
+  }
+
+  memcpy(mrfiRxFilterAddr, pAddr, MRFI_ADDR_SIZE);
+
+  return( 0 );
+}
+
+
+/**************************************************************************************************
+ * @fn          MRFI_EnableRxAddrFilter
+ *
+ * @brief       Enable received packet filtering.
+ *
+ * @param       none
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+void MRFI_EnableRxAddrFilter(void)
+{
+  MRFI_ASSERT( mrfiRxFilterAddr[0] != mrfiBroadcastAddr[0] ); /* filter address must be set */
+
+  mrfiRxFilterEnabled = 1;
+}
+
+
+/**************************************************************************************************
+ * @fn          MRFI_DisableRxAddrFilter
+ *
+ * @brief       Disable received packet filtering.
+ *
+ * @param       none
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+void MRFI_DisableRxAddrFilter(void)
+{
+  mrfiRxFilterEnabled = 0;
+}
+
+
+/**************************************************************************************************
+ * @fn          Mrfi_RxAddrIsFiltered
+ *
+ * @brief       Determine if address is filtered.
+ *
+ * @param       none
+ *
+ * @return      zero     : address is not filtered
+ *              non-zero : address is filtered
+ **************************************************************************************************
+ */
+static uint8_t Mrfi_RxAddrIsFiltered(uint8_t * pAddr)
+{
+  if (!mrfiRxFilterEnabled)
+  {
+    return( 0 );
+  }
+
+  return( memcmp(pAddr, mrfiRxFilterAddr, MRFI_ADDR_SIZE) &&
+          memcmp(pAddr, mrfiBroadcastAddr, MRFI_ADDR_SIZE) );
+}
+
+
+/**************************************************************************************************
+*/
@@ -55,26 +55,71 @@
  * CONSTANTS AND DEFINES
  */
 
+/* end-of-list marker for slot indices */
+#define  Q_NIL   0xFF
+
+#if (SIZE_INFRAME_Q >= Q_NIL) || (SIZE_OUTFRAME_Q >= Q_NIL) || (SIZE_OUTFRAME_Q < 1)
+#error "ERROR: Frame queue depth must be between 1 and 254 (input queue may be 0)."
+#endif
+
 /******************************************************************************
  * TYPEDEFS
  */
 
+/* Each queue keeps its occupied slots in a doubly linked list ordered by age
+ * (head is oldest, tail is newest) and its free slots on a stack. Allocation,
+ * cast-out and release are O(1) regardless of queue depth. The link arrays are
+ * separate from frameInfo_t so the frame objects themselves stay unchanged.
+ */
+typedef struct
+{
+  frameInfo_t *frames;
+  uint8_t     *next;
+  uint8_t     *prev;
+  uint8_t     *freeSlot;
+  uint8_t      num;
+} frameQ_t;
+
+typedef struct
+{
+  uint8_t  head;
+  uint8_t  tail;
+  uint8_t  numFree;
+} frameQState_t;
+
 /******************************************************************************
  * LOCAL VARIABLES
  */
 
 #if SIZE_INFRAME_Q > 0
 static frameInfo_t   sInFrameQ[SIZE_INFRAME_Q];
+static uint8_t       sInNext[SIZE_INFRAME_Q];
+static uint8_t       sInPrev[SIZE_INFRAME_Q];
+static uint8_t       sInFree[SIZE_INFRAME_Q];
 #else
 static frameInfo_t  *sInFrameQ = NULL;
 #endif  /* SIZE_INFRAME_Q > 0 */
 
 static frameInfo_t   sOutFrameQ[SIZE_OUTFRAME_Q];
+static uint8_t       sOutNext[SIZE_OUTFRAME_Q];
+static uint8_t       sOutPrev[SIZE_OUTFRAME_Q];
+static uint8_t       sOutFree[SIZE_OUTFRAME_Q];
+
+#if SIZE_INFRAME_Q > 0
+static const frameQ_t sInQ  = {sInFrameQ, sInNext, sInPrev, sInFree, SIZE_INFRAME_Q};
+static frameQState_t  sInQState;
+#endif  /* SIZE_INFRAME_Q > 0 */
+static const frameQ_t sOutQ = {sOutFrameQ, sOutNext, sOutPrev, sOutFree, SIZE_OUTFRAME_Q};
+static frameQState_t  sOutQState;
 
 /******************************************************************************
  * LOCAL FUNCTIONS
  */
 
+static void qInit(const frameQ_t *, frameQState_t *);
+static void qLinkTail(const frameQ_t *, frameQState_t *, uint8_t);
+static void qUnlink(const frameQ_t *, frameQState_t *, uint8_t);
+
 /******************************************************************************
  * GLOBAL VARIABLES
  */
@@ -97,18 +142,19 @@ static frameInfo_t   sOutFrameQ[SIZE_OUTFRAME_Q];
 void nwk_QInit(void)
 {
 #if SIZE_INFRAME_Q > 0
-  memset(sInFrameQ, 0, sizeof(sInFrameQ));
+  qInit(&sInQ, &sInQState);
 #endif  // SIZE_INFRAME_Q > 0
-  memset(sOutFrameQ, 0, sizeof(sOutFrameQ));
+  qInit(&sOutQ, &sOutQState);
 }
  
 /******************************************************************************
  * @fn          nwk_QfindSlot
  *
- * @brief       Finds a slot to use to retrieve the frame from the radio. It
- *              uses a LRU cast-out scheme. It is possible that this routine
- *              finds no slot. This can happen if the queue is of size 1 or 2
- *              and the Rx interrupt occurs during a retrieval call from an
+ * @brief       Finds a slot to use to retrieve the frame from the radio. Free
+ *              slots are popped from the free stack. If the input queue is full
+ *              the oldest frame is cast out (LRU). It is possible that this
+ *              routine finds no slot. This can happen if the queue is of size 1
+ *              or 2 and the Rx interrupt occurs during a retrieval call from an
  *              application. There are meta-states for frames as the application
  *              looks for the oldest frame on the port being requested.
  *
@@ -119,127 +165,110 @@ void nwk_QInit(void)
  *
  * output parameters
  *
- * @return      Pointer to oldest available frame in the queue
+ * @return      Pointer to the slot, now the newest frame in the queue
  */
 frameInfo_t *nwk_QfindSlot(uint8_t which)
 {
-  frameInfo_t *pFI, *oldest= 0, *newFI = 0;
-  uint8_t        i, num, newOrder = 0, orderTest;
+  const frameQ_t *q;
+  frameQState_t  *qs;
+  frameInfo_t    *newFI = 0;
+  uint8_t         i;
+  bspIState_t     intState;
 
   if (INQ == which)
   {
-    pFI  = sInFrameQ;
-    num  = SIZE_INFRAME_Q;
+#if SIZE_INFRAME_Q > 0
+    q  = &sInQ;
+    qs = &sInQState;
+#else
+    return (frameInfo_t *)0;
+#endif
   }
   else
   {
-    pFI  = sOutFrameQ;
-    num  = SIZE_OUTFRAME_Q;
+    q  = &sOutQ;
+    qs = &sOutQState;
   }
 
-  orderTest = num + 1;
+  BSP_ENTER_CRITICAL_SECTION(intState);
 
-  for (i=0; i<num; ++i, ++pFI)
+  if (qs->numFree)
   {
-    /* if frame is available it's a candidate. */
-    if (pFI->fi_usage != FI_AVAILABLE)
-    {
-      if (INQ == which)  /* TODO: do cast-out for Tx as well */
-      {
-
-        /* need to know the number of occupied slots so we know the age value
-         * for the unoccupied slot (if there is one).
-         */
-        newOrder++;
-
-        /* make sure nwk_retrieveFrame() is not processing this frame */
-        if (FI_INUSE_TRANSITION == pFI->fi_usage)
-        {
-          continue;
-        }
-        /* is this frame older than any we've seen? */
-        if (orderTest > pFI->orderStamp)
-        {
-          /* yes. */
-          oldest    = pFI;
-          orderTest = pFI->orderStamp;
-        }
-      }
-    }
-    else
+    i = q->freeSlot[--qs->numFree];
+    newFI = &q->frames[i];
+    /* reserve it so a nested caller cannot get the same slot */
+    newFI->fi_usage = FI_INUSE_TRANSITION;
+    qLinkTail(q, qs, i);
+  }
+  else if (INQ == which)  /* TODO: do cast-out for Tx as well */
+  {
+    /* queue was full. cast-out the oldest frame that is not being retrieved
+     * by nwk_retrieveFrame(). Only frames in transition are skipped so this
+     * terminates after a step or two.
+     */
+    for (i = qs->head; i != Q_NIL; i = q->next[i])
     {
-      if (OUTQ == which)  /* TODO: do cast-out for Tx as well */
+      if (FI_INUSE_TRANSITION != q->frames[i].fi_usage)
       {
-        return pFI;
+        newFI = &q->frames[i];
+        newFI->fi_usage = FI_INUSE_TRANSITION;
+        qUnlink(q, qs, i);
+        qLinkTail(q, qs, i);
+        break;
       }
-      newFI = pFI;
     }
+    /* If nothing was found the queue is only of size 1 or 2 and all
+     * the frames are in transition when the Rx interrupt occurs.
+     */
   }
 
-  /* did we find anything? */
-  if (!newFI)
-  {
-    /* queue was full. cast-out happens here...unless... */
-    if (!oldest)
-    {
-      /* This can happen if the queue is only of size 1 or 2 and all
-       * the frames are in transition when the Rx interrupt occurs.
-       */
-      return (frameInfo_t *)0;
-    }
-    newFI = oldest;
-    nwk_QadjustOrder(which, newFI->orderStamp);
-    newFI->orderStamp = i;
-  }
-  else
-  {
-    /* mark the available slot. */
-    newFI->orderStamp = ++newOrder;
-  }
+  BSP_EXIT_CRITICAL_SECTION(intState);
 
   return newFI;
 }
 
 /******************************************************************************
- * @fn          nwk_QadjustOrder
+ * @fn          nwk_QfreeSlot
  *
- * @brief       Adjusts the age of everyone in the queue newer than the frame
- *              being removed.
+ * @brief       Return a frame to the free stack of the queue it belongs to.
+ *              Replaces writing FI_AVAILABLE to the frame directly. Freeing a
+ *              frame that is already available is ignored.
  *
  * input parameters
- * @param   which   - INQ or OUTQ to adjust
- * @param   stamp   - value of frame being removed
+ * @param   pFI     - frame to release
  *
  * output parameters
  *
  * @return      void
  */
-void nwk_QadjustOrder(uint8_t which, uint8_t stamp)
+void nwk_QfreeSlot(frameInfo_t *pFI)
 {
-  frameInfo_t *pFI;
-  uint8_t      i, num;
-  bspIState_t  intState;
+  const frameQ_t *q;
+  frameQState_t  *qs;
+  uint8_t         i;
+  bspIState_t     intState;
 
-  if (INQ == which)
+#if SIZE_INFRAME_Q > 0
+  if ((pFI >= sInFrameQ) && (pFI < sInFrameQ + SIZE_INFRAME_Q))
   {
-    pFI  = sInFrameQ;
-    num  = SIZE_INFRAME_Q;
+    q  = &sInQ;
+    qs = &sInQState;
   }
   else
+#endif  /* SIZE_INFRAME_Q > 0 */
   {
-/*    pFI  = sOutFrameQ; */
-/*    num  = SIZE_OUTFRAME_Q; */
-    return;
+    q  = &sOutQ;
+    qs = &sOutQState;
   }
+  i = pFI - q->frames;
 
   BSP_ENTER_CRITICAL_SECTION(intState);
 
-  for (i=0; i<num; ++i, ++pFI)
+  if (FI_AVAILABLE != pFI->fi_usage)
   {
-    if ((pFI->fi_usage != FI_AVAILABLE) && (pFI->orderStamp > stamp))
-    {
-      pFI->orderStamp--;
-    }
+    pFI->fi_usage = FI_AVAILABLE;
+    qUnlink(q, qs, i);
+    q->freeSlot[qs->numFree++] = i;
   }
 
   BSP_EXIT_CRITICAL_SECTION(intState);
@@ -253,7 +282,8 @@ void nwk_QadjustOrder(uint8_t which, uint8_t stamp)
  * @brief       Look through frame queue and find the oldest available frame
  *              in the context in question. Supports connection-based (user),
  *              non-connection based (NWK applications), and the special case
- *              of store-and-forward.
+ *              of store-and-forward. The queue is walked from the oldest frame
+ *              so the first match is returned.
  *
  * input parameters
  * @param   which      - INQ or OUTQ to adjust
@@ -267,20 +297,15 @@ void nwk_QadjustOrder(uint8_t which, uint8_t stamp)
  */
 frameInfo_t *nwk_QfindOldest(uint8_t which, rcvContext_t *rcv, uint8_t fi_usage)
 {
-  uint8_t      i, oldest, num, port;
-  uint8_t      uType, addr12Compare;
+#if SIZE_INFRAME_Q > 0
+  uint8_t      i, port;
+  uint8_t      uType;
   bspIState_t  intState;
-  frameInfo_t *fPtr = 0, *wPtr;
+  frameInfo_t *wPtr;
   connInfo_t  *pCInfo = 0;
-  uint8_t     *pAddr1, *pAddr2, *pAddr3 = 0;
+  uint8_t     *pAddr1 = 0, *pAddr2 = 0, *pAddr3 = 0;
 
-  if (INQ == which)
-  {
-    wPtr   = sInFrameQ;
-    num    = SIZE_INFRAME_Q;
-    oldest = SIZE_INFRAME_Q+1;
-  }
-  else
+  if (INQ != which)
   {
 /*    pFI  = sOutFrameQ; */
 /*    num  = SIZE_OUTFRAME_Q; */
@@ -316,86 +341,72 @@ frameInfo_t *nwk_QfindOldest(uint8_t which, rcvContext_t *rcv, uint8_t fi_usage)
 
   uType = (USAGE_NORMAL == fi_usage) ? FI_INUSE_UNTIL_DEL : FI_INUSE_UNTIL_FWD;
 
-  for (i=0; i<num; ++i, ++wPtr)
-  {
+  BSP_ENTER_CRITICAL_SECTION(intState);   /* protect the frame states and links */
 
-    BSP_ENTER_CRITICAL_SECTION(intState);   /* protect the frame states */
+  for (i = sInQState.head; i != Q_NIL; i = sInNext[i])
+  {
+    wPtr = &sInFrameQ[i];
 
     /* only check entries in use and waiting for this port */
-    if (uType == wPtr->fi_usage)
+    if (uType != wPtr->fi_usage)
     {
-      wPtr->fi_usage = FI_INUSE_TRANSITION;
+      continue;
+    }
 
-      BSP_EXIT_CRITICAL_SECTION(intState);  /* release hold */
-      /* message sent to this device? */
-      if (GET_FROM_FRAME(MRFI_P_PAYLOAD(&wPtr->mrfiPkt), F_PORT_OS) == port)
-      {
-        /* Port matches. If the port of interest is a NWK applicaiton we're a
-         * match...the NWK applications are not connection-based. If it is a
-         * NWK application we need to check the source address for disambiguation.
-         * Also need to check source address if it's a raw frame lookup (S&F frame)
-         */
-        if (RCV_APP_LID == rcv->type)
-        {
-          if (SMPL_PORT_USER_BCAST == port)
-          {
-            /* guarantee a match... */
-            pAddr1 = pCInfo->peerAddr;
-          }
-          else
-          {
-            pAddr1 = MRFI_P_SRC_ADDR(&wPtr->mrfiPkt);
-          }
-        }
-#ifdef ACCESS_POINT
-        else if (RCV_RAW_POLL_FRAME == rcv->type)
-        {
-          pAddr1 = MRFI_P_DST_ADDR(&wPtr->mrfiPkt);
-        }
-#endif
+    /* A frame in transition is neither cast out nor freed by the Rx ISR
+     * so it stays linked while we look at it with interrupts enabled.
+     */
+    wPtr->fi_usage = FI_INUSE_TRANSITION;
+
+    BSP_EXIT_CRITICAL_SECTION(intState);  /* release hold */
 
-        addr12Compare = memcmp(pAddr1, pAddr2, NET_ADDR_SIZE);
-        if (  (RCV_NWK_PORT == rcv->type) ||
-              (!pAddr3 && !addr12Compare) ||
-              (pAddr3 && !memcmp(pAddr3, MRFI_P_SRC_ADDR(&wPtr->mrfiPkt), NET_ADDR_SIZE))
-           )
+    /* message sent to this device? */
+    if (GET_FROM_FRAME(MRFI_P_PAYLOAD(&wPtr->mrfiPkt), F_PORT_OS) == port)
+    {
+      /* Port matches. If the port of interest is a NWK applicaiton we're a
+       * match...the NWK applications are not connection-based. If it is a
+       * NWK application we need to check the source address for disambiguation.
+       * Also need to check source address if it's a raw frame lookup (S&F frame)
+       */
+      if (RCV_APP_LID == rcv->type)
+      {
+        if (SMPL_PORT_USER_BCAST == port)
         {
-          if (wPtr->orderStamp < oldest)
-          {
-            if (fPtr)
-            {
-              /* restore previous oldest one */
-              fPtr->fi_usage = uType;
-            }
-            oldest = wPtr->orderStamp;
-            fPtr   = wPtr;
-            continue;
-          }
-          else
-          {
-            /* not oldest. restore state */
-            wPtr->fi_usage = uType;
-          }
+          /* guarantee a match... */
+          pAddr1 = pCInfo->peerAddr;
         }
         else
         {
-          /* not a match. restore state */
-          wPtr->fi_usage = uType;
+          pAddr1 = MRFI_P_SRC_ADDR(&wPtr->mrfiPkt);
         }
       }
-      else
+#ifdef ACCESS_POINT
+      else if (RCV_RAW_POLL_FRAME == rcv->type)
       {
-        /* wrong port. restore state */
-        wPtr->fi_usage = uType;
+        pAddr1 = MRFI_P_DST_ADDR(&wPtr->mrfiPkt);
+      }
+#endif
+
+      /* NWK port lookups set no addresses, so compare only after that test */
+      if (  (RCV_NWK_PORT == rcv->type) ||
+            (!pAddr3 && !memcmp(pAddr1, pAddr2, NET_ADDR_SIZE)) ||
+            (pAddr3 && !memcmp(pAddr3, MRFI_P_SRC_ADDR(&wPtr->mrfiPkt), NET_ADDR_SIZE))
+         )
+      {
+        /* oldest match. leave it in transition for the caller. */
+        return wPtr;
       }
     }
-    else
-    {
-      BSP_EXIT_CRITICAL_SECTION(intState);
-    }
+
+    /* not a match. restore state and move on to the next newer frame. */
+    BSP_ENTER_CRITICAL_SECTION(intState);
+    wPtr->fi_usage = uType;
   }
 
-  return fPtr;
+  BSP_EXIT_CRITICAL_SECTION(intState);
+#endif  /* SIZE_INFRAME_Q > 0 */
+
+  return (frameInfo_t *)0;
 }
 
 /******************************************************************************
@@ -415,3 +426,97 @@ frameInfo_t *nwk_getQ(uint8_t which)
   return (INQ == which) ? sInFrameQ : sOutFrameQ;
 }
 
+
+/******************************************************************************
+ * @fn          qInit
+ *
+ * @brief       Empty a queue: all slots available and on the free stack.
+ *
+ * input parameters
+ * @param   q       - queue to initialize
+ * @param   qs      - its list state
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+static void qInit(const frameQ_t *q, frameQState_t *qs)
+{
+  uint8_t i;
+
+  memset(q->frames, 0, q->num * sizeof(frameInfo_t));
+
+  /* lowest slot on top of the stack so allocation order matches the old scan */
+  for (i = 0; i < q->num; ++i)
+  {
+    q->freeSlot[i] = q->num - 1 - i;
+  }
+  qs->numFree = q->num;
+  qs->head    = Q_NIL;
+  qs->tail    = Q_NIL;
+}
+
+/******************************************************************************
+ * @fn          qLinkTail
+ *
+ * @brief       Append a slot to the age list as the newest frame. Caller must
+ *              hold the critical section.
+ *
+ * input parameters
+ * @param   q       - queue
+ * @param   qs      - its list state
+ * @param   i       - slot index
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+static void qLinkTail(const frameQ_t *q, frameQState_t *qs, uint8_t i)
+{
+  q->next[i] = Q_NIL;
+  q->prev[i] = qs->tail;
+  if (Q_NIL == qs->tail)
+  {
+    qs->head = i;
+  }
+  else
+  {
+    q->next[qs->tail] = i;
+  }
+  qs->tail = i;
+}
+
+/******************************************************************************
+ * @fn          qUnlink
+ *
+ * @brief       Remove a slot from the age list. Caller must hold the critical
+ *              section.
+ *
+ * input parameters
+ * @param   q       - queue
+ * @param   qs      - its list state
+ * @param   i       - slot index
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+static void qUnlink(const frameQ_t *q, frameQState_t *qs, uint8_t i)
+{
+  if (Q_NIL == q->prev[i])
+  {
+    qs->head = q->next[i];
+  }
+  else
+  {
+    q->next[q->prev[i]] = q->next[i];
+  }
+  if (Q_NIL == q->next[i])
+  {
+    qs->tail = q->prev[i];
+  }
+  else
+  {
+    q->prev[q->next[i]] = q->prev[i];
+  }
+}
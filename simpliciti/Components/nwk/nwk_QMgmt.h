@@ -46,7 +46,7 @@
 /* prototypes */
 void              nwk_QInit(void);
 frameInfo_t *nwk_QfindSlot(uint8_t);
-void              nwk_QadjustOrder(uint8_t, uint8_t);
+void              nwk_QfreeSlot(frameInfo_t *);
 frameInfo_t *nwk_QfindOldest(uint8_t, rcvContext_t *, uint8_t);
 frameInfo_t *nwk_getQ(uint8_t);
 
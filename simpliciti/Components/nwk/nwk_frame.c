@@ -391,9 +391,7 @@ smplStatus_t nwk_retrieveFrame(rcvContext_t *rcv, uint8_t *msg, uint8_t *len, ad
         *hopCount = GET_FROM_FRAME(MRFI_P_PAYLOAD(&fPtr->mrfiPkt), F_HOP_COUNT);
       }
       /* input frame no longer needed. free it. */
-      nwk_QadjustOrder(INQ, fPtr->orderStamp);
-
-      fPtr->fi_usage = FI_AVAILABLE;
+      nwk_QfreeSlot(fPtr);
       return SMPL_SUCCESS;
     }
   } while (!done);
@@ -431,7 +429,7 @@ static void dispatchFrame(frameInfo_t *fiPtr)
   /* be sure it's not an echo... */
   if (!memcmp(MRFI_P_SRC_ADDR(&fiPtr->mrfiPkt), sMyAddr, NET_ADDR_SIZE))
   {
-    fiPtr->fi_usage = FI_AVAILABLE;
+    nwk_QfreeSlot(fiPtr);
     return;
   }
 
@@ -440,14 +438,14 @@ static void dispatchFrame(frameInfo_t *fiPtr)
   if (!(GET_FROM_FRAME(MRFI_P_PAYLOAD(&fiPtr->mrfiPkt), F_ENCRYPT_OS)))
   {
     /* Encyrption bit is not on when when it should be */
-    fiPtr->fi_usage = FI_AVAILABLE;
+    nwk_QfreeSlot(fiPtr);
     return;
   }
 #else
   if (GET_FROM_FRAME(MRFI_P_PAYLOAD(&fiPtr->mrfiPkt), F_ENCRYPT_OS))
   {
     /* Encyrption bit is on when when it should not be */
-    fiPtr->fi_usage = FI_AVAILABLE;
+    nwk_QfreeSlot(fiPtr);
     return;
   }
 #endif  /* SMPL_SECURE */
@@ -461,7 +459,7 @@ static void dispatchFrame(frameInfo_t *fiPtr)
     /* Non-connection-based frame. We can decode here if it was encrypted */
     if (!nwk_getSecureFrame(&fiPtr->mrfiPkt, MRFI_GET_PAYLOAD_LEN(&fiPtr->mrfiPkt) - F_SEC_CTR_OS, 0))
     {
-      fiPtr->fi_usage = FI_AVAILABLE;
+      nwk_QfreeSlot(fiPtr);
       return;
     }
 #endif
@@ -479,7 +477,7 @@ static void dispatchFrame(frameInfo_t *fiPtr)
 #endif
     else  /* rc == FHS_RELEASE (default...) */
     {
-      fiPtr->fi_usage = FI_AVAILABLE;
+      nwk_QfreeSlot(fiPtr);
     }
     return;
   }
@@ -487,7 +485,7 @@ static void dispatchFrame(frameInfo_t *fiPtr)
   else if ((port != SMPL_PORT_USER_BCAST) && ((port < PORT_BASE_NUMBER) || (port > SMPL_PORT_STATIC_MAX)))
   {
     /* bogus port. drop frame */
-    fiPtr->fi_usage = FI_AVAILABLE;
+    nwk_QfreeSlot(fiPtr);
     return;
   }
 
@@ -512,12 +510,12 @@ static void dispatchFrame(frameInfo_t *fiPtr)
     }
     else
     {
-      fiPtr->fi_usage = FI_AVAILABLE;
+      nwk_QfreeSlot(fiPtr);
     }
   }
   else
   {
-    fiPtr->fi_usage = FI_AVAILABLE;
+    nwk_QfreeSlot(fiPtr);
   }
 #else
   /* it's destined for a user app. */
@@ -526,13 +524,13 @@ static void dispatchFrame(frameInfo_t *fiPtr)
     fiPtr->fi_usage = FI_INUSE_UNTIL_DEL;
     if (spCallback && spCallback(lid))
     {
-      fiPtr->fi_usage = FI_AVAILABLE;
+      nwk_QfreeSlot(fiPtr);
       return;
     }
   }
   else
   {
-    fiPtr->fi_usage = FI_AVAILABLE;
+    nwk_QfreeSlot(fiPtr);
   }
 #endif  /* RX_POLLS */
 
@@ -571,13 +569,13 @@ static void dispatchFrame(frameInfo_t *fiPtr)
       fiPtr->fi_usage = FI_INUSE_UNTIL_DEL;
       if (spCallback && spCallback(lid))
       {
-        fiPtr->fi_usage = FI_AVAILABLE;
+        nwk_QfreeSlot(fiPtr);
         return;
       }
     }
     else
     {
-      fiPtr->fi_usage = FI_AVAILABLE;
+      nwk_QfreeSlot(fiPtr);
     }
   }
 #if defined( ACCESS_POINT )
@@ -601,19 +599,19 @@ static void dispatchFrame(frameInfo_t *fiPtr)
     }
     else
     {
-      fiPtr->fi_usage = FI_AVAILABLE;
+      nwk_QfreeSlot(fiPtr);
     }
   }
   else if (GET_FROM_FRAME(MRFI_P_PAYLOAD(&fiPtr->mrfiPkt), F_TX_DEVICE) == F_TX_DEVICE_AP)
   {
     /* I'm an AP and this frame came from an AP. Don't replay. */
-    fiPtr->fi_usage = FI_AVAILABLE;
+    nwk_QfreeSlot(fiPtr);
   }
 #elif defined( RANGE_EXTENDER )
   else if (GET_FROM_FRAME(MRFI_P_PAYLOAD(&fiPtr->mrfiPkt), F_TX_DEVICE) == F_TX_DEVICE_RE)
   {
     /* I'm an RE and this frame came from an RE. Don't replay. */
-    fiPtr->fi_usage = FI_AVAILABLE;
+    nwk_QfreeSlot(fiPtr);
   }
 #endif
   else
@@ -663,7 +661,7 @@ smplStatus_t nwk_sendFrame(frameInfo_t *pFrameInfo, uint8_t txOption)
   }
 
   /* TX is done. free up the frame buffer */
-  pFrameInfo->fi_usage = FI_AVAILABLE;
+  nwk_QfreeSlot(pFrameInfo);
 
   return rc;
 }
@@ -790,7 +788,7 @@ void nwk_replayFrame(frameInfo_t *pFrameInfo)
   }
   else
   {
-    pFrameInfo->fi_usage = FI_AVAILABLE;
+    nwk_QfreeSlot(pFrameInfo);
   }
   return;
 }
@@ -121,7 +121,6 @@ typedef struct
 typedef struct
 {
   volatile uint8_t      fi_usage;
-           uint8_t      orderStamp;
            mrfiPacket_t mrfiPkt;
 } frameInfo_t;
 
@@ -220,18 +220,19 @@ smplStatus_t nwk_radioControl(ioctlAction_t action, void *val)
   {
     uint8_t idx;
 
+    /* [BM] Levels keep their old PA settings, the table has extra steps in between */
     switch (*(ioctlLevel_t *)val)
     {
       case IOCTL_LEVEL_2:
-        idx = 2;
+        idx = MRFI_NUM_POWER_SETTINGS - 1;
         break;
 
       case IOCTL_LEVEL_1:
-        idx = 1;
+        idx = MRFI_NUM_POWER_SETTINGS - 2;
         break;
 
       case IOCTL_LEVEL_0:
-        idx = 0;
+        idx = 1;
         break;
 
       default:
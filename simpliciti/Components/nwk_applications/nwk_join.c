@@ -42,6 +42,7 @@
 #include "nwk_types.h"
 #include "nwk_api.h"
 #include "nwk_frame.h"
+#include "nwk_QMgmt.h"
 #include "nwk.h"
 #include "nwk_link.h"
 #include "nwk_join.h"
@@ -293,7 +294,8 @@ static void smpl_send_join_reply(mrfiPacket_t *frame)
       }
       else
       {
-        /* No room left. Just return and don't send reply. */
+        /* No room left. Release the reply frame and don't send it. */
+        nwk_QfreeSlot(pOutFrame);
         return;
       }
     }
@@ -139,6 +139,14 @@ extern void simpliciti_get_ed_data_callback(void);
 #define SYNC_ED_TYPE_R2R                        (1u)
 #define SYNC_ED_TYPE_MEMORY                     (2u)
 #define SYNC_ED_TYPE_STATUS                     (3u)
+#define SYNC_ED_TYPE_PROFILE                    (4u)
+#define SYNC_ED_TYPE_CRASH                      (5u)
+#define SYNC_ED_TYPE_SLEEP                      (6u)
+#define SYNC_ED_TYPE_IMPACT                     (7u)
+#define SYNC_ED_TYPE_TRACK                      (8u)
+#define SYNC_ED_TYPE_HISTORY                    (9u)
+// (1) SYNC_ED_TYPE_xxx of the log (2) 1 = erased or already empty, 0 = kept, it changed since it was read
+#define SYNC_ED_TYPE_ERASE                      (10u)
 
 // Host data    (0)CMD    (1) - (18) DATA 
 #define SYNC_AP_CMD_NOP                         (1u)
@@ -148,6 +156,16 @@ extern void simpliciti_get_ed_data_callback(void);
 #define SYNC_AP_CMD_GET_MEMORY_BLOCKS_MODE_2   	(5u)
 #define SYNC_AP_CMD_ERASE_MEMORY                (6u)
 #define SYNC_AP_CMD_EXIT						(7u)
+// (1) RSSI in dBm (signed) the access point received the last ready-to-receive packet with
+#define SYNC_AP_CMD_LINK_RSSI					(8u)
+#define SYNC_AP_CMD_GET_PROFILE					(9u)
+#define SYNC_AP_CMD_GET_CRASH					(10u)
+#define SYNC_AP_CMD_GET_SLEEP					(11u)
+#define SYNC_AP_CMD_GET_IMPACT					(12u)
+#define SYNC_AP_CMD_GET_TRACK					(13u)
+#define SYNC_AP_CMD_GET_HISTORY					(14u)
+// (1) SYNC_ED_TYPE_xxx of the log (2)-(3) number of entries on page 0 of the download, MSB first
+#define SYNC_AP_CMD_ERASE_LOG					(15u)
 
 
 // Entry point into SimpliciTI library
@@ -162,3 +180,12 @@ extern void simpliciti_sync_get_data_callback(unsigned int index);
 // Send reply packets (>0), 0=no need to reply
 extern unsigned char simpliciti_reply_count;
 
+// Feed RSSI echoed by access point into the link quality management
+extern void simpliciti_link_peer_rssi(signed char rssi);
+
+// Filtered RSSI in dBm of packets received from access point
+extern signed char simpliciti_link_rssi(void);
+
+// Temperature in 1/10 degree Celsius used to select cached radio calibration
+extern void simpliciti_link_temperature(signed short degrees);
+
@@ -122,8 +122,9 @@ DATA["CONFIG_PHASE_CLOCK"] = {
         "name": "Phase Clock (918 bytes)",
         "depends": [],
         "default": False,
-        "help": "Measures sleep phase by recording body movement and sending the data to the accesspoint.\n"
-                "Designed to be used with uberclock",
+        "help": "Records body movement during the night in a 512 byte flash log, one activity value per minute. "
+                "Within a window before the alarm time, light sleep rings the alarm early. "
+                "Sync command 11 uploads the night to contrib/sleep_dump.py, the radio stays off while recording.",
 }
 
 DATA["CONFIG_ALTITUDE"] = {
@@ -146,6 +147,29 @@ DATA["CONFIG_ALTI_ACCUMULATOR"] = {
 	"help": "If active take altitude measurement once per minute and accumulate all ascending vertical meters."
 	}
 
+DATA["CONFIG_ALTI_TRACK"] = {
+        "name": "Altitude accumulator: track recorder",
+        "depends": ["CONFIG_ALTI_ACCUMULATOR"],
+        "default": False,
+        "help": "Logs every peak and dip of the accumulator with its time in flash, up to 126 points, and shows descent and number "
+                "of climbs. The track is uploaded in SYNC mode with contrib/track_dump.py."
+        }
+
+DATA["CONFIG_WEATHER"] = {
+        "name": "Weather trend",
+        "depends": [],
+        "default": False,
+        "help": "Pressure history of 48 hours, one triggered conversion every 10 minutes. Shows pressure (sea level when the altitude "
+                "was set), 3 hour tendency and a fair/cloud/rain/storm forecast. Needs about 320 bytes of RAM."
+        }
+
+DATA["CONFIG_WEATHER_ALARM"] = {
+        "name": "Weather trend: storm alarm",
+        "depends": ["CONFIG_WEATHER"],
+        "default": True,
+        "help": "Beep and show STORM when the pressure falls by 4hPa or more within 3 hours"
+        }
+
 DATA["CONFIG_PROUT"] = {
         "name": "Simple example that displays a text (238 bytes)",
         "depends": [],
@@ -171,8 +195,40 @@ DATA["CONFIG_DST"] = {
         }
 
 
+DATA["CONFIG_DVFS"] = {
+        "name": "Dynamic voltage/frequency scaling",
+        "depends": [],
+        "default": True,
+        "help": "Run at VCore 0 and 3MHz MCLK by default. Radio and pressure conversion temporarily switch to VCore 3 and 12MHz."
+        }
+
+DATA["CONFIG_SETTINGS"] = {
+        "name": "Persistent settings",
+        "depends": [],
+        "default": True,
+        "help": "Keep alarm, units, time format, beep/lock, view modes, altitude offset and eggtimer defaults in the Information Memory.\n"
+                "Changes are written back some seconds after the last key press or before the radio is started."
+        }
+
+DATA["CONFIG_PROFILE"] = {
+        "name": "Energy profiler",
+        "depends": [],
+        "default": True,
+        "help": "Count wakeups and CPU active time per interrupt source and radio airtime. Long press # in the SYNC menu shows the counters, "
+                "sync command 9 sends them to contrib/energy_budget.py for a current estimate."
+        }
+
+DATA["CONFIG_CRASH_LOG"] = {
+        "name": "Crash recorder",
+        "depends": [],
+        "default": True,
+        "help": "Keep reset cause, last interrupt, PC/SP and the last events of a crashed run in the Information Memory. "
+                "A software watchdog resets the watch if the main loop did not sleep for 12 seconds. "
+                "Sync command 10 sends the record to contrib/crash_dump.py."
+        }
+
 DATA["CONFIG_INFOMEM"] = {
-        "name": "Information Memory Driver (2934 bytes, requires sidereal clock)",
+        "name": "Information Memory Driver (2934 bytes, requires sidereal clock, settings or doorlock)",
         "depends": [],
         "default": False,
         "help": "Build driver for usage of the Information Memory.\n"
@@ -187,6 +243,61 @@ DATA["CONFIG_ACCEL"] = {
         "help": "Acceleration applications (display and transmission). When no other application uses the acceleration sensor, it is disabled completely"
         }
 
+DATA["CONFIG_PEDOMETER"] = {
+        "name": "Pedometer",
+        "depends": [],
+        "default": False,
+        "help": "Always-on step counter, shows steps of the day and cadence. The acceleration sensor waits in motion detection mode "
+                "and samples at 40Hz only while walking, the CPU is woken once per 0.8s burst of samples. "
+                "Selects the acceleration sensor driver also when Acceleration is disabled."
+        }
+
+DATA["CONFIG_GESTURE"] = {
+        "name": "Gestures",
+        "depends": [],
+        "default": False,
+        "help": "Wrist raise, tap and double tap recognized on the acceleration sensor. The sensor waits in motion detection mode "
+                "and samples at 40Hz for a short burst after each movement, the CPU is only woken when a gesture is recognized. "
+                "Selects the acceleration sensor driver also when Acceleration is disabled."
+        }
+
+DATA["CONFIG_GESTURE_RAISE"] = {
+        "name": "Gesture: wrist raise",
+        "depends": ["CONFIG_GESTURE"],
+        "default": 1,
+        "type": "choices",
+        "values": [(0, "Nothing"), (1, "Backlight"), (2, "Next menu"), (3, "Silence alarm")],
+        "help": "Action when the wrist is turned so that the display faces up"
+        }
+
+DATA["CONFIG_GESTURE_TAP"] = {
+        "name": "Gesture: tap",
+        "depends": ["CONFIG_GESTURE"],
+        "default": 0,
+        "type": "choices",
+        "values": [(0, "Nothing"), (1, "Backlight"), (2, "Next menu"), (3, "Silence alarm")],
+        "help": "Action on a single tap on the watch"
+        }
+
+DATA["CONFIG_GESTURE_DOUBLE_TAP"] = {
+        "name": "Gesture: double tap",
+        "depends": ["CONFIG_GESTURE"],
+        "default": 3,
+        "type": "choices",
+        "values": [(0, "Nothing"), (1, "Backlight"), (2, "Next menu"), (3, "Silence alarm")],
+        "help": "Action on two taps within 0.4s"
+        }
+
+DATA["CONFIG_IMPACT"] = {
+        "name": "Fall and shock logger",
+        "depends": [],
+        "default": False,
+        "help": "Logs falls and shocks above 3g with time and peak acceleration in flash, uploaded in SYNC mode with contrib/impact_dump.py. "
+                "As the only user the acceleration sensor waits in free fall detection mode and the CPU sleeps until a fall. "
+                "Together with Pedometer, Gestures or Sleep Phase Clock, shocks are only seen while they sample. "
+                "Selects the acceleration sensor driver also when Acceleration is disabled."
+        }
+
 DATA["CONFIG_STRENGTH"] = {
     "name": "Strength training timer (380 bytes)",
     "depends": [],
@@ -203,6 +314,24 @@ DATA["CONFIG_BATTERY"] = {
         "name": "Battery (360 bytes)",
         "depends": [],
         "default": True}
+DATA["CONFIG_HISTORY"] = {
+        "name": "Battery: daily temperature and battery history",
+        "depends": ["CONFIG_BATTERY"],
+        "default": False,
+        "help": "Samples the temperature with the battery voltage once a minute and logs min/max/mean of every day in flash. "
+                "UP in the temperature menu shows maximum, minimum (blinking MAX) and mean of today, DOWN in the battery menu "
+                "the mean of today and the trend of the daily mean in mV per day. 30 days are uploaded in SYNC mode with "
+                "contrib/history_dump.py."
+        }
+DATA["CONFIG_GAUGE"] = {
+        "name": "Battery: fuel gauge and power governor",
+        "depends": ["CONFIG_BATTERY", "CONFIG_PROFILE"],
+        "default": False,
+        "help": "Counts the charge drawn by CPU, radio and sensors with the energy profiler and predicts the remaining days of the "
+                "CR2032 at the mean current, shown with DOWN in the battery menu. The charge starts from the temperature compensated "
+                "voltage curve after a reset. Radio and 400Hz acceleration modes are switched off when the cell could brown out "
+                "under radio load."
+        }
 DATA["CONFIG_CLOCK"] = {
         "name": "Clock",
         "depends": [],
@@ -0,0 +1,223 @@
+#!/usr/bin/env python2
+# encoding: utf-8
+#
+# Terminal front end for the host emulator of the complete firmware (host/emulator.c).
+#
+# Starts build/host/emulator (make emulator_host), draws the LCD it reports with 7-segment
+# digits and the lit symbols, and turns key presses into emulator commands. The CPU time the
+# emulator measures per screen is listed below the display.
+#
+# Usage: tools/emulator.py [emulator options], e.g. tools/emulator.py -x 10
+
+import urwid
+import urwid.raw_display
+import subprocess
+import random
+import sys
+import os
+
+EMULATOR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "build", "host", "emulator")
+
+# Held for a long press, e.g. to enter set mode
+LONG_PRESS_MS = 2500
+
+# Steps per minute while walking
+WALK_CADENCE = 110
+
+BUTTONS = {
+    "s": "star", "n": "num", "u": "up", "up": "up", "d": "down", "down": "down", "b": "backlight",
+}
+
+HELP = (u"s=* n=#  u/d=up/down  b=light  capital=long press  |  "
+        u"+/- temp  a/z alt  v/c batt  m move  w walk  x fast  F8 quit")
+
+L1_DIGITS = ["L1_3", "L1_2", "L1_1", "L1_0"]
+L2_DIGITS = ["L2_5", "L2_4", "L2_3", "L2_2", "L2_1", "L2_0"]
+
+# Symbols drawn next to the digits, everything else is listed by name
+INLINE_SYMBOLS = set(L1_DIGITS + L2_DIGITS + ["L1_COL", "L1_DP1", "L1_DP0", "L2_COL1", "L2_COL0", "L2_DP"])
+
+
+def segments(bits):
+    """Three text rows of a 7-segment digit, bits 0..6 are segments A..G"""
+    a, b, c, d, e, f, g = [(bits >> i) & 1 for i in range(7)]
+    return [u" %s " % (u"_" if a else u" "),
+            u"%s%s%s" % (u"|" if f else u" ", u"_" if g else u" ", u"|" if b else u" "),
+            u"%s%s%s" % (u"|" if e else u" ", u"_" if d else u" ", u"|" if c else u" ")]
+
+
+class EmulatorApp(object):
+    def __init__(self, args):
+        self.args = args
+        self.digits = [0] * 10
+        self.symbols = set()
+        self.blink = set()
+        self.blink_phase = False
+        self.buzz = 0
+        self.light = 0
+        self.now = 0
+        self.cpu = {}
+        self.temperature = 220
+        self.altitude = 300
+        self.battery = 300
+        self.fast = False
+        self.walking = False
+        self.partial = ""
+
+    def send(self, command):
+        self.proc.stdin.write(command + "\n")
+        self.proc.stdin.flush()
+
+    def lit(self, name):
+        if name not in self.symbols and not (name in L1_DIGITS + L2_DIGITS):
+            return False
+        if self.blink_phase and (name in self.blink or "ALL" in self.blink):
+            return False
+        return True
+
+    def render_line(self, names, first, separators):
+        rows = [u"", u"", u""]
+        for i, name in enumerate(names):
+            bits = self.digits[first + i] if self.lit(name) else 0
+            for r, text in enumerate(segments(bits)):
+                rows[r] += text
+            # Colon or decimal point after this digit
+            colon = point = False
+            for symbol in separators.get(i, []):
+                if symbol in self.symbols and self.lit(symbol):
+                    colon = colon or "COL" in symbol
+                    point = point or "DP" in symbol
+            rows[0] += u" "
+            rows[1] += u"." if colon else u" "
+            rows[2] += u"." if colon or point else u" "
+        return u"\n".join(rows)
+
+    def redraw(self):
+        line1 = self.render_line(L1_DIGITS, 0, {1: ["L1_DP1", "L1_COL"], 2: ["L1_DP0"]})
+        line2 = self.render_line(L2_DIGITS, 4, {1: ["L2_COL1"], 3: ["L2_DP", "L2_COL0"]})
+        self.line1.set_text(line1)
+        self.line2.set_text(line2)
+
+        icons = sorted(s for s in self.symbols if s not in INLINE_SYMBOLS and self.lit(s))
+        self.icons.set_text(u" ".join(icons))
+
+        status = u"%8.1f s   temp %.1f C   alt %d m   batt %.2f V   %s%s%s%s" % (
+            self.now / 1000.0, self.temperature / 10.0, self.altitude, self.battery / 100.0,
+            u"fast" if self.fast else u"real time",
+            u"   WALK" if self.walking else u"",
+            u"   BUZZ %d Hz" % self.buzz if self.buzz else u"",
+            u"   LIGHT" if self.light else u"")
+        self.status.set_text(status)
+
+        rows = [u"%-44s %8s %8s %12s" % (u"screen", u"seconds", u"wakeups", u"cycles/s")]
+        for name in sorted(self.cpu):
+            wakeups, cycles, seconds = self.cpu[name]
+            rows.append(u"%-44s %8.1f %8d %12.0f" % (name, seconds, wakeups, cycles / seconds if seconds else 0))
+        self.table.set_text(u"\n".join(rows))
+
+    def parse(self, line):
+        words = line.split(" ", 2)
+        if len(words) < 2:
+            return
+        self.now = int(words[1])
+        if words[0] == "lcd":
+            fields = line.split("|")
+            hexdigits = fields[3]
+            self.digits = [int(hexdigits[i:i + 2], 16) for i in range(0, 20, 2)]
+            self.symbols = set(fields[4].split(",")) - set(["-"])
+            self.blink = set(fields[5].split(",")) - set(["-"])
+        elif words[0] == "buzz":
+            self.buzz = int(words[2])
+        elif words[0] == "light":
+            self.light = int(words[2])
+        elif words[0] == "cpu":
+            name, wakeups, cycles, seconds = words[2].split(" ")
+            self.cpu[name] = (int(wakeups), float(cycles), float(seconds))
+        elif words[0] == "rfbsl":
+            raise urwid.ExitMainLoop()
+
+    def output(self):
+        data = os.read(self.proc.stdout.fileno(), 4096)
+        if not data:
+            raise urwid.ExitMainLoop()
+        lines = (self.partial + data).split("\n")
+        self.partial = lines.pop()
+        for line in lines:
+            self.parse(line)
+        self.redraw()
+        self.loop.draw_screen()
+
+    def tick(self, loop, user_data):
+        # LCD blinks with 1Hz
+        self.blink_phase = not self.blink_phase
+        self.redraw()
+        loop.set_alarm_in(0.5, self.tick)
+
+    def keypress(self, key):
+        if key in ("f8", "Q"):
+            raise urwid.ExitMainLoop()
+        if key in BUTTONS:
+            self.send("press %s" % BUTTONS[key])
+        elif key.lower() in BUTTONS and key != key.lower():
+            self.send("press %s %d" % (BUTTONS[key.lower()], LONG_PRESS_MS))
+        elif key in ("+", "-"):
+            self.temperature += 10 if key == "+" else -10
+            self.send("temp %d" % self.temperature)
+        elif key in ("a", "z"):
+            self.altitude += 50 if key == "a" else -50
+            self.send("alt %d" % self.altitude)
+        elif key in ("v", "c"):
+            self.battery += 5 if key == "v" else -5
+            self.send("batt %d" % self.battery)
+        elif key == "m":
+            self.send("accel %d %d %d" % tuple(random.randint(-1500, 1500) for i in range(3)))
+        elif key == "w":
+            self.walking = not self.walking
+            self.send("walk %d" % (WALK_CADENCE if self.walking else 0))
+        elif key == "x":
+            self.fast = not self.fast
+            self.send("speed %d" % (0 if self.fast else 1))
+        self.redraw()
+
+    def main(self):
+        if not os.path.exists(EMULATOR):
+            sys.stderr.write("%s not found, run: make emulator_host\n" % EMULATOR)
+            sys.exit(1)
+        self.proc = subprocess.Popen([EMULATOR, "-p", "-q"] + self.args,
+                                     stdin=subprocess.PIPE, stdout=subprocess.PIPE)
+
+        self.line1 = urwid.Text(u"", align="center")
+        self.line2 = urwid.Text(u"", align="center")
+        self.icons = urwid.Text(u"", align="center")
+        self.status = urwid.Text(u"")
+        self.table = urwid.Text(u"")
+        lcd = urwid.LineBox(urwid.Pile([self.line1, urwid.Divider(), self.line2, urwid.Divider(), self.icons]))
+        body = urwid.Filler(urwid.Pile([urwid.Padding(lcd, 'center', 40), urwid.Divider(),
+                                        self.status, urwid.Divider(), self.table]), 'top')
+        header = urwid.AttrWrap(urwid.Text(u"OpenChronos emulator  |  " + HELP), 'header')
+        frame = urwid.Frame(urwid.AttrWrap(body, 'body'), header=header)
+
+        screen = urwid.raw_display.Screen()
+        palette = [
+            ('body', 'black', 'light gray', 'standout'),
+            ('header', 'white', 'dark red', 'bold'),
+            ]
+
+        loop = urwid.MainLoop(frame, palette, screen, unhandled_input=self.keypress)
+        self.loop = loop
+        loop.event_loop.watch_file(self.proc.stdout.fileno(), self.output)
+        loop.set_alarm_in(0.5, self.tick)
+        self.redraw()
+        try:
+            loop.run()
+        finally:
+            if self.proc.poll() is None:
+                try:
+                    self.send("quit")
+                except IOError:
+                    pass
+                self.proc.wait()
+
+
+if __name__ == "__main__":
+    EmulatorApp(sys.argv[1:]).main()
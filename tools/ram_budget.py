@@ -0,0 +1,283 @@
+#!/usr/bin/env python
+# encoding: utf-8
+#
+# RAM budget of a firmware image.
+#
+#  - static RAM (.data, .bss, .noinit) per object file from the linker map (-Wl,-Map=output.map)
+#  - worst case stack depth of main() and of every interrupt handler, from the call graph of
+#    the disassembled image. Frame sizes come from the prologues (push, sub #n,r1), or from
+#    -fstack-usage .su files when the compiler supports it.
+#  - fails if static RAM plus worst case stack (main plus nested interrupts) exceeds the RAM.
+#
+# Indirect calls (menu function pointers, timer callbacks) are charged with the deepest
+# function that is never called directly, recursion is reported and cut at the back edge.
+#
+# Example:
+#
+#   tools/ram_budget.py --map output.map --elf build/eZChronos.elf --reserve 64
+#
+
+from __future__ import print_function
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+RAM_SIZE = 4096
+
+STATIC_SECTIONS = ('.data', '.bss', '.noinit')
+
+# Return address pushed by call, PC and SR pushed on interrupt entry
+CALL_COST = 2
+IRQ_COST = 4
+
+
+# ---------------------------------------------------------------------------------------------
+# Linker map
+
+MAP_OUTPUT = re.compile(r'^(\.\w+)\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)')
+MAP_INPUT = re.compile(r'^ (\.\w+|COMMON)(\.\S+)?\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S+)')
+MAP_INPUT_NAME = re.compile(r'^ (\.\w+|COMMON)(\.\S+)?\s*$')
+MAP_INPUT_WRAPPED = re.compile(r'^\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S+)')
+
+
+def parse_map(path):
+    """Return ({module: {section: bytes}}, {section: bytes})."""
+    modules = {}
+    totals = {}
+    section = None
+    pending = False
+    for line in open(path):
+        line = line.rstrip('\r\n')
+        m = MAP_OUTPUT.match(line)
+        if m:
+            section = m.group(1)
+            if section in STATIC_SECTIONS:
+                totals[section] = int(m.group(3), 16)
+            pending = False
+            continue
+        if re.match(r'^\.\w+\s*$', line):
+            section = line.strip()
+            pending = False
+            continue
+        if section not in STATIC_SECTIONS:
+            continue
+        m = MAP_INPUT.match(line)
+        if m:
+            size, obj = int(m.group(4), 16), m.group(5)
+        elif MAP_INPUT_NAME.match(line):
+            pending = True
+            continue
+        elif pending and MAP_INPUT_WRAPPED.match(line):
+            m = MAP_INPUT_WRAPPED.match(line)
+            size, obj = int(m.group(2), 16), m.group(3)
+        else:
+            pending = False
+            continue
+        pending = False
+        if size == 0:
+            continue
+        entry = modules.setdefault(os.path.normpath(obj), {})
+        entry[section] = entry.get(section, 0) + size
+    return modules, totals
+
+
+# ---------------------------------------------------------------------------------------------
+# Disassembly
+
+FUNC = re.compile(r'^([0-9a-f]+) <([^>]+)>:')
+INSN = re.compile(r'^\s*([0-9a-f]+):\s+(?:[0-9a-f]{2} )+\s*([a-z.]+)\s*([^;]*)')
+IMM = re.compile(r'#(-?0x[0-9a-f]+|-?\d+)')
+TO_SP = re.compile(r',\s*r1$')
+
+
+def immediate(text):
+    m = IMM.search(text)
+    if not m:
+        return None
+    return int(m.group(1), 0) & 0xFFFF
+
+
+class Function(object):
+    def __init__(self, name, addr):
+        self.name = name
+        self.addr = addr
+        self.frame = 0          # prologue
+        self.extra = 0          # deepest argument pushes
+        self.calls = []         # (depth at call site, address or None, tail call)
+        self.isr = False
+        self.called = False
+        self.depth = None
+        self.path = []
+
+
+def parse_objdump(elf, objdump):
+    out = subprocess.check_output([objdump, '-d', elf])
+    if not isinstance(out, str):
+        out = out.decode('latin-1')
+    funcs = {}
+    f = None
+    prologue = True
+    running = 0
+    for line in out.splitlines():
+        m = FUNC.match(line)
+        if m:
+            f = Function(m.group(2), int(m.group(1), 16))
+            funcs[f.addr] = f
+            prologue, running = True, 0
+            continue
+        m = INSN.match(line)
+        if not m or f is None:
+            continue
+        op, args = m.group(2), m.group(3).strip()
+        size = 0
+        if op.startswith('push'):
+            size = 2 * (immediate(args) or 1) if op.startswith('pushm') else 2
+        elif op.startswith('sub') and TO_SP.search(args) and immediate(args) is not None:
+            size = immediate(args)
+        elif op.startswith('add') and TO_SP.search(args) and immediate(args) is not None:
+            size = -(immediate(args) - 0x10000) if immediate(args) & 0x8000 else -immediate(args)
+        elif op.startswith('decd') and args == 'r1':
+            size = 2
+        elif op.startswith('pop') or (op.startswith('incd') and args == 'r1'):
+            size = -2
+        if prologue:
+            if size > 0:
+                f.frame += size
+                continue
+            prologue = False
+        running = max(running + size, 0)
+        f.extra = max(f.extra, running)
+        if op.startswith('call'):
+            target = immediate(args) if args.startswith('#') else None
+            f.calls.append((f.frame + running, target, False))
+        elif op.startswith('br') and args.startswith('#'):
+            f.calls.append((f.frame + running, immediate(args), True))
+        elif op.startswith('reti'):
+            f.isr = True
+        if op.startswith('ret'):
+            running = 0
+    return funcs
+
+
+def parse_su(paths):
+    frames = {}
+    for root in paths:
+        for dirpath, _, files in os.walk(root):
+            for name in files:
+                if not name.endswith('.su'):
+                    continue
+                for line in open(os.path.join(dirpath, name)):
+                    parts = line.split('\t')
+                    if len(parts) >= 2:
+                        frames[parts[0].split(':')[-1]] = int(parts[1])
+    return frames
+
+
+def solve(funcs, su):
+    for f in funcs.values():
+        if f.name in su:
+            f.frame = max(f.frame, su[f.name])
+        for _, target, _ in f.calls:
+            if target in funcs:
+                funcs[target].called = True
+
+    recursion = set()
+    indirect = [0, []]
+
+    def depth(f, stack):
+        if f.depth is not None:
+            return f.depth
+        if f in stack:
+            recursion.add(f.name)
+            return 0
+        stack.append(f)
+        best, path = f.frame + f.extra, []
+        for site, target, tail in f.calls:
+            cost = 0 if tail else CALL_COST
+            if target is None:
+                d, p = indirect
+            elif target in funcs:
+                callee = funcs[target]
+                d, p = depth(callee, stack), [callee.name] + callee.path
+            else:
+                continue
+            if site + cost + d > best:
+                best, path = site + cost + d, p
+        stack.pop()
+        f.depth, f.path = best, path
+        return best
+
+    # Indirect targets may call through pointers themselves, repeat until the worst case is stable
+    candidates = [f for f in funcs.values() if not f.called and not f.isr and f.name != 'main']
+    for _ in range(4):
+        for f in funcs.values():
+            f.depth = None
+        worst = [0, []]
+        for f in candidates:
+            if depth(f, []) > worst[0]:
+                worst = [f.depth, [f.name + '()*'] + f.path]
+        if worst[0] == indirect[0]:
+            break
+        indirect[:] = worst
+    for f in funcs.values():
+        depth(f, [])
+    return recursion
+
+
+# ---------------------------------------------------------------------------------------------
+
+def main():
+    p = argparse.ArgumentParser(description='Static RAM and worst case stack budget')
+    p.add_argument('--map', required=True, help='linker map file')
+    p.add_argument('--elf', required=True, help='linked image')
+    p.add_argument('--objdump', default='msp430-objdump')
+    p.add_argument('--su', action='append', default=[], metavar='DIR',
+                   help='directory with -fstack-usage .su files (may be repeated)')
+    p.add_argument('--ram', type=int, default=RAM_SIZE, help='RAM size in bytes')
+    p.add_argument('--reserve', type=int, default=0, help='bytes to keep free')
+    p.add_argument('--nest', type=int, default=2,
+                   help='interrupt nesting levels on top of main (PORT2 re-enables interrupts)')
+    p.add_argument('--top', type=int, default=15, help='number of modules to list')
+    args = p.parse_args()
+
+    modules, totals = parse_map(args.map)
+    static = sum(totals.get(s, 0) for s in STATIC_SECTIONS)
+
+    print('Static RAM per module')
+    rows = sorted(modules.items(), key=lambda kv: -sum(kv[1].values()))
+    for obj, sections in rows[:args.top]:
+        print('  %5d  %-32s %s' % (sum(sections.values()), obj,
+              ' '.join('%s=%d' % (s, sections[s]) for s in STATIC_SECTIONS if s in sections)))
+    print('  %5d  total (%s)' % (static, ', '.join('%s=%d' % (s, totals.get(s, 0)) for s in STATIC_SECTIONS)))
+
+    funcs = parse_objdump(args.elf, args.objdump)
+    recursion = solve(funcs, parse_su(args.su))
+    byname = dict((f.name, f) for f in funcs.values())
+
+    print('Worst case stack')
+    entry = byname.get('main')
+    main_depth = entry.depth if entry else 0
+    if entry:
+        print('  %5d  main -> %s' % (main_depth, ' -> '.join(entry.path) or '-'))
+    isrs = sorted((f for f in funcs.values() if f.isr), key=lambda f: -f.depth)
+    for f in isrs:
+        print('  %5d  %s -> %s' % (f.depth + IRQ_COST, f.name, ' -> '.join(f.path) or '-'))
+    if recursion:
+        print('  recursion (cut at back edge): %s' % ', '.join(sorted(recursion)))
+
+    irq = sum(f.depth + IRQ_COST for f in isrs[:args.nest])
+    stack = main_depth + irq
+    used = static + stack + args.reserve
+    print('Budget: %d static + %d stack (main %d, %d nested irq %d) + %d reserve = %d of %d bytes'
+          % (static, stack, main_depth, min(args.nest, len(isrs)), irq, args.reserve, used, args.ram))
+    if used > args.ram:
+        print('RAM budget exceeded by %d bytes' % (used - args.ram), file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())